@@ -36,12 +36,28 @@ public:
         return p;
     }
 
+    /// Add distortion to the points (one point per column)
+    virtual void addDistortion(const Mat2X& pts, Mat2X& distorted) const
+    {
+        distorted.resize(2, pts.cols());
+        for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+            distorted.col(i) = addDistortion(pts.col(i));
+    }
+
     /// Remove distortion (return p' such that disto(p') = p)
     virtual Vec2 removeDistortion(const Vec2& p) const
     {
         return p;
     }
 
+    /// Remove distortion of the points (one point per column)
+    virtual void removeDistortion(const Mat2X& pts, Mat2X& undistorted) const
+    {
+        undistorted.resize(2, pts.cols());
+        for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+            undistorted.col(i) = removeDistortion(pts.col(i));
+    }
+
     virtual double getUndistortedRadius(double r) const
     {
         return r;
@@ -36,15 +36,23 @@ public:
 
   Distortion3DERadial4* clone() const override { return new Distortion3DERadial4(*this); }
 
+  /// Number of distortion parameters (size of the params of the static functions)
+  static constexpr int nbParams = 6;
+
   /// Add distortion to the point p (assume p is in the camera frame [normalized coordinates])
   Vec2 addDistortion(const Vec2 & p) const override
   {
-    const double c2 = _distortionParams[0];
-    const double c4 = _distortionParams[1];
-    const double u1 = _distortionParams[2];
-    const double v1 = _distortionParams[3];
-    const double u3 = _distortionParams[4];
-    const double v3 = _distortionParams[5];
+    return addDistortion(_distortionParams.data(), p);
+  }
+
+  static Vec2 addDistortion(const double* params, const Vec2 & p)
+  {
+    const double c2 = params[0];
+    const double c4 = params[1];
+    const double u1 = params[2];
+    const double v1 = params[3];
+    const double u3 = params[4];
+    const double v3 = params[5];
 
     Vec2 np;
 
@@ -71,14 +79,27 @@ public:
     return np;
   }
 
+  /// Add distortion to the points (one point per column)
+  void addDistortion(const Mat2X& pts, Mat2X& distorted) const override
+  {
+    distorted.resize(2, pts.cols());
+    for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+      distorted.col(i) = addDistortion(_distortionParams.data(), pts.col(i));
+  }
+
   Eigen::Matrix2d getDerivativeAddDistoWrtPt(const Vec2 & p) const override
   {
-    const double c2 = _distortionParams[0];
-    const double c4 = _distortionParams[1];
-    const double u1 = _distortionParams[2];
-    const double v1 = _distortionParams[3];
-    const double u3 = _distortionParams[4];
-    const double v3 = _distortionParams[5];
+    return getDerivativeAddDistoWrtPt(_distortionParams.data(), p);
+  }
+
+  static Eigen::Matrix2d getDerivativeAddDistoWrtPt(const double* params, const Vec2 & p)
+  {
+    const double c2 = params[0];
+    const double c4 = params[1];
+    const double u1 = params[2];
+    const double v1 = params[3];
+    const double u3 = params[4];
+    const double v3 = params[5];
 
     Vec2 np;
 
@@ -148,14 +169,19 @@ public:
     return ret;
   }
 
-  Eigen::MatrixXd getDerivativeAddDistoWrtDisto(const Vec2 & p) const  override
+  Eigen::MatrixXd getDerivativeAddDistoWrtDisto(const Vec2 & p) const override
   {
-    const double c2 = _distortionParams[0];
-    const double c4 = _distortionParams[1];
-    const double u1 = _distortionParams[2];
-    const double v1 = _distortionParams[3];
-    const double u3 = _distortionParams[4];
-    const double v3 = _distortionParams[5];
+    return getDerivativeAddDistoWrtDisto(_distortionParams.data(), p);
+  }
+
+  static Eigen::Matrix<double, 2, nbParams> getDerivativeAddDistoWrtDisto(const double* params, const Vec2 & p)
+  {
+    const double c2 = params[0];
+    const double c4 = params[1];
+    const double u1 = params[2];
+    const double v1 = params[3];
+    const double u3 = params[4];
+    const double v3 = params[5];
     
     Vec2 np;
 
@@ -284,13 +310,21 @@ public:
 
   Distortion3DEAnamorphic4* clone() const override { return new Distortion3DEAnamorphic4(*this); }
 
+  /// Number of distortion parameters (size of the params of the static functions)
+  static constexpr int nbParams = 4;
+
   /// Add distortion to the point p (assume p is in the camera frame [normalized coordinates])
   Vec2 addDistortion(const Vec2 & p) const override
   {
-    const double cxx = _distortionParams[0];
-    const double cxy = _distortionParams[1];
-    const double cyx = _distortionParams[2];
-    const double cyy = _distortionParams[3];
+    return addDistortion(_distortionParams.data(), p);
+  }
+
+  static Vec2 addDistortion(const double* params, const Vec2 & p)
+  {
+    const double cxx = params[0];
+    const double cxy = params[1];
+    const double cyx = params[2];
+    const double cyy = params[3];
 
     Vec2 np;
 
@@ -305,12 +339,25 @@ public:
     return np;
   }
 
+  /// Add distortion to the points (one point per column)
+  void addDistortion(const Mat2X& pts, Mat2X& distorted) const override
+  {
+    distorted.resize(2, pts.cols());
+    for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+      distorted.col(i) = addDistortion(_distortionParams.data(), pts.col(i));
+  }
+
   Eigen::Matrix2d getDerivativeAddDistoWrtPt(const Vec2 & p) const override
   {
-    const double cxx = _distortionParams[0];
-    const double cxy = _distortionParams[1];
-    const double cyx = _distortionParams[2];
-    const double cyy = _distortionParams[3];
+    return getDerivativeAddDistoWrtPt(_distortionParams.data(), p);
+  }
+
+  static Eigen::Matrix2d getDerivativeAddDistoWrtPt(const double* params, const Vec2 & p)
+  {
+    const double cxx = params[0];
+    const double cxy = params[1];
+    const double cyx = params[2];
+    const double cyy = params[3];
 
     double x = p.x();
     double y = p.y();
@@ -333,12 +380,17 @@ public:
     return ret;
   }
 
-  Eigen::MatrixXd getDerivativeAddDistoWrtDisto(const Vec2 & p) const  override
+  Eigen::MatrixXd getDerivativeAddDistoWrtDisto(const Vec2 & p) const override
+  {
+    return getDerivativeAddDistoWrtDisto(_distortionParams.data(), p);
+  }
+
+  static Eigen::Matrix<double, 2, nbParams> getDerivativeAddDistoWrtDisto(const double* params, const Vec2 & p)
   {
-    const double cxx = _distortionParams[0];
-    const double cxy = _distortionParams[1];
-    const double cyx = _distortionParams[2];
-    const double cyy = _distortionParams[3];
+    const double cxx = params[0];
+    const double cxy = params[1];
+    const double cyx = params[2];
+    const double cyy = params[3];
 
     Vec2 np;
 
@@ -429,14 +481,22 @@ public:
 
   Distortion3DEClassicLD* clone() const override { return new Distortion3DEClassicLD(*this); }
 
+  /// Number of distortion parameters (size of the params of the static functions)
+  static constexpr int nbParams = 5;
+
   /// Add distortion to the point p (assume p is in the camera frame [normalized coordinates])
   Vec2 addDistortion(const Vec2 & p) const override
   {
-    const double delta = _distortionParams[0];
-    const double invepsilon = _distortionParams[1];
-    const double mux = _distortionParams[2];
-    const double muy = _distortionParams[3];
-    const double q = _distortionParams[4];
+    return addDistortion(_distortionParams.data(), p);
+  }
+
+  static Vec2 addDistortion(const double* params, const Vec2 & p)
+  {
+    const double delta = params[0];
+    const double invepsilon = params[1];
+    const double mux = params[2];
+    const double muy = params[3];
+    const double q = params[4];
 
     const double eps = 1.0 + cos(invepsilon);
 
@@ -469,13 +529,26 @@ public:
     return np;
   }
 
+  /// Add distortion to the points (one point per column)
+  void addDistortion(const Mat2X& pts, Mat2X& distorted) const override
+  {
+    distorted.resize(2, pts.cols());
+    for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+      distorted.col(i) = addDistortion(_distortionParams.data(), pts.col(i));
+  }
+
   Eigen::Matrix2d getDerivativeAddDistoWrtPt(const Vec2 & p) const override
   {
-    const double delta = _distortionParams[0];
-    const double invepsilon = _distortionParams[1];
-    const double mux = _distortionParams[2];
-    const double muy = _distortionParams[3];
-    const double q = _distortionParams[4];
+    return getDerivativeAddDistoWrtPt(_distortionParams.data(), p);
+  }
+
+  static Eigen::Matrix2d getDerivativeAddDistoWrtPt(const double* params, const Vec2 & p)
+  {
+    const double delta = params[0];
+    const double invepsilon = params[1];
+    const double mux = params[2];
+    const double muy = params[3];
+    const double q = params[4];
     
     const double eps = 1.0 + cos(invepsilon);
 
@@ -525,13 +598,18 @@ public:
     return ret;
   }
 
-  Eigen::MatrixXd getDerivativeAddDistoWrtDisto(const Vec2 & p) const  override
+  Eigen::MatrixXd getDerivativeAddDistoWrtDisto(const Vec2 & p) const override
+  {
+    return getDerivativeAddDistoWrtDisto(_distortionParams.data(), p);
+  }
+
+  static Eigen::Matrix<double, 2, nbParams> getDerivativeAddDistoWrtDisto(const double* params, const Vec2 & p)
   {
-    const double delta = _distortionParams[0];
-    const double invepsilon = _distortionParams[1];
-    const double mux = _distortionParams[2];
-    const double muy = _distortionParams[3];
-    const double q = _distortionParams[4];
+    const double delta = params[0];
+    const double invepsilon = params[1];
+    const double mux = params[2];
+    const double muy = params[3];
+    const double q = params[4];
     
     const double eps = 1.0 + cos(invepsilon);
 
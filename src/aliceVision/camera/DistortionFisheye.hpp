@@ -30,8 +30,16 @@ public:
       return new DistortionFisheye(*this);
   }
 
+  /// Number of distortion parameters (size of the params of the static functions)
+  static constexpr int nbParams = 4;
+
   /// Add distortion to the point p (assume p is in the camera frame [normalized coordinates])
   Vec2 addDistortion(const Vec2 & p) const override
+  {
+    return addDistortion(_distortionParams.data(), p);
+  }
+
+  static Vec2 addDistortion(const double* params, const Vec2 & p)
   {
     const double eps = 1e-8;
     const double r = std::hypot(p(0), p(1));
@@ -40,10 +48,10 @@ public:
       return p;
     }
 
-    const double k1 = _distortionParams.at(0);
-    const double k2 = _distortionParams.at(1);
-    const double k3 = _distortionParams.at(2);
-    const double k4 = _distortionParams.at(3);    
+    const double k1 = params[0];
+    const double k2 = params[1];
+    const double k3 = params[2];
+    const double k4 = params[3];    
 
     const double theta = std::atan(r);
     const double theta2 = theta*theta;
@@ -60,7 +68,20 @@ public:
     return p * cdist;
   }
 
-   Eigen::Matrix2d getDerivativeAddDistoWrtPt(const Vec2 & p) const override
+  /// Add distortion to the points (one point per column)
+  void addDistortion(const Mat2X& pts, Mat2X& distorted) const override
+  {
+    distorted.resize(2, pts.cols());
+    for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+      distorted.col(i) = addDistortion(_distortionParams.data(), pts.col(i));
+  }
+
+  Eigen::Matrix2d getDerivativeAddDistoWrtPt(const Vec2 & p) const override
+  {
+    return getDerivativeAddDistoWrtPt(_distortionParams.data(), p);
+  }
+
+  static Eigen::Matrix2d getDerivativeAddDistoWrtPt(const double* params, const Vec2 & p)
   {
       const double eps = 1e-8;
       const double r = sqrt(p(0) * p(0) + p(1) * p(1));
@@ -69,10 +90,10 @@ public:
           return Eigen::Matrix2d::Identity();
       }
 
-      const double k1 = _distortionParams.at(0);
-      const double k2 = _distortionParams.at(1);
-      const double k3 = _distortionParams.at(2);
-      const double k4 = _distortionParams.at(3);
+      const double k1 = params[0];
+      const double k2 = params[1];
+      const double k3 = params[2];
+      const double k4 = params[3];
 
       const double theta = std::atan(r);
       const double theta2 = theta * theta;
@@ -101,7 +122,12 @@ public:
       return Eigen::Matrix2d::Identity() * cdist + p * d_cdist_d_p;
   }
 
-  Eigen::MatrixXd getDerivativeAddDistoWrtDisto(const Vec2 & p) const  override
+  Eigen::MatrixXd getDerivativeAddDistoWrtDisto(const Vec2 & p) const override
+  {
+    return getDerivativeAddDistoWrtDisto(_distortionParams.data(), p);
+  }
+
+  static Eigen::Matrix<double, 2, nbParams> getDerivativeAddDistoWrtDisto(const double* params, const Vec2 & p)
   {
     
     const double eps = 1e-8;
@@ -130,7 +156,7 @@ public:
     d_r_theta_dist_d_params(0, 2) = theta7;
     d_r_theta_dist_d_params(0, 3) = theta9;
 
-    const Eigen::MatrixXd ret = p * d_cdist_d_theta_dist * d_r_theta_dist_d_params;
+    const Eigen::Matrix<double, 2, nbParams> ret = p * d_cdist_d_theta_dist * d_r_theta_dist_d_params;
 
     return ret;
   }
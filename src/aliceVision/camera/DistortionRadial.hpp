@@ -73,10 +73,18 @@ public:
 
   DistortionRadialK1* clone() const override { return new DistortionRadialK1(*this); }
 
+  /// Number of distortion parameters (size of the params of the static functions)
+  static constexpr int nbParams = 1;
+
   /// Add distortion to the point p (assume p is in the camera frame [normalized coordinates])
   Vec2 addDistortion(const Vec2 & p) const override
   {
-    const double k1 = _distortionParams.at(0);
+    return addDistortion(_distortionParams.data(), p);
+  }
+
+  static Vec2 addDistortion(const double* params, const Vec2 & p)
+  {
+    const double k1 = params[0];
 
     const double r2 = p(0)*p(0) + p(1)*p(1);
     const double r_coeff = (1. + k1*r2);
@@ -84,10 +92,24 @@ public:
     return (p * r_coeff);
   }
 
+  /// Add distortion to the points (one point per column)
+  void addDistortion(const Mat2X& pts, Mat2X& distorted) const override
+  {
+    const double k1 = _distortionParams[0];
+
+    const Eigen::Array<double, 1, Eigen::Dynamic> r2 = pts.colwise().squaredNorm().array();
+    distorted = pts.array().rowwise() * (1. + k1 * r2);
+  }
+
   Eigen::Matrix2d getDerivativeAddDistoWrtPt(const Vec2 & p) const override
   {
+    return getDerivativeAddDistoWrtPt(_distortionParams.data(), p);
+  }
 
-    const double k1 = _distortionParams[0];
+  static Eigen::Matrix2d getDerivativeAddDistoWrtPt(const double* params, const Vec2 & p)
+  {
+
+    const double k1 = params[0];
 
     const double r = sqrt(p(0)*p(0) + p(1)*p(1));
     const double eps = 1e-8;
@@ -110,10 +132,15 @@ public:
     return Eigen::Matrix2d::Identity() * r_coeff + p * d_r_coeff_d_p;
   }
 
-  Eigen::MatrixXd getDerivativeAddDistoWrtDisto(const Vec2 & p) const  override
+  Eigen::MatrixXd getDerivativeAddDistoWrtDisto(const Vec2 & p) const override
+  {
+    return getDerivativeAddDistoWrtDisto(_distortionParams.data(), p);
+  }
+
+  static Eigen::Matrix<double, 2, nbParams> getDerivativeAddDistoWrtDisto(const double* params, const Vec2 & p)
   {
     
-    const double k1 = _distortionParams[0];
+    const double k1 = params[0];
 
     const double r = sqrt(p(0)*p(0) + p(1)*p(1));   
     const double eps = 1e-8;
@@ -122,7 +149,7 @@ public:
       return Eigen::Matrix<double, 2, 1>::Zero();
     }
 
-    const Eigen::MatrixXd ret = p * r * r;
+    const Eigen::Matrix<double, 2, nbParams> ret = p * r * r;
 
     return ret;
   }
@@ -227,12 +254,20 @@ public:
 
   DistortionRadialK3* clone() const override { return new DistortionRadialK3(*this); }
 
+  /// Number of distortion parameters (size of the params of the static functions)
+  static constexpr int nbParams = 3;
+
   /// Add distortion to the point p (assume p is in the camera frame [normalized coordinates])
   Vec2 addDistortion(const Vec2 & p) const override
   {
-    const double k1 = _distortionParams[0];
-    const double k2 = _distortionParams[1];
-    const double k3 = _distortionParams[2];
+    return addDistortion(_distortionParams.data(), p);
+  }
+
+  static Vec2 addDistortion(const double* params, const Vec2 & p)
+  {
+    const double k1 = params[0];
+    const double k2 = params[1];
+    const double k3 = params[2];
 
     const double r = sqrt(p(0)*p(0) + p(1)*p(1));
     
@@ -244,13 +279,29 @@ public:
     return (p * r_coeff);
   }
 
-  Eigen::Matrix2d getDerivativeAddDistoWrtPt(const Vec2 & p) const override
+  /// Add distortion to the points (one point per column)
+  void addDistortion(const Mat2X& pts, Mat2X& distorted) const override
   {
-
     const double k1 = _distortionParams[0];
     const double k2 = _distortionParams[1];
     const double k3 = _distortionParams[2];
 
+    const Eigen::Array<double, 1, Eigen::Dynamic> r2 = pts.colwise().squaredNorm().array();
+    distorted = pts.array().rowwise() * (1. + r2 * (k1 + r2 * (k2 + r2 * k3)));
+  }
+
+  Eigen::Matrix2d getDerivativeAddDistoWrtPt(const Vec2 & p) const override
+  {
+    return getDerivativeAddDistoWrtPt(_distortionParams.data(), p);
+  }
+
+  static Eigen::Matrix2d getDerivativeAddDistoWrtPt(const double* params, const Vec2 & p)
+  {
+
+    const double k1 = params[0];
+    const double k2 = params[1];
+    const double k3 = params[2];
+
     const double r = sqrt(p(0)*p(0) + p(1)*p(1));
     const double eps = 1e-8;
     if (r < eps)
@@ -276,7 +327,12 @@ public:
     return Eigen::Matrix2d::Identity() * r_coeff + p * d_r_coeff_d_p;
   }
 
-  Eigen::MatrixXd getDerivativeAddDistoWrtDisto(const Vec2 & p) const  override
+  Eigen::MatrixXd getDerivativeAddDistoWrtDisto(const Vec2 & p) const override
+  {
+    return getDerivativeAddDistoWrtDisto(_distortionParams.data(), p);
+  }
+
+  static Eigen::Matrix<double, 2, nbParams> getDerivativeAddDistoWrtDisto(const double* params, const Vec2 & p)
   {
     const double r = sqrt(p(0)*p(0) + p(1)*p(1));
     const double eps = 1e-8;
@@ -296,7 +352,7 @@ public:
     d_r_coeff_d_params(0, 1) = r4;
     d_r_coeff_d_params(0, 2) = r6;
 
-    Eigen::MatrixXd ret = p * d_r_coeff_d_params;
+    Eigen::Matrix<double, 2, nbParams> ret = p * d_r_coeff_d_params;
 
     return ret;
   }
@@ -398,12 +454,20 @@ public:
 
   DistortionRadialK3PT* clone() const override { return new DistortionRadialK3PT(*this); }
 
+  /// Number of distortion parameters (size of the params of the static functions)
+  static constexpr int nbParams = 3;
+
   /// Add distortion to the point p (assume p is in the camera frame [normalized coordinates])
   Vec2 addDistortion(const Vec2 & p) const override
   {
-    const double k1 = _distortionParams[0];
-    const double k2 = _distortionParams[1];
-    const double k3 = _distortionParams[2];
+    return addDistortion(_distortionParams.data(), p);
+  }
+
+  static Vec2 addDistortion(const double* params, const Vec2 & p)
+  {
+    const double k1 = params[0];
+    const double k2 = params[1];
+    const double k3 = params[2];
 
     const double r = sqrt(p(0)*p(0) + p(1)*p(1));
     
@@ -416,13 +480,29 @@ public:
     return (p * r_coeff);
   }
 
-  Eigen::Matrix2d getDerivativeAddDistoWrtPt(const Vec2 & p) const override
+  /// Add distortion to the points (one point per column)
+  void addDistortion(const Mat2X& pts, Mat2X& distorted) const override
   {
-
     const double k1 = _distortionParams[0];
     const double k2 = _distortionParams[1];
     const double k3 = _distortionParams[2];
 
+    const Eigen::Array<double, 1, Eigen::Dynamic> r2 = pts.colwise().squaredNorm().array();
+    distorted = pts.array().rowwise() * ((1. + r2 * (k1 + r2 * (k2 + r2 * k3))) / (1.0 + k1 + k2 + k3));
+  }
+
+  Eigen::Matrix2d getDerivativeAddDistoWrtPt(const Vec2 & p) const override
+  {
+    return getDerivativeAddDistoWrtPt(_distortionParams.data(), p);
+  }
+
+  static Eigen::Matrix2d getDerivativeAddDistoWrtPt(const double* params, const Vec2 & p)
+  {
+
+    const double k1 = params[0];
+    const double k2 = params[1];
+    const double k3 = params[2];
+
     const double r = sqrt(p(0)*p(0) + p(1)*p(1));
     if (r < 1e-12) {
       return Eigen::Matrix2d::Identity();
@@ -446,12 +526,17 @@ public:
     return Eigen::Matrix2d::Identity() * r_coeff + p * d_r_coeff_d_p;
   }
 
-  Eigen::MatrixXd getDerivativeAddDistoWrtDisto(const Vec2 & p) const  override
+  Eigen::MatrixXd getDerivativeAddDistoWrtDisto(const Vec2 & p) const override
+  {
+    return getDerivativeAddDistoWrtDisto(_distortionParams.data(), p);
+  }
+
+  static Eigen::Matrix<double, 2, nbParams> getDerivativeAddDistoWrtDisto(const double* params, const Vec2 & p)
   {
     
-    const double k1 = _distortionParams[0];
-    const double k2 = _distortionParams[1];
-    const double k3 = _distortionParams[2];
+    const double k1 = params[0];
+    const double k2 = params[1];
+    const double k3 = params[2];
 
     const double r = sqrt(p(0)*p(0) + p(1)*p(1));
     const double eps = 1e-8;
@@ -480,7 +565,7 @@ public:
     d_denum_d_params(0, 2) = 1;
 
     Eigen::Matrix<double, 1, 3> d_rcoeff_d_params = (denum * d_num_d_params - num * d_denum_d_params) / denum2;
-    Eigen::MatrixXd ret = p * d_rcoeff_d_params;
+    Eigen::Matrix<double, 2, nbParams> ret = p * d_rcoeff_d_params;
 
     return ret;
   }
@@ -96,6 +96,38 @@ public:
     return pt_ima;
   }
 
+  void project(const geometry::Pose3& pose, const Mat4X& pts, Mat2X& pts2D, bool applyDistortion = true) const override
+  {
+    const double rsensor = std::min(sensorWidth(), sensorHeight());
+    const double rscale = sensorWidth() / std::max(w(), h());
+    const double fmm = _scale(0) * rscale;
+    const double fov = rsensor / fmm;
+
+    const Mat3X X = pose.getHomogeneous().topRows<3>() * pts;
+
+    Mat2X P(2, X.cols());
+    for (Mat3X::Index i = 0; i < X.cols(); ++i)
+    {
+      // Compute angle with optical center
+      const double angle_Z = std::atan2(sqrt(X(0, i) * X(0, i) + X(1, i) * X(1, i)), X(2, i));
+
+      // Ignore depth component and compute radial angle
+      const double angle_radial = std::atan2(X(1, i), X(0, i));
+
+      const double radius = angle_Z / (0.5 * fov);
+
+      P(0, i) = cos(angle_radial) * radius;
+      P(1, i) = sin(angle_radial) * radius;
+    }
+
+    if (applyDistortion && hasDistortion())
+      _pDistortion->addDistortion(P, pts2D);
+    else
+      pts2D = P;
+
+    this->cam2ima(pts2D, pts2D);
+  }
+
   Eigen::Matrix<double, 2, 9> getDerivativeProjectWrtRotation(const geometry::Pose3& pose, const Vec4 & pt) 
   {
     Eigen::Matrix4d T = pose.getHomogeneous();
@@ -397,6 +429,12 @@ public:
     return _circleRadius * p  + getPrincipalPoint();
   }
 
+  // Transform points from the camera plane to the image plane (one point per column)
+  void cam2ima(const Mat2X& pts, Mat2X& ptsIma) const override
+  {
+    ptsIma = (_circleRadius * pts).colwise() + getPrincipalPoint();
+  }
+
   Eigen::Matrix2d getDerivativeCam2ImaWrtPoint() const override
   {
     return Eigen::Matrix2d::Identity() * _circleRadius;
@@ -408,6 +446,12 @@ public:
     return (p - getPrincipalPoint()) / _circleRadius;
   }
 
+  // Transform points from the image plane to the camera plane (one point per column)
+  void ima2cam(const Mat2X& pts, Mat2X& ptsCam) const override
+  {
+    ptsCam = (pts.colwise() - getPrincipalPoint()) / _circleRadius;
+  }
+
   Eigen::Matrix2d getDerivativeIma2CamWrtPoint() const override
   {
     return Eigen::Matrix2d::Identity() * (1.0 / _circleRadius);
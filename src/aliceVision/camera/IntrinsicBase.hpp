@@ -139,6 +139,20 @@ public:
    */
   virtual Vec2 project(const geometry::Pose3& pose, const Vec4& pt3D, bool applyDistortion = true) const = 0;
 
+  /**
+   * @brief Projection of 3D points into the camera plane (Apply pose, disto (if any) and Intrinsics)
+   * @param[in] pose The pose
+   * @param[in] pts3D The 3d points (one point per column)
+   * @param[out] pts2D The 2d projections in the camera plane
+   * @param[in] applyDistortion If true apply distrortion if any
+   */
+  virtual void project(const geometry::Pose3& pose, const Mat4X& pts3D, Mat2X& pts2D, bool applyDistortion = true) const
+  {
+    pts2D.resize(2, pts3D.cols());
+    for(Mat4X::Index i = 0; i < pts3D.cols(); ++i)
+      pts2D.col(i) = project(pose, pts3D.col(i), applyDistortion);
+  }
+
   /**
    * @brief Back-projection of a 2D point at a specific depth into a 3D point
    * @param[in] pt2D The 2d point
@@ -233,13 +247,9 @@ public:
   inline Mat2X residuals(const geometry::Pose3& pose, const Mat3X& X, const Mat2X& x) const
   {
     assert(X.cols() == x.cols());
-    const std::size_t numPts = x.cols();
-    Mat2X residuals = Mat2X::Zero(2, numPts);
-    for(std::size_t i = 0; i < numPts; ++i)
-    {
-      residuals.col(i) = residual(pose, ((const Vec3&)X.col(i)).homogeneous(), x.col(i));
-    }
-    return residuals;
+    Mat2X proj;
+    project(pose, X.colwise().homogeneous(), proj);
+    return x - proj;
   }
 
   /**
@@ -397,6 +407,18 @@ public:
    */
   virtual Vec2 removeDistortion(const Vec2& p) const = 0;
 
+  /**
+   * @brief Remove the distortion to camera points (that are in normalized camera frame)
+   * @param[in] pts The points (one point per column)
+   * @param[out] undistorted The points with removed distortion field
+   */
+  virtual void removeDistortion(const Mat2X& pts, Mat2X& undistorted) const
+  {
+    undistorted.resize(2, pts.cols());
+    for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+      undistorted.col(i) = removeDistortion(pts.col(i));
+  }
+
   /**
    * @brief Return the undistorted pixel (with removed distortion)
    * @param[in] p The point
@@ -404,6 +426,18 @@ public:
    */
   virtual Vec2 get_ud_pixel(const Vec2& p) const = 0;
 
+  /**
+   * @brief Return the undistorted pixels (with removed distortion)
+   * @param[in] pts The pixels (one pixel per column)
+   * @param[out] undistorted The undistorted pixels
+   */
+  virtual void get_ud_pixel(const Mat2X& pts, Mat2X& undistorted) const
+  {
+    undistorted.resize(2, pts.cols());
+    for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+      undistorted.col(i) = get_ud_pixel(pts.col(i));
+  }
+
   /**
    * @brief Return the distorted pixel (with added distortion)
    * @param[in] p The undistorted point
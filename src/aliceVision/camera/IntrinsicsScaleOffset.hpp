@@ -80,6 +80,12 @@ public:
     return p.cwiseProduct(_scale) + getPrincipalPoint();
   }
 
+  /// Transform points from the camera plane to the image plane (one point per column)
+  virtual void cam2ima(const Mat2X& pts, Mat2X& ptsIma) const
+  {
+    ptsIma = (_scale.asDiagonal() * pts).colwise() + getPrincipalPoint();
+  }
+
   virtual Eigen::Matrix2d getDerivativeCam2ImaWrtScale(const Vec2& p) const
   {
     Eigen::Matrix2d M = Eigen::Matrix2d::Zero();
@@ -118,6 +124,12 @@ public:
     return np;
   }
 
+  /// Transform points from the image plane to the camera plane (one point per column)
+  virtual void ima2cam(const Mat2X& pts, Mat2X& ptsCam) const
+  {
+    ptsCam = _scale.cwiseInverse().asDiagonal() * (pts.colwise() - getPrincipalPoint());
+  }
+
   virtual Eigen::Matrix<double, 2, 2> getDerivativeIma2CamWrtScale(const Vec2& p) const
   {
       Eigen::Matrix2d M = Eigen::Matrix2d::Zero();
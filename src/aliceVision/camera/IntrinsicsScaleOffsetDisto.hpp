@@ -69,12 +69,31 @@ public:
     return _pDistortion->removeDistortion(p); 
   }
 
+  void removeDistortion(const Mat2X& pts, Mat2X& undistorted) const override
+  {
+    if (_pDistortion == nullptr)
+    {
+      undistorted = pts;
+      return;
+    }
+    _pDistortion->removeDistortion(pts, undistorted);
+  }
+
   /// Return the un-distorted pixel (with removed distortion)
   Vec2 get_ud_pixel(const Vec2& p) const override
   {
     return cam2ima(removeDistortion(ima2cam(p)));
   }
 
+  /// Return the un-distorted pixels (with removed distortion)
+  void get_ud_pixel(const Mat2X& pts, Mat2X& undistorted) const override
+  {
+    Mat2X ptsCam;
+    ima2cam(pts, ptsCam);
+    removeDistortion(ptsCam, undistorted);
+    cam2ima(undistorted, undistorted);
+  }
+
   /// Return the distorted pixel (with added distortion)
   Vec2 get_d_pixel(const Vec2& p) const override
   {
@@ -109,6 +109,19 @@ public:
     return impt;
   }
 
+  void project(const geometry::Pose3& pose, const Mat4X& pts, Mat2X& pts2D, bool applyDistortion = true) const override
+  {
+    const Mat3X X = pose.getHomogeneous().topRows<3>() * pts; // apply pose
+    const Mat2X P = X.colwise().hnormalized();
+
+    if (hasDistortion())
+      _pDistortion->addDistortion(P, pts2D);
+    else
+      pts2D = P;
+
+    this->cam2ima(pts2D, pts2D);
+  }
+
   Eigen::Matrix<double, 2, 9> getDerivativeProjectWrtRotation(const geometry::Pose3& pose, const Vec4 & pt)
   {
     const Vec4 X = pose.getHomogeneous() * pt; // apply pose
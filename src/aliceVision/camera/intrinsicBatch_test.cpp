@@ -0,0 +1,125 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/camera/camera.hpp>
+
+#define BOOST_TEST_MODULE intrinsicBatch
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+#include <aliceVision/unitTest.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create a camera of each model, with a non null distortion
+// - Generate random points inside the image domain
+// - Assert that the batch projection, undistortion and distortion
+//   give the same points as the per-point functions
+//-----------------
+BOOST_AUTO_TEST_CASE(cameraIntrinsic_batchEqualsPerPoint)
+{
+  makeRandomOperationsReproducible();
+
+  const std::vector<EINTRINSIC> intrinsicTypes = {
+    EINTRINSIC::PINHOLE_CAMERA,
+    EINTRINSIC::PINHOLE_CAMERA_RADIAL1,
+    EINTRINSIC::PINHOLE_CAMERA_RADIAL3,
+    EINTRINSIC::PINHOLE_CAMERA_3DERADIAL4,
+    EINTRINSIC::PINHOLE_CAMERA_BROWN,
+    EINTRINSIC::PINHOLE_CAMERA_FISHEYE,
+    EINTRINSIC::PINHOLE_CAMERA_FISHEYE1,
+    EINTRINSIC::PINHOLE_CAMERA_3DEANAMORPHIC4,
+    EINTRINSIC::PINHOLE_CAMERA_3DECLASSICLD,
+    EINTRINSIC::EQUIDISTANT_CAMERA,
+    EINTRINSIC::EQUIDISTANT_CAMERA_RADIAL3,
+  };
+
+  const int nbPoints = 50;
+  const double epsilon = 1e-8;
+
+  for(const EINTRINSIC intrinsicType : intrinsicTypes)
+  {
+    BOOST_TEST_MESSAGE(EINTRINSIC_enumToString(intrinsicType));
+
+    const std::shared_ptr<IntrinsicBase> cam = createIntrinsic(intrinsicType, 1000, 800, 900, 900, 5, -3);
+
+    // small distortion around the default parameters
+    IntrinsicsScaleOffsetDisto* camDisto = dynamic_cast<IntrinsicsScaleOffsetDisto*>(cam.get());
+    if(camDisto && camDisto->getDistortion())
+    {
+      std::vector<double> distortionParams = camDisto->getDistortionParams();
+      for(std::size_t i = 0; i < distortionParams.size(); ++i)
+        distortionParams[i] += (i % 2 ? -0.01 : 0.01);
+      camDisto->setDistortionParams(distortionParams);
+    }
+
+    // random points inside the image domain, and 3D points seen by them
+    const geometry::Pose3 pose(geometry::randomPose());
+    Mat2X ptsImage(2, nbPoints);
+    Mat4X pts3D(4, nbPoints);
+    for(int i = 0; i < nbPoints; ++i)
+    {
+      ptsImage.col(i) = (Vec2::Random() * 800. / 2.) + Vec2(500, 400);
+      const double depth = 1.0 + std::abs(Vec2::Random()(0)) * 100.0;
+      pts3D.col(i) = cam->backproject(ptsImage.col(i), true, pose, depth).homogeneous();
+    }
+
+    for(const bool applyDistortion : {true, false})
+    {
+      Mat2X projected;
+      cam->project(pose, pts3D, projected, applyDistortion);
+      BOOST_REQUIRE_EQUAL(projected.cols(), nbPoints);
+      for(int i = 0; i < nbPoints; ++i)
+        EXPECT_MATRIX_NEAR(cam->project(pose, pts3D.col(i), applyDistortion), projected.col(i), epsilon);
+    }
+
+    Mat2X udPixels;
+    cam->get_ud_pixel(ptsImage, udPixels);
+    BOOST_REQUIRE_EQUAL(udPixels.cols(), nbPoints);
+    for(int i = 0; i < nbPoints; ++i)
+      EXPECT_MATRIX_NEAR(cam->get_ud_pixel(ptsImage.col(i)), udPixels.col(i), epsilon);
+
+    const IntrinsicsScaleOffset* camScaleOffset = dynamic_cast<const IntrinsicsScaleOffset*>(cam.get());
+    BOOST_REQUIRE(camScaleOffset);
+
+    Mat2X ptsCamera;
+    camScaleOffset->ima2cam(ptsImage, ptsCamera);
+    BOOST_REQUIRE_EQUAL(ptsCamera.cols(), nbPoints);
+    for(int i = 0; i < nbPoints; ++i)
+      EXPECT_MATRIX_NEAR(cam->ima2cam(ptsImage.col(i)), ptsCamera.col(i), epsilon);
+
+    Mat2X ptsImageBack;
+    camScaleOffset->cam2ima(ptsCamera, ptsImageBack);
+    for(int i = 0; i < nbPoints; ++i)
+      EXPECT_MATRIX_NEAR(cam->cam2ima(ptsCamera.col(i)), ptsImageBack.col(i), epsilon);
+
+    Mat2X undistorted;
+    cam->removeDistortion(ptsCamera, undistorted);
+    BOOST_REQUIRE_EQUAL(undistorted.cols(), nbPoints);
+    for(int i = 0; i < nbPoints; ++i)
+      EXPECT_MATRIX_NEAR(cam->removeDistortion(ptsCamera.col(i)), undistorted.col(i), epsilon);
+
+    if(camDisto && camDisto->getDistortion())
+    {
+      const Distortion& distortion = *camDisto->getDistortion();
+
+      Mat2X distorted;
+      distortion.addDistortion(ptsCamera, distorted);
+      BOOST_REQUIRE_EQUAL(distorted.cols(), nbPoints);
+      for(int i = 0; i < nbPoints; ++i)
+        EXPECT_MATRIX_NEAR(distortion.addDistortion(ptsCamera.col(i)), distorted.col(i), epsilon);
+
+      distortion.removeDistortion(ptsCamera, undistorted);
+      BOOST_REQUIRE_EQUAL(undistorted.cols(), nbPoints);
+      for(int i = 0; i < nbPoints; ++i)
+        EXPECT_MATRIX_NEAR(distortion.removeDistortion(ptsCamera.col(i)), undistorted.col(i), epsilon);
+    }
+  }
+}
@@ -6,13 +6,18 @@
 
 #include "Refine.hpp"
 
+#include <aliceVision/config.hpp>
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/gpu/gpu.hpp>
 
 #include <aliceVision/depthMap/RefineParams.hpp>
+#include <aliceVision/depthMap/cpu/PlaneSweepingCpu.hpp>
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
 #include <aliceVision/depthMap/cuda/PlaneSweepingCuda.hpp>
+#endif
 
 #include <aliceVision/mvsData/Point2d.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
@@ -29,9 +34,18 @@ namespace depthMap {
 namespace bfs = boost::filesystem;
 
 Refine::Refine(const RefineParams& refineParams, const mvsUtils::MultiViewParams& mp, PlaneSweepingCuda& cps, int rc)
+    : Refine(refineParams, mp, &cps, nullptr, rc)
+{}
+
+Refine::Refine(const RefineParams& refineParams, const mvsUtils::MultiViewParams& mp, PlaneSweepingCpu& cps, int rc)
+    : Refine(refineParams, mp, nullptr, &cps, rc)
+{}
+
+Refine::Refine(const RefineParams& refineParams, const mvsUtils::MultiViewParams& mp, PlaneSweepingCuda* cps, PlaneSweepingCpu* cpsCpu, int rc)
     : _rc(rc)
     , _mp(mp)
     , _cps(cps)
+    , _cpsCpu(cpsCpu)
     , _refineParams(refineParams)
     , _depthSimMap(_rc, _mp, 1, 1)
 {
@@ -70,7 +84,12 @@ void Refine::upscaleSgmDepthSimMap(const DepthSimMap& sgmDepthSimMap, DepthSimMa
 
 void Refine::filterMaskedPixels(DepthSimMap& out_depthSimMap)
 {
-    mvsUtils::ImagesCache<ImageRGBAf>::ImgSharedPtr img = _cps._ic.getImg_sync(_rc);
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+    mvsUtils::ImagesCache<ImageRGBAf>& ic = (_cps != nullptr) ? _cps->_ic : _cpsCpu->_ic;
+#else
+    mvsUtils::ImagesCache<ImageRGBAf>& ic = _cpsCpu->_ic;
+#endif
+    mvsUtils::ImagesCache<ImageRGBAf>::ImgSharedPtr img = ic.getImg_sync(_rc);
 
     const int h = _mp.getHeight(_rc);
     const int w = _mp.getWidth(_rc);
@@ -117,7 +136,12 @@ void Refine::refineDepthSimMapPerTc(int tc, DepthSimMap& depthSimMap) const
         StaticVector<float> simMap;
         depthSimMap.getSimMapStep1XPart(simMap, xFrom, wPartAct);
 
-        _cps.refineRcTcDepthMap(_rc, tc, depthMap, simMap, _refineParams, xFrom, wPartAct);
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+        if(_cps != nullptr)
+            _cps->refineRcTcDepthMap(_rc, tc, depthMap, simMap, _refineParams, xFrom, wPartAct);
+        else
+#endif
+            _cpsCpu->refineRcTcDepthMap(_rc, tc, depthMap, simMap, _refineParams, xFrom, wPartAct);
 
         for(int yp = 0; yp < h; ++yp)
         {
@@ -204,10 +228,22 @@ void Refine::refineAndFuseDepthSimMap(const DepthSimMap& depthSimMapSgmUpscale,
         StaticVector<DepthSim> depthSimMapFusedHPart;
         depthSimMapFusedHPart.resize_with(w * hPartHeight, DepthSim(-1.0f, 1.0f));
 
-        _cps.fuseDepthSimMapsGaussianKernelVoting(w, hPartHeight, 
-                                                  depthSimMapFusedHPart, 
-                                                  dataMapsHPart, 
-                                                  _refineParams);
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+        if(_cps != nullptr)
+        {
+            _cps->fuseDepthSimMapsGaussianKernelVoting(w, hPartHeight, 
+                                                       depthSimMapFusedHPart, 
+                                                       dataMapsHPart, 
+                                                       _refineParams);
+        }
+        else
+#endif
+        {
+            _cpsCpu->fuseDepthSimMapsGaussianKernelVoting(w, hPartHeight, 
+                                                          depthSimMapFusedHPart, 
+                                                          dataMapsHPart, 
+                                                          _refineParams);
+        }
 
 #pragma omp parallel for
         for(int y = 0; y < hPartHeight; ++y)
@@ -255,12 +291,26 @@ void Refine::optimizeDepthSimMap(const DepthSimMap& depthSimMapSgmUpscale,     /
     {
         const int yFrom = part * hPart;
         const int hPartAct = std::min(hPart, h - yFrom);
-        _cps.optimizeDepthSimMapGradientDescent(_rc, 
-                                                out_depthSimMapOptimized._dsm, 
-                                                depthSimMapSgmUpscale._dsm, 
-                                                depthSimMapRefinedFused._dsm, 
-                                                _refineParams,
-                                                yFrom, hPartAct);
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+        if(_cps != nullptr)
+        {
+            _cps->optimizeDepthSimMapGradientDescent(_rc, 
+                                                     out_depthSimMapOptimized._dsm, 
+                                                     depthSimMapSgmUpscale._dsm, 
+                                                     depthSimMapRefinedFused._dsm, 
+                                                     _refineParams,
+                                                     yFrom, hPartAct);
+        }
+        else
+#endif
+        {
+            _cpsCpu->optimizeDepthSimMapGradientDescent(_rc, 
+                                                        out_depthSimMapOptimized._dsm, 
+                                                        depthSimMapSgmUpscale._dsm, 
+                                                        depthSimMapRefinedFused._dsm, 
+                                                        _refineParams,
+                                                        yFrom, hPartAct);
+        }
     }
 
     ALICEVISION_LOG_INFO("Refine Optimizing depth/sim map (rc: " << _rc << ") done in: " << timer.elapsedMs() << " ms.");
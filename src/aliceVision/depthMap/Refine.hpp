@@ -15,6 +15,7 @@ namespace depthMap {
 
 struct RefineParams;
 class PlaneSweepingCuda;
+class PlaneSweepingCpu;
 
 /**
  * @brief Depth Map Estimation Refine
@@ -23,6 +24,7 @@ class Refine
 {
 public:
     Refine(const RefineParams& refineParams, const mvsUtils::MultiViewParams& mp, PlaneSweepingCuda& cps, int rc);
+    Refine(const RefineParams& refineParams, const mvsUtils::MultiViewParams& mp, PlaneSweepingCpu& cps, int rc);
     ~Refine();
 
     bool refineRc(const DepthSimMap& sgmDepthSimMap);
@@ -32,9 +34,12 @@ public:
 
 private:
 
+    Refine(const RefineParams& refineParams, const mvsUtils::MultiViewParams& mp, PlaneSweepingCuda* cps, PlaneSweepingCpu* cpsCpu, int rc);
+
     const RefineParams& _refineParams;
     const mvsUtils::MultiViewParams& _mp;
-    PlaneSweepingCuda& _cps;
+    PlaneSweepingCuda* _cps;   // nullptr when computed on the CPU
+    PlaneSweepingCpu* _cpsCpu; // nullptr when computed on a CUDA device
 
     const int _rc;            // refine R camera index
     StaticVector<int> _tCams; // refine T camera indexes, compute in the constructor
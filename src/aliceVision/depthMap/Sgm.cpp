@@ -6,16 +6,22 @@
 
 #include "Sgm.hpp"
 
+#include <aliceVision/config.hpp>
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/gpu/gpu.hpp>
 
 #include <aliceVision/depthMap/SgmParams.hpp>
+#include <aliceVision/depthMap/cpu/PlaneSweepingCpu.hpp>
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
 #include <aliceVision/depthMap/volumeIO.hpp>
 #include <aliceVision/depthMap/cuda/PlaneSweepingCuda.hpp>
 #include <aliceVision/depthMap/cuda/deviceCommon/device_utils.h>
+#endif
 
+#include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/OrientedPoint.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/imageIO.hpp>
@@ -36,9 +42,18 @@ namespace depthMap {
 namespace bfs = boost::filesystem;
 
 Sgm::Sgm(const SgmParams& sgmParams, const mvsUtils::MultiViewParams& mp, PlaneSweepingCuda& cps, int rc)
+    : Sgm(sgmParams, mp, &cps, nullptr, rc)
+{}
+
+Sgm::Sgm(const SgmParams& sgmParams, const mvsUtils::MultiViewParams& mp, PlaneSweepingCpu& cps, int rc)
+    : Sgm(sgmParams, mp, nullptr, &cps, rc)
+{}
+
+Sgm::Sgm(const SgmParams& sgmParams, const mvsUtils::MultiViewParams& mp, PlaneSweepingCuda* cps, PlaneSweepingCpu* cpsCpu, int rc)
     : _rc(rc)
     , _mp(mp)
     , _cps(cps)
+    , _cpsCpu(cpsCpu)
     , _sgmParams(sgmParams)
     , _depthSimMap(_rc, _mp, _sgmParams.scale, _sgmParams.stepXY)
 {
@@ -71,6 +86,35 @@ bool Sgm::sgmRc()
     const int volDimY = _mp.getHeight(_rc) / (_sgmParams.scale * _sgmParams.stepXY);
     const int volDimZ = _depths.size();
 
+    checkStartingAndStoppingDepth();
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+    if(_cps != nullptr)
+        computeDepthSimMapCuda(volDimX, volDimY, volDimZ);
+    else
+#endif
+        computeDepthSimMapCpu(volDimX, volDimY, volDimZ);
+
+    if(_sgmParams.exportIntermediateResults)
+    {
+        // {
+        //     // Export RAW SGM results with the depths based on the input planes without interpolation
+        //     DepthSimMap depthSimMapRawPlanes(_rc, _mp, _scale, _step);
+        //     _sp.cps.SgmRetrieveBestDepth(depthSimMapRawPlanes, volumeSecBestSim_d, _depths, volDimX, volDimY, volDimZ, false); // interpolate=false
+        //     depthSimMapRawPlanes.save("_sgmPlanes");
+        // }
+        _depthSimMap.save("_sgm");
+        _depthSimMap.save("_sgmStep1", true);
+    }
+
+    ALICEVISION_LOG_INFO("SGM depth/sim map (rc: " << _rc << ") done in: " << timer.elapsedMs() << " ms.");
+    return true;
+}
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+void Sgm::computeDepthSimMapCuda(int volDimX, int volDimY, int volDimZ)
+{
+    const IndexT viewId = _mp.getViewId(_rc);
     const CudaSize<3> volDim(volDimX, volDimY, volDimZ);
 
     // log volumes allocation size / gpu device id
@@ -85,9 +129,7 @@ bool Sgm::sgmRc()
     CudaDeviceMemoryPitched<TSim, 3> volumeSecBestSim_dmp(volDim);
     CudaDeviceMemoryPitched<TSim, 3> volumeBestSim_dmp(volDim);
 
-    checkStartingAndStoppingDepth();
-
-    _cps.computeDepthSimMapVolume(_rc, volumeBestSim_dmp, volumeSecBestSim_dmp, volDim, _tCams.getData(), _depthsTcamsLimits.getData(), _depths.getData(), _sgmParams);
+    _cps->computeDepthSimMapVolume(_rc, volumeBestSim_dmp, volumeSecBestSim_dmp, volDim, _tCams.getData(), _depthsTcamsLimits.getData(), _depths.getData(), _sgmParams);
 
     // particular case with only one tc
     if(_tCams.size() < 2)
@@ -114,7 +156,7 @@ bool Sgm::sgmRc()
     // optimized depthmaps ... it must equals to true in normal case
     if(_sgmParams.doSgmOptimizeVolume)                      
     {
-        _cps.sgmOptimizeSimVolume(_rc, volumeFilteredSim_dmp, volumeSecBestSim_dmp, volDim, _sgmParams);
+        _cps->sgmOptimizeSimVolume(_rc, volumeFilteredSim_dmp, volumeSecBestSim_dmp, volDim, _sgmParams);
     }
     else
     {
@@ -132,22 +174,45 @@ bool Sgm::sgmRc()
 
     // Retrieve best depth per pixel
     // For each pixel, choose the voxel with the minimal similarity value
-    _cps.sgmRetrieveBestDepth(_rc, _depthSimMap, volumeFilteredSim_dmp, volDim, _depths, _sgmParams);
+    _cps->sgmRetrieveBestDepth(_rc, _depthSimMap, volumeFilteredSim_dmp, volDim, _depths, _sgmParams);
+}
+#endif
+
+void Sgm::computeDepthSimMapCpu(int volDimX, int volDimY, int volDimZ)
+{
+    ALICEVISION_LOG_DEBUG("Allocating 2 volumes (x: " << volDimX << ", y: " << volDimY << ", z: " << volDimZ << ") in host memory.");
+
+    CpuSimVolume volumeSecBestSim(volDimX, volDimY, volDimZ);
+    CpuSimVolume volumeBestSim(volDimX, volDimY, volDimZ);
+
+    _cpsCpu->computeDepthSimMapVolume(_rc, volumeBestSim, volumeSecBestSim, _tCams.getData(), _depthsTcamsLimits.getData(), _depths.getData(), _sgmParams);
+
+    // particular case with only one tc
+    if(_tCams.size() < 2)
+    {
+        // the second best volume has no valid similarity values
+        volumeSecBestSim = volumeBestSim;
+    }
 
     if(_sgmParams.exportIntermediateResults)
     {
-        // {
-        //     // Export RAW SGM results with the depths based on the input planes without interpolation
-        //     DepthSimMap depthSimMapRawPlanes(_rc, _mp, _scale, _step);
-        //     _sp.cps.SgmRetrieveBestDepth(depthSimMapRawPlanes, volumeSecBestSim_d, _depths, volDimX, volDimY, volDimZ, false); // interpolate=false
-        //     depthSimMapRawPlanes.save("_sgmPlanes");
-        // }
-        _depthSimMap.save("_sgm");
-        _depthSimMap.save("_sgmStep1", true);
+        ALICEVISION_LOG_DEBUG("Similarity volumes export is not available with the CPU implementation.");
     }
 
-    ALICEVISION_LOG_INFO("SGM depth/sim map (rc: " << _rc << ") done in: " << timer.elapsedMs() << " ms.");
-    return true;
+    // reuse best sim to put filtered sim volume
+    CpuSimVolume& volumeFilteredSim = volumeBestSim;
+
+    if(_sgmParams.doSgmOptimizeVolume)
+    {
+        _cpsCpu->sgmOptimizeSimVolume(_rc, volumeFilteredSim, volumeSecBestSim, _sgmParams);
+    }
+    else
+    {
+        volumeFilteredSim = volumeSecBestSim;
+    }
+
+    // Retrieve best depth per pixel
+    _cpsCpu->sgmRetrieveBestDepth(_rc, _depthSimMap, volumeFilteredSim, _depths, _sgmParams);
 }
 
 void Sgm::logRcTcDepthInformation() const 
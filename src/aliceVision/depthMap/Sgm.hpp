@@ -16,6 +16,7 @@ namespace depthMap {
 
 struct SgmParams;
 class PlaneSweepingCuda;
+class PlaneSweepingCpu;
 
 /**
  * @brief Depth Map Estimation Semi-Global Matching
@@ -24,6 +25,7 @@ class Sgm
 {
 public:
     Sgm(const SgmParams& sgmParams, const mvsUtils::MultiViewParams& mp, PlaneSweepingCuda& cps, int rc);
+    Sgm(const SgmParams& sgmParams, const mvsUtils::MultiViewParams& mp, PlaneSweepingCpu& cps, int rc);
     ~Sgm();
 
     bool sgmRc();
@@ -34,6 +36,15 @@ public:
 
 private:
 
+    Sgm(const SgmParams& sgmParams, const mvsUtils::MultiViewParams& mp, PlaneSweepingCuda* cps, PlaneSweepingCpu* cpsCpu, int rc);
+
+    /**
+     * @brief Compute the similarity volume, filter it and retrieve the best depth per pixel.
+     *        Volumes are stored in GPU device memory (CUDA) or host memory (CPU).
+     */
+    void computeDepthSimMapCuda(int volDimX, int volDimY, int volDimZ);
+    void computeDepthSimMapCpu(int volDimX, int volDimY, int volDimZ);
+
     void logRcTcDepthInformation() const;
     void checkStartingAndStoppingDepth() const;
 
@@ -65,7 +76,8 @@ private:
 
     const SgmParams& _sgmParams;
     const mvsUtils::MultiViewParams& _mp;
-    PlaneSweepingCuda& _cps;
+    PlaneSweepingCuda* _cps;   // nullptr when computed on the CPU
+    PlaneSweepingCpu* _cpsCpu; // nullptr when computed on a CUDA device
     const int _rc;
 
     StaticVector<int> _tCams;
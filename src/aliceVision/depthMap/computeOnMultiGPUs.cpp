@@ -5,15 +5,23 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "computeOnMultiGPUs.hpp"
-#include <aliceVision/depthMap/cuda/PlaneSweepingCuda.hpp> // useful for listCUDADevices
+#include <aliceVision/config.hpp>
 #include <aliceVision/alicevision_omp.hpp>
 
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+#include <aliceVision/depthMap/cuda/PlaneSweepingCuda.hpp> // useful for listCUDADevices
+#endif
+
 namespace aliceVision {
 namespace depthMap {
 
 void computeOnMultiGPUs(mvsUtils::MultiViewParams& mp, const std::vector<int>& cams, GPUJob gpujob, int nbGPUsToUse)
 {
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
     const int nbGPUDevices = listCUDADevices(true);
+#else
+    const int nbGPUDevices = 0;
+#endif
     const int nbCPUThreads = omp_get_num_procs();
 
     ALICEVISION_LOG_INFO("Number of GPU devices: " << nbGPUDevices << ", number of CPU threads: " << nbCPUThreads);
@@ -26,7 +34,12 @@ void computeOnMultiGPUs(mvsUtils::MultiViewParams& mp, const std::vector<int>& c
         nbThreads = std::min(nbThreads, nbGPUsToUse);
     }
 
-    if (nbThreads == 1)
+    if (nbThreads == 0)
+    {
+        ALICEVISION_LOG_WARNING("No CUDA device available, the computation is done on the CPU.");
+        gpujob(CPU_DEVICE_INDEX, mp, cams);
+    }
+    else if (nbThreads == 1)
     {
         // the GPU sorting is determined by an environment variable named CUDA_DEVICE_ORDER
         // possible values: FASTEST_FIRST (default) or PCI_BUS_ID
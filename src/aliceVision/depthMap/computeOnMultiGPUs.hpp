@@ -12,6 +12,9 @@
 namespace aliceVision {
 namespace depthMap {
 
+/// device index given to the job when there is no CUDA device available
+constexpr int CPU_DEVICE_INDEX = -1;
+
 typedef void (*GPUJob)(int cudaDeviceNo, mvsUtils::MultiViewParams& mp, const std::vector<int>& cams);
 
 void computeOnMultiGPUs(mvsUtils::MultiViewParams& mp, const std::vector<int>& cams, GPUJob gpujob, int nbGPUsToUse);
@@ -0,0 +1,1361 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PlaneSweepingCpu.hpp"
+
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/mvsData/Matrix3x3.hpp>
+#include <aliceVision/mvsData/Matrix3x4.hpp>
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsData/Stat3d.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+
+namespace aliceVision {
+namespace depthMap {
+
+namespace {
+
+/*********************************************************************************
+ * Small vector types, same operations as the CUDA device code
+ *********************************************************************************/
+
+struct Vec2f
+{
+    float x, y;
+};
+
+struct Vec3f
+{
+    float x, y, z;
+
+    inline Vec3f operator+(const Vec3f& v) const { return {x + v.x, y + v.y, z + v.z}; }
+    inline Vec3f operator-(const Vec3f& v) const { return {x - v.x, y - v.y, z - v.z}; }
+    inline Vec3f operator*(float s) const { return {x * s, y * s, z * s}; }
+    inline Vec3f operator/(float s) const { return {x / s, y / s, z / s}; }
+};
+
+inline float dot(const Vec3f& a, const Vec3f& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float size(const Vec3f& a) { return std::sqrt(dot(a, a)); }
+inline Vec3f cross(const Vec3f& a, const Vec3f& b) { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+
+inline void normalize(Vec3f& a)
+{
+    const float d = size(a);
+    a = a / d;
+}
+
+inline void normalize(Vec2f& a)
+{
+    const float d = std::sqrt(a.x * a.x + a.y * a.y);
+    a.x /= d;
+    a.y /= d;
+}
+
+/**
+ * f(x) = min + (max-min) * \frac{1}{1 + e^{10 * (x - mid) / width}}
+ */
+inline float sigmoid(float zeroVal, float endVal, float sigwidth, float sigMid, float xval)
+{
+    return zeroVal + (endVal - zeroVal) * (1.0f / (1.0f + std::exp(10.0f * ((xval - sigMid) / sigwidth))));
+}
+
+/**
+ * f(x) = min + (max-min) * \frac{1}{1 + e^{10 * (mid - x) / width}}
+ */
+inline float sigmoid2(float zeroVal, float endVal, float sigwidth, float sigMid, float xval)
+{
+    return zeroVal + (endVal - zeroVal) * (1.0f / (1.0f + std::exp(10.0f * ((sigMid - xval) / sigwidth))));
+}
+
+/*********************************************************************************
+ * Images
+ *********************************************************************************/
+
+struct LabColor
+{
+    float l, a, b, alpha;
+};
+
+inline float euclidean3(const LabColor& c1, const LabColor& c2)
+{
+    const float dl = c1.l - c2.l;
+    const float da = c1.a - c2.a;
+    const float db = c1.b - c2.b;
+    return std::sqrt(dl * dl + da * da + db * db);
+}
+
+/**
+ * @brief Image in CIELAB color space (values scaled to 0..255, alpha in 0..255).
+ */
+class LabImage
+{
+public:
+    LabImage(int width, int height)
+        : _width(width)
+        , _height(height)
+        , _data(std::size_t(width) * std::size_t(height))
+    {}
+
+    inline int width() const { return _width; }
+    inline int height() const { return _height; }
+
+    inline LabColor& at(int x, int y) { return _data[std::size_t(y) * _width + x]; }
+    inline const LabColor& at(int x, int y) const { return _data[std::size_t(y) * _width + x]; }
+
+    /**
+     * @brief Bilinear interpolation with clamped borders.
+     *        Same value as a linear filtered CUDA texture lookup at (x + 0.5, y + 0.5).
+     */
+    inline LabColor sample(float x, float y) const
+    {
+        // clamp before the integer conversion (also handles NaN)
+        x = (x > -1.0f) ? x : -1.0f;
+        y = (y > -1.0f) ? y : -1.0f;
+        x = (x < float(_width)) ? x : float(_width);
+        y = (y < float(_height)) ? y : float(_height);
+
+        const float fx = std::floor(x);
+        const float fy = std::floor(y);
+        const float ax = x - fx;
+        const float ay = y - fy;
+
+        const int x0 = std::min(std::max(int(fx), 0), _width - 1);
+        const int y0 = std::min(std::max(int(fy), 0), _height - 1);
+        const int x1 = std::min(std::max(int(fx) + 1, 0), _width - 1);
+        const int y1 = std::min(std::max(int(fy) + 1, 0), _height - 1);
+
+        const LabColor& c00 = at(x0, y0);
+        const LabColor& c10 = at(x1, y0);
+        const LabColor& c01 = at(x0, y1);
+        const LabColor& c11 = at(x1, y1);
+
+        const float w00 = (1.0f - ax) * (1.0f - ay);
+        const float w10 = ax * (1.0f - ay);
+        const float w01 = (1.0f - ax) * ay;
+        const float w11 = ax * ay;
+
+        return {w00 * c00.l + w10 * c10.l + w01 * c01.l + w11 * c11.l,
+                w00 * c00.a + w10 * c10.a + w01 * c01.a + w11 * c11.a,
+                w00 * c00.b + w10 * c10.b + w01 * c01.b + w11 * c11.b,
+                w00 * c00.alpha + w10 * c10.alpha + w01 * c01.alpha + w11 * c11.alpha};
+    }
+
+private:
+    int _width;
+    int _height;
+    std::vector<LabColor> _data;
+};
+
+/**
+ * @brief Linear RGB (0..1) to CIELAB, values scaled to fit into 0..255 (same as xyz2lab in device_color.cu).
+ */
+inline LabColor rgb2lab(const ColorRGBAf& c)
+{
+    // linear RGB to XYZ
+    const float X = 0.4124564f * c.r + 0.3575761f * c.g + 0.1804375f * c.b;
+    const float Y = 0.2126729f * c.r + 0.7151522f * c.g + 0.0721750f * c.b;
+    const float Z = 0.0193339f * c.r + 0.1191920f * c.g + 0.9503041f * c.b;
+
+    // assuming whitepoint D65, XYZ=(0.95047, 1.00000, 1.08883)
+    const auto f = [](float t) { return (t > 216.0f / 24389.0f) ? std::cbrt(t) : (24389.0f / 27.0f * t + 16.0f) / 116.0f; };
+    const float fx = f(X / 0.95047f);
+    const float fy = f(Y);
+    const float fz = f(Z / 1.08883f);
+
+    return {(116.0f * fy - 16.0f) * 2.55f, 500.0f * (fx - fy) * 2.55f, 200.0f * (fy - fz) * 2.55f, c.a * 255.0f};
+}
+
+} // namespace
+
+struct LabPyramid
+{
+    std::vector<LabImage> levels;
+};
+
+namespace {
+
+/**
+ * @brief Build the CIELAB pyramid of an image, each level is a Gaussian-filtered
+ *        and downscaled version of the full resolution image (same as ps_device_fillPyramidFromHostFrame).
+ */
+std::shared_ptr<const LabPyramid> buildPyramid(const ImageRGBAf& img, int width, int height, int scales)
+{
+    std::shared_ptr<LabPyramid> pyramid = std::make_shared<LabPyramid>();
+    pyramid->levels.reserve(scales);
+    pyramid->levels.emplace_back(width, height);
+
+    LabImage& fullImg = pyramid->levels.front();
+
+    #pragma omp parallel for
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+            fullImg.at(x, y) = rgb2lab(img.at(x, y));
+    }
+
+    for(int scale = 1; scale < scales; ++scale)
+    {
+        const int factor = scale + 1;
+        const int radius = scale + 1;
+        const int levelWidth = width / factor;
+        const int levelHeight = height / factor;
+        const float s = float(factor) * 0.5f;
+
+        std::vector<float> gauss(2 * radius + 1);
+        for(int i = -radius; i <= radius; ++i)
+            gauss[i + radius] = std::exp(-float(i * i) / 2.0f);
+
+        pyramid->levels.emplace_back(levelWidth, levelHeight);
+        LabImage& level = pyramid->levels.back();
+
+        #pragma omp parallel for
+        for(int y = 0; y < levelHeight; ++y)
+        {
+            for(int x = 0; x < levelWidth; ++x)
+            {
+                LabColor t{0.0f, 0.0f, 0.0f, 0.0f};
+                float sum = 0.0f;
+                for(int i = -radius; i <= radius; ++i)
+                {
+                    for(int j = -radius; j <= radius; ++j)
+                    {
+                        const LabColor c = fullImg.sample(float(x * factor + j) + s - 0.5f, float(y * factor + i) + s - 0.5f);
+                        const float factorW = gauss[i + radius] * gauss[j + radius];
+                        t.l += c.l * factorW;
+                        t.a += c.a * factorW;
+                        t.b += c.b * factorW;
+                        t.alpha += c.alpha * factorW;
+                        sum += factorW;
+                    }
+                }
+                level.at(x, y) = {t.l / sum, t.a / sum, t.b / sum, t.alpha / sum};
+            }
+        }
+    }
+    return pyramid;
+}
+
+/*********************************************************************************
+ * Cameras
+ *********************************************************************************/
+
+/**
+ * @brief Camera parameters in single precision, column-major matrices (same as CameraStructBase).
+ */
+struct CameraCpu
+{
+    float P[12];
+    float iP[9];
+    Vec3f C;
+    Vec3f ZVect;
+};
+
+CameraCpu createCamera(const mvsUtils::MultiViewParams& mp, int c, int scale)
+{
+    Matrix3x3 scaleM;
+    scaleM.m11 = 1.0 / (float)scale;
+    scaleM.m12 = 0.0;
+    scaleM.m13 = 0.0;
+    scaleM.m21 = 0.0;
+    scaleM.m22 = 1.0 / (float)scale;
+    scaleM.m23 = 0.0;
+    scaleM.m31 = 0.0;
+    scaleM.m32 = 0.0;
+    scaleM.m33 = 1.0;
+    const Matrix3x3 K = scaleM * mp.KArr[c];
+
+    const Matrix3x3 iK = K.inverse();
+    const Matrix3x4 P = K * (mp.RArr[c] | (Point3d(0.0, 0.0, 0.0) - mp.RArr[c] * mp.CArr[c]));
+    const Matrix3x3 iP = mp.iRArr[c] * iK;
+
+    CameraCpu cam;
+
+    const double Pcm[12] = {P.m11, P.m21, P.m31, P.m12, P.m22, P.m32, P.m13, P.m23, P.m33, P.m14, P.m24, P.m34};
+    const double iPcm[9] = {iP.m11, iP.m21, iP.m31, iP.m12, iP.m22, iP.m32, iP.m13, iP.m23, iP.m33};
+    std::copy(Pcm, Pcm + 12, cam.P);
+    std::copy(iPcm, iPcm + 9, cam.iP);
+
+    cam.C = {float(mp.CArr[c].x), float(mp.CArr[c].y), float(mp.CArr[c].z)};
+
+    const Matrix3x3& iR = mp.iRArr[c];
+    cam.ZVect = {float(iR.m13), float(iR.m23), float(iR.m33)};
+    normalize(cam.ZVect);
+
+    return cam;
+}
+
+inline Vec3f M3x4mulV3(const float* M3x4, const Vec3f& V)
+{
+    return {M3x4[0] * V.x + M3x4[3] * V.y + M3x4[6] * V.z + M3x4[9],
+            M3x4[1] * V.x + M3x4[4] * V.y + M3x4[7] * V.z + M3x4[10],
+            M3x4[2] * V.x + M3x4[5] * V.y + M3x4[8] * V.z + M3x4[11]};
+}
+
+inline Vec3f M3x3mulV3(const float* M3x3, const Vec3f& V)
+{
+    return {M3x3[0] * V.x + M3x3[3] * V.y + M3x3[6] * V.z,
+            M3x3[1] * V.x + M3x3[4] * V.y + M3x3[7] * V.z,
+            M3x3[2] * V.x + M3x3[5] * V.y + M3x3[8] * V.z};
+}
+
+inline Vec3f M3x3mulV2(const float* M3x3, const Vec2f& V)
+{
+    return {M3x3[0] * V.x + M3x3[3] * V.y + M3x3[6],
+            M3x3[1] * V.x + M3x3[4] * V.y + M3x3[7],
+            M3x3[2] * V.x + M3x3[5] * V.y + M3x3[8]};
+}
+
+inline Vec2f project3DPoint(const CameraCpu& cam, const Vec3f& p)
+{
+    const Vec3f v = M3x4mulV3(cam.P, p);
+    return {v.x / v.z, v.y / v.z};
+}
+
+inline Vec2f getPixelFor3DPoint(const CameraCpu& cam, const Vec3f& p)
+{
+    const Vec3f v = M3x4mulV3(cam.P, p);
+    if(v.z <= 0.0f)
+        return {-1.0f, -1.0f};
+    return {v.x / v.z, v.y / v.z};
+}
+
+inline Vec3f linePlaneIntersect(const Vec3f& linePoint, const Vec3f& lineVect, const Vec3f& planePoint, const Vec3f& planeNormal)
+{
+    const float k = (dot(planePoint, planeNormal) - dot(planeNormal, linePoint)) / dot(planeNormal, lineVect);
+    return linePoint + lineVect * k;
+}
+
+inline Vec3f get3DPointForPixelAndFrontoParallelPlaneRC(const CameraCpu& cam, const Vec2f& pix, float fpPlaneDepth)
+{
+    const Vec3f planep = cam.C + cam.ZVect * fpPlaneDepth;
+    Vec3f v = M3x3mulV2(cam.iP, pix);
+    normalize(v);
+    return linePlaneIntersect(cam.C, v, planep, cam.ZVect);
+}
+
+inline Vec3f get3DPointForPixelAndDepthFromRC(const CameraCpu& cam, const Vec2f& pix, float depth)
+{
+    Vec3f rpv = M3x3mulV2(cam.iP, pix);
+    normalize(rpv);
+    return cam.C + rpv * depth;
+}
+
+inline float depthPlaneToDepth(const CameraCpu& cam, const Vec2f& pix, float fpPlaneDepth)
+{
+    const Vec3f p = get3DPointForPixelAndFrontoParallelPlaneRC(cam, pix, fpPlaneDepth);
+    return size(cam.C - p);
+}
+
+inline float computePixSize(const CameraCpu& cam, const Vec3f& p)
+{
+    const Vec2f rp = project3DPoint(cam, p);
+    Vec3f refvect = M3x3mulV2(cam.iP, Vec2f{rp.x + 1.0f, rp.y});
+    normalize(refvect);
+    // point line distance
+    return size(cross(refvect, cam.C - p));
+}
+
+/**
+ * @brief Intersection of the rc ray of refpix with the tc ray of tarpix (closest point on the rc ray).
+ */
+Vec3f triangulateMatchRef(const CameraCpu& rcCam, const CameraCpu& tcCam, const Vec2f& refpix, const Vec2f& tarpix)
+{
+    Vec3f refvect = M3x3mulV2(rcCam.iP, refpix);
+    normalize(refvect);
+    Vec3f tarvect = M3x3mulV2(tcCam.iP, tarpix);
+    normalize(tarvect);
+
+    // line line intersection (Paul Bourke), only the parameter on the first line is needed
+    const Vec3f p13 = rcCam.C - tcCam.C;
+    const Vec3f& p43 = tarvect;
+    const Vec3f& p21 = refvect;
+
+    const float d1343 = dot(p13, p43);
+    const float d4321 = dot(p43, p21);
+    const float d1321 = dot(p13, p21);
+    const float d4343 = dot(p43, p43);
+    const float d2121 = dot(p21, p21);
+
+    const float denom = d2121 * d4343 - d4321 * d4321;
+    const float numer = d1343 * d4321 - d1321 * d4343;
+
+    return rcCam.C + refvect * (numer / denom);
+}
+
+void move3DPointByTcOrRcPixStep(const CameraCpu& rcCam, const CameraCpu& tcCam, Vec3f& p, float pixStep, bool moveByTcOrRc)
+{
+    if(moveByTcOrRc)
+    {
+        const Vec3f rpv = rcCam.C - p;
+        const Vec3f prp1 = p + rpv / 2.0f;
+
+        const Vec2f rp = getPixelFor3DPoint(rcCam, p);
+        const Vec2f tpo = getPixelFor3DPoint(tcCam, p);
+        const Vec2f tp1 = getPixelFor3DPoint(tcCam, prp1);
+
+        Vec2f tpv{tp1.x - tpo.x, tp1.y - tpo.y};
+        normalize(tpv);
+
+        const Vec2f tpd{tpo.x + tpv.x * pixStep, tpo.y + tpv.y * pixStep};
+        p = triangulateMatchRef(rcCam, tcCam, rp, tpd);
+    }
+    else
+    {
+        const float pixSize = pixStep * computePixSize(rcCam, p);
+        Vec3f rpv = p - rcCam.C;
+        normalize(rpv);
+        p = p + rpv * pixSize;
+    }
+}
+
+/*********************************************************************************
+ * Similarity
+ *********************************************************************************/
+
+struct Patch
+{
+    Vec3f p; // 3d point
+    Vec3f n; // normal
+    Vec3f x; // x axis
+    Vec3f y; // y axis
+    float d; // pixel size
+};
+
+inline void computeRotCSEpip(const CameraCpu& rcCam, const CameraCpu& tcCam, Patch& ptch)
+{
+    // vectors from the cameras to the 3d point
+    Vec3f v1 = rcCam.C - ptch.p;
+    Vec3f v2 = tcCam.C - ptch.p;
+    normalize(v1);
+    normalize(v2);
+
+    // y has to be orthogonal to the epipolar plane, n and x on the epipolar plane
+    ptch.y = cross(v1, v2);
+    normalize(ptch.y);
+
+    ptch.n = (v1 + v2) / 2.0f;
+    normalize(ptch.n);
+
+    ptch.x = cross(ptch.y, ptch.n);
+    normalize(ptch.x);
+}
+
+inline void computePatch(const CameraCpu& rcCam, const CameraCpu& tcCam, Patch& ptch, const Vec3f& p)
+{
+    ptch.p = p;
+    ptch.d = computePixSize(rcCam, p);
+    computeRotCSEpip(rcCam, tcCam, ptch);
+}
+
+/**
+ * @brief Compute the weighted Normalized Cross-Correlation of a patch (same as compNCCby3DptsYK in device_patch_es.cu).
+ *
+ * The patch 3d points are affine in the patch coordinates, so their projections are computed
+ * incrementally along each patch row and the row loop is written to be vectorized.
+ *
+ * @return similarity value in range (-1, 0), 1 if it cannot be computed
+ *         or infinity if the patch is outside the images or masked
+ */
+float compNCCby3DptsYK(const LabImage& rcImg, const LabImage& tcImg,
+                       const CameraCpu& rcCam, const CameraCpu& tcCam,
+                       const Patch& ptch, int wsh, float gammaC, float gammaP)
+{
+    const Vec2f rp = project3DPoint(rcCam, ptch.p);
+    const Vec2f tp = project3DPoint(tcCam, ptch.p);
+
+    const float dd = wsh + 2.0f;
+    if((rp.x < dd) || (rp.x > float(rcImg.width() - 1) - dd) ||
+       (rp.y < dd) || (rp.y > float(rcImg.height() - 1) - dd) ||
+       (tp.x < dd) || (tp.x > float(tcImg.width() - 1) - dd) ||
+       (tp.y < dd) || (tp.y > float(tcImg.height() - 1) - dd))
+    {
+        return std::numeric_limits<float>::infinity(); // uninitialized
+    }
+
+    const LabColor gcr = rcImg.sample(rp.x, rp.y);
+    const LabColor gct = tcImg.sample(tp.x, tp.y);
+
+    if(gcr.alpha == 0.0f || gct.alpha == 0.0f)
+        return std::numeric_limits<float>::infinity(); // if no alpha, invalid pixel from input mask
+
+    const float invGammaC = 1.0f / gammaC;
+    const float invGammaP = 1.0f / gammaP;
+
+    const Vec3f rcStepX = M3x3mulV3(rcCam.P, ptch.x * ptch.d);
+    const Vec3f tcStepX = M3x3mulV3(tcCam.P, ptch.x * ptch.d);
+
+    float wsum = 0.0f;
+    float xsum = 0.0f;
+    float ysum = 0.0f;
+    float xxsum = 0.0f;
+    float yysum = 0.0f;
+    float xysum = 0.0f;
+
+    for(int yp = -wsh; yp <= wsh; ++yp)
+    {
+        const Vec3f pRow = ptch.p + ptch.y * (ptch.d * float(yp));
+        const Vec3f rcRow = M3x4mulV3(rcCam.P, pRow);
+        const Vec3f tcRow = M3x4mulV3(tcCam.P, pRow);
+
+        #pragma omp simd reduction(+:wsum, xsum, ysum, xxsum, yysum, xysum)
+        for(int xp = -wsh; xp <= wsh; ++xp)
+        {
+            const float fxp = float(xp);
+            const float rz = rcRow.z + rcStepX.z * fxp;
+            const float tz = tcRow.z + tcStepX.z * fxp;
+            const LabColor gcr1 = rcImg.sample((rcRow.x + rcStepX.x * fxp) / rz, (rcRow.y + rcStepX.y * fxp) / rz);
+            const LabColor gct1 = tcImg.sample((tcRow.x + tcStepX.x * fxp) / tz, (tcRow.y + tcStepX.y * fxp) / tz);
+
+            // Yoon & Kweon weights: color difference and distance to the center pixel of the patch
+            const float deltaP = std::sqrt(float(xp * xp + yp * yp)) * invGammaP;
+            const float w = std::exp(-((euclidean3(gcr, gcr1) + euclidean3(gct, gct1)) * invGammaC + 2.0f * deltaP));
+
+            wsum += w;
+            xsum += w * gcr1.l;
+            ysum += w * gct1.l;
+            xxsum += w * gcr1.l * gcr1.l;
+            yysum += w * gct1.l * gct1.l;
+            xysum += w * gcr1.l * gct1.l;
+        }
+    }
+
+    const float varXW = (xxsum - xsum * xsum / wsum) / wsum;
+    const float varYW = (yysum - ysum * ysum / wsum) / wsum;
+    const float varXYW = (xysum - xsum * ysum / wsum) / wsum;
+    const float rawSim = varXYW / std::sqrt(varXW * varYW);
+
+    return std::isfinite(rawSim) ? -rawSim : 1.0f;
+}
+
+/**
+ * @brief Sub-pixel depth from the 3 depth candidates with a quadratic interpolation of their similarities.
+ */
+float refineDepthSubPixel(const Vec3f& depths, const Vec3f& sims)
+{
+    const float simM1 = (sims.x + 1.0f) / 2.0f;
+    const float sim = (sims.y + 1.0f) / 2.0f;
+    const float simP1 = (sims.z + 1.0f) / 2.0f;
+
+    // sim is supposed to be the best one (so the smallest one)
+    if((simM1 < sim) || (simP1 < sim))
+        return depths.y;
+
+    const float dispStep = -((simP1 - simM1) / (2.0f * (simP1 + simM1 - 2.0f * sim)));
+
+    // linear function fit between the depth candidates
+    const float b = (depths.z + depths.x) / 2.0f;
+    const float a = b - depths.x;
+    const float interpDepth = a * dispStep + b;
+
+    if(!std::isfinite(interpDepth) || interpDepth <= 0.0f)
+        return depths.y;
+
+    return interpDepth;
+}
+
+/*********************************************************************************
+ * SGM
+ *********************************************************************************/
+
+constexpr int volumeTileSize = 8;
+constexpr int aggregationBlockSize = 16;
+
+/**
+ * @brief Aggregate the similarity volume along one path direction (same as ps_aggregatePathVolume).
+ *
+ * Scanlines along the path axis are independent: they are processed by blocks of
+ * aggregationBlockSize neighbor lines, so that the inner loop over the lines is contiguous
+ * in memory for the Y axis and can be vectorized.
+ *
+ * @param[inout] volAgr the aggregated volume
+ * @param[in] volSim the similarity volume
+ * @param[in] axisT the axes of the (x, path, z) coordinates in the volume
+ */
+void aggregatePathVolume(CpuSimVolume& volAgr, const CpuSimVolume& volSim, const int axisT[3],
+                         const LabImage& rcImg, const SgmParams& sgmParams, bool invY, int filteringIndex)
+{
+    const int volDim[3] = {volSim.dimX(), volSim.dimY(), volSim.dimZ()};
+    const std::size_t volStride[3] = {1, std::size_t(volDim[0]), std::size_t(volDim[0]) * std::size_t(volDim[1])};
+
+    const int volDimX = volDim[axisT[0]];
+    const int volDimY = volDim[axisT[1]];
+    const int volDimZ = volDim[axisT[2]];
+    const std::size_t strideX = volStride[axisT[0]];
+    const std::size_t strideY = volStride[axisT[1]];
+    const std::size_t strideZ = volStride[axisT[2]];
+
+    const int ySign = (invY ? -1 : 1);
+    const float P1 = float(sgmParams.p1);
+    const float P2Weighting = float(sgmParams.p2Weighting);
+    const float step = float(sgmParams.stepXY);
+    const float fIndex = float(filteringIndex);
+
+    const TSim* sim = volSim.getBuffer();
+    TSim* agr = volAgr.getBuffer();
+
+    const int nbBlocks = (volDimX + aggregationBlockSize - 1) / aggregationBlockSize;
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int block = 0; block < nbBlocks; ++block)
+    {
+        const int x0 = block * aggregationBlockSize;
+        const int nx = std::min(aggregationBlockSize, volDimX - x0);
+
+        std::vector<TSimAcc> sliceYm1(std::size_t(volDimZ) * aggregationBlockSize);
+        std::vector<TSimAcc> sliceY(std::size_t(volDimZ) * aggregationBlockSize);
+        TSimAcc bestSimInYm1[aggregationBlockSize];
+        float P2[aggregationBlockSize];
+
+        // copy the first slice (y = 0) and set it to 255 in the aggregated volume
+        // note: as in the CUDA implementation, it is also the first slice of the inverted paths
+        for(int z = 0; z < volDimZ; ++z)
+        {
+            for(int ix = 0; ix < nx; ++ix)
+            {
+                const std::size_t v = std::size_t(x0 + ix) * strideX + std::size_t(z) * strideZ;
+                sliceYm1[std::size_t(z) * aggregationBlockSize + ix] = TSimAcc(sim[v]);
+                agr[v] = TSim(255);
+            }
+        }
+
+        for(int iy = 1; iy < volDimY; ++iy)
+        {
+            const int y = invY ? volDimY - 1 - iy : iy;
+
+            for(int ix = 0; ix < nx; ++ix)
+            {
+                // best score of the previous slice
+                TSimAcc bestCst = sliceYm1[ix];
+                for(int z = 1; z < volDimZ; ++z)
+                    bestCst = std::min(bestCst, sliceYm1[std::size_t(z) * aggregationBlockSize + ix]);
+                bestSimInYm1[ix] = bestCst;
+
+                if(P2Weighting < 0)
+                {
+                    // P2 convention: use negative value to skip the use of deltaC
+                    P2[ix] = std::abs(P2Weighting);
+                }
+                else
+                {
+                    int v[3];
+                    v[axisT[0]] = x0 + ix;
+                    v[axisT[1]] = y;
+                    v[axisT[2]] = 0;
+
+                    const int imX0 = v[0] * step; // current
+                    const int imY0 = v[1] * step;
+                    const int imX1 = imX0 - ySign * step * (axisT[1] == 0); // M1
+                    const int imY1 = imY0 - ySign * step * (axisT[1] == 1);
+
+                    const float deltaC = euclidean3(rcImg.sample(float(imX0), float(imY0)), rcImg.sample(float(imX1), float(imY1)));
+
+                    // sigmoid with i = 80, a = 255, w = 80
+                    P2[ix] = sigmoid(80.f, 255.f, 80.f, P2Weighting, deltaC);
+                }
+            }
+
+            const std::size_t vy = std::size_t(y) * strideY;
+
+            for(int z = 0; z < volDimZ; ++z)
+            {
+                const bool border = (z == 0) || (z == volDimZ - 1);
+                const TSimAcc* costMD = &sliceYm1[std::size_t(z) * aggregationBlockSize];
+                const TSimAcc* costMDM1 = border ? costMD : costMD - aggregationBlockSize;
+                const TSimAcc* costMDP1 = border ? costMD : costMD + aggregationBlockSize;
+                TSimAcc* costOut = &sliceY[std::size_t(z) * aggregationBlockSize];
+
+                for(int ix = 0; ix < nx; ++ix)
+                {
+                    const std::size_t v = vy + std::size_t(x0 + ix) * strideX + std::size_t(z) * strideZ;
+                    float pathCost = 255.0f;
+
+                    if(!border)
+                    {
+                        const float bestCostInColM1 = float(bestSimInYm1[ix]);
+                        const float minCost = std::min(std::min(float(costMD[ix]), float(costMDM1[ix]) + P1),
+                                                       std::min(float(costMDP1[ix]) + P1, bestCostInColM1 + P2[ix]));
+                        pathCost = float(sim[v]) + minCost - bestCostInColM1;
+                    }
+
+                    costOut[ix] = TSimAcc(pathCost);
+
+#ifndef TSIM_USE_FLOAT
+                    // clamp if TSim = uchar (TSimAcc = unsigned int)
+                    pathCost = std::min(255.0f, std::max(0.0f, pathCost));
+#endif
+                    // aggregate into the final output
+                    agr[v] = TSim((float(agr[v]) * fIndex + pathCost) / (fIndex + 1.0f));
+                }
+            }
+
+            std::swap(sliceYm1, sliceY);
+        }
+    }
+}
+
+/*********************************************************************************
+ * Refine
+ *********************************************************************************/
+
+/**
+ * @return (smoothStep, energy)
+ */
+Vec2f getCellSmoothStepEnergy(const CameraCpu& rcCam, const std::vector<float>& depthMap, int width, int height, int x, int y, int yFrom)
+{
+    Vec2f out{0.0f, 180.0f};
+
+    // nearest depth with clamped borders
+    const auto getDepth = [&](int cx, int cy) {
+        cx = std::min(std::max(cx, 0), width - 1);
+        cy = std::min(std::max(cy - yFrom, 0), height - 1);
+        return depthMap[std::size_t(cy) * width + cx];
+    };
+
+    const float d0 = getDepth(x, y);
+
+    // early exit: depth is <= 0
+    if(d0 <= 0.0f)
+        return out;
+
+    // consider the neighbor pixels
+    const float dL = getDepth(x, y - 1);
+    const float dR = getDepth(x, y + 1);
+    const float dU = getDepth(x - 1, y);
+    const float dB = getDepth(x + 1, y);
+
+    const Vec3f p0 = get3DPointForPixelAndDepthFromRC(rcCam, Vec2f{float(x), float(y)}, d0);
+    const Vec3f pL = get3DPointForPixelAndDepthFromRC(rcCam, Vec2f{float(x), float(y - 1)}, dL);
+    const Vec3f pR = get3DPointForPixelAndDepthFromRC(rcCam, Vec2f{float(x), float(y + 1)}, dR);
+    const Vec3f pU = get3DPointForPixelAndDepthFromRC(rcCam, Vec2f{float(x - 1), float(y)}, dU);
+    const Vec3f pB = get3DPointForPixelAndDepthFromRC(rcCam, Vec2f{float(x + 1), float(y)}, dB);
+
+    // average point based on neighbors
+    Vec3f cg{0.0f, 0.0f, 0.0f};
+    float n = 0.0f;
+
+    if(dL > 0.0f) { cg = cg + pL; n++; }
+    if(dR > 0.0f) { cg = cg + pR; n++; }
+    if(dU > 0.0f) { cg = cg + pU; n++; }
+    if(dB > 0.0f) { cg = cg + pB; n++; }
+
+    if(n > 1.0f)
+    {
+        cg = cg / n;
+        Vec3f vcn = rcCam.C - p0;
+        normalize(vcn);
+        // projection of cg on the line from p0 to camera
+        const Vec3f pS = p0 + vcn * dot(vcn, cg - p0);
+        // keep the depth difference between pS and p0 as the smoothing step
+        out.x = size(rcCam.C - pS) - d0;
+    }
+
+    const auto angleBetwABandAC = [](const Vec3f& A, const Vec3f& B, const Vec3f& C) {
+        Vec3f V1 = B - A;
+        Vec3f V2 = C - A;
+        normalize(V1);
+        normalize(V2);
+        float a = std::acos(dot(V1, V2));
+        a = std::isinf(a) ? 0.0f : a;
+        return std::abs(a) / (float(M_PI) / 180.0f);
+    };
+
+    float e = 0.0f;
+    n = 0.0f;
+
+    if(dL > 0.0f && dR > 0.0f)
+    {
+        // large angle between neighbors == flat area => low energy
+        e = std::max(e, (180.0f - angleBetwABandAC(p0, pL, pR)));
+        n++;
+    }
+    if(dU > 0.0f && dB > 0.0f)
+    {
+        e = std::max(e, (180.0f - angleBetwABandAC(p0, pU, pB)));
+        n++;
+    }
+    if(n > 0.0f)
+        out.y = e;
+
+    return out;
+}
+
+} // namespace
+
+/*********************************************************************************
+ * PlaneSweepingCpu
+ *********************************************************************************/
+
+PlaneSweepingCpu::PlaneSweepingCpu(mvsUtils::ImagesCache<ImageRGBAf>& ic, mvsUtils::MultiViewParams& mp, int scales)
+    : _mp(mp)
+    , _scales(scales)
+    , _ic(ic)
+    , _pyramidsCache(3) // rc, tc and the next tc
+    , _pyramids(3)
+{
+    ALICEVISION_LOG_INFO("PlaneSweepingCpu: " << omp_get_max_threads() << " threads, " << _scales << " scales.");
+}
+
+PlaneSweepingCpu::~PlaneSweepingCpu() = default;
+
+std::shared_ptr<const LabPyramid> PlaneSweepingCpu::getPyramid(int camId)
+{
+    int cacheId;
+    if(_pyramidsCache.insert(camId, &cacheId))
+    {
+        const system::Timer timer;
+        mvsUtils::ImagesCache<ImageRGBAf>::ImgSharedPtr img = _ic.getImg_sync(camId);
+        _pyramids[cacheId] = buildPyramid(*img, _mp.getWidth(camId), _mp.getHeight(camId), _scales);
+        ALICEVISION_LOG_DEBUG("Build CIELAB pyramid of camera " << camId << " done in: " << timer.elapsedMs() << " ms.");
+    }
+    return _pyramids[cacheId];
+}
+
+void PlaneSweepingCpu::computeDepthSimMapVolume(int rc,
+                                                CpuSimVolume& volBestSim,
+                                                CpuSimVolume& volSecBestSim,
+                                                const std::vector<int>& tCams,
+                                                const std::vector<Pixel>& rcDepthsTcamsLimits,
+                                                const std::vector<float>& rcDepths,
+                                                const SgmParams& sgmParams)
+{
+    const system::Timer timer;
+
+    const int volDimX = volBestSim.dimX();
+    const int volDimY = volBestSim.dimY();
+
+    ALICEVISION_LOG_INFO("SGM Compute similarity volume (x: " << volDimX << ", y: " << volDimY << ", z: " << volBestSim.dimZ() << ")");
+
+    volBestSim.fill(TSim(255));
+    volSecBestSim.fill(TSim(255));
+
+    const int scale = sgmParams.scale;
+    const int stepXY = sgmParams.stepXY;
+    const int wsh = sgmParams.wsh;
+    const float gammaC = float(sgmParams.gammaC);
+    const float gammaP = float(sgmParams.gammaP);
+
+    const CameraCpu rcCam = createCamera(_mp, rc, scale);
+    const int nbTilesY = (volDimY + volumeTileSize - 1) / volumeTileSize;
+
+    for(std::size_t tci = 0; tci < rcDepthsTcamsLimits.size(); ++tci)
+    {
+        const system::Timer timerPerTc;
+
+        const int tc = tCams[tci];
+        const int startDepthIndex = rcDepthsTcamsLimits[tci].x;
+        const int nbDepthsToSearch = rcDepthsTcamsLimits[tci].y;
+
+        const std::shared_ptr<const LabPyramid> rcPyramid = getPyramid(rc);
+        const std::shared_ptr<const LabPyramid> tcPyramid = getPyramid(tc);
+        const LabImage& rcImg = rcPyramid->levels[scale - 1];
+        const LabImage& tcImg = tcPyramid->levels[scale - 1];
+
+        const CameraCpu tcCam = createCamera(_mp, tc, scale);
+
+        // parallelize over depth planes and tiles of rows:
+        // for a given tc, each (x, y, z) voxel is only written by one iteration
+        const int nbTasks = nbDepthsToSearch * nbTilesY;
+
+        #pragma omp parallel for schedule(dynamic)
+        for(int task = 0; task < nbTasks; ++task)
+        {
+            const int vz = task / nbTilesY;
+            const int tileY = task % nbTilesY;
+            const int zIndex = startDepthIndex + vz;
+            const float fpPlaneDepth = rcDepths[zIndex];
+
+            const int vyEnd = std::min(volDimY, (tileY + 1) * volumeTileSize);
+            for(int vy = tileY * volumeTileSize; vy < vyEnd; ++vy)
+            {
+                for(int vx = 0; vx < volDimX; ++vx)
+                {
+                    const Vec2f pix{float(vx * stepXY), float(vy * stepXY)};
+
+                    Patch ptch;
+                    computePatch(rcCam, tcCam, ptch, get3DPointForPixelAndFrontoParallelPlaneRC(rcCam, pix, fpPlaneDepth));
+
+                    float fsim = compNCCby3DptsYK(rcImg, tcImg, rcCam, tcCam, ptch, wsh, gammaC, gammaP);
+
+                    if(fsim == std::numeric_limits<float>::infinity()) // invalid similarity
+                    {
+                        fsim = 255.0f;
+                    }
+                    else // valid similarity
+                    {
+                        fsim = (fsim + 1.0f) * 0.5f;
+#ifndef TSIM_USE_FLOAT
+                        fsim = std::min(1.0f, std::max(0.0f, fsim));
+#endif
+                        // convert from (0, 1) to (0, 254)
+                        // 255 is reserved for the similarity initialization, i.e. undefined values
+                        fsim *= 254.0f;
+                    }
+
+                    TSim& fsim1st = volBestSim(vx, vy, zIndex);
+                    TSim& fsim2nd = volSecBestSim(vx, vy, zIndex);
+
+                    if(fsim < fsim1st)
+                    {
+                        fsim2nd = fsim1st;
+                        fsim1st = TSim(fsim);
+                    }
+                    else if(fsim < fsim2nd)
+                    {
+                        fsim2nd = TSim(fsim);
+                    }
+                }
+            }
+        }
+
+        ALICEVISION_LOG_DEBUG("Compute similarity volume (with tc: " << tc << ") done in: " << timerPerTc.elapsedMs() << " ms.");
+    }
+
+    ALICEVISION_LOG_INFO("SGM Compute similarity volume done in: " << timer.elapsedMs() << " ms.");
+}
+
+bool PlaneSweepingCpu::sgmOptimizeSimVolume(int rc,
+                                            CpuSimVolume& volSimFiltered,
+                                            const CpuSimVolume& volSim,
+                                            const SgmParams& sgmParams)
+{
+    const system::Timer timer;
+
+    ALICEVISION_LOG_INFO("SGM Optimizing volume:" << std::endl
+                          << "\t- filtering axes: " << sgmParams.filteringAxes << std::endl
+                          << "\t- volume dimensions: (x: " << volSim.dimX() << ", y: " << volSim.dimY() << ", z: " << volSim.dimZ() << ")");
+
+    const std::shared_ptr<const LabPyramid> rcPyramid = getPyramid(rc);
+    const LabImage& rcImg = rcPyramid->levels[sgmParams.scale - 1];
+
+    // filtering is done on the last axis
+    const std::map<char, std::array<int, 3>> mapAxes = {
+        {'X', {1, 0, 2}}, // XYZ -> YXZ
+        {'Y', {0, 1, 2}}, // XYZ
+    };
+
+    int npaths = 0;
+    for(char axis : sgmParams.filteringAxes)
+    {
+        const std::array<int, 3>& axisT = mapAxes.at(axis);
+        aggregatePathVolume(volSimFiltered, volSim, axisT.data(), rcImg, sgmParams, false, npaths++); // without transpose
+        aggregatePathVolume(volSimFiltered, volSim, axisT.data(), rcImg, sgmParams, true, npaths++);  // with transpose of the last axis
+    }
+
+    ALICEVISION_LOG_INFO("SGM Optimizing volume done in: " << timer.elapsedMs() << " ms.");
+    return true;
+}
+
+void PlaneSweepingCpu::sgmRetrieveBestDepth(int rc,
+                                            DepthSimMap& bestDepth,
+                                            const CpuSimVolume& volSim,
+                                            const StaticVector<float>& rcDepths,
+                                            const SgmParams& sgmParams)
+{
+    const system::Timer timer;
+
+    const int volDimX = volSim.dimX();
+    const int volDimY = volSim.dimY();
+    const int volDimZ = volSim.dimZ();
+
+    ALICEVISION_LOG_INFO("SGM Retrieve best depth in volume (x: " << volDimX << ", y: " << volDimY << ", z: " << volDimZ << ")");
+
+    const CameraCpu rcCam = createCamera(_mp, rc, 1);
+    const int scaleStep = sgmParams.scale * sgmParams.stepXY;
+    const bool interpolate = sgmParams.interpolateRetrieveBestDepth;
+
+    #pragma omp parallel for
+    for(int y = 0; y < volDimY; ++y)
+    {
+        for(int x = 0; x < volDimX; ++x)
+        {
+            DepthSim& out = bestDepth._dsm[y * volDimX + x];
+
+            float bestSim = 255.0f;
+            int bestZIdx = -1;
+            for(int z = 0; z < volDimZ; ++z)
+            {
+                const float simAtZ = volSim(x, y, z);
+                if(simAtZ < bestSim)
+                {
+                    bestSim = simAtZ;
+                    bestZIdx = z;
+                }
+            }
+
+            if(bestZIdx == -1)
+            {
+                out.depth = -1.0f;
+                out.sim = 1.0f;
+                continue;
+            }
+
+            const Vec2f pix{float(x * scaleStep), float(y * scaleStep)};
+
+            // without depth interpolation (for debug purpose only)
+            if(!interpolate)
+            {
+                out.depth = depthPlaneToDepth(rcCam, pix, rcDepths[bestZIdx]);
+                out.sim = (bestSim / 255.0f) * 2.0f - 1.0f; // convert from (0, 255) to (-1, +1)
+                continue;
+            }
+
+            // with depth/sim interpolation
+            const int bestZIdx_m1 = std::max(0, bestZIdx - 1);
+            const int bestZIdx_p1 = std::min(volDimZ - 1, bestZIdx + 1);
+
+            const Vec3f depths{rcDepths[bestZIdx_m1], rcDepths[bestZIdx], rcDepths[bestZIdx_p1]};
+
+            // convert sims from (0, 255) to (-1, +1)
+            const Vec3f sims{(float(volSim(x, y, bestZIdx_m1)) / 255.0f) * 2.0f - 1.0f,
+                             (bestSim / 255.0f) * 2.0f - 1.0f,
+                             (float(volSim(x, y, bestZIdx_p1)) / 255.0f) * 2.0f - 1.0f};
+
+            // interpolation between the 3 depth planes candidates
+            const float refinedDepth = refineDepthSubPixel(depths, sims);
+
+            out.depth = depthPlaneToDepth(rcCam, pix, refinedDepth);
+            out.sim = sims.y;
+        }
+    }
+
+    ALICEVISION_LOG_INFO("SGM Retrieve best depth in volume done in: " << timer.elapsedMs() << " ms.");
+}
+
+bool PlaneSweepingCpu::refineRcTcDepthMap(int rc, int tc,
+                                          StaticVector<float>& inout_depthMap,
+                                          StaticVector<float>& out_simMap,
+                                          const RefineParams& refineParams,
+                                          int xFrom, int wPart)
+{
+    const int scale = refineParams.scale;
+    const int rcHeight = _mp.getHeight(rc) / scale;
+
+    const std::shared_ptr<const LabPyramid> rcPyramid = getPyramid(rc);
+    const std::shared_ptr<const LabPyramid> tcPyramid = getPyramid(tc);
+    const LabImage& rcImg = rcPyramid->levels[scale - 1];
+    const LabImage& tcImg = tcPyramid->levels[scale - 1];
+
+    const CameraCpu rcCam = createCamera(_mp, rc, scale);
+    const CameraCpu tcCam = createCamera(_mp, tc, scale);
+
+    const int wsh = refineParams.wsh;
+    const float gammaC = float(refineParams.gammaC);
+    const float gammaP = float(refineParams.gammaP);
+    const bool moveByTcOrRc = refineParams.useTcOrRcPixSize;
+    const int halfNSteps = ((refineParams.nDepthsToRefine - 1) / 2) + 1; // default ntcsteps = 31
+
+    // similarity of the patch of a pixel moved by the given step from the given depth
+    const auto computeSim = [&](const Vec2f& pix, float depth, float step, float& outDepth) {
+        Vec3f p = get3DPointForPixelAndDepthFromRC(rcCam, pix, depth);
+        move3DPointByTcOrRcPixStep(rcCam, tcCam, p, step, moveByTcOrRc);
+        outDepth = size(p - rcCam.C);
+
+        Patch ptch;
+        computePatch(rcCam, tcCam, ptch, p);
+        return compNCCby3DptsYK(rcImg, tcImg, rcCam, tcCam, ptch, wsh, gammaC, gammaP);
+    };
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int y = 0; y < rcHeight; ++y)
+    {
+        for(int tx = 0; tx < wPart; ++tx)
+        {
+            const Vec2f pix{float(tx + xFrom), float(y)};
+            const std::size_t i = std::size_t(y) * wPart + tx;
+            const float depth = inout_depthMap[i];
+
+            float bestSim = 1.0f;
+            float bestDepth = depth;
+
+            const LabColor gcr = rcImg.sample(pix.x, pix.y);
+            if(depth <= 0.0f || gcr.alpha == 0.0f)
+            {
+                out_simMap[i] = bestSim;
+                continue;
+            }
+
+            // steps: 0, 1, ..., halfNSteps - 1, -1, ..., -(halfNSteps - 1)
+            for(int s = 0; s < 2 * halfNSteps - 1; ++s)
+            {
+                const float step = (s < halfNSteps) ? float(s) : -float(s - halfNSteps + 1);
+                float stepDepth;
+                const float sim = computeSim(pix, depth, step, stepDepth);
+                if(s == 0 || sim < bestSim)
+                {
+                    bestSim = sim;
+                    bestDepth = stepDepth;
+                }
+            }
+
+            // interpolation from the similarities of the neighbor depths
+            float outDepth = bestDepth;
+            if(bestDepth > 0.0f)
+            {
+                float depthM1;
+                float depthP1;
+                const float simM1 = computeSim(pix, bestDepth, -1.0f, depthM1);
+                const float simP1 = computeSim(pix, bestDepth, +1.0f, depthP1);
+                outDepth = refineDepthSubPixel(Vec3f{depthM1, bestDepth, depthP1}, Vec3f{simM1, bestSim, simP1});
+            }
+
+            out_simMap[i] = bestSim;
+            inout_depthMap[i] = outDepth;
+        }
+    }
+    return true;
+}
+
+bool PlaneSweepingCpu::fuseDepthSimMapsGaussianKernelVoting(int wPart, int hPart,
+                                                            StaticVector<DepthSim>& out_depthSimMap,
+                                                            const StaticVector<StaticVector<DepthSim>*>& dataMaps,
+                                                            const RefineParams& refineParams)
+{
+    const system::Timer timer;
+
+    const float samplesPerPixSize = float(refineParams.nSamplesHalf / ((refineParams.nDepthsToRefine - 1) / 2));
+    const float twoTimesSigmaPowerTwo = float(2.0 * refineParams.sigma * refineParams.sigma);
+    const int nSamplesHalf = refineParams.nSamplesHalf;
+    const int nbTCams = dataMaps.size() - 1;
+
+    #pragma omp parallel for
+    for(int y = 0; y < hPart; ++y)
+    {
+        // per T camera sample index and similarity, they do not depend on the voting sample
+        std::vector<float> camSample(nbTCams);
+        std::vector<float> camSim(nbTCams);
+
+        for(int x = 0; x < wPart; ++x)
+        {
+            const std::size_t i = std::size_t(y) * wPart + x;
+            const DepthSim& midDepthPixSize = (*dataMaps[0])[i];
+            DepthSim& out = out_depthSimMap[i];
+
+            if(midDepthPixSize.depth <= 0.0f)
+            {
+                out = DepthSim(-1.0f, 1.0f);
+                continue;
+            }
+
+            const float depthStep = midDepthPixSize.sim / samplesPerPixSize;
+
+            int nbValid = 0;
+            for(int c = 0; c < nbTCams; ++c)
+            {
+                const DepthSim& depthSim = (*dataMaps[c + 1])[i];
+                if(depthSim.depth > 0.0f)
+                {
+                    camSample[nbValid] = (midDepthPixSize.depth - depthSim.depth) / depthStep;
+                    camSim[nbValid] = -sigmoid(0.0f, 1.0f, 0.7f, -0.7f, depthSim.sim);
+                    ++nbValid;
+                }
+            }
+
+            float bestGsvSample = 0.0f;
+            float bestS = float(-nSamplesHalf);
+            for(int s = -nSamplesHalf; s <= nSamplesHalf; ++s)
+            {
+                float gsvSample = 0.0f;
+                for(int c = 0; c < nbValid; ++c)
+                {
+                    const float d = camSample[c] - float(s);
+                    gsvSample += camSim[c] * std::exp(-(d * d) / twoTimesSigmaPowerTwo);
+                }
+                if(s == -nSamplesHalf || gsvSample < bestGsvSample)
+                {
+                    bestGsvSample = gsvSample;
+                    bestS = float(s);
+                }
+            }
+
+            out = DepthSim(midDepthPixSize.depth - bestS * depthStep, bestGsvSample);
+        }
+    }
+
+    ALICEVISION_LOG_DEBUG("Fuse depth/sim maps gaussian kernel voting done in: " << timer.elapsedMs() << " ms.");
+    return true;
+}
+
+bool PlaneSweepingCpu::optimizeDepthSimMapGradientDescent(int rc,
+                                                          StaticVector<DepthSim>& out_depthSimMapOptimized,
+                                                          const StaticVector<DepthSim>& depthSimMapSgmUpscale,
+                                                          const StaticVector<DepthSim>& depthSimMapRefinedFused,
+                                                          const RefineParams& refineParams,
+                                                          int yFrom, int hPart)
+{
+    const system::Timer timer;
+
+    const int partWidth = _mp.getWidth(rc) / refineParams.scale;
+    const int partHeight = hPart;
+
+    const std::shared_ptr<const LabPyramid> rcPyramid = getPyramid(rc);
+    const LabImage& rcImg = rcPyramid->levels[refineParams.scale - 1];
+    const CameraCpu rcCam = createCamera(_mp, rc, refineParams.scale);
+
+    // gradient size of the L channel
+    std::vector<float> imgVariance(std::size_t(partWidth) * partHeight);
+
+    #pragma omp parallel for
+    for(int y = 0; y < partHeight; ++y)
+    {
+        for(int x = 0; x < partWidth; ++x)
+        {
+            const int iy = y + yFrom;
+            const float gx = rcImg.sample(float(x - 1), float(iy)).l - rcImg.sample(float(x + 1), float(iy)).l;
+            const float gy = rcImg.sample(float(x), float(iy - 1)).l - rcImg.sample(float(x), float(iy + 1)).l;
+            imgVariance[std::size_t(y) * partWidth + x] = std::sqrt(gx * gx + gy * gy);
+        }
+    }
+
+    // optimized depth/sim map of the part, initialized from the SGM upscaled depth map
+    std::vector<DepthSim> optDepthSimMap(std::size_t(partWidth) * partHeight);
+    std::vector<float> optDepthMap(optDepthSimMap.size());
+
+    for(int y = 0; y < partHeight; ++y)
+    {
+        for(int x = 0; x < partWidth; ++x)
+            optDepthSimMap[std::size_t(y) * partWidth + x] = depthSimMapSgmUpscale[std::size_t(y + yFrom) * partWidth + x];
+    }
+
+    for(int iter = 0; iter < refineParams.nIters; ++iter) // nIters: 100 by default
+    {
+        // copy depths values from optDepthSimMap to optDepthMap
+        for(std::size_t i = 0; i < optDepthSimMap.size(); ++i)
+            optDepthMap[i] = optDepthSimMap[i].depth;
+
+        // adjust depth/sim by using previously computed depths
+        #pragma omp parallel for
+        for(int y = 0; y < partHeight; ++y)
+        {
+            for(int x = 0; x < partWidth; ++x)
+            {
+                const std::size_t i = std::size_t(y) * partWidth + x;
+                const DepthSim& roughDepthPixSize = depthSimMapSgmUpscale[std::size_t(y + yFrom) * partWidth + x];
+                const DepthSim& fineDepthSim = depthSimMapRefinedFused[std::size_t(y + yFrom) * partWidth + x];
+
+                const float roughDepth = roughDepthPixSize.depth;
+                const float roughPixSize = roughDepthPixSize.sim;
+                const float fineDepth = fineDepthSim.depth;
+                const float fineSim = fineDepthSim.sim;
+
+                DepthSim outOptDepthSim = (iter == 0) ? DepthSim(roughDepth, fineSim) : optDepthSimMap[i];
+                const float depthOpt = outOptDepthSim.depth;
+
+                if(depthOpt > 0.0f)
+                {
+                    const Vec2f depthSmoothStepEnergy = getCellSmoothStepEnergy(rcCam, optDepthMap, partWidth, partHeight, x, y + yFrom, yFrom); // (smoothStep, energy)
+                    float stepToSmoothDepth = depthSmoothStepEnergy.x;
+                    stepToSmoothDepth = std::copysign(std::min(std::abs(stepToSmoothDepth), roughPixSize / 10.0f), stepToSmoothDepth);
+                    const float depthEnergy = depthSmoothStepEnergy.y; // max angle with neighbors
+                    float stepToFineDM = fineDepth - depthOpt; // distance to refined/noisy input depth map
+                    stepToFineDM = std::copysign(std::min(std::abs(stepToFineDM), roughPixSize / 10.0f), stepToFineDM);
+
+                    const float stepToRoughDM = roughDepth - depthOpt; // distance to smooth/robust input depth map
+                    const float imgColorVariance = imgVariance[i];
+                    const float colorVarianceThresholdForSmoothing = 20.0f;
+                    const float angleThresholdForSmoothing = 30.0f;
+
+                    const float weightedColorVariance = sigmoid2(5.0f, angleThresholdForSmoothing, 40.0f, colorVarianceThresholdForSmoothing, imgColorVariance);
+                    const float fineSimWeight = sigmoid(0.0f, 1.0f, 0.7f, -0.7f, fineSim);
+
+                    // if geometry variation is bigger than color variation => the fineDM is considered noisy
+                    const float energyLowerThanVarianceWeight = sigmoid(0.0f, 1.0f, 30.0f, weightedColorVariance, depthEnergy);
+                    const float closeToRoughWeight = 1.0f - sigmoid(0.0f, 1.0f, 10.0f, 17.0f, std::abs(stepToRoughDM / roughPixSize));
+
+                    const float depthOptStep = closeToRoughWeight * stepToRoughDM + // distance to smooth/robust input depth map
+                                               (1.0f - closeToRoughWeight) * (energyLowerThanVarianceWeight * fineSimWeight * stepToFineDM + // distance to refined/noisy
+                                                                             (1.0f - energyLowerThanVarianceWeight) * stepToSmoothDepth); // max angle in current depthMap
+
+                    outOptDepthSim.depth = depthOpt + depthOptStep;
+                    outOptDepthSim.sim = (1.0f - closeToRoughWeight) * (energyLowerThanVarianceWeight * fineSimWeight * fineSim +
+                                                                        (1.0f - energyLowerThanVarianceWeight) * (depthEnergy / 20.0f));
+                }
+
+                optDepthSimMap[i] = outOptDepthSim;
+            }
+        }
+    }
+
+    for(int y = 0; y < partHeight; ++y)
+    {
+        for(int x = 0; x < partWidth; ++x)
+            out_depthSimMapOptimized[std::size_t(y + yFrom) * partWidth + x] = optDepthSimMap[std::size_t(y) * partWidth + x];
+    }
+
+    ALICEVISION_LOG_DEBUG("Optimize depth/sim map gradient descent done in: " << timer.elapsedMs() << " ms.");
+    return true;
+}
+
+bool PlaneSweepingCpu::computeNormalMap(const std::vector<float>& depthMap,
+                                        std::vector<ColorRGBf>& normalMap,
+                                        int rc, int scale, int wsh)
+{
+    const system::Timer timer;
+
+    const int width = _mp.getWidth(rc) / scale;
+    const int height = _mp.getHeight(rc) / scale;
+    const CameraCpu rcCam = createCamera(_mp, rc, scale);
+
+    normalMap.resize(std::size_t(width) * height);
+
+    #pragma omp parallel for
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            ColorRGBf& out = normalMap[std::size_t(y) * width + x];
+            out = ColorRGBf(-1.f, -1.f, -1.f);
+
+            const float depth = depthMap[std::size_t(y) * width + x];
+            if(depth <= 0.0f)
+                continue;
+
+            const Vec3f p = get3DPointForPixelAndDepthFromRC(rcCam, Vec2f{float(x), float(y)}, depth);
+            const float pixSize = size(p - get3DPointForPixelAndDepthFromRC(rcCam, Vec2f{float(x + 1), float(y)}, depth));
+
+            Stat3d s3d;
+            for(int yp = std::max(0, y - wsh); yp <= std::min(height - 1, y + wsh); ++yp)
+            {
+                for(int xp = std::max(0, x - wsh); xp <= std::min(width - 1, x + wsh); ++xp)
+                {
+                    const float depthn = depthMap[std::size_t(yp) * width + xp];
+                    if(depthn > 0.0f && std::abs(depthn - depth) < 30.0f * pixSize)
+                    {
+                        const Vec3f pn = get3DPointForPixelAndDepthFromRC(rcCam, Vec2f{float(xp), float(yp)}, depthn);
+                        Point3d pnd(pn.x, pn.y, pn.z);
+                        s3d.update(&pnd);
+                    }
+                }
+            }
+
+            if(s3d.count < 3)
+                continue;
+
+            Point3d cg, v1, v2, v3;
+            float d1, d2, d3;
+            s3d.getEigenVectorsDesc(cg, v1, v2, v3, d1, d2, d3);
+
+            // the normal is oriented toward the camera
+            Vec3f n{float(v3.x), float(v3.y), float(v3.z)};
+            if(dot(n, rcCam.C - p) < 0.0f)
+                n = n * -1.0f;
+
+            out = ColorRGBf(n.x, n.y, n.z);
+        }
+    }
+
+    ALICEVISION_LOG_DEBUG("Compute normal map of camera " << rc << " done in: " << timer.elapsedMs() << " ms.");
+    return true;
+}
+
+} // namespace depthMap
+} // namespace aliceVision
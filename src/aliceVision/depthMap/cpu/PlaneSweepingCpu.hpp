@@ -0,0 +1,144 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Color.hpp>
+#include <aliceVision/mvsData/Pixel.hpp>
+#include <aliceVision/mvsData/StaticVector.hpp>
+#include <aliceVision/mvsUtils/ImagesCache.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/depthMap/SgmParams.hpp>
+#include <aliceVision/depthMap/RefineParams.hpp>
+#include <aliceVision/depthMap/DepthSimMap.hpp>
+#include <aliceVision/depthMap/cuda/LRUCache.hpp>
+#include <aliceVision/depthMap/cuda/planeSweeping/similarity.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @brief Similarity volume stored in host memory.
+ *        Voxels are indexed (x, y, z) with x varying the fastest, as the CUDA pitched volumes.
+ */
+class CpuSimVolume
+{
+public:
+    CpuSimVolume(int dimX, int dimY, int dimZ, TSim value = TSim(255))
+        : _dimX(dimX)
+        , _dimY(dimY)
+        , _dimZ(dimZ)
+        , _data(std::size_t(dimX) * std::size_t(dimY) * std::size_t(dimZ), value)
+    {}
+
+    inline int dimX() const { return _dimX; }
+    inline int dimY() const { return _dimY; }
+    inline int dimZ() const { return _dimZ; }
+
+    inline TSim& operator()(int x, int y, int z) { return _data[index(x, y, z)]; }
+    inline const TSim& operator()(int x, int y, int z) const { return _data[index(x, y, z)]; }
+
+    inline TSim* getBuffer() { return _data.data(); }
+    inline const TSim* getBuffer() const { return _data.data(); }
+
+    inline void fill(TSim value) { std::fill(_data.begin(), _data.end(), value); }
+
+private:
+    inline std::size_t index(int x, int y, int z) const
+    {
+        return (std::size_t(z) * std::size_t(_dimY) + std::size_t(y)) * std::size_t(_dimX) + std::size_t(x);
+    }
+
+    int _dimX;
+    int _dimY;
+    int _dimZ;
+    std::vector<TSim> _data;
+};
+
+/**
+ * @brief CIELAB image pyramid of a camera (level i is downscaled by a factor i + 1).
+ */
+struct LabPyramid;
+
+/*********************************************************************************
+ * PlaneSweepingCpu
+ * Host implementation of the plane sweeping used by Sgm and Refine,
+ * for computers without a CUDA device.
+ * The computations are the same as the PlaneSweepingCuda ones, they are parallelized
+ * over depth planes and image tiles with OpenMP.
+ *********************************************************************************/
+class PlaneSweepingCpu
+{
+public:
+    mvsUtils::MultiViewParams& _mp;
+    const int _scales;
+    mvsUtils::ImagesCache<ImageRGBAf>& _ic;
+
+    PlaneSweepingCpu(mvsUtils::ImagesCache<ImageRGBAf>& ic, mvsUtils::MultiViewParams& mp, int scales);
+    ~PlaneSweepingCpu();
+
+    void computeDepthSimMapVolume(int rc,
+        CpuSimVolume& volBestSim,
+        CpuSimVolume& volSecBestSim,
+        const std::vector<int>& tCams,
+        const std::vector<Pixel>& rcDepthsTcamsLimits,
+        const std::vector<float>& rcDepths,
+        const SgmParams& sgmParams);
+
+    bool sgmOptimizeSimVolume(int rc,
+        CpuSimVolume& volSimFiltered,
+        const CpuSimVolume& volSim,
+        const SgmParams& sgmParams);
+
+    void sgmRetrieveBestDepth(int rc,
+        DepthSimMap& bestDepth,
+        const CpuSimVolume& volSim,
+        const StaticVector<float>& rcDepths,
+        const SgmParams& sgmParams);
+
+    bool refineRcTcDepthMap(int rc, int tc,
+                            StaticVector<float>& inout_depthMap,
+                            StaticVector<float>& out_simMap,
+                            const RefineParams& refineParams,
+                            int xFrom, int wPart);
+
+    bool fuseDepthSimMapsGaussianKernelVoting(int wPart, int hPart,
+                                              StaticVector<DepthSim>& out_depthSimMap,
+                                              const StaticVector<StaticVector<DepthSim>*>& dataMaps,
+                                              const RefineParams& refineParams);
+
+    bool optimizeDepthSimMapGradientDescent(int rc,
+                                            StaticVector<DepthSim>& out_depthSimMapOptimized,
+                                            const StaticVector<DepthSim>& depthSimMapSgmUpscale,
+                                            const StaticVector<DepthSim>& depthSimMapRefinedFused,
+                                            const RefineParams& refineParams,
+                                            int yFrom, int hPart);
+
+    /**
+     * @brief Compute the normal map of a camera from its depth map,
+     *        by fitting a plane on the 3D points of the (2 * wsh + 1)^2 neighbourhood of each pixel.
+     *        Pixels without depth or without a valid plane get the normal (-1, -1, -1).
+     */
+    bool computeNormalMap(const std::vector<float>& depthMap,
+                          std::vector<ColorRGBf>& normalMap,
+                          int rc, int scale, int wsh);
+
+private:
+    /* Get the CIELAB image pyramid of the given camera.
+     * Pyramids are kept in a small LRU cache, the returned pointer
+     * remains valid after being evicted from the cache. */
+    std::shared_ptr<const LabPyramid> getPyramid(int camId);
+
+    LRUCache<int> _pyramidsCache;
+    std::vector<std::shared_ptr<const LabPyramid>> _pyramids;
+};
+
+} // namespace depthMap
+} // namespace aliceVision
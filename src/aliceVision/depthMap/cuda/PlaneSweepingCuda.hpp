@@ -24,16 +24,11 @@
 #include <aliceVision/depthMap/cuda/OneTC.hpp>
 #include <aliceVision/depthMap/cuda/LRUCache.hpp>
 #include <aliceVision/depthMap/cuda/normalmap/normal_map.hpp>
+#include <aliceVision/depthMap/cuda/planeSweeping/similarity.hpp>
 
 namespace aliceVision {
 namespace depthMap {
 
-#ifdef TSIM_USE_FLOAT
-    using TSim = float;
-#else
-    using TSim = unsigned char;
-#endif
-
 /*********************************************************************************
  * CamSelection
  * Support class for operating an LRU cache of the currently selection cameras
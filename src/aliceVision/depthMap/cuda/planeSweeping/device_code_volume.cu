@@ -7,19 +7,12 @@
 #pragma once
 
 #include <aliceVision/depthMap/cuda/deviceCommon/device_matrix.cu>
+#include <aliceVision/depthMap/cuda/planeSweeping/similarity.hpp>
 
 
 namespace aliceVision {
 namespace depthMap {
 
-#ifdef TSIM_USE_FLOAT
-using TSim = float;
-using TSimAcc = float;
-#else
-using TSim = unsigned char;
-using TSimAcc = unsigned int; // TSimAcc is the similarity accumulation type
-#endif
-
 
 inline __device__ void volume_computePatch( int rc_cam_cache_idx,
                                             int tc_cam_cache_idx,
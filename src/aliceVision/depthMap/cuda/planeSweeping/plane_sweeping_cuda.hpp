@@ -10,18 +10,11 @@
 #include <aliceVision/depthMap/RefineParams.hpp>
 #include <aliceVision/depthMap/cuda/commonStructures.hpp>
 #include <aliceVision/depthMap/cuda/OneTC.hpp>
+#include <aliceVision/depthMap/cuda/planeSweeping/similarity.hpp>
 
 namespace aliceVision {
 namespace depthMap {
 
-#ifdef TSIM_USE_FLOAT
-    using TSim = float;
-    using TSimAcc = float;
-#else
-    using TSim = unsigned char;
-    using TSimAcc = unsigned int; // TSimAcc is the similarity accumulation type
-#endif
-
 
 void ps_initCameraMatrix( CameraStructBase& base );
 
@@ -0,0 +1,24 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+namespace aliceVision {
+namespace depthMap {
+
+// Similarity volume types, shared by the CUDA and the CPU plane sweeping.
+// This header does not depend on CUDA.
+
+#ifdef TSIM_USE_FLOAT
+    using TSim = float;
+    using TSimAcc = float;
+#else
+    using TSim = unsigned char;
+    using TSimAcc = unsigned int; // TSimAcc is the similarity accumulation type
+#endif
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -6,6 +6,7 @@
 
 #include "depthMap.hpp"
 
+#include <aliceVision/config.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
 #include <aliceVision/mvsUtils/fileIO.hpp>
@@ -14,10 +15,16 @@
 #include <aliceVision/depthMap/RefineParams.hpp>
 #include <aliceVision/depthMap/Sgm.hpp>
 #include <aliceVision/depthMap/SgmParams.hpp>
+#include <aliceVision/depthMap/cpu/PlaneSweepingCpu.hpp>
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
 #include <aliceVision/depthMap/cuda/PlaneSweepingCuda.hpp>
+#endif
 
 #include <boost/filesystem.hpp>
 
+#include <memory>
+
 namespace fs = boost::filesystem;
 
 namespace aliceVision {
@@ -60,24 +67,16 @@ void getRefineParams(const mvsUtils::MultiViewParams& mp, RefineParams& refinePa
     refineParams.exportIntermediateResults = mp.userParams.get<bool>("refine.exportIntermediateResults", refineParams.exportIntermediateResults);
 }
 
-void estimateAndRefineDepthMaps(int cudaDeviceIndex, mvsUtils::MultiViewParams& mp, const std::vector<int>& cams)
-{
-    SgmParams sgmParams;
-    RefineParams refineParams;
-
-    // get user parameters from MultiViewParams property_tree
-    getSgmParams(mp, sgmParams);
-    getRefineParams(mp, refineParams);
-
-    // compute scale and step
-    computeScaleStepSgmParams(mp, sgmParams);
-
-    // load images from files into RAM
-    mvsUtils::ImagesCache<ImageRGBAf> ic(mp, imageIO::EImageColorSpace::LINEAR);
-
-    // load stuff on GPU memory and creates multi-level images and computes gradients
-    PlaneSweepingCuda cps(cudaDeviceIndex, ic, mp, sgmParams.scale);
+namespace {
 
+/**
+ * @brief Estimate and refine the depth maps of the given cameras with the given plane sweeping implementation.
+ * @tparam PlaneSweeping PlaneSweepingCuda or PlaneSweepingCpu
+ */
+template <class PlaneSweeping>
+void estimateAndRefineDepthMaps(PlaneSweeping& cps, const SgmParams& sgmParams, const RefineParams& refineParams,
+                                mvsUtils::MultiViewParams& mp, const std::vector<int>& cams)
+{
     for(const int rc : cams)
     {
         Sgm sgm(sgmParams, mp, cps, rc);
@@ -107,18 +106,60 @@ void estimateAndRefineDepthMaps(int cudaDeviceIndex, mvsUtils::MultiViewParams&
     }
 }
 
+} // namespace
+
+void estimateAndRefineDepthMaps(int cudaDeviceIndex, mvsUtils::MultiViewParams& mp, const std::vector<int>& cams)
+{
+    SgmParams sgmParams;
+    RefineParams refineParams;
+
+    // get user parameters from MultiViewParams property_tree
+    getSgmParams(mp, sgmParams);
+    getRefineParams(mp, refineParams);
+
+    // compute scale and step
+    computeScaleStepSgmParams(mp, sgmParams);
+
+    // load images from files into RAM
+    mvsUtils::ImagesCache<ImageRGBAf> ic(mp, imageIO::EImageColorSpace::LINEAR);
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+    if(cudaDeviceIndex >= 0)
+    {
+        // load stuff on GPU memory and creates multi-level images and computes gradients
+        PlaneSweepingCuda cps(cudaDeviceIndex, ic, mp, sgmParams.scale);
+        estimateAndRefineDepthMaps(cps, sgmParams, refineParams, mp, cams);
+        return;
+    }
+#endif
+
+    // no CUDA device: compute on the CPU
+    PlaneSweepingCpu cps(ic, mp, sgmParams.scale);
+    estimateAndRefineDepthMaps(cps, sgmParams, refineParams, mp, cams);
+}
+
 void computeNormalMaps(int cudaDeviceIndex, mvsUtils::MultiViewParams& mp, const std::vector<int>& cams)
 {
     using namespace imageIO;
     
-    const float gammaC = 1.0f;
-    const float gammaP = 1.0f;
     const int wsh = 3;
 
     mvsUtils::ImagesCache<ImageRGBAf> ic(mp, EImageColorSpace::LINEAR);
-    PlaneSweepingCuda cps(cudaDeviceIndex, ic, mp, 1);
 
-    NormalMapping* mapping = cps.createNormalMapping();
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+    std::unique_ptr<PlaneSweepingCuda> cps;
+    NormalMapping* mapping = nullptr;
+    if(cudaDeviceIndex >= 0)
+    {
+        cps.reset(new PlaneSweepingCuda(cudaDeviceIndex, ic, mp, 1));
+        mapping = cps->createNormalMapping();
+    }
+#endif
+
+    // no CUDA device: compute on the CPU
+    std::unique_ptr<PlaneSweepingCpu> cpsCpu;
+    if(cudaDeviceIndex < 0)
+        cpsCpu.reset(new PlaneSweepingCpu(ic, mp, 1));
 
     for(const int rc : cams)
     {
@@ -134,11 +175,24 @@ void computeNormalMaps(int cudaDeviceIndex, mvsUtils::MultiViewParams& mp, const
             std::vector<ColorRGBf> normalMap;
             normalMap.resize(mp.getWidth(rc) * mp.getHeight(rc));
 
-            cps.computeNormalMap(mapping, depthMap, normalMap, rc, 1, gammaC, gammaP, wsh);
+            if(cpsCpu)
+                cpsCpu->computeNormalMap(depthMap, normalMap, rc, 1, wsh);
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+            else
+            {
+                const float gammaC = 1.0f;
+                const float gammaP = 1.0f;
+                cps->computeNormalMap(mapping, depthMap, normalMap, rc, 1, gammaC, gammaP, wsh);
+            }
+#endif
             writeImage(normalMapFilepath, mp.getWidth(rc), mp.getHeight(rc), normalMap, EImageQuality::LOSSLESS, OutputFileColorSpace(EImageColorSpace::NO_CONVERSION));
         }
     }
-    cps.deleteNormalMapping(mapping);
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+    if(cps)
+        cps->deleteNormalMapping(mapping);
+#endif
 }
 
 } // namespace depthMap
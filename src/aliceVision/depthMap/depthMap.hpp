@@ -15,6 +15,10 @@ namespace mvsUtils { class MultiViewParams; }
 
 namespace depthMap {
 
+/**
+ * @brief Estimate and refine the depth maps of the given cameras.
+ * @param[in] cudaDeviceIndex the CUDA device index, or a negative value to compute on the CPU
+ */
 void estimateAndRefineDepthMaps(int cudaDeviceIndex, mvsUtils::MultiViewParams& mp, const std::vector<int>& cams);
 void computeNormalMaps(int cudaDeviceIndex, mvsUtils::MultiViewParams& mp, const std::vector<int>& cams);
 
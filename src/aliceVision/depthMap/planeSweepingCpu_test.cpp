@@ -0,0 +1,230 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/depthMap/cpu/PlaneSweepingCpu.hpp>
+#include <aliceVision/depthMap/DepthSimMap.hpp>
+#include <aliceVision/depthMap/SgmParams.hpp>
+#include <aliceVision/camera/Pinhole.hpp>
+#include <aliceVision/mvsData/imageIO.hpp>
+#include <aliceVision/mvsUtils/ImagesCache.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE depthMapPlaneSweepingCpu
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::depthMap;
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+const int width = 128;
+const int height = 96;
+const double focal = 150.0;
+const double planeDepth = 10.0;
+const double baseline = 1.0;
+
+/**
+ * @brief Random gray levels on a regular grid of the plane, bilinearly interpolated
+ */
+class PlaneTexture
+{
+public:
+    explicit PlaneTexture(double cellSize)
+        : _cellSize(cellSize)
+        , _values(_gridSize * _gridSize)
+    {
+        std::mt19937 randomNumberGenerator;
+        std::uniform_real_distribution<float> distribution(0.05f, 0.95f);
+        for(float& value : _values)
+            value = distribution(randomNumberGenerator);
+    }
+
+    float operator()(double x, double y) const
+    {
+        const double gx = x / _cellSize + _gridSize / 2;
+        const double gy = y / _cellSize + _gridSize / 2;
+        const int x0 = std::min(std::max(int(std::floor(gx)), 0), _gridSize - 2);
+        const int y0 = std::min(std::max(int(std::floor(gy)), 0), _gridSize - 2);
+        const float ax = float(gx - x0);
+        const float ay = float(gy - y0);
+
+        return (1.f - ax) * (1.f - ay) * value(x0, y0) + ax * (1.f - ay) * value(x0 + 1, y0) +
+               (1.f - ax) * ay * value(x0, y0 + 1) + ax * ay * value(x0 + 1, y0 + 1);
+    }
+
+private:
+    float value(int x, int y) const { return _values[y * _gridSize + x]; }
+
+    const int _gridSize = 256;
+    double _cellSize;
+    std::vector<float> _values;
+};
+
+/**
+ * @brief Image of the fronto-parallel plane Z = planeDepth seen by a camera looking along the z axis
+ * @param[in] cameraX The x coordinate of the camera center
+ */
+std::vector<ColorRGBf> renderPlane(const PlaneTexture& texture, double cameraX)
+{
+    std::vector<ColorRGBf> image(width * height);
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            const float gray = texture(cameraX + (x - width * 0.5) * planeDepth / focal, (y - height * 0.5) * planeDepth / focal);
+            image[y * width + x] = ColorRGBf(gray, gray, gray);
+        }
+    }
+    return image;
+}
+
+/**
+ * @brief Two views of a textured fronto-parallel plane, the second camera is translated along the x axis
+ */
+void createTwoViewsScene(const std::string& folder, sfmData::SfMData& sfmData)
+{
+    const PlaneTexture texture(0.15); // about 2 pixels
+
+    sfmData.intrinsics.emplace(0, std::make_shared<camera::Pinhole>(width, height, focal, focal, 0.0, 0.0));
+
+    for(IndexT viewId = 0; viewId < 2; ++viewId)
+    {
+        const double cameraX = viewId * baseline;
+        const std::string imagePath = (fs::path(folder) / (std::to_string(viewId) + ".exr")).string();
+
+        imageIO::writeImage(imagePath, width, height, renderPlane(texture, cameraX), imageIO::EImageQuality::LOSSLESS,
+                            imageIO::OutputFileColorSpace(imageIO::EImageColorSpace::NO_CONVERSION));
+
+        sfmData.views.emplace(viewId, std::make_shared<sfmData::View>(imagePath, viewId, 0, viewId, width, height));
+        sfmData.setPose(*sfmData.views.at(viewId), sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), Vec3(cameraX, 0.0, 0.0))));
+    }
+}
+
+/// distance to the camera center of the plane point seen by pixel (x, y) of the first camera
+double expectedDepth(int x, int y)
+{
+    const Vec3 ray((x - width * 0.5) / focal, (y - height * 0.5) / focal, 1.0);
+    return ray.norm() * planeDepth;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(PlaneSweepingCpu_frontoParallelTwoViews)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path("depthMap_planeSweepingCpu_%%%%");
+    fs::create_directories(folder);
+
+    sfmData::SfMData sfmData;
+    createTwoViewsScene(folder.string(), sfmData);
+
+    mvsUtils::MultiViewParams mp(sfmData, "", folder.string(), "", false, 1);
+    mvsUtils::ImagesCache<ImageRGBAf> ic(mp, imageIO::EImageColorSpace::LINEAR);
+    PlaneSweepingCpu cps(ic, mp, 1);
+
+    SgmParams sgmParams;
+    sgmParams.scale = 1;
+    sgmParams.stepXY = 1;
+
+    // fronto-parallel planes around the ground truth
+    std::vector<float> depths;
+    for(float depth = 8.f; depth <= 12.f; depth += 0.02f)
+        depths.push_back(depth);
+
+    const int rc = mp.getIndexFromViewId(0);
+    const int tc = mp.getIndexFromViewId(1);
+
+    CpuSimVolume volBestSim(width, height, int(depths.size()));
+    CpuSimVolume volSecBestSim(width, height, int(depths.size()));
+    cps.computeDepthSimMapVolume(rc, volBestSim, volSecBestSim, {tc}, {Pixel(0, int(depths.size()))}, depths, sgmParams);
+
+    StaticVector<float> depthsSV;
+    depthsSV.getDataWritable() = depths;
+
+    DepthSimMap depthSimMap(rc, mp, sgmParams.scale, sgmParams.stepXY);
+    cps.sgmRetrieveBestDepth(rc, depthSimMap, volBestSim, depthsSV, sgmParams);
+
+    // the pixels seen by both cameras, the second camera image is shifted by focal * baseline / planeDepth pixels
+    const int margin = sgmParams.wsh + 2;
+    const int disparity = int(std::ceil(focal * baseline / planeDepth));
+
+    std::size_t nbPixels = 0;
+    std::size_t nbCorrect = 0;
+    for(int y = margin; y < height - margin; ++y)
+    {
+        for(int x = disparity + margin; x < width - margin; ++x)
+        {
+            ++nbPixels;
+            if(std::abs(depthSimMap._dsm[y * width + x].depth - expectedDepth(x, y)) < 0.05)
+                ++nbCorrect;
+        }
+    }
+
+    BOOST_CHECK_GT(nbPixels, 0);
+    BOOST_CHECK_GE(nbCorrect, 0.95 * nbPixels);
+
+    fs::remove_all(folder);
+}
+
+BOOST_AUTO_TEST_CASE(PlaneSweepingCpu_normalMapFrontoParallel)
+{
+    const fs::path folder = fs::temp_directory_path() / fs::unique_path("depthMap_planeSweepingCpu_%%%%");
+    fs::create_directories(folder);
+
+    sfmData::SfMData sfmData;
+    createTwoViewsScene(folder.string(), sfmData);
+
+    mvsUtils::MultiViewParams mp(sfmData, "", folder.string(), "", false, 1);
+    mvsUtils::ImagesCache<ImageRGBAf> ic(mp, imageIO::EImageColorSpace::LINEAR);
+    PlaneSweepingCpu cps(ic, mp, 1);
+
+    const int rc = mp.getIndexFromViewId(0);
+
+    std::vector<float> depthMap(width * height);
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+            depthMap[y * width + x] = float(expectedDepth(x, y));
+    }
+    // pixel without depth
+    depthMap[(height / 2) * width + width / 2] = -1.f;
+
+    std::vector<ColorRGBf> normalMap;
+    cps.computeNormalMap(depthMap, normalMap, rc, 1, 3);
+
+    BOOST_CHECK_EQUAL(normalMap.size(), depthMap.size());
+
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            const ColorRGBf& n = normalMap[y * width + x];
+            if(depthMap[y * width + x] <= 0.f)
+            {
+                BOOST_CHECK_EQUAL(n.r, -1.f);
+                continue;
+            }
+            // the plane normal, oriented toward the camera
+            BOOST_CHECK_SMALL(n.r, 1e-2f);
+            BOOST_CHECK_SMALL(n.g, 1e-2f);
+            BOOST_CHECK_CLOSE(n.b, -1.f, 1e-1f);
+        }
+    }
+
+    fs::remove_all(folder);
+}
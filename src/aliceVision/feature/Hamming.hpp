@@ -8,6 +8,7 @@
 #pragma once
 
 #include "metric.hpp"
+#include "distanceKernels.hpp"
 
 #include <bitset>
 
@@ -166,6 +167,29 @@ struct Hamming
   }
 };
 
+// Template specialization to run the SIMD Hamming distance
+//  on raw memory of unsigned char
+// Only this specialization uses the SIMD kernels,
+//  the other element types use the scalar popcount above.
+template<>
+struct Hamming<unsigned char>
+{
+  typedef unsigned char ElementType;
+  typedef unsigned int ResultType;
+
+  // Size must be equal to number of bytes
+  template <typename Iterator1, typename Iterator2>
+  inline ResultType operator()(Iterator1 a, Iterator2 b, size_t size) const
+  {
+    return hammingDistance(reinterpret_cast<const unsigned char*>(a), reinterpret_cast<const unsigned char*>(b), size);
+  }
+};
+
+inline void computeDistances(const Hamming<unsigned char>&, const unsigned char* query, const unsigned char* data, size_t nbData, size_t dim, unsigned int* out)
+{
+  hammingDistances(query, data, nbData, dim, out);
+}
+
 
 template<typename T>
 struct SquaredHamming
@@ -194,7 +194,8 @@ void ImageDescriber::Save(const Regions* regions, const std::string& sfileNameFe
   const std::string tmpFeatsPath = (bFeatsPath.parent_path() / bFeatsPath.stem()).string() + "." + fs::unique_path().string() + bFeatsPath.extension().string();
   const std::string tmpDescsPath = (bDescsPath.parent_path() / bDescsPath.stem()).string() + "." + fs::unique_path().string() + bDescsPath.extension().string();
 
-  regions->Save(tmpFeatsPath, tmpDescsPath);
+  regions->SaveFeatures(tmpFeatsPath, EImageDescriberType_enumToString(getDescriberType()));
+  regions->SaveDesc(tmpDescsPath);
 
   // rename temporary filenames
   fs::rename(tmpFeatsPath, sfileNameFeats);
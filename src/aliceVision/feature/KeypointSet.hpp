@@ -57,12 +57,12 @@ public:
   }
 
   /// Export in two separate files the feats and their corresponding descriptors
-  ///  descriptor in binary to save place
+  ///  feats and descriptors in binary to save place (like the Regions)
   void saveToBinFile(
     const std::string& sfileNameFeats,
     const std::string& sfileNameDescs) const
   {
-    saveFeatsToFile(sfileNameFeats, _feats);
+    saveFeatsToBinFile(sfileNameFeats, _feats);
     saveDescsToBinFile(sfileNameDescs, _descs);
   }
 
@@ -8,6 +8,13 @@
 #pragma once
 
 #include "aliceVision/numeric/numeric.hpp"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <iterator>
 #include <fstream>
@@ -94,12 +101,159 @@ inline std::istream& operator>>(std::istream& in, PointFeature& obj)
   return in >> obj._coords(0) >> obj._coords(1) >> obj._scale >> obj._orientation;
 }
 
-/// Read feats from file
+/**
+ * @brief Memory layout of the features stored in a binary .feat file.
+ */
+enum class EFeatBinLayout : std::uint32_t
+{
+  /// 4 float32 per feature: x, y, scale, orientation
+  XY_SCALE_ORIENTATION_F32 = 0
+};
+
+/**
+ * @brief Header of the binary .feat file format.
+ *        The header is followed by \p count features stored contiguously
+ *        according to \p layout, so the file can be memory-mapped and decoded
+ *        without any text parsing.
+ */
+struct FeatBinHeader
+{
+  /// magic number used to distinguish binary files from the legacy ASCII files
+  static constexpr const char* MAGIC = "AVFEATB";
+  static constexpr std::uint32_t CURRENT_VERSION = 1;
+
+  char magic[8];
+  std::uint32_t version;
+  EFeatBinLayout layout;
+  std::uint64_t count;
+  /// name of the image describer type (e.g. "sift"), may be empty
+  char describerType[32];
+  char reserved[8];
+
+  FeatBinHeader()
+    : version(CURRENT_VERSION)
+    , layout(EFeatBinLayout::XY_SCALE_ORIENTATION_F32)
+    , count(0)
+  {
+    std::memset(magic, 0, sizeof(magic));
+    std::memcpy(magic, MAGIC, std::strlen(MAGIC));
+    std::memset(describerType, 0, sizeof(describerType));
+    std::memset(reserved, 0, sizeof(reserved));
+  }
+
+  bool hasValidMagic() const
+  {
+    return std::strncmp(magic, MAGIC, sizeof(magic)) == 0;
+  }
+
+  std::string getDescriberType() const
+  {
+    return std::string(describerType, strnlen(describerType, sizeof(describerType)));
+  }
+
+  void setDescriberType(const std::string& type)
+  {
+    std::memset(describerType, 0, sizeof(describerType));
+    std::memcpy(describerType, type.c_str(), std::min(type.size(), sizeof(describerType) - 1));
+  }
+
+  /// size in bytes of one feature for the given layout
+  static std::size_t featureSize(EFeatBinLayout layout)
+  {
+    switch(layout)
+    {
+      case EFeatBinLayout::XY_SCALE_ORIENTATION_F32: return 4 * sizeof(float);
+    }
+    throw std::runtime_error("Unrecognized binary feature layout: " + std::to_string(static_cast<std::uint32_t>(layout)));
+  }
+};
+
+static_assert(sizeof(FeatBinHeader) == 64, "The binary .feat header must be 64 bytes.");
+
+/**
+ * @brief Check if the given features file uses the binary format (based on the file magic).
+ * @param[in] sfileNameFeats The features file path
+ * @return true if the file exists and starts with the binary .feat magic
+ */
+inline bool isFeatBinFile(const std::string & sfileNameFeats)
+{
+  std::ifstream fileIn(sfileNameFeats, std::ios::in | std::ios::binary);
+  if(!fileIn.is_open())
+    return false;
+
+  FeatBinHeader header;
+  fileIn.read(header.magic, sizeof(header.magic));
+  return fileIn.gcount() == sizeof(header.magic) && header.hasValidMagic();
+}
+
+/**
+ * @brief Read feats from a binary file.
+ *        The file is memory-mapped and the features are decoded directly from the mapped pages.
+ * @param[in] sfileNameFeats The features file path
+ * @param[out] vec_feat The loaded features
+ * @param[out] out_header The header of the file (optional)
+ */
+template<typename FeaturesT >
+inline void loadFeatsFromBinFile(
+  const std::string & sfileNameFeats,
+  FeaturesT & vec_feat,
+  FeatBinHeader* out_header = nullptr)
+{
+  namespace bip = boost::interprocess;
+
+  vec_feat.clear();
+
+  bip::file_mapping mapping;
+  bip::mapped_region region;
+  try
+  {
+    mapping = bip::file_mapping(sfileNameFeats.c_str(), bip::read_only);
+    region = bip::mapped_region(mapping, bip::read_only);
+  }
+  catch(const bip::interprocess_exception& e)
+  {
+    throw std::runtime_error("Can't load features binary file, can't open '" + sfileNameFeats + "' (" + e.what() + ") !");
+  }
+
+  const std::size_t fileSize = region.get_size();
+  if(fileSize < sizeof(FeatBinHeader))
+    throw std::runtime_error("Can't load features binary file, '" + sfileNameFeats + "' is incorrect !");
+
+  FeatBinHeader header;
+  std::memcpy(&header, region.get_address(), sizeof(FeatBinHeader));
+
+  if(!header.hasValidMagic())
+    throw std::runtime_error("Can't load features binary file, '" + sfileNameFeats + "' is not a binary features file !");
+  if(header.version > FeatBinHeader::CURRENT_VERSION)
+    throw std::runtime_error("Can't load features binary file, '" + sfileNameFeats + "' has an unsupported version (" + std::to_string(header.version) + ") !");
+
+  const std::size_t featureSize = FeatBinHeader::featureSize(header.layout);
+  // compare the count to the available size to avoid an overflow of count * featureSize
+  if(header.count > (fileSize - sizeof(FeatBinHeader)) / featureSize)
+    throw std::runtime_error("Can't load features binary file, '" + sfileNameFeats + "' is truncated !");
+
+  const float* data = reinterpret_cast<const float*>(static_cast<const char*>(region.get_address()) + sizeof(FeatBinHeader));
+
+  vec_feat.reserve(header.count);
+  for(std::size_t i = 0; i < header.count; ++i, data += 4)
+    vec_feat.emplace_back(data[0], data[1], data[2], data[3]);
+
+  if(out_header != nullptr)
+    *out_header = header;
+}
+
+/// Read feats from file (binary or ASCII, chosen by the file magic)
 template<typename FeaturesT >
 inline void loadFeatsFromFile(
   const std::string & sfileNameFeats,
   FeaturesT & vec_feat)
 {
+  if(isFeatBinFile(sfileNameFeats))
+  {
+    loadFeatsFromBinFile(sfileNameFeats, vec_feat);
+    return;
+  }
+
   vec_feat.clear();
 
   std::ifstream fileIn(sfileNameFeats);
@@ -135,6 +289,45 @@ inline void saveFeatsToFile(
   file.close();
 }
 
+/**
+ * @brief Write feats to file (in binary mode)
+ * @param[in] sfileNameFeats The features file path
+ * @param[in] vec_feat The features to save
+ * @param[in] describerType The image describer type name stored in the header (optional)
+ */
+template<typename FeaturesT >
+inline void saveFeatsToBinFile(
+  const std::string & sfileNameFeats,
+  const FeaturesT & vec_feat,
+  const std::string & describerType = "")
+{
+  std::ofstream file(sfileNameFeats, std::ios::out | std::ios::binary);
+
+  if(!file.is_open())
+    throw std::runtime_error("Can't save features binary file, can't open '" + sfileNameFeats + "' !");
+
+  FeatBinHeader header;
+  header.count = vec_feat.size();
+  header.setDescriberType(describerType);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(FeatBinHeader));
+
+  std::vector<float> buffer;
+  buffer.reserve(4 * vec_feat.size());
+  for(const auto& feat : vec_feat)
+  {
+    buffer.push_back(feat.x());
+    buffer.push_back(feat.y());
+    buffer.push_back(feat.scale());
+    buffer.push_back(feat.orientation());
+  }
+  file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(float));
+
+  if(!file.good())
+    throw std::runtime_error("Can't save features binary file, '" + sfileNameFeats + "' is incorrect !");
+
+  file.close();
+}
+
 /// Export point feature based vector to a matrix [(x,y)'T, (x,y)'T]
 template< typename FeaturesT, typename MatT >
 void PointsToMat(
@@ -13,10 +13,16 @@
 #include <aliceVision/feature/Descriptor.hpp>
 #include <aliceVision/feature/metric.hpp>
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 #include <string>
 #include <cstddef>
+#include <cstring>
+#include <fstream>
 #include <typeinfo>
 #include <memory>
+#include <stdexcept>
 
 
 namespace aliceVision {
@@ -62,6 +68,11 @@ public:
     loadFeatsFromFile(sfileNameFeats, _vec_feats);
   }
 
+  void SaveFeatures(const std::string& sfileNameFeats, const std::string& describerType = "") const
+  {
+    saveFeatsToBinFile(sfileNameFeats, _vec_feats, describerType);
+  }
+
   PointFeatures GetRegionsPositions() const
   {
     return PointFeatures(_vec_feats.begin(), _vec_feats.end());
@@ -130,6 +141,12 @@ public:
 
   virtual Regions * EmptyClone() const = 0;
 
+  /**
+   * @brief Create an empty Regions container of the same descriptor type
+   *        whose descriptors are a read-only memory mapping of the .desc file.
+   */
+  virtual Regions * EmptyMappedClone() const = 0;
+
   virtual std::unique_ptr<Regions> createFilteredRegions(
                      const std::vector<FeatureInImage>& featuresInImage,
                      std::vector<IndexT>& out_associated3dPoint,
@@ -162,6 +179,9 @@ struct SquaredMetric<T, ERegionType::Binary>
 };
 
 
+template<typename T, std::size_t L, ERegionType regionType>
+class MappedFeatDescRegions;
+
 template<typename T, std::size_t L, ERegionType regionType>
 class FeatDescRegions : public Regions
 {
@@ -187,7 +207,10 @@ public:
     return new This();
   }
 
+  Regions * EmptyMappedClone() const override;
+
   /// Read from files the regions and their corresponding descriptors.
+  /// Binary features files are memory-mapped, legacy ASCII files are still supported.
   void Load(
     const std::string& sfileNameFeats,
     const std::string& sfileNameDescs) override
@@ -201,7 +224,7 @@ public:
     const std::string& sfileNameFeats,
     const std::string& sfileNameDescs) const override
   {
-    saveFeatsToFile(sfileNameFeats, this->_vec_feats);
+    saveFeatsToBinFile(sfileNameFeats, this->_vec_feats);
     saveDescsToBinFile(sfileNameDescs, _vec_descs);
   }
 
@@ -233,9 +256,10 @@ public:
     assert(genericRegions);
     assert(j < genericRegions->RegionCount());
 
-    const This * regionsT = dynamic_cast<const This*>(genericRegions);
+    // works with both in-memory and mapped regions of the same descriptor type
+    const DescriptorT* otherDescs = static_cast<const DescriptorT*>(genericRegions->DescriptorRawData());
     static typename SquaredMetric<T, regionType>::Metric metric;
-    return metric(this->_vec_descs[i].getData(), regionsT->_vec_descs[j].getData(), DescriptorT::static_size);
+    return metric(this->_vec_descs[i].getData(), otherDescs[j].getData(), DescriptorT::static_size);
   }
 
   /**
@@ -289,6 +313,212 @@ public:
 };
 
 
+/**
+ * @brief Regions container whose descriptors are not loaded in memory but
+ *        accessed through a read-only memory mapping of the .desc file.
+ *        Pages are loaded lazily by the OS on first access and can be shared
+ *        by several processes reading the same files on one node.
+ *        Features are still loaded in memory.
+ *
+ * @note: Descriptors are not stored as an std::vector<DescType>,
+ *        so blindDescriptors() is not available. Use DescriptorRawData() instead.
+ */
+template<typename T, std::size_t L, ERegionType regionType>
+class MappedFeatDescRegions : public Regions
+{
+public:
+  typedef MappedFeatDescRegions<T, L, regionType> This;
+  /// In-memory regions with the same descriptor type
+  typedef FeatDescRegions<T, L, regionType> InMemoryRegionsT;
+  /// Region descriptor
+  typedef Descriptor<T, L> DescriptorT;
+
+  static_assert(sizeof(DescriptorT) == L * sizeof(T), "Descriptor must be layout compatible with the .desc file.");
+
+protected:
+  boost::interprocess::file_mapping _descsMapping;
+  boost::interprocess::mapped_region _descsRegion;
+  const DescriptorT* _descs = nullptr;  // region descriptions (mapped memory)
+  std::size_t _nbDescs = 0;
+
+public:
+  std::string Type_id() const override {return typeid(T).name();}
+  std::size_t DescriptorLength() const override {return static_cast<std::size_t>(L);}
+
+  bool IsScalar() const override { return regionType == ERegionType::Scalar; }
+  bool IsBinary() const override { return regionType == ERegionType::Binary; }
+
+  /// Mapped regions cannot be appended, so the clone is an in-memory container.
+  Regions * EmptyClone() const override
+  {
+    return new InMemoryRegionsT();
+  }
+
+  Regions * EmptyMappedClone() const override
+  {
+    return new This();
+  }
+
+  /// Read the features from file and map the corresponding descriptors file.
+  void Load(
+    const std::string& sfileNameFeats,
+    const std::string& sfileNameDescs) override
+  {
+    loadFeatsFromFile(sfileNameFeats, this->_vec_feats);
+    mapDescriptors(sfileNameDescs);
+  }
+
+  /// Export in two separate files the regions and their corresponding descriptors.
+  void Save(
+    const std::string& sfileNameFeats,
+    const std::string& sfileNameDescs) const override
+  {
+    saveFeatsToBinFile(sfileNameFeats, this->_vec_feats);
+    SaveDesc(sfileNameDescs);
+  }
+
+  void SaveDesc(const std::string& sfileNameDescs) const override
+  {
+    std::ofstream file(sfileNameDescs, std::ios::out | std::ios::binary);
+
+    if(!file.is_open())
+      throw std::runtime_error("Can't save descriptor binary file, can't open '" + sfileNameDescs + "' !");
+
+    file.write(reinterpret_cast<const char*>(&_nbDescs), sizeof(std::size_t));
+    file.write(reinterpret_cast<const char*>(_descs), _nbDescs * sizeof(DescriptorT));
+
+    if(!file.good())
+      throw std::runtime_error("Can't save descriptor binary file, '" + sfileNameDescs + "' is incorrect !");
+  }
+
+  /// Return the number of mapped descriptors
+  inline std::size_t DescriptorCount() const { return _nbDescs; }
+
+  /// Non-mutable DescriptorT getter.
+  inline const DescriptorT& DescriptorAt(std::size_t i) const
+  {
+    assert(i < _nbDescs);
+    return _descs[i];
+  }
+
+  const void* blindDescriptors() const override
+  {
+    throw std::logic_error("Memory-mapped regions do not store descriptors as an std::vector.");
+  }
+
+  inline const void* DescriptorRawData() const override { return _descs; }
+
+  /// Release the mapping, the OS can then drop the corresponding pages.
+  inline void clearDescriptors() override
+  {
+    _descsRegion = boost::interprocess::mapped_region();
+    _descsMapping = boost::interprocess::file_mapping();
+    _descs = nullptr;
+    _nbDescs = 0;
+  }
+
+  // Return the distance between two descriptors
+  double SquaredDescriptorDistance(std::size_t i, const Regions * genericRegions, std::size_t j) const override
+  {
+    assert(i < _nbDescs);
+    assert(genericRegions);
+    assert(j < genericRegions->RegionCount());
+
+    // works with both in-memory and mapped regions of the same descriptor type
+    const DescriptorT* otherDescs = static_cast<const DescriptorT*>(genericRegions->DescriptorRawData());
+    static typename SquaredMetric<T, regionType>::Metric metric;
+    return metric(_descs[i].getData(), otherDescs[j].getData(), DescriptorT::static_size);
+  }
+
+  /**
+   * @brief Add the Inth region to another Region container
+   * @param[in] i: index of the region to copy
+   * @param[out] outRegionContainer: the output region group to add the region (must be an in-memory container)
+   */
+  void CopyRegion(std::size_t i, Regions * outRegionContainer) const override
+  {
+    assert(i < this->_vec_feats.size() && i < _nbDescs);
+    InMemoryRegionsT* outRegions = dynamic_cast<InMemoryRegionsT*>(outRegionContainer);
+    if(outRegions == nullptr)
+      throw std::logic_error("Cannot copy a region into a memory-mapped regions container.");
+    outRegions->Features().push_back(this->_vec_feats[i]);
+    outRegions->Descriptors().push_back(_descs[i]);
+  }
+
+  /**
+   * @brief Duplicate only reconstructed regions in an in-memory container.
+   * @param[in] featuresInImage list of features with an associated 3D point Id
+   * @param[out] out_associated3dPoint
+   * @param[out] out_mapFullToLocal
+   */
+  std::unique_ptr<Regions> createFilteredRegions(
+                     const std::vector<FeatureInImage>& featuresInImage,
+                     std::vector<IndexT>& out_associated3dPoint,
+                     std::map<IndexT, IndexT>& out_mapFullToLocal) const override
+  {
+    out_associated3dPoint.clear();
+    out_mapFullToLocal.clear();
+
+    InMemoryRegionsT* regionsPtr = new InMemoryRegionsT;
+    std::unique_ptr<Regions> regions(regionsPtr);
+    regionsPtr->Features().reserve(featuresInImage.size());
+    regionsPtr->Descriptors().reserve(featuresInImage.size());
+    out_associated3dPoint.reserve(featuresInImage.size());
+    for(std::size_t i = 0; i < featuresInImage.size(); ++i)
+    {
+      const FeatureInImage & feat = featuresInImage[i];
+      regionsPtr->Features().push_back(this->_vec_feats[feat._featureIndex]);
+      regionsPtr->Descriptors().push_back(_descs[feat._featureIndex]);
+      out_mapFullToLocal[feat._featureIndex] = i;
+      out_associated3dPoint.push_back(feat._point3dId);
+    }
+    return regions;
+  }
+
+private:
+
+  /**
+   * @brief Map a binary descriptors file (.desc).
+   *        The file must contain descriptors of type DescriptorT (no conversion).
+   * @param[in] sfileNameDescs The descriptors file path
+   */
+  void mapDescriptors(const std::string& sfileNameDescs)
+  {
+    namespace bip = boost::interprocess;
+
+    clearDescriptors();
+
+    try
+    {
+      _descsMapping = bip::file_mapping(sfileNameDescs.c_str(), bip::read_only);
+      _descsRegion = bip::mapped_region(_descsMapping, bip::read_only);
+    }
+    catch(const bip::interprocess_exception& e)
+    {
+      throw std::runtime_error("Can't map descriptor binary file, can't open '" + sfileNameDescs + "' (" + e.what() + ") !");
+    }
+
+    const std::size_t fileSize = _descsRegion.get_size();
+    if(fileSize < sizeof(std::size_t))
+      throw std::runtime_error("Can't map descriptor binary file, '" + sfileNameDescs + "' is incorrect !");
+
+    std::size_t cardDesc = 0;
+    std::memcpy(&cardDesc, _descsRegion.get_address(), sizeof(std::size_t));
+
+    if(fileSize != sizeof(std::size_t) + cardDesc * sizeof(DescriptorT))
+      throw std::runtime_error("Can't map descriptor binary file, '" + sfileNameDescs + "' does not match the descriptor type !");
+
+    _descs = reinterpret_cast<const DescriptorT*>(static_cast<const char*>(_descsRegion.get_address()) + sizeof(std::size_t));
+    _nbDescs = cardDesc;
+  }
+};
+
+template<typename T, std::size_t L, ERegionType regionType>
+Regions * FeatDescRegions<T, L, regionType>::EmptyMappedClone() const
+{
+  return new MappedFeatDescRegions<T, L, regionType>();
+}
+
 template<typename T, std::size_t L>
 using ScalarRegions = FeatDescRegions<T, L, ERegionType::Scalar>;
 
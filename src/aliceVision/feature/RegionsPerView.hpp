@@ -112,6 +112,11 @@ public:
     _data[viewId][descType].reset(regionsPtr);
   }
 
+  void removeRegions(IndexT viewId)
+  {
+    _data.erase(viewId);
+  }
+
   std::vector<feature::EImageDescriberType> getCommonDescTypes(const Pair& pair) const
   {
     const auto& regionsA = getAllRegions(pair.first);
@@ -0,0 +1,1068 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "distanceKernels.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ALICEVISION_DISTANCE_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC does not need a target attribute to use the intrinsics
+#define ALICEVISION_DISTANCE_TARGET(isa)
+#else
+// the kernels are compiled for their own instruction set, independently of the compilation flags
+#define ALICEVISION_DISTANCE_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+// NEON is part of the armv8 base instruction set
+#define ALICEVISION_DISTANCE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace aliceVision {
+namespace feature {
+
+std::string ESimdLevel_enumToString(ESimdLevel level)
+{
+  switch(level)
+  {
+    case ESimdLevel::SCALAR: return "scalar";
+    case ESimdLevel::SSE2:   return "sse2";
+    case ESimdLevel::AVX2:   return "avx2";
+    case ESimdLevel::AVX512: return "avx512";
+    case ESimdLevel::NEON:   return "neon";
+  }
+  throw std::out_of_range("Invalid SIMD level enum");
+}
+
+namespace {
+
+inline unsigned int popcount64(std::uint64_t n)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcountll(n);
+#else
+  n -= ((n >> 1) & 0x5555555555555555ULL);
+  n = (n & 0x3333333333333333ULL) + ((n >> 2) & 0x3333333333333333ULL);
+  return unsigned(((n + (n >> 4)) & 0x0f0f0f0f0f0f0f0fULL) * 0x0101010101010101ULL >> 56);
+#endif
+}
+
+// Scalar kernels, also used for the remaining elements of the SIMD kernels
+
+inline float l2FloatTail(const float* a, const float* b, std::size_t begin, std::size_t size)
+{
+  float result = 0.f;
+  for(std::size_t i = begin; i < size; ++i)
+  {
+    const float diff = a[i] - b[i];
+    result += diff * diff;
+  }
+  return result;
+}
+
+inline unsigned int l2UCharTail(const unsigned char* a, const unsigned char* b, std::size_t begin, std::size_t size)
+{
+  unsigned int result = 0;
+  for(std::size_t i = begin; i < size; ++i)
+  {
+    const int diff = int(a[i]) - int(b[i]);
+    result += unsigned(diff * diff);
+  }
+  return result;
+}
+
+inline float l2UCharFloatTail(const unsigned char* a, const float* b, std::size_t begin, std::size_t size)
+{
+  float result = 0.f;
+  for(std::size_t i = begin; i < size; ++i)
+  {
+    const float diff = float(a[i]) - b[i];
+    result += diff * diff;
+  }
+  return result;
+}
+
+inline unsigned int hammingTail(const unsigned char* a, const unsigned char* b, std::size_t begin, std::size_t size)
+{
+  unsigned int result = 0;
+  std::size_t i = begin;
+  for(; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t))
+  {
+    std::uint64_t va;
+    std::uint64_t vb;
+    std::memcpy(&va, a + i, sizeof(std::uint64_t));
+    std::memcpy(&vb, b + i, sizeof(std::uint64_t));
+    result += popcount64(va ^ vb);
+  }
+  for(; i < size; ++i)
+    result += popcount64(a[i] ^ b[i]);
+  return result;
+}
+
+float l2FloatScalar(const float* a, const float* b, std::size_t size)
+{
+  return l2FloatTail(a, b, 0, size);
+}
+
+float l2UCharScalar(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  return float(l2UCharTail(a, b, 0, size));
+}
+
+float l2UCharFloatScalar(const unsigned char* a, const float* b, std::size_t size)
+{
+  return l2UCharFloatTail(a, b, 0, size);
+}
+
+unsigned int hammingScalar(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  return hammingTail(a, b, 0, size);
+}
+
+// The dot product kernels compute the products of 4 queries with an even number of data rows (out[q * nbData + d]),
+// by 4x2 tiles so each loaded element is used for several products.
+// The rows are stored contiguously and padded with zeros to a multiple of 64 bytes, so there are no remaining elements.
+
+void dotInt16Scalar(const std::int16_t* queries, const std::int16_t* data, std::size_t nbData, std::size_t dim, std::int32_t* out)
+{
+  for(std::size_t q = 0; q < 4; ++q)
+  {
+    for(std::size_t d = 0; d < nbData; ++d)
+    {
+      std::int32_t result = 0;
+      for(std::size_t i = 0; i < dim; ++i)
+        result += std::int32_t(queries[q * dim + i]) * std::int32_t(data[d * dim + i]);
+      out[q * nbData + d] = result;
+    }
+  }
+}
+
+void dotFloatScalar(const float* queries, const float* data, std::size_t nbData, std::size_t dim, float* out)
+{
+  for(std::size_t q = 0; q < 4; ++q)
+  {
+    for(std::size_t d = 0; d < nbData; ++d)
+    {
+      float result = 0.f;
+      for(std::size_t i = 0; i < dim; ++i)
+        result += queries[q * dim + i] * data[d * dim + i];
+      out[q * nbData + d] = result;
+    }
+  }
+}
+
+#if defined(ALICEVISION_DISTANCE_X86)
+
+// SSE2 kernels
+
+ALICEVISION_DISTANCE_TARGET("sse2")
+inline float hsumSSE2(__m128 v)
+{
+  alignas(16) float values[4];
+  _mm_store_ps(values, v);
+  return (values[0] + values[1]) + (values[2] + values[3]);
+}
+
+ALICEVISION_DISTANCE_TARGET("sse2")
+inline unsigned int hsumSSE2(__m128i v)
+{
+  alignas(16) std::uint32_t values[4];
+  _mm_store_si128(reinterpret_cast<__m128i*>(values), v);
+  return values[0] + values[1] + values[2] + values[3];
+}
+
+// horizontal sums of 4 registers at once, by transposition
+ALICEVISION_DISTANCE_TARGET("sse2")
+inline __m128i hsum4SSE2(__m128i a, __m128i b, __m128i c, __m128i d)
+{
+  const __m128i ab = _mm_add_epi32(_mm_unpacklo_epi32(a, b), _mm_unpackhi_epi32(a, b));
+  const __m128i cd = _mm_add_epi32(_mm_unpacklo_epi32(c, d), _mm_unpackhi_epi32(c, d));
+  return _mm_add_epi32(_mm_unpacklo_epi64(ab, cd), _mm_unpackhi_epi64(ab, cd));
+}
+
+ALICEVISION_DISTANCE_TARGET("sse2")
+inline __m128 hsum4SSE2(__m128 a, __m128 b, __m128 c, __m128 d)
+{
+  const __m128 ab = _mm_add_ps(_mm_unpacklo_ps(a, b), _mm_unpackhi_ps(a, b));
+  const __m128 cd = _mm_add_ps(_mm_unpacklo_ps(c, d), _mm_unpackhi_ps(c, d));
+  return _mm_add_ps(_mm_movelh_ps(ab, cd), _mm_movehl_ps(cd, ab));
+}
+
+// store the sums of the 8 accumulators of the dot product kernels
+ALICEVISION_DISTANCE_TARGET("sse2")
+inline void storeSums8SSE2(const __m128i* sum, std::int32_t* out, std::size_t outStride)
+{
+  // the accumulators are ordered by query, then by data row
+  const __m128i sum01 = hsum4SSE2(sum[0], sum[1], sum[2], sum[3]);
+  const __m128i sum23 = hsum4SSE2(sum[4], sum[5], sum[6], sum[7]);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(out), sum01);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(out + outStride), _mm_unpackhi_epi64(sum01, sum01));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 2 * outStride), sum23);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 3 * outStride), _mm_unpackhi_epi64(sum23, sum23));
+}
+
+ALICEVISION_DISTANCE_TARGET("sse2")
+inline void storeSums8SSE2(const __m128* sum, float* out, std::size_t outStride)
+{
+  const __m128 sum01 = hsum4SSE2(sum[0], sum[1], sum[2], sum[3]);
+  const __m128 sum23 = hsum4SSE2(sum[4], sum[5], sum[6], sum[7]);
+  _mm_storel_pi(reinterpret_cast<__m64*>(out), sum01);
+  _mm_storeh_pi(reinterpret_cast<__m64*>(out + outStride), sum01);
+  _mm_storel_pi(reinterpret_cast<__m64*>(out + 2 * outStride), sum23);
+  _mm_storeh_pi(reinterpret_cast<__m64*>(out + 3 * outStride), sum23);
+}
+
+ALICEVISION_DISTANCE_TARGET("sse2")
+float l2FloatSSE2(const float* a, const float* b, std::size_t size)
+{
+  __m128 sum = _mm_setzero_ps();
+  std::size_t i = 0;
+  for(; i + 4 <= size; i += 4)
+  {
+    const __m128 diff = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+    sum = _mm_add_ps(sum, _mm_mul_ps(diff, diff));
+  }
+  return hsumSSE2(sum) + l2FloatTail(a, b, i, size);
+}
+
+ALICEVISION_DISTANCE_TARGET("sse2")
+float l2UCharSSE2(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128i sum = _mm_setzero_si128();
+  std::size_t i = 0;
+  for(; i + 16 <= size; i += 16)
+  {
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    // differences on 16 bits, squared and summed by pairs on 32 bits
+    const __m128i diffLow = _mm_sub_epi16(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero));
+    const __m128i diffHigh = _mm_sub_epi16(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero));
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(diffLow, diffLow));
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(diffHigh, diffHigh));
+  }
+  return float(hsumSSE2(sum) + l2UCharTail(a, b, i, size));
+}
+
+ALICEVISION_DISTANCE_TARGET("sse2")
+float l2UCharFloatSSE2(const unsigned char* a, const float* b, std::size_t size)
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128 sum = _mm_setzero_ps();
+  std::size_t i = 0;
+  for(; i + 8 <= size; i += 8)
+  {
+    const __m128i va = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(a + i)), zero);
+    const __m128 diffLow = _mm_sub_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(va, zero)), _mm_loadu_ps(b + i));
+    const __m128 diffHigh = _mm_sub_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(va, zero)), _mm_loadu_ps(b + i + 4));
+    sum = _mm_add_ps(sum, _mm_mul_ps(diffLow, diffLow));
+    sum = _mm_add_ps(sum, _mm_mul_ps(diffHigh, diffHigh));
+  }
+  return hsumSSE2(sum) + l2UCharFloatTail(a, b, i, size);
+}
+
+ALICEVISION_DISTANCE_TARGET("sse2")
+unsigned int hammingSSE2(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  // no byte shuffle in SSE2, the bytes population counts are computed with bit masks
+  const __m128i mask1 = _mm_set1_epi8(0x55);
+  const __m128i mask2 = _mm_set1_epi8(0x33);
+  const __m128i mask4 = _mm_set1_epi8(0x0f);
+  const __m128i zero = _mm_setzero_si128();
+  __m128i sum = _mm_setzero_si128();
+  std::size_t i = 0;
+  for(; i + 16 <= size; i += 16)
+  {
+    __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                              _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+    v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi64(v, 1), mask1));
+    v = _mm_add_epi8(_mm_and_si128(v, mask2), _mm_and_si128(_mm_srli_epi64(v, 2), mask2));
+    v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi64(v, 4)), mask4);
+    // sum the bytes counts on 64 bits
+    sum = _mm_add_epi64(sum, _mm_sad_epu8(v, zero));
+  }
+  alignas(16) std::uint64_t values[2];
+  _mm_store_si128(reinterpret_cast<__m128i*>(values), sum);
+  return unsigned(values[0] + values[1]) + hammingTail(a, b, i, size);
+}
+
+ALICEVISION_DISTANCE_TARGET("sse2")
+void dotInt16SSE2(const std::int16_t* queries, const std::int16_t* data, std::size_t nbData, std::size_t dim, std::int32_t* out)
+{
+  for(std::size_t d = 0; d < nbData; d += 2)
+  {
+    const std::int16_t* data0 = data + d * dim;
+    const std::int16_t* data1 = data0 + dim;
+    __m128i sum[8];
+    for(int k = 0; k < 8; ++k)
+      sum[k] = _mm_setzero_si128();
+    for(std::size_t i = 0; i < dim; i += 8)
+    {
+      const __m128i d0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data0 + i));
+      const __m128i d1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data1 + i));
+      for(std::size_t q = 0; q < 4; ++q)
+      {
+        const __m128i vq = _mm_loadu_si128(reinterpret_cast<const __m128i*>(queries + q * dim + i));
+        sum[q * 2] = _mm_add_epi32(sum[q * 2], _mm_madd_epi16(vq, d0));
+        sum[q * 2 + 1] = _mm_add_epi32(sum[q * 2 + 1], _mm_madd_epi16(vq, d1));
+      }
+    }
+    storeSums8SSE2(sum, out + d, nbData);
+  }
+}
+
+ALICEVISION_DISTANCE_TARGET("sse2")
+void dotFloatSSE2(const float* queries, const float* data, std::size_t nbData, std::size_t dim, float* out)
+{
+  for(std::size_t d = 0; d < nbData; d += 2)
+  {
+    const float* data0 = data + d * dim;
+    const float* data1 = data0 + dim;
+    __m128 sum[8];
+    for(int k = 0; k < 8; ++k)
+      sum[k] = _mm_setzero_ps();
+    for(std::size_t i = 0; i < dim; i += 4)
+    {
+      const __m128 d0 = _mm_loadu_ps(data0 + i);
+      const __m128 d1 = _mm_loadu_ps(data1 + i);
+      for(std::size_t q = 0; q < 4; ++q)
+      {
+        const __m128 vq = _mm_loadu_ps(queries + q * dim + i);
+        sum[q * 2] = _mm_add_ps(sum[q * 2], _mm_mul_ps(vq, d0));
+        sum[q * 2 + 1] = _mm_add_ps(sum[q * 2 + 1], _mm_mul_ps(vq, d1));
+      }
+    }
+    storeSums8SSE2(sum, out + d, nbData);
+  }
+}
+
+// AVX2 kernels
+
+ALICEVISION_DISTANCE_TARGET("avx2")
+inline float hsumAVX2(__m256 v)
+{
+  return hsumSSE2(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+ALICEVISION_DISTANCE_TARGET("avx2,popcnt")
+float l2FloatAVX2(const float* a, const float* b, std::size_t size)
+{
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+  std::size_t i = 0;
+  for(; i + 16 <= size; i += 16)
+  {
+    const __m256 diff0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    const __m256 diff1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+    sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(diff0, diff0));
+    sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(diff1, diff1));
+  }
+  for(; i + 8 <= size; i += 8)
+  {
+    const __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(diff, diff));
+  }
+  return hsumAVX2(_mm256_add_ps(sum0, sum1)) + l2FloatTail(a, b, i, size);
+}
+
+ALICEVISION_DISTANCE_TARGET("avx2,popcnt")
+float l2UCharAVX2(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  __m256i sum = _mm256_setzero_si256();
+  std::size_t i = 0;
+  for(; i + 16 <= size; i += 16)
+  {
+    const __m256i va = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+    const __m256i vb = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+    const __m256i diff = _mm256_sub_epi16(va, vb);
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(diff, diff));
+  }
+  const __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+  return float(hsumSSE2(sum128) + l2UCharTail(a, b, i, size));
+}
+
+ALICEVISION_DISTANCE_TARGET("avx2,popcnt")
+float l2UCharFloatAVX2(const unsigned char* a, const float* b, std::size_t size)
+{
+  __m256 sum = _mm256_setzero_ps();
+  std::size_t i = 0;
+  for(; i + 8 <= size; i += 8)
+  {
+    const __m256 va = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(a + i))));
+    const __m256 diff = _mm256_sub_ps(va, _mm256_loadu_ps(b + i));
+    sum = _mm256_add_ps(sum, _mm256_mul_ps(diff, diff));
+  }
+  return hsumAVX2(sum) + l2UCharFloatTail(a, b, i, size);
+}
+
+ALICEVISION_DISTANCE_TARGET("avx2,popcnt")
+unsigned int hammingAVX2(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  // population count of each 4 bits with a lookup table in a register
+  const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                          0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i lowMask = _mm256_set1_epi8(0x0f);
+  __m256i sum = _mm256_setzero_si256();
+  std::size_t i = 0;
+  for(; i + 32 <= size; i += 32)
+  {
+    const __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+                                       _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+    const __m256i countLow = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, lowMask));
+    const __m256i countHigh = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask));
+    // sum the bytes counts on 64 bits
+    sum = _mm256_add_epi64(sum, _mm256_sad_epu8(_mm256_add_epi8(countLow, countHigh), _mm256_setzero_si256()));
+  }
+  alignas(32) std::uint64_t values[4];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(values), sum);
+  return unsigned(values[0] + values[1] + values[2] + values[3]) + hammingTail(a, b, i, size);
+}
+
+ALICEVISION_DISTANCE_TARGET("avx2,popcnt")
+inline __m128i reduceTo128AVX2(__m256i v)
+{
+  return _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+}
+
+ALICEVISION_DISTANCE_TARGET("avx2,popcnt")
+inline __m128 reduceTo128AVX2(__m256 v)
+{
+  return _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+}
+
+ALICEVISION_DISTANCE_TARGET("avx2,popcnt")
+void dotInt16AVX2(const std::int16_t* queries, const std::int16_t* data, std::size_t nbData, std::size_t dim, std::int32_t* out)
+{
+  for(std::size_t d = 0; d < nbData; d += 2)
+  {
+    const std::int16_t* data0 = data + d * dim;
+    const std::int16_t* data1 = data0 + dim;
+    __m256i sum[8];
+    for(int k = 0; k < 8; ++k)
+      sum[k] = _mm256_setzero_si256();
+    for(std::size_t i = 0; i < dim; i += 16)
+    {
+      const __m256i d0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data0 + i));
+      const __m256i d1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data1 + i));
+      for(std::size_t q = 0; q < 4; ++q)
+      {
+        const __m256i vq = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(queries + q * dim + i));
+        sum[q * 2] = _mm256_add_epi32(sum[q * 2], _mm256_madd_epi16(vq, d0));
+        sum[q * 2 + 1] = _mm256_add_epi32(sum[q * 2 + 1], _mm256_madd_epi16(vq, d1));
+      }
+    }
+    __m128i sum128[8];
+    for(int k = 0; k < 8; ++k)
+      sum128[k] = reduceTo128AVX2(sum[k]);
+    storeSums8SSE2(sum128, out + d, nbData);
+  }
+}
+
+ALICEVISION_DISTANCE_TARGET("avx2,popcnt")
+void dotFloatAVX2(const float* queries, const float* data, std::size_t nbData, std::size_t dim, float* out)
+{
+  for(std::size_t d = 0; d < nbData; d += 2)
+  {
+    const float* data0 = data + d * dim;
+    const float* data1 = data0 + dim;
+    __m256 sum[8];
+    for(int k = 0; k < 8; ++k)
+      sum[k] = _mm256_setzero_ps();
+    for(std::size_t i = 0; i < dim; i += 8)
+    {
+      const __m256 d0 = _mm256_loadu_ps(data0 + i);
+      const __m256 d1 = _mm256_loadu_ps(data1 + i);
+      for(std::size_t q = 0; q < 4; ++q)
+      {
+        const __m256 vq = _mm256_loadu_ps(queries + q * dim + i);
+        sum[q * 2] = _mm256_add_ps(sum[q * 2], _mm256_mul_ps(vq, d0));
+        sum[q * 2 + 1] = _mm256_add_ps(sum[q * 2 + 1], _mm256_mul_ps(vq, d1));
+      }
+    }
+    __m128 sum128[8];
+    for(int k = 0; k < 8; ++k)
+      sum128[k] = reduceTo128AVX2(sum[k]);
+    storeSums8SSE2(sum128, out + d, nbData);
+  }
+}
+
+// AVX-512 kernels
+// The widening conversions are used with an explicit zero source: the implicit one is an undefined register,
+// reported as maybe uninitialized by GCC.
+
+ALICEVISION_DISTANCE_TARGET("avx512f,avx512bw,popcnt")
+inline __m512i cvtepu8Epi16AVX512(__m256i v)
+{
+  return _mm512_maskz_cvtepu8_epi16(~__mmask32(0), v);
+}
+
+ALICEVISION_DISTANCE_TARGET("avx512f,avx512bw,popcnt")
+inline __m512 cvtepu8PsAVX512(__m128i v)
+{
+  return _mm512_maskz_cvtepi32_ps(~__mmask16(0), _mm512_maskz_cvtepu8_epi32(~__mmask16(0), v));
+}
+
+ALICEVISION_DISTANCE_TARGET("avx512f,avx512bw,popcnt")
+inline __mmask64 tailMask64(std::size_t n)
+{
+  return (n >= 64) ? ~__mmask64(0) : ((__mmask64(1) << n) - 1);
+}
+
+ALICEVISION_DISTANCE_TARGET("avx512f,avx512bw,popcnt")
+inline float hsumAVX512(__m512 v)
+{
+  alignas(64) float values[16];
+  _mm512_store_ps(values, v);
+  float result = 0.f;
+  for(int i = 0; i < 16; ++i)
+    result += values[i];
+  return result;
+}
+
+ALICEVISION_DISTANCE_TARGET("avx512f,avx512bw,popcnt")
+inline unsigned int hsumAVX512(__m512i v)
+{
+  alignas(64) std::uint32_t values[16];
+  _mm512_store_si512(reinterpret_cast<__m512i*>(values), v);
+  unsigned int result = 0;
+  for(int i = 0; i < 16; ++i)
+    result += values[i];
+  return result;
+}
+
+ALICEVISION_DISTANCE_TARGET("avx512f,avx512bw,popcnt")
+float l2FloatAVX512(const float* a, const float* b, std::size_t size)
+{
+  __m512 sum = _mm512_setzero_ps();
+  std::size_t i = 0;
+  for(; i + 16 <= size; i += 16)
+  {
+    const __m512 diff = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+    sum = _mm512_add_ps(sum, _mm512_mul_ps(diff, diff));
+  }
+  if(i < size)
+  {
+    const __mmask16 mask = __mmask16(tailMask64(size - i));
+    const __m512 diff = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i));
+    sum = _mm512_add_ps(sum, _mm512_mul_ps(diff, diff));
+  }
+  return hsumAVX512(sum);
+}
+
+ALICEVISION_DISTANCE_TARGET("avx512f,avx512bw,popcnt")
+float l2UCharAVX512(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  __m512i sum = _mm512_setzero_si512();
+  std::size_t i = 0;
+  for(; i + 32 <= size; i += 32)
+  {
+    const __m512i va = cvtepu8Epi16AVX512(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+    const __m512i vb = cvtepu8Epi16AVX512(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+    const __m512i diff = _mm512_sub_epi16(va, vb);
+    sum = _mm512_add_epi32(sum, _mm512_madd_epi16(diff, diff));
+  }
+  return float(hsumAVX512(sum) + l2UCharTail(a, b, i, size));
+}
+
+ALICEVISION_DISTANCE_TARGET("avx512f,avx512bw,popcnt")
+float l2UCharFloatAVX512(const unsigned char* a, const float* b, std::size_t size)
+{
+  __m512 sum = _mm512_setzero_ps();
+  std::size_t i = 0;
+  for(; i + 16 <= size; i += 16)
+  {
+    const __m512 va = cvtepu8PsAVX512(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+    const __m512 diff = _mm512_sub_ps(va, _mm512_loadu_ps(b + i));
+    sum = _mm512_add_ps(sum, _mm512_mul_ps(diff, diff));
+  }
+  return hsumAVX512(sum) + l2UCharFloatTail(a, b, i, size);
+}
+
+ALICEVISION_DISTANCE_TARGET("avx512f,avx512bw,popcnt")
+unsigned int hammingAVX512(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  // same lookup table than hammingAVX2, in each 128 bits lane
+  const __m512i lookup = _mm512_set4_epi32(0x04030302, 0x03020201, 0x03020201, 0x02010100);
+  const __m512i lowMask = _mm512_set1_epi8(0x0f);
+  __m512i sum = _mm512_setzero_si512();
+  for(std::size_t i = 0; i < size; i += 64)
+  {
+    const __mmask64 mask = tailMask64(size - i);
+    const __m512i v = _mm512_xor_si512(_mm512_maskz_loadu_epi8(mask, a + i), _mm512_maskz_loadu_epi8(mask, b + i));
+    const __m512i countLow = _mm512_shuffle_epi8(lookup, _mm512_and_si512(v, lowMask));
+    const __m512i countHigh = _mm512_shuffle_epi8(lookup, _mm512_and_si512(_mm512_srli_epi16(v, 4), lowMask));
+    sum = _mm512_add_epi64(sum, _mm512_sad_epu8(_mm512_add_epi8(countLow, countHigh), _mm512_setzero_si512()));
+  }
+  alignas(64) std::uint64_t values[8];
+  _mm512_store_si512(reinterpret_cast<__m512i*>(values), sum);
+  std::uint64_t result = 0;
+  for(int i = 0; i < 8; ++i)
+    result += values[i];
+  return unsigned(result);
+}
+
+ALICEVISION_DISTANCE_TARGET("avx512f,avx512bw,popcnt")
+inline __m128i reduceTo128AVX512(__m512i v)
+{
+  const __m256i low = _mm512_maskz_extracti64x4_epi64(~__mmask8(0), v, 0);
+  const __m256i high = _mm512_maskz_extracti64x4_epi64(~__mmask8(0), v, 1);
+  return reduceTo128AVX2(_mm256_add_epi32(low, high));
+}
+
+ALICEVISION_DISTANCE_TARGET("avx512f,avx512bw,popcnt")
+inline __m128 reduceTo128AVX512(__m512 v)
+{
+  const __m256 low = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(~__mmask8(0), _mm512_castps_pd(v), 0));
+  const __m256 high = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(~__mmask8(0), _mm512_castps_pd(v), 1));
+  return reduceTo128AVX2(_mm256_add_ps(low, high));
+}
+
+ALICEVISION_DISTANCE_TARGET("avx512f,avx512bw,popcnt")
+void dotInt16AVX512(const std::int16_t* queries, const std::int16_t* data, std::size_t nbData, std::size_t dim, std::int32_t* out)
+{
+  for(std::size_t d = 0; d < nbData; d += 2)
+  {
+    const std::int16_t* data0 = data + d * dim;
+    const std::int16_t* data1 = data0 + dim;
+    __m512i sum[8];
+    for(int k = 0; k < 8; ++k)
+      sum[k] = _mm512_setzero_si512();
+    for(std::size_t i = 0; i < dim; i += 32)
+    {
+      const __m512i d0 = _mm512_loadu_si512(data0 + i);
+      const __m512i d1 = _mm512_loadu_si512(data1 + i);
+      for(std::size_t q = 0; q < 4; ++q)
+      {
+        const __m512i vq = _mm512_loadu_si512(queries + q * dim + i);
+        sum[q * 2] = _mm512_add_epi32(sum[q * 2], _mm512_madd_epi16(vq, d0));
+        sum[q * 2 + 1] = _mm512_add_epi32(sum[q * 2 + 1], _mm512_madd_epi16(vq, d1));
+      }
+    }
+    __m128i sum128[8];
+    for(int k = 0; k < 8; ++k)
+      sum128[k] = reduceTo128AVX512(sum[k]);
+    storeSums8SSE2(sum128, out + d, nbData);
+  }
+}
+
+ALICEVISION_DISTANCE_TARGET("avx512f,avx512bw,popcnt")
+void dotFloatAVX512(const float* queries, const float* data, std::size_t nbData, std::size_t dim, float* out)
+{
+  for(std::size_t d = 0; d < nbData; d += 2)
+  {
+    const float* data0 = data + d * dim;
+    const float* data1 = data0 + dim;
+    __m512 sum[8];
+    for(int k = 0; k < 8; ++k)
+      sum[k] = _mm512_setzero_ps();
+    for(std::size_t i = 0; i < dim; i += 16)
+    {
+      const __m512 d0 = _mm512_loadu_ps(data0 + i);
+      const __m512 d1 = _mm512_loadu_ps(data1 + i);
+      for(std::size_t q = 0; q < 4; ++q)
+      {
+        const __m512 vq = _mm512_loadu_ps(queries + q * dim + i);
+        sum[q * 2] = _mm512_add_ps(sum[q * 2], _mm512_mul_ps(vq, d0));
+        sum[q * 2 + 1] = _mm512_add_ps(sum[q * 2 + 1], _mm512_mul_ps(vq, d1));
+      }
+    }
+    __m128 sum128[8];
+    for(int k = 0; k < 8; ++k)
+      sum128[k] = reduceTo128AVX512(sum[k]);
+    storeSums8SSE2(sum128, out + d, nbData);
+  }
+}
+
+#endif // ALICEVISION_DISTANCE_X86
+
+#if defined(ALICEVISION_DISTANCE_NEON)
+
+float l2FloatNEON(const float* a, const float* b, std::size_t size)
+{
+  float32x4_t sum = vdupq_n_f32(0.f);
+  std::size_t i = 0;
+  for(; i + 4 <= size; i += 4)
+  {
+    const float32x4_t diff = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+    sum = vmlaq_f32(sum, diff, diff);
+  }
+  return vaddvq_f32(sum) + l2FloatTail(a, b, i, size);
+}
+
+float l2UCharNEON(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  uint32x4_t sum = vdupq_n_u32(0);
+  std::size_t i = 0;
+  for(; i + 16 <= size; i += 16)
+  {
+    // squared absolute differences fit on 16 bits
+    const uint8x16_t diff = vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+    sum = vpadalq_u16(sum, vmull_u8(vget_low_u8(diff), vget_low_u8(diff)));
+    sum = vpadalq_u16(sum, vmull_u8(vget_high_u8(diff), vget_high_u8(diff)));
+  }
+  return float(vaddvq_u32(sum) + l2UCharTail(a, b, i, size));
+}
+
+float l2UCharFloatNEON(const unsigned char* a, const float* b, std::size_t size)
+{
+  float32x4_t sum = vdupq_n_f32(0.f);
+  std::size_t i = 0;
+  for(; i + 8 <= size; i += 8)
+  {
+    const uint16x8_t va = vmovl_u8(vld1_u8(a + i));
+    const float32x4_t diffLow = vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(va))), vld1q_f32(b + i));
+    const float32x4_t diffHigh = vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(va))), vld1q_f32(b + i + 4));
+    sum = vmlaq_f32(sum, diffLow, diffLow);
+    sum = vmlaq_f32(sum, diffHigh, diffHigh);
+  }
+  return vaddvq_f32(sum) + l2UCharFloatTail(a, b, i, size);
+}
+
+unsigned int hammingNEON(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  uint32x4_t sum = vdupq_n_u32(0);
+  std::size_t i = 0;
+  for(; i + 16 <= size; i += 16)
+  {
+    const uint8x16_t count = vcntq_u8(veorq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+    sum = vpadalq_u16(sum, vpaddlq_u8(count));
+  }
+  return vaddvq_u32(sum) + hammingTail(a, b, i, size);
+}
+
+void dotInt16NEON(const std::int16_t* queries, const std::int16_t* data, std::size_t nbData, std::size_t dim, std::int32_t* out)
+{
+  for(std::size_t d = 0; d < nbData; d += 2)
+  {
+    const std::int16_t* data0 = data + d * dim;
+    const std::int16_t* data1 = data0 + dim;
+    int32x4_t sum[8];
+    for(int k = 0; k < 8; ++k)
+      sum[k] = vdupq_n_s32(0);
+    for(std::size_t i = 0; i < dim; i += 8)
+    {
+      const int16x8_t d0 = vld1q_s16(data0 + i);
+      const int16x8_t d1 = vld1q_s16(data1 + i);
+      for(std::size_t q = 0; q < 4; ++q)
+      {
+        const int16x8_t vq = vld1q_s16(queries + q * dim + i);
+        sum[q * 2] = vmlal_s16(vmlal_s16(sum[q * 2], vget_low_s16(vq), vget_low_s16(d0)), vget_high_s16(vq), vget_high_s16(d0));
+        sum[q * 2 + 1] = vmlal_s16(vmlal_s16(sum[q * 2 + 1], vget_low_s16(vq), vget_low_s16(d1)), vget_high_s16(vq), vget_high_s16(d1));
+      }
+    }
+    for(std::size_t q = 0; q < 4; ++q)
+    {
+      out[q * nbData + d] = vaddvq_s32(sum[q * 2]);
+      out[q * nbData + d + 1] = vaddvq_s32(sum[q * 2 + 1]);
+    }
+  }
+}
+
+void dotFloatNEON(const float* queries, const float* data, std::size_t nbData, std::size_t dim, float* out)
+{
+  for(std::size_t d = 0; d < nbData; d += 2)
+  {
+    const float* data0 = data + d * dim;
+    const float* data1 = data0 + dim;
+    float32x4_t sum[8];
+    for(int k = 0; k < 8; ++k)
+      sum[k] = vdupq_n_f32(0.f);
+    for(std::size_t i = 0; i < dim; i += 4)
+    {
+      const float32x4_t d0 = vld1q_f32(data0 + i);
+      const float32x4_t d1 = vld1q_f32(data1 + i);
+      for(std::size_t q = 0; q < 4; ++q)
+      {
+        const float32x4_t vq = vld1q_f32(queries + q * dim + i);
+        sum[q * 2] = vmlaq_f32(sum[q * 2], vq, d0);
+        sum[q * 2 + 1] = vmlaq_f32(sum[q * 2 + 1], vq, d1);
+      }
+    }
+    for(std::size_t q = 0; q < 4; ++q)
+    {
+      out[q * nbData + d] = vaddvq_f32(sum[q * 2]);
+      out[q * nbData + d + 1] = vaddvq_f32(sum[q * 2 + 1]);
+    }
+  }
+}
+
+#endif // ALICEVISION_DISTANCE_NEON
+
+struct DistanceKernels
+{
+  ESimdLevel level;
+  float (*l2Float)(const float*, const float*, std::size_t);
+  float (*l2UChar)(const unsigned char*, const unsigned char*, std::size_t);
+  float (*l2UCharFloat)(const unsigned char*, const float*, std::size_t);
+  unsigned int (*hamming)(const unsigned char*, const unsigned char*, std::size_t);
+  void (*dotInt16)(const std::int16_t*, const std::int16_t*, std::size_t, std::size_t, std::int32_t*);
+  void (*dotFloat)(const float*, const float*, std::size_t, std::size_t, float*);
+};
+
+const DistanceKernels scalarKernels = {ESimdLevel::SCALAR, l2FloatScalar, l2UCharScalar, l2UCharFloatScalar, hammingScalar,
+                                       dotInt16Scalar, dotFloatScalar};
+#if defined(ALICEVISION_DISTANCE_X86)
+const DistanceKernels sse2Kernels = {ESimdLevel::SSE2, l2FloatSSE2, l2UCharSSE2, l2UCharFloatSSE2, hammingSSE2,
+                                     dotInt16SSE2, dotFloatSSE2};
+const DistanceKernels avx2Kernels = {ESimdLevel::AVX2, l2FloatAVX2, l2UCharAVX2, l2UCharFloatAVX2, hammingAVX2,
+                                     dotInt16AVX2, dotFloatAVX2};
+const DistanceKernels avx512Kernels = {ESimdLevel::AVX512, l2FloatAVX512, l2UCharAVX512, l2UCharFloatAVX512, hammingAVX512,
+                                       dotInt16AVX512, dotFloatAVX512};
+#endif
+#if defined(ALICEVISION_DISTANCE_NEON)
+const DistanceKernels neonKernels = {ESimdLevel::NEON, l2FloatNEON, l2UCharNEON, l2UCharFloatNEON, hammingNEON,
+                                     dotInt16NEON, dotFloatNEON};
+#endif
+
+ESimdLevel detectSimdLevel()
+{
+#if defined(ALICEVISION_DISTANCE_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  const int maxLeaf = info[0];
+  __cpuid(info, 1);
+  const bool sse2 = (info[3] & (1 << 26)) != 0;
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  // check that the OS saves the AVX and AVX-512 registers
+  const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+  bool avx2 = false;
+  bool avx512 = false;
+  if(maxLeaf >= 7)
+  {
+    __cpuidex(info, 7, 0);
+    avx2 = avx && ((info[1] & (1 << 5)) != 0) && ((xcr0 & 0x6) == 0x6);
+    avx512 = avx2 && ((info[1] & (1 << 16)) != 0) && ((info[1] & (1 << 30)) != 0) && ((xcr0 & 0xe6) == 0xe6);
+  }
+#else
+  __builtin_cpu_init();
+  const bool sse2 = __builtin_cpu_supports("sse2");
+  const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+  const bool avx512 = avx2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+  if(avx512)
+    return ESimdLevel::AVX512;
+  if(avx2)
+    return ESimdLevel::AVX2;
+  if(sse2)
+    return ESimdLevel::SSE2;
+#elif defined(ALICEVISION_DISTANCE_NEON)
+  return ESimdLevel::NEON;
+#endif
+  return ESimdLevel::SCALAR;
+}
+
+bool isSupported(ESimdLevel level)
+{
+  const ESimdLevel supported = getSupportedSimdLevel();
+  if(level == ESimdLevel::SCALAR)
+    return true;
+  if(level == ESimdLevel::NEON || supported == ESimdLevel::NEON)
+    return level == supported;
+  return level <= supported;
+}
+
+const DistanceKernels& getKernels(ESimdLevel level)
+{
+  switch(level)
+  {
+#if defined(ALICEVISION_DISTANCE_X86)
+    case ESimdLevel::SSE2:   return sse2Kernels;
+    case ESimdLevel::AVX2:   return avx2Kernels;
+    case ESimdLevel::AVX512: return avx512Kernels;
+#endif
+#if defined(ALICEVISION_DISTANCE_NEON)
+    case ESimdLevel::NEON:   return neonKernels;
+#endif
+    default:                 return scalarKernels;
+  }
+}
+
+std::atomic<const DistanceKernels*> currentKernels(nullptr);
+
+inline const DistanceKernels& kernels()
+{
+  const DistanceKernels* k = currentKernels.load(std::memory_order_relaxed);
+  if(k == nullptr)
+  {
+    k = &getKernels(getSupportedSimdLevel());
+    currentKernels.store(k, std::memory_order_relaxed);
+  }
+  return *k;
+}
+
+template<typename QueryT, typename DataT, typename ResultT, typename Kernel>
+inline void computeDistances1xN(Kernel kernel, const QueryT* query, const DataT* data, std::size_t nbData, std::size_t dim, ResultT* out)
+{
+  for(std::size_t i = 0; i < nbData; ++i)
+    out[i] = kernel(query, data + i * dim, dim);
+}
+
+template<typename QueryT, typename DataT, typename ResultT, typename Kernel>
+inline void computeDistancesMxN(Kernel kernel, const QueryT* queries, std::size_t nbQueries, const DataT* data, std::size_t nbData, std::size_t dim, ResultT* out)
+{
+  // process the data by blocks staying in the cache for all the queries
+  const std::size_t blockSize = std::max<std::size_t>(1, (64 * 1024) / std::max<std::size_t>(1, dim * sizeof(DataT)));
+
+  for(std::size_t blockBegin = 0; blockBegin < nbData; blockBegin += blockSize)
+  {
+    const std::size_t blockEnd = std::min(nbData, blockBegin + blockSize);
+    for(std::size_t q = 0; q < nbQueries; ++q)
+    {
+      const QueryT* query = queries + q * dim;
+      ResultT* outRow = out + q * nbData;
+      for(std::size_t i = blockBegin; i < blockEnd; ++i)
+        outRow[i] = kernel(query, data + i * dim, dim);
+    }
+  }
+}
+
+template<typename InT, typename KernelT>
+inline void copyPaddedRows(const InT* rows, std::size_t nbRows, std::size_t dim, std::size_t paddedDim, KernelT* out)
+{
+  for(std::size_t r = 0; r < nbRows; ++r)
+  {
+    std::copy(rows + r * dim, rows + (r + 1) * dim, out + r * paddedDim);
+    std::fill(out + r * paddedDim + dim, out + (r + 1) * paddedDim, KernelT(0));
+  }
+}
+
+template<typename KernelT, typename InT, typename ResultT, typename Kernel>
+inline void computeDotProductsMxN(Kernel kernel, const InT* queries, std::size_t nbQueries, const InT* data, std::size_t nbData, std::size_t dim, ResultT* out)
+{
+  // the rows are copied in the type of the kernel, with the dimension padded to a multiple of 64 bytes,
+  // the queries padded to a multiple of 4 rows and the data blocks to an even number of rows
+  const std::size_t elementsPer64Bytes = 64 / sizeof(KernelT);
+  const std::size_t paddedDim = (dim + elementsPer64Bytes - 1) / elementsPer64Bytes * elementsPer64Bytes;
+  std::vector<KernelT> paddedQueries((nbQueries + 3) / 4 * 4 * paddedDim, KernelT(0));
+  copyPaddedRows(queries, nbQueries, dim, paddedDim, paddedQueries.data());
+
+  // process the data by blocks staying in the cache for all the queries
+  const std::size_t blockSize = std::max<std::size_t>(1, (64 * 1024) / (2 * paddedDim * sizeof(KernelT))) * 2;
+  std::vector<KernelT> paddedData(blockSize * paddedDim, KernelT(0));
+  std::vector<ResultT> products(4 * blockSize);
+
+  for(std::size_t blockBegin = 0; blockBegin < nbData; blockBegin += blockSize)
+  {
+    const std::size_t nbBlockData = std::min(nbData - blockBegin, blockSize);
+    const std::size_t nbPaddedBlockData = (nbBlockData + 1) / 2 * 2;
+    copyPaddedRows(data + blockBegin * dim, nbBlockData, dim, paddedDim, paddedData.data());
+
+    for(std::size_t q = 0; q < nbQueries; q += 4)
+    {
+      kernel(&paddedQueries[q * paddedDim], paddedData.data(), nbPaddedBlockData, paddedDim, products.data());
+
+      const std::size_t nbGroupQueries = std::min<std::size_t>(4, nbQueries - q);
+      for(std::size_t k = 0; k < nbGroupQueries; ++k)
+        std::copy(&products[k * nbPaddedBlockData], &products[k * nbPaddedBlockData + nbBlockData], out + (q + k) * nbData + blockBegin);
+    }
+  }
+}
+
+} // namespace
+
+ESimdLevel getSupportedSimdLevel()
+{
+  static const ESimdLevel level = detectSimdLevel();
+  return level;
+}
+
+ESimdLevel getSimdLevel()
+{
+  return kernels().level;
+}
+
+bool setSimdLevel(ESimdLevel level)
+{
+  if(!isSupported(level))
+    return false;
+  currentKernels.store(&getKernels(level), std::memory_order_relaxed);
+  return true;
+}
+
+float l2SquaredDistance(const float* a, const float* b, std::size_t size)
+{
+  return kernels().l2Float(a, b, size);
+}
+
+float l2SquaredDistance(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  return kernels().l2UChar(a, b, size);
+}
+
+float l2SquaredDistance(const unsigned char* a, const float* b, std::size_t size)
+{
+  return kernels().l2UCharFloat(a, b, size);
+}
+
+unsigned int hammingDistance(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  return kernels().hamming(a, b, size);
+}
+
+void l2SquaredDistances(const float* query, const float* data, std::size_t nbData, std::size_t dim, float* out)
+{
+  computeDistances1xN(kernels().l2Float, query, data, nbData, dim, out);
+}
+
+void l2SquaredDistances(const unsigned char* query, const unsigned char* data, std::size_t nbData, std::size_t dim, float* out)
+{
+  computeDistances1xN(kernels().l2UChar, query, data, nbData, dim, out);
+}
+
+void l2SquaredDistances(const unsigned char* query, const float* data, std::size_t nbData, std::size_t dim, float* out)
+{
+  computeDistances1xN(kernels().l2UCharFloat, query, data, nbData, dim, out);
+}
+
+void hammingDistances(const unsigned char* query, const unsigned char* data, std::size_t nbData, std::size_t size, unsigned int* out)
+{
+  computeDistances1xN(kernels().hamming, query, data, nbData, size, out);
+}
+
+void l2SquaredDistances(const float* queries, std::size_t nbQueries, const float* data, std::size_t nbData, std::size_t dim, float* out)
+{
+  computeDistancesMxN(kernels().l2Float, queries, nbQueries, data, nbData, dim, out);
+}
+
+void l2SquaredDistances(const unsigned char* queries, std::size_t nbQueries, const unsigned char* data, std::size_t nbData, std::size_t dim, float* out)
+{
+  computeDistancesMxN(kernels().l2UChar, queries, nbQueries, data, nbData, dim, out);
+}
+
+void l2SquaredDistances(const unsigned char* queries, std::size_t nbQueries, const float* data, std::size_t nbData, std::size_t dim, float* out)
+{
+  computeDistancesMxN(kernels().l2UCharFloat, queries, nbQueries, data, nbData, dim, out);
+}
+
+void hammingDistances(const unsigned char* queries, std::size_t nbQueries, const unsigned char* data, std::size_t nbData, std::size_t size, unsigned int* out)
+{
+  computeDistancesMxN(kernels().hamming, queries, nbQueries, data, nbData, size, out);
+}
+
+void dotProducts(const float* queries, std::size_t nbQueries, const float* data, std::size_t nbData, std::size_t dim, float* out)
+{
+  computeDotProductsMxN<float>(kernels().dotFloat, queries, nbQueries, data, nbData, dim, out);
+}
+
+void dotProducts(const unsigned char* queries, std::size_t nbQueries, const unsigned char* data, std::size_t nbData, std::size_t dim, std::int32_t* out)
+{
+  // the values are widened once to 16 bits, the products are accumulated on 32 bits
+  computeDotProductsMxN<std::int16_t>(kernels().dotInt16, queries, nbQueries, data, nbData, dim, out);
+}
+
+} // namespace feature
+} // namespace aliceVision
@@ -0,0 +1,90 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Descriptor distance kernels.
+// The instruction set is selected at runtime from the CPU capabilities,
+// so the binaries do not need to be compiled for a specific architecture.
+//
+// Batched versions work on descriptors stored contiguously (row-major, one descriptor per row):
+//  - 1xN: out[i] = distance(query, data[i])
+//  - MxN: out[q * nbData + i] = distance(queries[q], data[i])
+//
+// The MxN dot products are computed by tiles like a matrix product, for the squared L2 distances
+// computed as ||a||^2 + ||b||^2 - 2 a.b (see ArrayMatcher_bruteForceBlocked).
+// The dot products of unsigned char descriptors are accumulated on 32 bits, so they are exact.
+
+namespace aliceVision {
+namespace feature {
+
+/**
+ * @brief Instruction sets of the descriptor distance kernels
+ */
+enum class ESimdLevel
+{
+  SCALAR = 0,
+  SSE2,
+  AVX2,
+  AVX512,
+  NEON
+};
+
+std::string ESimdLevel_enumToString(ESimdLevel level);
+
+/**
+ * @brief Get the best instruction set supported by both the build and the CPU
+ */
+ESimdLevel getSupportedSimdLevel();
+
+/**
+ * @brief Get the instruction set currently used by the distance kernels
+ */
+ESimdLevel getSimdLevel();
+
+/**
+ * @brief Force the instruction set used by the distance kernels (for tests and benchmarks).
+ * @param[in] level the requested instruction set
+ * @return false if the instruction set is not supported (the current one is kept)
+ */
+bool setSimdLevel(ESimdLevel level);
+
+/// Squared L2 distance between float descriptors
+float l2SquaredDistance(const float* a, const float* b, std::size_t size);
+
+/// Squared L2 distance between unsigned char descriptors
+float l2SquaredDistance(const unsigned char* a, const unsigned char* b, std::size_t size);
+
+/// Squared L2 distance between an unsigned char descriptor and a float descriptor (e.g. a cluster center)
+float l2SquaredDistance(const unsigned char* a, const float* b, std::size_t size);
+
+/// Hamming distance between binary descriptors of \p size bytes (used by Hamming<unsigned char> only)
+unsigned int hammingDistance(const unsigned char* a, const unsigned char* b, std::size_t size);
+
+// 1xN
+
+void l2SquaredDistances(const float* query, const float* data, std::size_t nbData, std::size_t dim, float* out);
+void l2SquaredDistances(const unsigned char* query, const unsigned char* data, std::size_t nbData, std::size_t dim, float* out);
+void l2SquaredDistances(const unsigned char* query, const float* data, std::size_t nbData, std::size_t dim, float* out);
+void hammingDistances(const unsigned char* query, const unsigned char* data, std::size_t nbData, std::size_t size, unsigned int* out);
+
+// MxN
+
+void l2SquaredDistances(const float* queries, std::size_t nbQueries, const float* data, std::size_t nbData, std::size_t dim, float* out);
+void l2SquaredDistances(const unsigned char* queries, std::size_t nbQueries, const unsigned char* data, std::size_t nbData, std::size_t dim, float* out);
+void l2SquaredDistances(const unsigned char* queries, std::size_t nbQueries, const float* data, std::size_t nbData, std::size_t dim, float* out);
+void hammingDistances(const unsigned char* queries, std::size_t nbQueries, const unsigned char* data, std::size_t nbData, std::size_t size, unsigned int* out);
+
+/// Dot products between descriptors: out[q * nbData + i] = queries[q].data[i]
+void dotProducts(const float* queries, std::size_t nbQueries, const float* data, std::size_t nbData, std::size_t dim, float* out);
+void dotProducts(const unsigned char* queries, std::size_t nbQueries, const unsigned char* data, std::size_t nbData, std::size_t dim, std::int32_t* out);
+
+} // namespace feature
+} // namespace aliceVision
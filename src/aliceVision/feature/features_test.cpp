@@ -69,6 +69,43 @@ BOOST_AUTO_TEST_CASE(featureIO_ASCII) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(featureIO_BINARY) {
+  Feats_T vec_feats;
+  for(int i = 0; i < CARD; ++i)  {
+    vec_feats.push_back(Feature_T(i, i*2, i*3, i*4));
+  }
+
+  //Save them to a binary file
+  BOOST_CHECK_NO_THROW(saveFeatsToBinFile("tempFeatsBin.feat", vec_feats, "sift"));
+  BOOST_CHECK(isFeatBinFile("tempFeatsBin.feat"));
+
+  //An ASCII file must not be recognized as a binary file
+  BOOST_CHECK_NO_THROW(saveFeatsToFile("tempFeatsBinAscii.feat", vec_feats));
+  BOOST_CHECK(!isFeatBinFile("tempFeatsBinAscii.feat"));
+
+  //Read the saved data and compare to input, the header must be valid
+  Feats_T vec_feats_read;
+  FeatBinHeader header;
+  BOOST_CHECK_NO_THROW(loadFeatsFromBinFile("tempFeatsBin.feat", vec_feats_read, &header));
+  BOOST_CHECK_EQUAL(CARD, header.count);
+  BOOST_CHECK_EQUAL("sift", header.getDescriberType());
+  BOOST_CHECK(EFeatBinLayout::XY_SCALE_ORIENTATION_F32 == header.layout);
+  BOOST_CHECK_EQUAL(CARD, vec_feats_read.size());
+
+  for(int i = 0; i < CARD; ++i) {
+    BOOST_CHECK_EQUAL(vec_feats[i], vec_feats_read[i]);
+  }
+
+  //The generic loader must choose the format from the file magic
+  Feats_T vec_feats_generic;
+  BOOST_CHECK_NO_THROW(loadFeatsFromFile("tempFeatsBin.feat", vec_feats_generic));
+  BOOST_CHECK_EQUAL(CARD, vec_feats_generic.size());
+
+  for(int i = 0; i < CARD; ++i) {
+    BOOST_CHECK_EQUAL(vec_feats[i], vec_feats_generic[i]);
+  }
+}
+
 //--
 //-- Descriptors interface test
 //--
@@ -121,3 +158,45 @@ BOOST_AUTO_TEST_CASE(descriptorIO_BINARY) {
       BOOST_CHECK_EQUAL(vec_descs[i][j], vec_descs_read[i][j]);
   }
 }
+
+//Test memory-mapped descriptors regions
+BOOST_AUTO_TEST_CASE(regionsIO_MEMORY_MAPPED) {
+  SIFT_Regions regions;
+  for(int i = 0; i < CARD; ++i)
+  {
+    regions.Features().push_back(Feature_T(i, i*2, i*3, i*4));
+    SIFT_Regions::DescriptorT desc;
+    for (int j = 0; j < 128; ++j)
+      desc[j] = static_cast<unsigned char>(i + j);
+    regions.Descriptors().push_back(desc);
+  }
+
+  BOOST_CHECK_NO_THROW(regions.Save("tempRegions.feat", "tempRegions.desc"));
+
+  std::unique_ptr<Regions> mappedRegions(regions.EmptyMappedClone());
+  BOOST_CHECK_NO_THROW(mappedRegions->Load("tempRegions.feat", "tempRegions.desc"));
+  BOOST_CHECK_EQUAL(CARD, mappedRegions->RegionCount());
+  BOOST_CHECK_THROW(mappedRegions->blindDescriptors(), std::logic_error);
+
+  const unsigned char* mappedData = static_cast<const unsigned char*>(mappedRegions->DescriptorRawData());
+  for(int i = 0; i < CARD; ++i)
+  {
+    BOOST_CHECK_EQUAL(regions.Features()[i], mappedRegions->Features()[i]);
+    for (int j = 0; j < 128; ++j)
+      BOOST_CHECK_EQUAL(regions.Descriptors()[i][j], mappedData[i * 128 + j]);
+
+    // distances between mapped and in-memory regions are consistent
+    BOOST_CHECK_EQUAL(regions.SquaredDescriptorDistance(i, &regions, 0), mappedRegions->SquaredDescriptorDistance(i, &regions, 0));
+    BOOST_CHECK_EQUAL(regions.SquaredDescriptorDistance(i, &regions, 0), regions.SquaredDescriptorDistance(i, mappedRegions.get(), 0));
+  }
+
+  // copied regions are stored in memory
+  std::unique_ptr<Regions> copiedRegions(mappedRegions->EmptyClone());
+  mappedRegions->CopyRegion(2, copiedRegions.get());
+  BOOST_CHECK_EQUAL(1, copiedRegions->RegionCount());
+  BOOST_CHECK(regions.Descriptors()[2] == static_cast<SIFT_Regions*>(copiedRegions.get())->Descriptors()[0]);
+
+  // a descriptor file of another type cannot be mapped
+  std::unique_ptr<Regions> mappedFloatRegions(SIFT_Float_Regions().EmptyMappedClone());
+  BOOST_CHECK_THROW(mappedFloatRegions->Load("tempRegions.feat", "tempRegions.desc"), std::runtime_error);
+}
@@ -9,13 +9,8 @@
 
 #include "Hamming.hpp"
 
+#include <aliceVision/feature/distanceKernels.hpp>
 #include <aliceVision/numeric/Accumulator.hpp>
-#include <aliceVision/config.hpp>
-
-#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
-#include <aliceVision/system/Logger.hpp>
-#include <xmmintrin.h>
-#endif
 
 #include <cstddef>
 
@@ -77,51 +72,7 @@ struct L2_Vectorized
   }
 };
 
-#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
-
-namespace optim_ss2{
-
-  /// Union to switch between SSE and float array
-  union sseRegisterHelper
-  {
-      __m128 m;
-      float f[4];
-  };
-
-  // Euclidean distance (SSE method) (squared result)
-  inline float l2_sse(const float * b1, const float * b2, int size)
-  {
-    float* b1Pt = (float*)b1;
-    float* b2Pt = (float*)b2;
-    if(size%4 == 0)
-    {
-      __m128 srcA, srcB, temp, cumSum;
-      float zeros[4] = {0.f,0.f,0.f,0.f};
-      cumSum = _mm_load_ps( zeros );
-      for(int i = 0 ; i < size; i+=4)
-      {
-        srcA = _mm_load_ps(b1Pt+i);
-        srcB = _mm_load_ps(b2Pt+i);
-        //-- Subtract
-        temp = _mm_sub_ps( srcA, srcB );
-        //-- Multiply
-        temp =  _mm_mul_ps( temp, temp );
-        //-- sum
-        cumSum = _mm_add_ps( cumSum, temp );
-      }
-      sseRegisterHelper res;
-      res.m = cumSum;
-      return (res.f[0]+res.f[1]+res.f[2]+res.f[3]);
-    }
-    else
-    {
-      ALICEVISION_LOG_WARNING("/!\\ size is not modulus 4, distance cannot be performed in SSE");
-      return 0.0f;
-    }
-  }
-} // namespace optim_ss2
-
-// Template specification to run SSE L2 squared distance
+// Template specialization to run the SIMD L2 squared distance
 //  on float vector
 template<>
 struct L2_Vectorized<float>
@@ -132,11 +83,46 @@ struct L2_Vectorized<float>
   template <typename Iterator1, typename Iterator2>
   inline ResultType operator()(Iterator1 a, Iterator2 b, size_t size) const
   {
-    return optim_ss2::l2_sse(a,b,size);
+    return l2SquaredDistance(a, b, size);
+  }
+};
+
+// Template specialization to run the SIMD L2 squared distance
+//  on unsigned char vector
+template<>
+struct L2_Vectorized<unsigned char>
+{
+  typedef unsigned char ElementType;
+  typedef Accumulator<unsigned char>::Type ResultType;
+
+  template <typename Iterator1, typename Iterator2>
+  inline ResultType operator()(Iterator1 a, Iterator2 b, size_t size) const
+  {
+    return l2SquaredDistance(a, b, size);
   }
 };
 
-#endif // ALICEVISION_HAVE_SSE
+/**
+ * @brief Compute the distances between a query and descriptors stored contiguously
+ *        out[i] = metric(query, data + i * dim, dim)
+ *        Overloaded for the metrics with batched SIMD kernels.
+ */
+template<class Metric, typename T, typename DistanceT>
+inline void computeDistances(const Metric& metric, const T* query, const T* data, size_t nbData, size_t dim, DistanceT* out)
+{
+  for(size_t i = 0; i < nbData; ++i)
+    out[i] = metric(query, data + i * dim, dim);
+}
+
+inline void computeDistances(const L2_Vectorized<float>&, const float* query, const float* data, size_t nbData, size_t dim, float* out)
+{
+  l2SquaredDistances(query, data, nbData, dim, out);
+}
+
+inline void computeDistances(const L2_Vectorized<unsigned char>&, const unsigned char* query, const unsigned char* data, size_t nbData, size_t dim, float* out)
+{
+  l2SquaredDistances(query, data, nbData, dim, out);
+}
 
 }  // namespace feature
 }  // namespace aliceVision
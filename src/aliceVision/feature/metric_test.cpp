@@ -8,7 +8,9 @@
 #include <aliceVision/feature/metric.hpp>
 
 #include <iostream>
+#include <random>
 #include <string>
+#include <vector>
 
 #define BOOST_TEST_MODULE matchingMetric
 
@@ -134,3 +136,89 @@ BOOST_AUTO_TEST_CASE(Metric_HAMMING_BITSET_RAW_MEMORY_32BITS)
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(Metric_SIMD_Kernels)
+{
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<int> distributionUChar(0, 255);
+  std::uniform_real_distribution<float> distributionFloat(-1.f, 1.f);
+
+  // sizes not multiple of the register sizes to test the remaining elements
+  const std::vector<std::size_t> sizes = {1, 7, 31, 64, 100, 128, 131};
+  // a full group of 4 queries for the dot products, and a partial one
+  const std::size_t nbData = 7;
+  const std::size_t nbQueries = 5;
+
+  const ESimdLevel supportedLevel = getSupportedSimdLevel();
+  const std::vector<ESimdLevel> levels = {ESimdLevel::SCALAR, ESimdLevel::SSE2, ESimdLevel::AVX2, ESimdLevel::AVX512, ESimdLevel::NEON};
+
+  for(ESimdLevel level : levels)
+  {
+    if(!setSimdLevel(level))
+      continue;
+    BOOST_CHECK(getSimdLevel() == level);
+    BOOST_TEST_MESSAGE("SIMD level: " << ESimdLevel_enumToString(level));
+
+    for(std::size_t size : sizes)
+    {
+      std::vector<unsigned char> dataUChar(nbData * size);
+      std::vector<float> dataFloat(nbData * size);
+      for(std::size_t i = 0; i < dataUChar.size(); ++i)
+      {
+        dataUChar[i] = static_cast<unsigned char>(distributionUChar(generator));
+        dataFloat[i] = distributionFloat(generator);
+      }
+      const unsigned char* queriesUChar = dataUChar.data();
+      const float* queriesFloat = dataFloat.data();
+
+      std::vector<float> distancesUChar(nbQueries * nbData);
+      std::vector<float> distancesFloat(nbQueries * nbData);
+      std::vector<float> distancesUCharFloat(nbQueries * nbData);
+      std::vector<unsigned int> distancesHamming(nbQueries * nbData);
+      l2SquaredDistances(queriesUChar, nbQueries, dataUChar.data(), nbData, size, distancesUChar.data());
+      l2SquaredDistances(queriesFloat, nbQueries, dataFloat.data(), nbData, size, distancesFloat.data());
+      l2SquaredDistances(queriesUChar, nbQueries, dataFloat.data(), nbData, size, distancesUCharFloat.data());
+      hammingDistances(queriesUChar, nbQueries, dataUChar.data(), nbData, size, distancesHamming.data());
+
+      std::vector<std::int32_t> dotProductsUChar(nbQueries * nbData);
+      dotProducts(queriesUChar, nbQueries, dataUChar.data(), nbData, size, dotProductsUChar.data());
+
+      for(std::size_t q = 0; q < nbQueries; ++q)
+      {
+        std::vector<unsigned int> distances1xN(nbData);
+        hammingDistances(queriesUChar + q * size, dataUChar.data(), nbData, size, distances1xN.data());
+
+        for(std::size_t i = 0; i < nbData; ++i)
+        {
+          const std::size_t index = q * nbData + i;
+          const unsigned char* aUChar = queriesUChar + q * size;
+          const unsigned char* bUChar = dataUChar.data() + i * size;
+          const float* aFloat = queriesFloat + q * size;
+          const float* bFloat = dataFloat.data() + i * size;
+
+          std::vector<float> aUCharAsFloat(aUChar, aUChar + size);
+
+          // integer distances are exact
+          BOOST_CHECK_EQUAL(L2_Simple<unsigned char>()(aUChar, bUChar, size), distancesUChar[index]);
+          BOOST_CHECK_EQUAL(L2_Vectorized<unsigned char>()(aUChar, bUChar, size), distancesUChar[index]);
+          BOOST_CHECK_CLOSE(L2_Simple<float>()(aFloat, bFloat, size), distancesFloat[index], 1e-3);
+          BOOST_CHECK_CLOSE(L2_Vectorized<float>()(aFloat, bFloat, size), distancesFloat[index], 1e-3);
+          BOOST_CHECK_CLOSE(L2_Simple<float>()(aUCharAsFloat.data(), bFloat, size), distancesUCharFloat[index], 1e-3);
+
+          unsigned int hamming = 0;
+          for(std::size_t k = 0; k < size; ++k)
+            hamming += std::bitset<8>(aUChar[k] ^ bUChar[k]).count();
+          BOOST_CHECK_EQUAL(hamming, distancesHamming[index]);
+          BOOST_CHECK_EQUAL(hamming, distances1xN[i]);
+          BOOST_CHECK_EQUAL(hamming, Hamming<unsigned char>()(aUChar, bUChar, size));
+
+          std::int32_t dotProduct = 0;
+          for(std::size_t k = 0; k < size; ++k)
+            dotProduct += std::int32_t(aUChar[k]) * std::int32_t(bUChar[k]);
+          BOOST_CHECK_EQUAL(dotProduct, dotProductsUChar[index]);
+        }
+      }
+    }
+  }
+  BOOST_CHECK(setSimdLevel(supportedLevel));
+}
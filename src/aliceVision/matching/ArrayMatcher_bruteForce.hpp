@@ -71,11 +71,8 @@ class ArrayMatcher_bruteForce  : public ArrayMatcher<Scalar, Metric>
       Eigen::Map<BaseMat> mat_query((Scalar*)query, 1, (*memMapping).cols() );
       Metric metric;
       std::vector<DistanceType> vec_dist((*memMapping).rows(), 0.0);
-    for (int i = 0; i < (*memMapping).rows(); ++i)
-    {
-        // Compute Distance Metric
-        vec_dist[i] = metric( (Scalar*)query, (*memMapping).row(i).data(), (*memMapping).cols() );
-      }
+      // Compute Distance Metric
+      feature::computeDistances(metric, query, (*memMapping).data(), (*memMapping).rows(), (*memMapping).cols(), vec_dist.data());
       if (!vec_dist.empty())
       {
         // Find the minimum distance :
@@ -129,13 +126,8 @@ class ArrayMatcher_bruteForce  : public ArrayMatcher<Scalar, Metric>
     {
       std::vector<DistanceType> vec_distance((*memMapping).rows(), 0.0);
       const Scalar * queryPtr = mat_query.row(queryIndex).data();
-      const Scalar * rowPtr = (*memMapping).data();
-      for (int i = 0; i < (*memMapping).rows(); ++i)
-      {
-        vec_distance[i] = metric( queryPtr,
-          rowPtr, (*memMapping).cols() );
-        rowPtr += (*memMapping).cols();
-      }
+      // distances to all the rows with the batched metric kernels
+      feature::computeDistances(metric, queryPtr, (*memMapping).data(), (*memMapping).rows(), (*memMapping).cols(), vec_distance.data());
 
       // Find the N minimum distances:
       const int maxMinFound = (int) std::min( size_t(NN), vec_distance.size());
@@ -0,0 +1,234 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/matching/ArrayMatcher.hpp>
+#include <aliceVision/feature/metric.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace aliceVision {
+namespace matching {
+
+/**
+ * @brief Brute force squared L2 matcher processing the queries and the database by blocks.
+ *
+ * The squared distances of a tile (a block of queries and a block of the database) are computed
+ * as ||q||^2 + ||d||^2 - 2 q.d, with the squared norms of the database computed once in Build()
+ * and the dot products of the tile computed as a matrix product:
+ *  - with the runtime-dispatched dot product kernels for the float and unsigned char descriptors
+ *    (see feature/distanceKernels.hpp), accumulated on 32 bits integers for unsigned char so the distances are exact
+ *  - with an Eigen matrix product for the other types.
+ * Only the N best neighbours of each query are kept while the database blocks are processed.
+ * Query blocks are processed in parallel.
+ */
+template <typename Scalar = float, typename Metric = feature::L2_Vectorized<Scalar> >
+class ArrayMatcher_bruteForceBlocked : public ArrayMatcher<Scalar, Metric>
+{
+public:
+  typedef typename Metric::ResultType DistanceType;
+  /// type of the dot products and squared norms, exact for the integer descriptors
+  typedef typename std::conditional<std::is_integral<Scalar>::value, std::int32_t, Scalar>::type ProductType;
+
+  ArrayMatcher_bruteForceBlocked() {}
+  virtual ~ArrayMatcher_bruteForceBlocked() {}
+
+  /**
+   * Build the matching structure
+   *
+   * \param[in] dataset   Input data.
+   * \param[in] nbRows    The number of component.
+   * \param[in] dimension Length of the data contained in the dataset.
+   *
+   * \return True if success.
+   */
+  bool Build(std::mt19937 & randomNumberGenerator, const Scalar * dataset, int nbRows, int dimension)
+  {
+    if (nbRows < 1)
+    {
+      _database = nullptr;
+      _databaseNorms.clear();
+      _nbRows = 0;
+      _dimension = 0;
+      return false;
+    }
+    // the dataset is not copied, it must stay valid while the matcher is used
+    _database = dataset;
+    _nbRows = nbRows;
+    _dimension = dimension;
+    _databaseNorms.resize(nbRows);
+    computeSquaredNorms(dataset, nbRows, dimension, _databaseNorms.data());
+    return true;
+  }
+
+  /**
+   * Search the nearest Neighbor of the scalar array query.
+   *
+   * \param[in]   query     The query array
+   * \param[out]  indice    The indice of array in the dataset that
+   *  have been computed as the nearest array.
+   * \param[out]  distance  The distance between the two arrays.
+   *
+   * \return True if success.
+   */
+  bool SearchNeighbour(const Scalar * query, int * indice, DistanceType * distance)
+  {
+    IndMatches indices;
+    std::vector<DistanceType> distances;
+    if (!SearchNeighbours(query, 1, &indices, &distances, 1))
+      return false;
+    *indice = indices.front()._j;
+    *distance = distances.front();
+    return true;
+  }
+
+  /**
+   * Search the N nearest Neighbor of the scalar array query.
+   *
+   * \param[in]   query     The query array
+   * \param[in]   nbQuery   The number of query rows
+   * \param[out]  indices   The corresponding (query, neighbor) indices
+   * \param[out]  distances The distances between the matched arrays.
+   * \param[out]  NN        The number of maximal neighbor that will be searched.
+   *
+   * \return True if success.
+   */
+  bool SearchNeighbours(const Scalar * query, int nbQuery,
+                        IndMatches * pvec_indices,
+                        std::vector<DistanceType> * pvec_distances,
+                        size_t NN)
+  {
+    if (_nbRows == 0)
+      return false;
+
+    if (NN == 0 || NN > std::size_t(_nbRows) || nbQuery < 1)
+      return false;
+
+    pvec_distances->resize(nbQuery * NN);
+    pvec_indices->resize(nbQuery * NN);
+
+    // the database block fits in the L2 cache
+    const int dataBlockSize = std::max(1, int(_dataBlockBytes / (_dimension * sizeof(Scalar))));
+    const int nbQueryBlocks = (nbQuery + _queryBlockSize - 1) / _queryBlockSize;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int queryBlock = 0; queryBlock < nbQueryBlocks; ++queryBlock)
+    {
+      const int queryBegin = queryBlock * _queryBlockSize;
+      const int queryBlockSize = std::min(_queryBlockSize, nbQuery - queryBegin);
+      const Scalar* queries = query + std::size_t(queryBegin) * _dimension;
+
+      std::vector<ProductType> queryNorms(queryBlockSize);
+      computeSquaredNorms(queries, queryBlockSize, _dimension, queryNorms.data());
+
+      // the N best neighbours of each query of the block, sorted by increasing distance
+      std::vector<DistanceType> bestDistances(queryBlockSize * NN, std::numeric_limits<DistanceType>::max());
+      std::vector<int> bestIndices(queryBlockSize * NN, -1);
+      std::vector<ProductType> products(std::size_t(queryBlockSize) * dataBlockSize);
+
+      for (int dataBegin = 0; dataBegin < _nbRows; dataBegin += dataBlockSize)
+      {
+        const int currentDataBlockSize = std::min(dataBlockSize, _nbRows - dataBegin);
+        const Scalar* data = _database + std::size_t(dataBegin) * _dimension;
+        const ProductType* dataNorms = &_databaseNorms[dataBegin];
+
+        computeDotProducts(queries, queryBlockSize, data, currentDataBlockSize, _dimension, products.data());
+
+        for (int q = 0; q < queryBlockSize; ++q)
+        {
+          DistanceType* queryBestDistances = &bestDistances[q * NN];
+          int* queryBestIndices = &bestIndices[q * NN];
+          const ProductType* queryProducts = &products[std::size_t(q) * currentDataBlockSize];
+
+          for (int d = 0; d < currentDataBlockSize; ++d)
+          {
+            // the rounding errors of the floating point products can give small negative distances
+            const DistanceType distance = std::max(DistanceType(0), DistanceType(queryNorms[q] + dataNorms[d] - 2 * queryProducts[d]));
+            if (distance >= queryBestDistances[NN - 1])
+              continue;
+
+            // insert in the sorted list of the best neighbours
+            size_t k = NN - 1;
+            for (; k > 0 && queryBestDistances[k - 1] > distance; --k)
+            {
+              queryBestDistances[k] = queryBestDistances[k - 1];
+              queryBestIndices[k] = queryBestIndices[k - 1];
+            }
+            queryBestDistances[k] = distance;
+            queryBestIndices[k] = dataBegin + d;
+          }
+        }
+      }
+
+      for (int q = 0; q < queryBlockSize; ++q)
+      {
+        const int queryIndex = queryBegin + q;
+        for (size_t k = 0; k < NN; ++k)
+        {
+          (*pvec_distances)[queryIndex * NN + k] = bestDistances[q * NN + k];
+          (*pvec_indices)[queryIndex * NN + k] = IndMatch(IndexT(queryIndex), IndexT(bestIndices[q * NN + k]));
+        }
+      }
+    }
+    return true;
+  }
+
+private:
+  typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> BaseMat;
+  typedef Eigen::Matrix<ProductType, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> ProductMat;
+
+  static void computeSquaredNorms(const Scalar* rows, int nbRows, int dimension, ProductType* norms)
+  {
+    for (int r = 0; r < nbRows; ++r)
+    {
+      const Scalar* row = rows + std::size_t(r) * dimension;
+      ProductType norm = 0;
+      for (int i = 0; i < dimension; ++i)
+        norm += ProductType(row[i]) * ProductType(row[i]);
+      norms[r] = norm;
+    }
+  }
+
+  /// dot products of the queries with the data rows: products[q * nbData + d] = queries[q].data[d]
+  static void computeDotProducts(const unsigned char* queries, int nbQueries, const unsigned char* data, int nbData, int dimension, std::int32_t* products)
+  {
+    feature::dotProducts(queries, nbQueries, data, nbData, dimension, products);
+  }
+
+  static void computeDotProducts(const float* queries, int nbQueries, const float* data, int nbData, int dimension, float* products)
+  {
+    feature::dotProducts(queries, nbQueries, data, nbData, dimension, products);
+  }
+
+  template <typename T>
+  static void computeDotProducts(const T* queries, int nbQueries, const T* data, int nbData, int dimension, T* products)
+  {
+    const Eigen::Map<const BaseMat> queriesMat(queries, nbQueries, dimension);
+    const Eigen::Map<const BaseMat> dataMat(data, nbData, dimension);
+    Eigen::Map<ProductMat> productsMat(products, nbQueries, nbData);
+    productsMat.noalias() = queriesMat * dataMat.transpose();
+  }
+
+  /// number of queries per block (processed by one thread)
+  const int _queryBlockSize = 256;
+  /// size in bytes of a database block, the block stays in the cache for all the queries of a block
+  const std::size_t _dataBlockBytes = 128 * 1024;
+
+  const Scalar* _database = nullptr;
+  /// squared norms of the database rows
+  std::vector<ProductType> _databaseNorms;
+  int _nbRows = 0;
+  int _dimension = 0;
+};
+
+}  // namespace matching
+}  // namespace aliceVision
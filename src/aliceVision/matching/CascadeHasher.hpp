@@ -8,33 +8,57 @@
 #pragma once
 
 #include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/feature/distanceKernels.hpp>
 #include <aliceVision/feature/metric.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
-#include <aliceVision/stl/DynamicBitset.hpp>
 
+#include <cstdint>
 #include <iostream>
+#include <numeric>
 #include <random>
 #include <cmath>
 
 namespace aliceVision {
 namespace matching {
 
-struct HashedDescription {
-  // Hash code generated by the primary hashing function.
-  stl::dynamic_bitset hash_code;
-
-  // Each bucket_ids[x] = y means the descriptor belongs to bucket y in bucket
-  // group x.
+/**
+ * @brief Hash codes and buckets of a set of descriptions.
+ */
+struct HashedDescriptions
+{
+  // Number of 64-bit blocks of a hash code.
+  int nb_blocks_per_code = 0;
+  // Number of bucket groups.
+  int nb_bucket_groups = 0;
+  // Number of buckets in each group.
+  int nb_buckets_per_group = 0;
+
+  // Hash codes generated by the primary hashing function, packed contiguously:
+  // hash_codes[i * nb_blocks_per_code + b] is the block b of the hash code of the description i.
+  std::vector<uint64_t> hash_codes;
+
+  // bucket_ids[i * nb_bucket_groups + x] = y means the description i belongs to bucket y in bucket group x.
   std::vector<uint16_t> bucket_ids;
-};
 
-struct HashedDescriptions{
-  // The hash information.
-  std::vector<HashedDescription> hashed_desc;
+  // Description ids of the bucket y in bucket group x:
+  // bucket_descriptions[bucket_offsets[x * nb_buckets_per_group + y] .. bucket_offsets[x * nb_buckets_per_group + y + 1]]
+  std::vector<int> bucket_offsets;
+  std::vector<int> bucket_descriptions;
+
+  std::size_t size() const
+  {
+    return nb_blocks_per_code == 0 ? 0 : hash_codes.size() / nb_blocks_per_code;
+  }
+
+  const uint64_t* hashCode(int i) const
+  {
+    return &hash_codes[i * nb_blocks_per_code];
+  }
 
-  typedef std::vector<int> Bucket;
-  // buckets[bucket_group][bucket_id] = bucket (container of description ids).
-  std::vector<std::vector<Bucket> > buckets;
+  const uint16_t* bucketIds(int i) const
+  {
+    return &bucket_ids[i * nb_bucket_groups];
+  }
 };
 
 /**
@@ -93,27 +117,33 @@ public:
     // Here we use C++11 normal distribution random number generator
     std::normal_distribution<> d(0,1);
 
-    primary_hash_projection_.resize(nb_hash_code, nb_hash_code);
+    Eigen::MatrixXf primary_hash_projection(nb_hash_code, nb_hash_code);
 
     // Initialize primary hash projection.
     for (int i = 0; i < nb_hash_code; ++i)
     {
       for (int j = 0; j < nb_hash_code; ++j)
-        primary_hash_projection_(i, j) = d(generator);
+        primary_hash_projection(i, j) = d(generator);
     }
 
     // Initialize secondary hash projection.
-    secondary_hash_projection_.resize(nb_bucket_groups);
+    std::vector<Eigen::MatrixXf> secondary_hash_projection(nb_bucket_groups);
     for (int i = 0; i < nb_bucket_groups; ++i)
     {
-      secondary_hash_projection_[i].resize(nb_bits_per_bucket_,
+      secondary_hash_projection[i].resize(nb_bits_per_bucket_,
         nb_hash_code);
       for (int j = 0; j < nb_bits_per_bucket_; ++j)
       {
         for (int k = 0; k < nb_hash_code; ++k)
-          secondary_hash_projection_[i](j, k) = d(generator);
+          secondary_hash_projection[i](j, k) = d(generator);
       }
     }
+
+    // Stack all the projections in a single matrix (one projection per column)
+    hash_projections_.resize(nb_hash_code, nb_hash_code + nb_bucket_groups * nb_bits_per_bucket_);
+    hash_projections_.leftCols(nb_hash_code) = primary_hash_projection.transpose();
+    for (int i = 0; i < nb_bucket_groups; ++i)
+      hash_projections_.middleCols(nb_hash_code + i * nb_bits_per_bucket_, nb_bits_per_bucket_) = secondary_hash_projection[i].transpose();
     return true;
   }
 
@@ -155,61 +185,70 @@ public:
       return hashed_descriptions;
     }
 
+    const int nbDescriptions = static_cast<int>(descriptions.rows());
+    hashed_descriptions.nb_blocks_per_code = (nb_hash_code_ + 63) / 64;
+    hashed_descriptions.nb_bucket_groups = nb_bucket_groups_;
+    hashed_descriptions.nb_buckets_per_group = nb_buckets_per_group_;
+
     // Create hash codes for each description.
     {
-      // Allocate space for hash codes.
-      const typename MatrixT::Index nbDescriptions = descriptions.rows();
-      hashed_descriptions.hashed_desc.resize(nbDescriptions);
-      Eigen::VectorXf descriptor(descriptions.cols());
+      hashed_descriptions.hash_codes.assign(nbDescriptions * hashed_descriptions.nb_blocks_per_code, 0);
+      hashed_descriptions.bucket_ids.resize(nbDescriptions * nb_bucket_groups_);
+
+      const int nbProjections = static_cast<int>(hash_projections_.cols());
+      std::vector<float> projections(nbProjections);
       for (int i = 0; i < nbDescriptions; ++i)
       {
-        // Allocate space for each bucket id.
-        hashed_descriptions.hashed_desc[i].bucket_ids.resize(nb_bucket_groups_);
-
+        // Primary and secondary projections are computed at once,
+        // accumulating the columns of the projections (contiguous and vectorizable).
+        std::fill(projections.begin(), projections.end(), 0.0f);
         for (int k = 0; k < descriptions.cols(); ++k)
         {
-          descriptor(k) = descriptions(i,k);
+          const float value = static_cast<float>(descriptions(i, k)) - zero_mean_descriptor(k);
+          const float* projection = hash_projections_.data() + k * nbProjections;
+          for (int j = 0; j < nbProjections; ++j)
+            projections[j] += value * projection[j];
         }
-        descriptor -= zero_mean_descriptor;
-
-        auto& hash_code = hashed_descriptions.hashed_desc[i].hash_code;
-        hash_code = stl::dynamic_bitset(descriptions.cols());
 
         // Compute hash code.
-        const Eigen::VectorXf primary_projection = primary_hash_projection_ * descriptor;
+        uint64_t* hash_code = &hashed_descriptions.hash_codes[i * hashed_descriptions.nb_blocks_per_code];
         for (int j = 0; j < nb_hash_code_; ++j)
         {
-          hash_code[j] = primary_projection(j) > 0;
+          if (projections[j] > 0)
+            hash_code[j / 64] |= uint64_t(1) << (j % 64);
         }
 
         // Determine the bucket index for each group.
-        Eigen::VectorXf secondary_projection;
-        for (int j = 0; j < nb_bucket_groups_; ++j)
+        const float* secondary_projection = projections.data() + nb_hash_code_;
+        for (int j = 0; j < nb_bucket_groups_; ++j, secondary_projection += nb_bits_per_bucket_)
         {
           uint16_t bucket_id = 0;
-          secondary_projection = secondary_hash_projection_[j] * descriptor;
-
           for (int k = 0; k < nb_bits_per_bucket_; ++k)
           {
-            bucket_id = (bucket_id << 1) + (secondary_projection(k) > 0 ? 1 : 0);
+            bucket_id = (bucket_id << 1) + (secondary_projection[k] > 0 ? 1 : 0);
           }
-          hashed_descriptions.hashed_desc[i].bucket_ids[j] = bucket_id;
+          hashed_descriptions.bucket_ids[i * nb_bucket_groups_ + j] = bucket_id;
         }
       }
     }
-    // Build the Buckets
+    // Build the Buckets (counting sort of the description ids by bucket)
     {
-      hashed_descriptions.buckets.resize(nb_bucket_groups_);
-      for (int i = 0; i < nb_bucket_groups_; ++i)
+      std::vector<int>& offsets = hashed_descriptions.bucket_offsets;
+      offsets.assign(nb_bucket_groups_ * nb_buckets_per_group_ + 1, 0);
+      for (int i = 0; i < nbDescriptions; ++i)
       {
-        hashed_descriptions.buckets[i].resize(nb_buckets_per_group_);
+        for (int j = 0; j < nb_bucket_groups_; ++j)
+          ++offsets[j * nb_buckets_per_group_ + hashed_descriptions.bucket_ids[i * nb_bucket_groups_ + j] + 1];
+      }
+      std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
 
-        // Add the descriptor ID to the proper bucket group and id.
-        for (int j = 0; j < hashed_descriptions.hashed_desc.size(); ++j)
-        {
-          const uint16_t bucket_id = hashed_descriptions.hashed_desc[j].bucket_ids[i];
-          hashed_descriptions.buckets[i][bucket_id].push_back(j);
-        }
+      // Add the descriptor ID to the proper bucket group and id.
+      std::vector<int> positions(offsets.begin(), offsets.end() - 1);
+      hashed_descriptions.bucket_descriptions.resize(nbDescriptions * nb_bucket_groups_);
+      for (int i = 0; i < nbDescriptions; ++i)
+      {
+        for (int j = 0; j < nb_bucket_groups_; ++j)
+          hashed_descriptions.bucket_descriptions[positions[j * nb_buckets_per_group_ + hashed_descriptions.bucket_ids[i * nb_bucket_groups_ + j]]++] = i;
       }
     }
     return hashed_descriptions;
@@ -234,17 +273,26 @@ public:
 
     static const int kNumTopCandidates = 10;
 
+    if (hashed_descriptions2.size() == 0)
+      return;
+
+    const std::size_t nbDescriptions2 = hashed_descriptions2.size();
+    const int nb_blocks_per_code = hashed_descriptions1.nb_blocks_per_code;
+
     // Preallocate the candidate descriptors container.
     std::vector<int> candidate_descriptors;
-    candidate_descriptors.reserve(hashed_descriptions2.hashed_desc.size());
-
-    // Preallocated hamming distances. Each column indicates the hamming distance
-    // and the rows collect the descriptor ids with that
-    // distance. num_descriptors_with_hamming_distance keeps track of how many
-    // descriptors have that distance.
-    Eigen::MatrixXi candidate_hamming_distances(
-      hashed_descriptions2.hashed_desc.size(), nb_hash_code_ + 1);
-    Eigen::VectorXi num_descriptors_with_hamming_distance(nb_hash_code_ + 1);
+    candidate_descriptors.reserve(nbDescriptions2);
+
+    // Preallocate the hash codes of the candidates (stored contiguously for the SIMD hamming distances),
+    // their hamming distances and the candidates sorted by hamming distance.
+    std::vector<uint64_t> candidate_hash_codes;
+    candidate_hash_codes.reserve(nbDescriptions2 * nb_blocks_per_code);
+    std::vector<unsigned int> candidate_hamming_distances;
+    candidate_hamming_distances.reserve(nbDescriptions2);
+    std::vector<int> sorted_candidates;
+    sorted_candidates.reserve(nbDescriptions2);
+    // num_descriptors_with_hamming_distance keeps track of how many descriptors have each distance.
+    std::vector<int> num_descriptors_with_hamming_distance(nb_hash_code_ + 2);
 
     // Preallocate the container for keeping euclidean distances.
     std::vector<std::pair<DistanceType, int> > candidate_euclidean_distances;
@@ -252,25 +300,23 @@ public:
 
     // A preallocated vector to determine if we have already used a particular
     // feature for matching (i.e., prevents duplicates).
-    std::vector<bool> used_descriptor(hashed_descriptions2.hashed_desc.size());
+    std::vector<bool> used_descriptor(nbDescriptions2);
 
-    typedef feature::Hamming<stl::dynamic_bitset::BlockType> HammingMetricType;
-    static const HammingMetricType metricH = {};
-    for (int i = 0; i < hashed_descriptions1.hashed_desc.size(); ++i)
+    for (int i = 0; i < hashed_descriptions1.size(); ++i)
     {
       candidate_descriptors.clear();
-      num_descriptors_with_hamming_distance.setZero();
       candidate_euclidean_distances.clear();
 
-      const auto& hashed_desc = hashed_descriptions1.hashed_desc[i];
+      const uint16_t* bucket_ids = hashed_descriptions1.bucketIds(i);
 
       // Accumulate all descriptors in each bucket group that are in the same
       // bucket id as the query descriptor.
       for (int j = 0; j < nb_bucket_groups_; ++j)
       {
-        const uint16_t bucket_id = hashed_desc.bucket_ids[j];
-        for (const auto& feature_id : hashed_descriptions2.buckets[j][bucket_id])
+        const int bucket = j * nb_buckets_per_group_ + bucket_ids[j];
+        for (int b = hashed_descriptions2.bucket_offsets[bucket]; b < hashed_descriptions2.bucket_offsets[bucket + 1]; ++b)
         {
+          const int feature_id = hashed_descriptions2.bucket_descriptions[b];
           candidate_descriptors.emplace_back(feature_id);
           used_descriptor[feature_id] = false;
         }
@@ -282,42 +328,51 @@ public:
         continue;
       }
 
-      // Compute the hamming distance of all candidates based on the comp hash
-      // code. Put the descriptors into buckets corresponding to their hamming
-      // distance.
+      // Gather the hash codes of the unique candidates.
+      candidate_hash_codes.clear();
+      std::size_t nbUniqueCandidates = 0;
       for (const int candidate_id : candidate_descriptors)
       {
         if (!used_descriptor[candidate_id]) // avoid selecting the same candidate multiple times
         {
           used_descriptor[candidate_id] = true;
-
-          const HammingMetricType::ResultType hamming_distance = metricH(
-            hashed_desc.hash_code.data(),
-            hashed_descriptions2.hashed_desc[candidate_id].hash_code.data(),
-            hashed_desc.hash_code.num_blocks());
-          candidate_hamming_distances(
-              num_descriptors_with_hamming_distance(hamming_distance)++,
-              hamming_distance) = candidate_id;
+          candidate_descriptors[nbUniqueCandidates++] = candidate_id;
+          const uint64_t* hash_code = hashed_descriptions2.hashCode(candidate_id);
+          candidate_hash_codes.insert(candidate_hash_codes.end(), hash_code, hash_code + nb_blocks_per_code);
         }
       }
+      candidate_descriptors.resize(nbUniqueCandidates);
+
+      // Compute the hamming distance of all candidates based on the comp hash code.
+      candidate_hamming_distances.resize(nbUniqueCandidates);
+      feature::hammingDistances(
+        reinterpret_cast<const unsigned char*>(hashed_descriptions1.hashCode(i)),
+        reinterpret_cast<const unsigned char*>(candidate_hash_codes.data()),
+        nbUniqueCandidates, nb_blocks_per_code * sizeof(uint64_t),
+        candidate_hamming_distances.data());
+
+      // Sort the candidates by hamming distance (stable counting sort).
+      std::fill(num_descriptors_with_hamming_distance.begin(), num_descriptors_with_hamming_distance.end(), 0);
+      for (const unsigned int hamming_distance : candidate_hamming_distances)
+        ++num_descriptors_with_hamming_distance[hamming_distance + 1];
+      std::partial_sum(num_descriptors_with_hamming_distance.begin(), num_descriptors_with_hamming_distance.end(),
+                       num_descriptors_with_hamming_distance.begin());
+      sorted_candidates.resize(nbUniqueCandidates);
+      for (std::size_t c = 0; c < nbUniqueCandidates; ++c)
+        sorted_candidates[num_descriptors_with_hamming_distance[candidate_hamming_distances[c]]++] = candidate_descriptors[c];
 
       // Compute the euclidean distance of the k descriptors with the best hamming
       // distance.
-      candidate_euclidean_distances.reserve(kNumTopCandidates);
-      for (int j = 0; j < candidate_hamming_distances.cols() &&
-        (candidate_euclidean_distances.size() < kNumTopCandidates); ++j)
+      const std::size_t nbTopCandidates = std::min<std::size_t>(kNumTopCandidates, nbUniqueCandidates);
+      for (std::size_t c = 0; c < nbTopCandidates; ++c)
       {
-        for(int k = 0; k < num_descriptors_with_hamming_distance(j) &&
-          (candidate_euclidean_distances.size() < kNumTopCandidates); ++k)
-        {
-          const int candidate_id = candidate_hamming_distances(k, j);
-          const DistanceType distance = metric(
-            descriptions2.row(candidate_id).data(),
-            descriptions1.row(i).data(),
-            descriptions1.cols());
+        const int candidate_id = sorted_candidates[c];
+        const DistanceType distance = metric(
+          descriptions2.row(candidate_id).data(),
+          descriptions1.row(i).data(),
+          descriptions1.cols());
 
-          candidate_euclidean_distances.emplace_back(distance, candidate_id);
-        }
+        candidate_euclidean_distances.emplace_back(distance, candidate_id);
       }
 
       // Assert that each query is having at least NN retrieved neighbors
@@ -339,11 +394,8 @@ public:
   }
 
   private:
-  // Primary hashing function.
-  Eigen::MatrixXf primary_hash_projection_;
-
-  // Secondary hashing function.
-  std::vector<Eigen::MatrixXf> secondary_hash_projection_;
+  // Primary and secondary hashing functions stacked (one projection per column, row-major storage).
+  Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> hash_projections_;
 };
 
 }  // namespace matching
@@ -8,6 +8,7 @@
 #include "aliceVision/matching/matcherType.hpp"
 #include "aliceVision/matching/RegionsMatcher.hpp"
 #include "aliceVision/matching/ArrayMatcher_bruteForce.hpp"
+#include "aliceVision/matching/ArrayMatcher_bruteForceBlocked.hpp"
 #include "aliceVision/matching/ArrayMatcher_kdtreeFlann.hpp"
 #include "aliceVision/matching/ArrayMatcher_cascadeHashing.hpp"
 
@@ -96,6 +97,12 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(std::mt19937 & randomNumbe
           out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
         }
         break;
+        case BLOCKED_BRUTE_FORCE_L2:
+        {
+          typedef ArrayMatcher_bruteForceBlocked<unsigned char> MatcherT;
+          out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
+        }
+        break;
         default:
           ALICEVISION_LOG_WARNING("Using unknown matcher type");
       }
@@ -125,6 +132,12 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(std::mt19937 & randomNumbe
           out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
         }
         break;
+        case BLOCKED_BRUTE_FORCE_L2:
+        {
+          typedef ArrayMatcher_bruteForceBlocked<float> MatcherT;
+          out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
+        }
+        break;
         default:
           ALICEVISION_LOG_WARNING("Using unknown matcher type");
       }
@@ -152,6 +165,12 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(std::mt19937 & randomNumbe
           ALICEVISION_LOG_WARNING("Not yet implemented");
         }
         break;
+        case BLOCKED_BRUTE_FORCE_L2:
+        {
+          typedef ArrayMatcher_bruteForceBlocked<double> MatcherT;
+          out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
+        }
+        break;
         default:
           ALICEVISION_LOG_WARNING("Using unknown matcher type");
       }
@@ -16,6 +16,10 @@
 #include <boost/test/tools/floating_point_comparison.hpp>
 #include <boost/filesystem.hpp>
 
+#include <cstdint>
+#include <fstream>
+#include <limits>
+
 using namespace aliceVision;
 using namespace aliceVision::matching;
 using namespace aliceVision::feature;
@@ -108,6 +112,124 @@ BOOST_AUTO_TEST_CASE(IndMatch_IO)
   boost::filesystem::remove_all(testFolder);
 }
 
+BOOST_AUTO_TEST_CASE(IndMatch_IO_Binary)
+{
+  const std::string testFolder = "matchingBinTest";
+  boost::filesystem::create_directory(testFolder);
+  {
+    PairwiseMatches matches;
+    matches[std::make_pair(0,1)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1}};
+    matches[std::make_pair(0,1)][EImageDescriberType::SIFT] = {{5,6}};
+    matches[std::make_pair(1,2)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1},{2,2}};
+    matches[std::make_pair(2,3)][EImageDescriberType::UNKNOWN] = {};
+
+    BOOST_CHECK(Save(matches, testFolder, "bin", false));
+
+    // load all the pairs
+    PairwiseMatches loadedMatches;
+    BOOST_CHECK(Load(loadedMatches, {}, {testFolder}, {}));
+    BOOST_CHECK_EQUAL(3, loadedMatches.size());
+    BOOST_CHECK(matches.at(std::make_pair(0,1)).at(EImageDescriberType::SIFT) == loadedMatches.at(std::make_pair(0,1)).at(EImageDescriberType::SIFT));
+    BOOST_CHECK(matches.at(std::make_pair(1,2)).at(EImageDescriberType::UNKNOWN) == loadedMatches.at(std::make_pair(1,2)).at(EImageDescriberType::UNKNOWN));
+    BOOST_CHECK_EQUAL(0, loadedMatches.at(std::make_pair(2,3)).at(EImageDescriberType::UNKNOWN).size());
+
+    // load only the pairs between the given views
+    loadedMatches.clear();
+    BOOST_CHECK(LoadMatchFile(loadedMatches, (fs::path(testFolder) / "matches.bin").string(), {1, 2, 3}));
+    BOOST_CHECK_EQUAL(2, loadedMatches.size());
+    BOOST_CHECK_EQUAL(0, loadedMatches.count(std::make_pair(0,1)));
+    BOOST_CHECK_EQUAL(3, loadedMatches.at(std::make_pair(1,2)).at(EImageDescriberType::UNKNOWN).size());
+  }
+  boost::filesystem::remove_all(testFolder);
+  boost::filesystem::create_directory(testFolder);
+  {
+    // append pairs chunk by chunk
+    {
+      MatchesBinWriter writer((fs::path(testFolder) / "matches.bin").string());
+      MatchesPerDescType chunk;
+      chunk[EImageDescriberType::UNKNOWN] = {{3,4}};
+      writer.append(std::make_pair(4,5), chunk);
+      chunk[EImageDescriberType::UNKNOWN] = {{1,2},{2,3}};
+      writer.append(std::make_pair(0,5), chunk);
+      writer.close();
+    }
+
+    PairwiseMatches loadedMatches;
+    BOOST_CHECK(Load(loadedMatches, {0, 5}, {testFolder}, {EImageDescriberType::UNKNOWN}));
+    BOOST_CHECK_EQUAL(1, loadedMatches.size());
+    BOOST_CHECK_EQUAL(2, loadedMatches.at(std::make_pair(0,5)).at(EImageDescriberType::UNKNOWN).size());
+
+    // per image match files fall back on the binary format
+    fs::copy_file(fs::path(testFolder) / "matches.bin", fs::path(testFolder) / "0.bin");
+    loadedMatches.clear();
+    BOOST_CHECK_EQUAL(1, LoadMatchFilePerImage(loadedMatches, {0, 1}, testFolder, "txt"));
+    BOOST_CHECK_EQUAL(2, loadedMatches.size());
+  }
+  boost::filesystem::remove_all(testFolder);
+  boost::filesystem::create_directory(testFolder);
+  {
+    const std::string filepath = (fs::path(testFolder) / "matches.bin").string();
+    PairwiseMatches matches;
+    matches[std::make_pair(0,1)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1}};
+    {
+      MatchesBinWriter writer(filepath);
+      writer.append(matches.begin(), matches.end());
+      writer.close();
+    }
+
+    MatchesBinHeader header;
+    MatchesBinIndexEntry entry;
+    {
+      std::ifstream stream(filepath, std::ios::binary);
+      stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+      stream.seekg(header.indexOffset);
+      stream.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+    }
+    const auto writeCorrupted = [&](const MatchesBinHeader& corruptedHeader, const MatchesBinIndexEntry& corruptedEntry, std::uint64_t nbMatches)
+    {
+      std::fstream stream(filepath, std::ios::in | std::ios::out | std::ios::binary);
+      stream.write(reinterpret_cast<const char*>(&corruptedHeader), sizeof(corruptedHeader));
+      stream.seekp(header.indexOffset);
+      stream.write(reinterpret_cast<const char*>(&corruptedEntry), sizeof(corruptedEntry));
+      // number of matches of the single describer type of the pair
+      stream.seekp(entry.offset + 2 * sizeof(std::uint32_t) + EImageDescriberType_enumToString(EImageDescriberType::UNKNOWN).size());
+      stream.write(reinterpret_cast<const char*>(&nbMatches), sizeof(nbMatches));
+    };
+
+    PairwiseMatches loadedMatches;
+    BOOST_CHECK(LoadMatchFile(loadedMatches, filepath));
+
+    // too many pairs for the file size
+    MatchesBinHeader corruptedHeader = header;
+    corruptedHeader.nbPairs = std::numeric_limits<std::uint64_t>::max() / sizeof(MatchesBinIndexEntry);
+    writeCorrupted(corruptedHeader, entry, 2);
+    BOOST_CHECK(!LoadMatchFile(loadedMatches, filepath));
+
+    // index out of the file
+    corruptedHeader = header;
+    corruptedHeader.indexOffset = header.indexOffset + 1000;
+    writeCorrupted(corruptedHeader, entry, 2);
+    BOOST_CHECK(!LoadMatchFile(loadedMatches, filepath));
+
+    // pair chunk out of the file
+    MatchesBinIndexEntry corruptedEntry = entry;
+    corruptedEntry.offset = header.indexOffset + 1000;
+    writeCorrupted(header, corruptedEntry, 2);
+    BOOST_CHECK(!LoadMatchFile(loadedMatches, filepath));
+
+    // too many matches for the file size
+    writeCorrupted(header, entry, std::numeric_limits<std::uint64_t>::max() / 4);
+    BOOST_CHECK(!LoadMatchFile(loadedMatches, filepath));
+
+    // restored file
+    writeCorrupted(header, entry, 2);
+    loadedMatches.clear();
+    BOOST_CHECK(LoadMatchFile(loadedMatches, filepath));
+    BOOST_CHECK(matches == loadedMatches);
+  }
+  boost::filesystem::remove_all(testFolder);
+}
+
 BOOST_AUTO_TEST_CASE(IndMatch_DuplicateRemoval_NoRemoval)
 {
   std::vector<IndMatch> vec_indMatch;
@@ -13,6 +13,8 @@
 #include <boost/filesystem.hpp>
 #include <boost/range/iterator_range.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <map>
 #include <fstream>
 #include <iterator>
@@ -24,7 +26,214 @@ namespace fs = boost::filesystem;
 namespace aliceVision {
 namespace matching {
 
+MatchesBinWriter::MatchesBinWriter(const std::string& filepath)
+  : _filepath(filepath)
+{
+  const fs::path bPath = fs::path(filepath);
+  _tmpPath = (bPath.parent_path() / bPath.stem()).string() + "." + fs::unique_path().string() + bPath.extension().string();
+
+  _stream.open(_tmpPath, std::ios::out | std::ios::binary);
+  if(!_stream.is_open())
+    throw std::runtime_error("Can't save matches binary file, can't open '" + _tmpPath + "'.");
+
+  // the header is rewritten with the index location in close()
+  MatchesBinHeader header;
+  std::memset(&header, 0, sizeof(MatchesBinHeader));
+  _stream.write(reinterpret_cast<const char*>(&header), sizeof(MatchesBinHeader));
+}
+
+MatchesBinWriter::~MatchesBinWriter()
+{
+  if(_stream.is_open())
+  {
+    // close() has not been called: discard the incomplete file
+    _stream.close();
+    boost::system::error_code ec;
+    fs::remove(_tmpPath, ec);
+  }
+}
+
+void MatchesBinWriter::append(const Pair& pair, const MatchesPerDescType& matchesPerDesc)
+{
+  MatchesBinIndexEntry entry;
+  entry.I = pair.first;
+  entry.J = pair.second;
+  entry.offset = static_cast<std::uint64_t>(_stream.tellp());
+  _index.push_back(entry);
+
+  const std::uint32_t nbDescType = static_cast<std::uint32_t>(matchesPerDesc.size());
+  _stream.write(reinterpret_cast<const char*>(&nbDescType), sizeof(nbDescType));
+
+  std::vector<std::uint32_t> buffer;
+  for(const auto& m: matchesPerDesc)
+  {
+    const std::string descTypeStr = feature::EImageDescriberType_enumToString(m.first);
+    const std::uint32_t descTypeLength = static_cast<std::uint32_t>(descTypeStr.size());
+    const std::uint64_t nbMatches = m.second.size();
+
+    _stream.write(reinterpret_cast<const char*>(&descTypeLength), sizeof(descTypeLength));
+    _stream.write(descTypeStr.data(), descTypeLength);
+    _stream.write(reinterpret_cast<const char*>(&nbMatches), sizeof(nbMatches));
+
+    buffer.resize(2 * nbMatches);
+    for(std::size_t i = 0; i < nbMatches; ++i)
+    {
+      buffer[2 * i] = m.second[i]._i;
+      buffer[2 * i + 1] = m.second[i]._j;
+    }
+    _stream.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(std::uint32_t));
+  }
+
+  if(!_stream)
+    throw std::runtime_error("Can't save matches binary file, error while writing '" + _tmpPath + "'.");
+}
+
+void MatchesBinWriter::append(const PairwiseMatches::const_iterator& matchBegin, const PairwiseMatches::const_iterator& matchEnd)
+{
+  for(PairwiseMatches::const_iterator match = matchBegin; match != matchEnd; ++match)
+    append(match->first, match->second);
+}
+
+void MatchesBinWriter::close()
+{
+  // sort the index to allow lookups by pair
+  std::sort(_index.begin(), _index.end(), [](const MatchesBinIndexEntry& a, const MatchesBinIndexEntry& b)
+  {
+    return std::make_pair(a.I, a.J) < std::make_pair(b.I, b.J);
+  });
+
+  MatchesBinHeader header;
+  std::memset(&header, 0, sizeof(MatchesBinHeader));
+  std::memcpy(header.magic, MatchesBinHeader::MAGIC, sizeof(header.magic));
+  header.version = MatchesBinHeader::CURRENT_VERSION;
+  header.nbPairs = _index.size();
+  header.indexOffset = static_cast<std::uint64_t>(_stream.tellp());
+
+  _stream.write(reinterpret_cast<const char*>(_index.data()), _index.size() * sizeof(MatchesBinIndexEntry));
+  _stream.seekp(0);
+  _stream.write(reinterpret_cast<const char*>(&header), sizeof(MatchesBinHeader));
+
+  if(!_stream)
+    throw std::runtime_error("Can't save matches binary file, error while writing '" + _tmpPath + "'.");
+
+  _stream.close();
+
+  // rename temporary file
+  fs::rename(_tmpPath, _filepath);
+}
+
+/**
+ * @brief Load the pairs of a binary matches file.
+ *        The pair index is read first, then only the chunks of the kept pairs are read.
+ * @param[out] matches container for the output matches
+ * @param[in] filepath the binary match file to load
+ * @param[in] viewsKeysFilter restrict the matches to these views (empty keeps all the pairs)
+ */
+bool loadBinMatchFile(PairwiseMatches& matches, const std::string& filepath, const std::set<IndexT>& viewsKeysFilter)
+{
+  std::ifstream stream(filepath, std::ios::in | std::ios::binary | std::ios::ate);
+  if(!stream.is_open())
+    return false;
+
+  // the sizes read from the file are checked against the file size before any allocation
+  const std::uint64_t fileSize = static_cast<std::uint64_t>(stream.tellg());
+  stream.seekg(0);
+
+  MatchesBinHeader header;
+  stream.read(reinterpret_cast<char*>(&header), sizeof(MatchesBinHeader));
+  if(!stream || std::strncmp(header.magic, MatchesBinHeader::MAGIC, sizeof(header.magic)) != 0)
+  {
+    ALICEVISION_LOG_WARNING("Invalid binary matches file: " << filepath);
+    return false;
+  }
+  if(header.version > MatchesBinHeader::CURRENT_VERSION)
+  {
+    ALICEVISION_LOG_WARNING("Unsupported binary matches file version (" << header.version << "): " << filepath);
+    return false;
+  }
+
+  if(header.indexOffset < sizeof(MatchesBinHeader) || header.indexOffset > fileSize ||
+     header.nbPairs > (fileSize - header.indexOffset) / sizeof(MatchesBinIndexEntry))
+  {
+    ALICEVISION_LOG_WARNING("Corrupted binary matches file index: " << filepath);
+    return false;
+  }
+
+  std::vector<MatchesBinIndexEntry> index(header.nbPairs);
+  stream.seekg(header.indexOffset);
+  stream.read(reinterpret_cast<char*>(index.data()), index.size() * sizeof(MatchesBinIndexEntry));
+  if(!stream)
+  {
+    ALICEVISION_LOG_WARNING("Truncated binary matches file: " << filepath);
+    return false;
+  }
+
+  std::vector<std::uint32_t> buffer;
+  for(const MatchesBinIndexEntry& entry: index)
+  {
+    if(!viewsKeysFilter.empty() &&
+       (viewsKeysFilter.find(entry.I) == viewsKeysFilter.end() ||
+        viewsKeysFilter.find(entry.J) == viewsKeysFilter.end()))
+      continue;
+
+    // the pair chunks are stored between the header and the index
+    if(entry.offset < sizeof(MatchesBinHeader) || entry.offset >= header.indexOffset)
+    {
+      ALICEVISION_LOG_WARNING("Corrupted binary matches file index: " << filepath);
+      return false;
+    }
+    stream.seekg(entry.offset);
+
+    std::uint32_t nbDescType = 0;
+    stream.read(reinterpret_cast<char*>(&nbDescType), sizeof(nbDescType));
+
+    MatchesPerDescType& matchesPerDesc = matches[std::make_pair(entry.I, entry.J)];
+    for(std::uint32_t d = 0; d < nbDescType && stream; ++d)
+    {
+      std::uint32_t descTypeLength = 0;
+      stream.read(reinterpret_cast<char*>(&descTypeLength), sizeof(descTypeLength));
+      if(!stream || descTypeLength > header.indexOffset - static_cast<std::uint64_t>(stream.tellg()))
+      {
+        stream.setstate(std::ios::failbit);
+        break;
+      }
+      std::string descTypeStr(descTypeLength, '\0');
+      stream.read(&descTypeStr[0], descTypeLength);
+      std::uint64_t nbMatches = 0;
+      stream.read(reinterpret_cast<char*>(&nbMatches), sizeof(nbMatches));
+      if(!stream || nbMatches > (header.indexOffset - static_cast<std::uint64_t>(stream.tellg())) / (2 * sizeof(std::uint32_t)))
+      {
+        stream.setstate(std::ios::failbit);
+        break;
+      }
+
+      buffer.resize(2 * nbMatches);
+      stream.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(std::uint32_t));
+
+      std::vector<IndMatch> matchesPerDescType(nbMatches);
+      for(std::size_t i = 0; i < nbMatches; ++i)
+      {
+        matchesPerDescType[i]._i = buffer[2 * i];
+        matchesPerDescType[i]._j = buffer[2 * i + 1];
+      }
+      matchesPerDesc[feature::EImageDescriberType_stringToEnum(descTypeStr)] = std::move(matchesPerDescType);
+    }
+
+    if(!stream)
+    {
+      ALICEVISION_LOG_WARNING("Truncated or corrupted binary matches file: " << filepath);
+      return false;
+    }
+  }
+  return true;
+}
+
 bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath)
+{
+  return LoadMatchFile(matches, filepath, std::set<IndexT>());
+}
+
+bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath, const std::set<IndexT>& viewsKeysFilter)
 {
   const std::string ext = fs::extension(filepath);
 
@@ -65,12 +274,20 @@ bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath)
         {
           stream >> matchesPerDesc[i];
         }
+        if(!viewsKeysFilter.empty() &&
+           (viewsKeysFilter.find(I) == viewsKeysFilter.end() ||
+            viewsKeysFilter.find(J) == viewsKeysFilter.end()))
+          continue;
         matches[std::make_pair(I,J)][descType] = std::move(matchesPerDesc);
       }
     }
     stream.close();
     return true;
   }
+  else if(ext == ".bin")
+  {
+    return loadBinMatchFile(matches, filepath, viewsKeysFilter);
+  }
   else
   {
     ALICEVISION_LOG_WARNING("Unknown matching file format: " << ext);
@@ -137,13 +354,20 @@ std::size_t LoadMatchFilePerImage(PairwiseMatches& matches,
 {
   int nbLoadedMatchFiles = 0;
   // Load one match file per image
-  #pragma omp parallel for num_threads(3)
+  #pragma omp parallel for
   for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(viewsKeys.size()); ++i)
   {
     std::set<IndexT>::const_iterator it = viewsKeys.begin();
     std::advance(it, i);
     const IndexT idView = *it;
-    const std::string matchFilename = std::to_string(idView) + "." + extension;
+    std::string matchFilename = std::to_string(idView) + "." + extension;
+    // fall back on the other file format if there is no match file with the requested extension
+    if(!fs::exists(fs::path(folder) / matchFilename))
+    {
+      const fs::path otherFormat = fs::path(matchFilename).replace_extension(fs::extension(matchFilename) == ".bin" ? ".txt" : ".bin");
+      if(fs::exists(fs::path(folder) / otherFormat))
+        matchFilename = otherFormat.string();
+    }
     PairwiseMatches fileMatches;
     if(!LoadMatchFile(fileMatches, (fs::path(folder) / matchFilename).string() ))
     {
@@ -167,31 +391,40 @@ std::size_t LoadMatchFilePerImage(PairwiseMatches& matches,
 }
 
 /**
- * Load and add pair-wise matches to \p matches from all files in \p folder matching \p pattern.
+ * Load and add pair-wise matches to \p matches from all files in \p folder matching one of \p patterns.
  * @param[out] matches PairwiseMatches to add loaded matches to
  * @param[in] folder Folder to load matches files from
- * @param[in] pattern Pattern that files must respect to be loaded
+ * @param[in] patterns Patterns that files must respect to be loaded (at least one of them)
+ * @param[in] viewsKeysFilter Restrict the matches to these views (empty keeps all the pairs)
  */
-std::size_t loadMatchesFromFolder(PairwiseMatches& matches, const std::string& folder, const std::string& pattern)
+std::size_t loadMatchesFromFolder(PairwiseMatches& matches,
+                                  const std::string& folder,
+                                  const std::vector<std::string>& patterns,
+                                  const std::set<IndexT>& viewsKeysFilter)
 {
   std::size_t nbLoadedMatchFiles = 0;
   std::vector<std::string> matchFiles;
-  // list all matches files in 'folder' matching (i.e containing) 'pattern'
+  // list all matches files in 'folder' matching (i.e containing) one of the 'patterns'
   for(const auto& entry : boost::make_iterator_range(fs::directory_iterator(folder), {}))
   {
-    if(entry.path().string().find(pattern) != std::string::npos)
+    const std::string path = entry.path().string();
+    for(const std::string& pattern : patterns)
     {
-      matchFiles.push_back(entry.path().string());
+      if(path.find(pattern) != std::string::npos)
+      {
+        matchFiles.push_back(path);
+        break;
+      }
     }
   }
 
-  #pragma omp parallel for num_threads(3)
-  for(int i = 0; i < matchFiles.size(); ++i)
+  #pragma omp parallel for
+  for(int i = 0; i < static_cast<int>(matchFiles.size()); ++i)
   {
     const std::string& matchFile = matchFiles[i];
     PairwiseMatches fileMatches;
     ALICEVISION_LOG_DEBUG("Loading match file: " << matchFile);
-    if(!LoadMatchFile(fileMatches, matchFile))
+    if(!LoadMatchFile(fileMatches, matchFile, viewsKeysFilter))
     {
       ALICEVISION_LOG_WARNING("Unable to load match file: " << matchFile);
       continue;
@@ -230,7 +463,7 @@ bool Load(PairwiseMatches& matches,
           int minNbMatches)
 {
   std::size_t nbLoadedMatchFiles = 0;
-  const std::string pattern = "matches.txt";
+  const std::vector<std::string> patterns = {"matches.txt", "matches.bin"};
 
   // build up a set with normalized paths to remove duplicates
   std::set<std::string> foldersSet;
@@ -244,7 +477,7 @@ bool Load(PairwiseMatches& matches,
 
   for(const auto& folder : foldersSet)
   {
-    nbLoadedMatchFiles += loadMatchesFromFolder(matches, folder, pattern);
+    nbLoadedMatchFiles += loadMatchesFromFolder(matches, folder, patterns, viewsKeysFilter);
   }
 
   if(!nbLoadedMatchFiles)
@@ -315,6 +548,16 @@ private:
     fs::rename(tmpPath, filepath);
   }
 
+  void saveBin(
+    const std::string& filepath,
+    const PairwiseMatches::const_iterator& matchBegin,
+    const PairwiseMatches::const_iterator& matchEnd)
+  {
+    MatchesBinWriter writer(filepath);
+    writer.append(matchBegin, matchEnd);
+    writer.close();
+  }
+
 public:
   MatchExporter(
     const PairwiseMatches& matches,
@@ -334,6 +577,8 @@ public:
 
     if(m_ext == ".txt")
       saveTxt(filepath, m_matches.begin(), m_matches.end());
+    else if(m_ext == ".bin")
+      saveBin(filepath, m_matches.begin(), m_matches.end());
     else
       throw std::runtime_error(std::string("Unknown matching file format: ") + m_ext);
   }
@@ -359,6 +604,8 @@ public:
       
       if(m_ext == ".txt")
         saveTxt(filepath, matchBegin, match);
+      else if(m_ext == ".bin")
+        saveBin(filepath, matchBegin, match);
       else
         throw std::runtime_error(std::string("Unknown matching file format: ") + m_ext);
 
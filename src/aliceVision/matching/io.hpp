@@ -9,11 +9,95 @@
 
 #include <aliceVision/matching/IndMatch.hpp>
 
+#include <cstdint>
+#include <fstream>
+#include <set>
 #include <string>
+#include <vector>
 
 namespace aliceVision {
 namespace matching {
 
+/**
+ * @brief Header of the binary matches file format (.matches.bin).
+ *
+ * The header is followed by one chunk per image pair:
+ *   nbDescType (uint32)
+ *   for each describer type:
+ *     descTypeLength (uint32), descType (chars), matchesCount (uint64), matchesCount * [i (uint32), j (uint32)]
+ * The file ends with a table of \p nbPairs MatchesBinIndexEntry (sorted by pair) located at \p indexOffset,
+ * so a reader can fetch the chunk of a given pair without parsing the whole file.
+ */
+struct MatchesBinHeader
+{
+  /// magic number used to identify binary matches files
+  static constexpr const char* MAGIC = "AVMATCHB";
+  static constexpr std::uint32_t CURRENT_VERSION = 1;
+
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t reserved;
+  std::uint64_t nbPairs;
+  std::uint64_t indexOffset;
+};
+
+static_assert(sizeof(MatchesBinHeader) == 32, "The binary matches header must be 32 bytes.");
+
+/**
+ * @brief Entry of the pair index of a binary matches file.
+ */
+struct MatchesBinIndexEntry
+{
+  std::uint32_t I;
+  std::uint32_t J;
+  /// offset in bytes of the pair chunk from the beginning of the file
+  std::uint64_t offset;
+};
+
+static_assert(sizeof(MatchesBinIndexEntry) == 16, "The binary matches index entry must be 16 bytes.");
+
+/**
+ * @brief Stream pairwise matches to a binary matches file.
+ *
+ * Pairs are appended chunk by chunk, so the caller does not need to hold
+ * all the matches in memory. The data is written in a temporary file which
+ * is renamed to \p filepath with the pair index when close() is called.
+ */
+class MatchesBinWriter
+{
+public:
+  explicit MatchesBinWriter(const std::string& filepath);
+  ~MatchesBinWriter();
+
+  MatchesBinWriter(const MatchesBinWriter&) = delete;
+  MatchesBinWriter& operator=(const MatchesBinWriter&) = delete;
+
+  /**
+   * @brief Append the matches of one image pair.
+   * @param[in] pair the image pair
+   * @param[in] matchesPerDesc the matches of the pair for each describer type
+   */
+  void append(const Pair& pair, const MatchesPerDescType& matchesPerDesc);
+
+  /**
+   * @brief Append a chunk of pairwise matches.
+   * @param[in] matchBegin first pair of the chunk
+   * @param[in] matchEnd end of the chunk
+   */
+  void append(const PairwiseMatches::const_iterator& matchBegin, const PairwiseMatches::const_iterator& matchEnd);
+
+  /**
+   * @brief Write the pair index and move the file to its final location.
+   */
+  void close();
+
+private:
+  std::string _filepath;
+  std::string _tmpPath;
+  std::ofstream _stream;
+  std::vector<MatchesBinIndexEntry> _index;
+};
+
 
 /**
  * @brief Load a match file.
@@ -23,12 +107,23 @@ namespace matching {
  */
 bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath);
 
+/**
+ * @brief Load a match file, keeping only the pairs whose both views are in \p viewsKeysFilter.
+ *        With the binary format, only the chunks of the kept pairs are read from the file.
+ *
+ * @param[out] matches container for the output matches
+ * @param[in] filepath the match file to load
+ * @param[in] viewsKeysFilter restrict the matches to these views (empty keeps all the pairs)
+ */
+bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath, const std::set<IndexT>& viewsKeysFilter);
+
 /**
  * @brief Load the match file for each image.
  * @param[out] matches container for the output matches.
  * @param[in] viewsKeys the list of views whose match files need to be loaded.
  * @param[in] folder the folder where to look for all the files.
- * @param[in] extension the extension of the match file.
+ * @param[in] extension the extension of the match file,
+ *            the binary (.bin) or text (.txt) file is loaded instead if there is no file with this extension.
  * @return the number of match file actually loaded (if a file cannot be loaded it is discarded)
  */
 std::size_t LoadMatchFilePerImage(PairwiseMatches& matches,
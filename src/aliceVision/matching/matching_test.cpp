@@ -7,9 +7,12 @@
 
 #include "aliceVision/numeric/numeric.hpp"
 #include "aliceVision/matching/ArrayMatcher_bruteForce.hpp"
+#include "aliceVision/matching/ArrayMatcher_bruteForceBlocked.hpp"
 #include "aliceVision/matching/ArrayMatcher_kdtreeFlann.hpp"
 #include "aliceVision/matching/ArrayMatcher_cascadeHashing.hpp"
 #include <iostream>
+#include <random>
+#include <vector>
 
 #define BOOST_TEST_MODULE matching
 
@@ -169,3 +172,169 @@ BOOST_AUTO_TEST_CASE(Matching_Cascade_Hashing_Simple_EmptyArrays)
   float fDistance = -1.0f;
   BOOST_CHECK(! matcher.SearchNeighbour( &array[0], &nIndice, &fDistance) );
 }
+
+BOOST_AUTO_TEST_CASE(Matching_CascadeHasher_NoisyDuplicates)
+{
+  typedef Eigen::Matrix<unsigned char, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> BaseMat;
+
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::uniform_int_distribution<int> noise(-2, 2);
+
+  // the queries are noisy copies of the database descriptors
+  const int dimension = 128;
+  const int nbData = 1000;
+  BaseMat data(nbData, dimension);
+  BaseMat queries(nbData, dimension);
+  for(int i = 0; i < nbData; ++i)
+  {
+    for(int j = 0; j < dimension; ++j)
+    {
+      data(i, j) = static_cast<unsigned char>(distribution(gen));
+      queries(i, j) = static_cast<unsigned char>(std::min(255, std::max(0, data(i, j) + noise(gen))));
+    }
+  }
+
+  CascadeHasher cascadeHasher;
+  cascadeHasher.Init(gen, dimension);
+  const Eigen::VectorXf zeroMeanDescriptor = CascadeHasher::GetZeroMeanDescriptor(data);
+  const HashedDescriptions hashedData = cascadeHasher.CreateHashedDescriptions(data, zeroMeanDescriptor);
+  const HashedDescriptions hashedQueries = cascadeHasher.CreateHashedDescriptions(queries, zeroMeanDescriptor);
+
+  BOOST_CHECK_EQUAL(nbData, hashedData.size());
+  BOOST_CHECK_EQUAL(nbData * hashedData.nb_bucket_groups, hashedData.bucket_descriptions.size());
+  BOOST_CHECK_EQUAL(nbData * hashedData.nb_bucket_groups, hashedData.bucket_offsets.back());
+
+  IndMatches indices;
+  std::vector<float> distances;
+  cascadeHasher.Match_HashedDescriptions<BaseMat, float>(hashedQueries, queries, hashedData, data, &indices, &distances);
+
+  BOOST_REQUIRE_EQUAL(indices.size(), distances.size());
+  BOOST_CHECK(indices.size() > nbData); // most queries have at least 2 candidates
+
+  // the nearest neighbour is the original descriptor
+  for(std::size_t i = 0; i < indices.size(); i += 2)
+  {
+    BOOST_CHECK_EQUAL(indices[i]._i, indices[i]._j);
+    BOOST_CHECK(distances[i] <= distances[i + 1]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_bruteForceBlocked_NN)
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  const float array[] = {0, 1, 2, 5, 6};
+  ArrayMatcher_bruteForceBlocked<float> matcher;
+  BOOST_CHECK( matcher.Build(gen, array, 5, 1) );
+
+  const float query[] = {2};
+  IndMatches vec_nIndice;
+  std::vector<float> vec_fDistance;
+  BOOST_CHECK( matcher.SearchNeighbours(query,1, &vec_nIndice, &vec_fDistance, 5) );
+
+  BOOST_CHECK_EQUAL( 5, vec_nIndice.size());
+  BOOST_CHECK_EQUAL( 5, vec_fDistance.size());
+
+  // Check distances:
+  BOOST_CHECK_SMALL(static_cast<double>(vec_fDistance[0]- Square(2.0f-2.0f)), 1e-6);
+  BOOST_CHECK_SMALL(static_cast<double>(vec_fDistance[1]- Square(1.0f-2.0f)), 1e-6);
+  BOOST_CHECK_SMALL(static_cast<double>(vec_fDistance[2]- Square(0.0f-2.0f)), 1e-6);
+  BOOST_CHECK_SMALL(static_cast<double>(vec_fDistance[3]- Square(5.0f-2.0f)), 1e-6);
+  BOOST_CHECK_SMALL(static_cast<double>(vec_fDistance[4]- Square(6.0f-2.0f)), 1e-6);
+
+  // Check indexes:
+  BOOST_CHECK_EQUAL(IndMatch(0,2), vec_nIndice[0]);
+  BOOST_CHECK_EQUAL(IndMatch(0,1), vec_nIndice[1]);
+  BOOST_CHECK_EQUAL(IndMatch(0,0), vec_nIndice[2]);
+  BOOST_CHECK_EQUAL(IndMatch(0,3), vec_nIndice[3]);
+  BOOST_CHECK_EQUAL(IndMatch(0,4), vec_nIndice[4]);
+
+  // too many neighbours
+  BOOST_CHECK( !matcher.SearchNeighbours(query,1, &vec_nIndice, &vec_fDistance, 6) );
+  // no neighbour
+  BOOST_CHECK( !matcher.SearchNeighbours(query,1, &vec_nIndice, &vec_fDistance, 0) );
+}
+
+BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_bruteForceBlocked_SameAsBruteForce)
+{
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<int> distribution(0, 255);
+
+  // several blocks of queries and database descriptors
+  const int dimension = 128;
+  const int nbData = 2500;
+  const int nbQuery = 600;
+  std::vector<unsigned char> data(nbData * dimension);
+  std::vector<unsigned char> queries(nbQuery * dimension);
+  for(unsigned char& value : data)
+    value = static_cast<unsigned char>(distribution(gen));
+  for(unsigned char& value : queries)
+    value = static_cast<unsigned char>(distribution(gen));
+
+  ArrayMatcher_bruteForce<unsigned char, feature::L2_Vectorized<unsigned char>> matcher;
+  ArrayMatcher_bruteForceBlocked<unsigned char> matcherBlocked;
+  BOOST_CHECK( matcher.Build(gen, data.data(), nbData, dimension) );
+  BOOST_CHECK( matcherBlocked.Build(gen, data.data(), nbData, dimension) );
+
+  IndMatches indices, indicesBlocked;
+  std::vector<float> distances, distancesBlocked;
+  BOOST_CHECK( matcher.SearchNeighbours(queries.data(), nbQuery, &indices, &distances, 2) );
+  BOOST_CHECK( matcherBlocked.SearchNeighbours(queries.data(), nbQuery, &indicesBlocked, &distancesBlocked, 2) );
+
+  BOOST_REQUIRE_EQUAL(distances.size(), distancesBlocked.size());
+  for(std::size_t i = 0; i < distances.size(); i += 2)
+  {
+    // unsigned char distances are exact
+    BOOST_CHECK_EQUAL(distances[i], distancesBlocked[i]);
+    BOOST_CHECK_EQUAL(distances[i + 1], distancesBlocked[i + 1]);
+    // the order of the neighbours is only defined without ties
+    if(distances[i] != distances[i + 1])
+    {
+      BOOST_CHECK_EQUAL(indices[i], indicesBlocked[i]);
+      BOOST_CHECK_EQUAL(indices[i + 1], indicesBlocked[i + 1]);
+    }
+  }
+}
+
+template <typename Scalar>
+void checkBlockedSameAsBruteForce()
+{
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<Scalar> distribution(0, 1);
+
+  // a dimension not multiple of the register sizes
+  const int dimension = 61;
+  const int nbData = 1500;
+  const int nbQuery = 300;
+  std::vector<Scalar> data(nbData * dimension);
+  std::vector<Scalar> queries(nbQuery * dimension);
+  for(Scalar& value : data)
+    value = distribution(gen);
+  for(Scalar& value : queries)
+    value = distribution(gen);
+
+  ArrayMatcher_bruteForce<Scalar, feature::L2_Vectorized<Scalar>> matcher;
+  ArrayMatcher_bruteForceBlocked<Scalar> matcherBlocked;
+  BOOST_CHECK( matcher.Build(gen, data.data(), nbData, dimension) );
+  BOOST_CHECK( matcherBlocked.Build(gen, data.data(), nbData, dimension) );
+
+  IndMatches indices, indicesBlocked;
+  std::vector<Scalar> distances, distancesBlocked;
+  BOOST_CHECK( matcher.SearchNeighbours(queries.data(), nbQuery, &indices, &distances, 2) );
+  BOOST_CHECK( matcherBlocked.SearchNeighbours(queries.data(), nbQuery, &indicesBlocked, &distancesBlocked, 2) );
+
+  BOOST_REQUIRE_EQUAL(distances.size(), distancesBlocked.size());
+  for(std::size_t i = 0; i < distances.size(); ++i)
+  {
+    BOOST_CHECK_CLOSE(distances[i], distancesBlocked[i], 1e-2);
+    BOOST_CHECK_EQUAL(indices[i], indicesBlocked[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_bruteForceBlocked_SameAsBruteForce_Float)
+{
+  checkBlockedSameAsBruteForce<float>();
+  checkBlockedSameAsBruteForce<double>();
+}
@@ -13,12 +13,12 @@
 namespace aliceVision  {
 namespace matching {
 
-/// Display pair wises matches as an Adjacency matrix in svg format
+/// Display the image pairs with matches as an Adjacency matrix in svg format
 inline void PairwiseMatchingToAdjacencyMatrixSVG(const size_t NbImages,
-  const matching::PairwiseMatches & map_Matches,
+  const PairSet & matchedPairs,
   const std::string & sOutName)
 {
-  if ( !map_Matches.empty())
+  if ( !matchedPairs.empty())
   {
     float scaleFactor = 5.0f;
     svg::svgDrawer svgStream((NbImages+3)*5, (NbImages+3)*5);
@@ -26,12 +26,8 @@ inline void PairwiseMatchingToAdjacencyMatrixSVG(const size_t NbImages,
     for (size_t I = 0; I < NbImages; ++I) {
       for (size_t J = 0; J < NbImages; ++J) {
         // If the pair have matches display a blue boxes at I,J position.
-        matching::PairwiseMatches::const_iterator iterSearch = map_Matches.find(std::make_pair(I,J));
-        if (iterSearch != map_Matches.end() && !iterSearch->second.empty())
+        if (matchedPairs.count(Pair(I,J)))
         {
-          // Display as a tooltip: (IndexI, IndexJ NbMatches)
-          std::ostringstream os;
-          os << "(" << J << "," << I << " " << iterSearch->second.getNbAllMatches() <<")";
           svgStream.drawSquare(J*scaleFactor, I*scaleFactor, scaleFactor/2.0f,
             svg::svgStyle().fill("blue").noStroke());
         } // HINT : THINK ABOUT OPACITY [0.4 -> 1.0] TO EXPRESS MATCH COUNT
@@ -59,5 +55,19 @@ inline void PairwiseMatchingToAdjacencyMatrixSVG(const size_t NbImages,
   }
 }
 
+/// Display pair wises matches as an Adjacency matrix in svg format
+inline void PairwiseMatchingToAdjacencyMatrixSVG(const size_t NbImages,
+  const matching::PairwiseMatches & map_Matches,
+  const std::string & sOutName)
+{
+  PairSet matchedPairs;
+  for (const auto & matches : map_Matches)
+  {
+    if (!matches.second.empty())
+      matchedPairs.insert(matches.first);
+  }
+  PairwiseMatchingToAdjacencyMatrixSVG(NbImages, matchedPairs, sOutName);
+}
+
 } // namespace matching
 } // namespace aliceVision
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/feature/PointFeature.hpp>
 #include <aliceVision/feature/RegionsPerView.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
@@ -15,6 +16,7 @@
 
 #include <boost/progress.hpp>
 
+#include <random>
 #include <vector>
 #include <map>
 
@@ -28,6 +30,8 @@ using namespace aliceVision::matching;
  * or all the pairs and regions correspondences contained in the putativeMatches set.
  * Allow to keep only geometrically coherent matches.
  * It discards pairs that do not lead to a valid robust model estimation.
+ * The pairs are processed in parallel, each pair uses its own random number generator
+ * seeded from the pair, so the results do not depend on the number of threads.
  * @param[out] geometricMatches
  * @param[in] sfmData
  * @param[in] regionsPerView
@@ -35,7 +39,7 @@ using namespace aliceVision::matching;
  * @param[in] putativeMatches
  * @param[in] guidedMatching
  * @param[in] distanceRatio
- * @param[in] randomNumberGenerator
+ * @param[in] randomNumberGenerator only used to draw the seed of the pairs random number generators
  */
 template<typename GeometryFunctor>
 void robustModelEstimation(
@@ -52,22 +56,33 @@ void robustModelEstimation(
   out_geometricMatches.clear();
 
   boost::progress_display progressBar(putativeMatches.size(), std::cout, "Robust Model Estimation\n");
-  
+
+  // flat list of the pairs
+  std::vector<PairwiseMatches::const_iterator> pairsMatches;
+  pairsMatches.reserve(putativeMatches.size());
+  for(PairwiseMatches::const_iterator iter = putativeMatches.begin(); iter != putativeMatches.end(); ++iter)
+    pairsMatches.push_back(iter);
+
+  const std::mt19937::result_type seed = randomNumberGenerator();
+
+  // geometric matches of each thread
+  std::vector<std::vector<std::pair<Pair, MatchesPerDescType>>> threadsGeometricMatches(omp_get_max_threads());
+
 #pragma omp parallel for schedule(dynamic)
-  for (int i = 0; i < (int)putativeMatches.size(); ++i)
+  for (int i = 0; i < (int)pairsMatches.size(); ++i)
   {
-    PairwiseMatches::const_iterator iter = putativeMatches.begin();
-    std::advance(iter, i);
+    const Pair& imagePair = pairsMatches[i]->first;
+    const MatchesPerDescType& putativeMatchesPerType = pairsMatches[i]->second;
 
-    const Pair currentPair = iter->first;
-    const MatchesPerDescType& putativeMatchesPerType = iter->second;
-    const Pair& imagePair = iter->first;
+    // random number generator of the pair
+    std::seed_seq pairSeed{seed, std::mt19937::result_type(imagePair.first), std::mt19937::result_type(imagePair.second)};
+    std::mt19937 pairRandomNumberGenerator(pairSeed);
 
     // apply the geometric filter (robust model estimation)
     {
       MatchesPerDescType inliers;
       GeometryFunctor geometricFilter = functor; // use a copy since we are in a multi-thread context
-      const EstimationStatus state = geometricFilter.geometricEstimation(sfmData, regionsPerView, imagePair, putativeMatchesPerType, randomNumberGenerator, inliers);
+      const EstimationStatus state = geometricFilter.geometricEstimation(sfmData, regionsPerView, imagePair, putativeMatchesPerType, pairRandomNumberGenerator, inliers);
       if(state.hasStrongSupport)
       {
         if(guidedMatching)
@@ -78,11 +93,7 @@ void robustModelEstimation(
           std::swap(inliers, guidedGeometricInliers);
         }
 
-#pragma omp critical
-        {
-          out_geometricMatches.emplace(currentPair, std::move(inliers));
-        }
-
+        threadsGeometricMatches[omp_get_thread_num()].emplace_back(imagePair, std::move(inliers));
       }
     }
 
@@ -91,6 +102,12 @@ void robustModelEstimation(
       ++progressBar;
     }
   }
+
+  for(auto& threadGeometricMatches : threadsGeometricMatches)
+  {
+    for(auto& geometricMatch : threadGeometricMatches)
+      out_geometricMatches.emplace(geometricMatch.first, std::move(geometricMatch.second));
+  }
 }
 
 } // namespace matchingImageCollection
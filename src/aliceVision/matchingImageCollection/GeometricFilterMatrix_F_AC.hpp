@@ -37,11 +37,13 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
   GeometricFilterMatrix_F_AC(double dPrecision = std::numeric_limits<double>::infinity(),
                              std::size_t iteration = 1024,
                              robustEstimation::ERobustEstimator estimator = robustEstimation::ERobustEstimator::ACRANSAC,
-                             bool estimateDistortion = false)
+                             bool estimateDistortion = false,
+                             bool useSprt = false)
     : GeometricFilterMatrix(dPrecision, std::numeric_limits<double>::infinity(), iteration)
     , m_F(Mat3::Identity())
     , m_estimator(estimator)
     , m_estimateDistortion(estimateDistortion)
+    , m_useSprt(useSprt)
   {}
 
   /**
@@ -329,7 +331,8 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
     const double normalizedThreshold = Square(m_dPrecision * kernel.normalizer2()(0, 0));
     robustEstimation::ScoreEvaluator<KernelT> scorer(normalizedThreshold);
 
-    robustEstimation::Mat3Model model = robustEstimation::LO_RANSAC(kernel, scorer, randomNumberGenerator, &out_inliers);
+    robustEstimation::Mat3Model model = robustEstimation::LO_RANSAC(kernel, scorer, randomNumberGenerator, &out_inliers,
+                                                                    nullptr, false, 100, 1e-2, m_useSprt);
     m_F = model.getMatrix();
 
     if(out_inliers.empty())
@@ -389,6 +392,8 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
   Mat3 m_F;
   robustEstimation::ERobustEstimator m_estimator;
   bool m_estimateDistortion;
+  /// verify the LORansac hypotheses with a SPRT
+  bool m_useSprt;
 };
 
 } // namespace matchingImageCollection
@@ -13,6 +13,8 @@
 
 #include <boost/progress.hpp>
 
+#include <algorithm>
+
 namespace aliceVision {
 namespace matchingImageCollection {
 
@@ -29,10 +31,49 @@ ImageCollectionMatcher_cascadeHashing
 
 namespace impl
 {
+/**
+ * @brief Draw the hashing projections and compute the zero mean descriptor
+ *        (the mean of the mean descriptor of each view, one for all the image regions)
+ */
+void initHashing
+(
+  std::mt19937 & gen,
+  const std::vector<Eigen::VectorXf>& viewsMeanDescriptor,
+  CascadeHasher & cascade_hasher,
+  Eigen::VectorXf & zero_mean_descriptor
+)
+{
+  if (viewsMeanDescriptor.empty())
+    return;
+
+  const size_t dimension = viewsMeanDescriptor.front().size();
+  cascade_hasher.Init(gen, dimension);
+
+  Eigen::MatrixXf matForZeroMean(viewsMeanDescriptor.size(), dimension);
+  for (std::size_t i = 0; i < viewsMeanDescriptor.size(); ++i)
+    matForZeroMean.row(i) = viewsMeanDescriptor[i];
+  zero_mean_descriptor = CascadeHasher::GetZeroMeanDescriptor(matForZeroMean);
+}
+
+template <typename ScalarT>
+Eigen::VectorXf computeMeanDescriptor(const feature::Regions& regions)
+{
+  typedef Eigen::Matrix<ScalarT, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> BaseMat;
+
+  const size_t dimension = regions.DescriptorLength();
+  if (regions.RegionCount() == 0)
+    return Eigen::VectorXf::Zero(dimension);
+
+  const ScalarT * tab = reinterpret_cast<const ScalarT*>(regions.DescriptorRawData());
+  Eigen::Map<BaseMat> mat( (ScalarT*)tab, regions.RegionCount(), dimension);
+  return CascadeHasher::GetZeroMeanDescriptor(mat);
+}
+
 template <typename ScalarT>
 void Match
 (
-  std::mt19937 & gen,
+  const CascadeHasher & cascade_hasher,
+  const Eigen::VectorXf & zero_mean_descriptor,
   const feature::RegionsPerView& regionsPerView,
   const PairSet & pairs,
   EImageDescriberType descType,
@@ -44,166 +85,122 @@ void Match
 
   // Collect used view indexes
   std::set<IndexT> used_index;
-  // Sort pairs according the first index to minimize later memory swapping
-  typedef std::map<IndexT, std::vector<IndexT> > Map_vectorT;
-  Map_vectorT map_Pairs;
-  for (PairSet::const_iterator iter = pairs.begin(); iter != pairs.end(); ++iter)
+  for (const Pair& pair : pairs)
   {
-    map_Pairs[iter->first].push_back(iter->second);
-    used_index.insert(iter->first);
-    used_index.insert(iter->second);
+    used_index.insert(pair.first);
+    used_index.insert(pair.second);
   }
+  const std::vector<IndexT> used_views(used_index.begin(), used_index.end());
 
   typedef Eigen::Matrix<ScalarT, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> BaseMat;
 
-  // Init the cascade hasher
-  CascadeHasher cascade_hasher;
-  if (!used_index.empty())
-  {
-    const IndexT I = *used_index.begin();
-    const feature::Regions &regionsI = regionsPerView.getRegions(I, descType);
-    const size_t dimension = regionsI.DescriptorLength();
-    cascade_hasher.Init(gen, dimension);
-  }
-
-  std::map<IndexT, HashedDescriptions> hashed_base_;
-
-  // Compute the zero mean descriptor that will be used for hashing (one for all the image regions)
-  Eigen::VectorXf zero_mean_descriptor;
-  {
-    Eigen::MatrixXf matForZeroMean;
-    for (int i =0; i < used_index.size(); ++i)
-    {
-      std::set<IndexT>::const_iterator iter = used_index.begin();
-      std::advance(iter, i);
-      const IndexT I = *iter;
-      const feature::Regions &regionsI = regionsPerView.getRegions(I, descType);
-      const ScalarT * tabI =
-        reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
-      const size_t dimension = regionsI.DescriptorLength();
-      if (i==0)
-      {
-        matForZeroMean.resize(used_index.size(), dimension);
-        matForZeroMean.fill(0.0f);
-      }
-      if (regionsI.RegionCount() > 0)
-      {
-        Eigen::Map<BaseMat> mat_I( (ScalarT*)tabI, regionsI.RegionCount(), dimension);
-        matForZeroMean.row(i) = CascadeHasher::GetZeroMeanDescriptor(mat_I);
-      }
-    }
-    zero_mean_descriptor = CascadeHasher::GetZeroMeanDescriptor(matForZeroMean);
-  }
-
-  // Index the input regions
+  // Index the input regions: the hash codes and buckets of each image are computed once for all its pairs
+  std::vector<HashedDescriptions> hashed_base_(used_views.size());
   #pragma omp parallel for schedule(dynamic)
-  for (int i =0; i < used_index.size(); ++i)
+  for (int i = 0; i < used_views.size(); ++i)
   {
-    std::set<IndexT>::const_iterator iter = used_index.begin();
-    std::advance(iter, i);
-    const IndexT I = *iter;
+    const IndexT I = used_views[i];
     const feature::Regions &regionsI = regionsPerView.getRegions(I, descType);
     const ScalarT * tabI =
       reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
     const size_t dimension = regionsI.DescriptorLength();
 
     Eigen::Map<BaseMat> mat_I( (ScalarT*)tabI, regionsI.RegionCount(), dimension);
-    HashedDescriptions hashed_description = cascade_hasher.CreateHashedDescriptions(mat_I,
-      zero_mean_descriptor);
-    #pragma omp critical
-    {
-      hashed_base_[I] = std::move(hashed_description);
-    }
+    hashed_base_[i] = cascade_hasher.CreateHashedDescriptions(mat_I, zero_mean_descriptor);
   }
 
-  // Perform matching between all the pairs
-  for (Map_vectorT::const_iterator iter = map_Pairs.begin();
-    iter != map_Pairs.end(); ++iter)
+  const auto hashedIndex = [&used_views](IndexT viewId)
+  {
+    return std::distance(used_views.begin(), std::lower_bound(used_views.begin(), used_views.end(), viewId));
+  };
+
+  // Perform matching between all the pairs.
+  // Pairs are sorted according the first index to keep the same image hot in the cache of a thread,
+  // and all the pairs are distributed over the threads (not only the pairs of a same image).
+  const std::vector<Pair> pairsList(pairs.begin(), pairs.end());
+  std::vector<matching::IndMatches> pairsMatches(pairsList.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int p = 0; p < pairsList.size(); ++p)
   {
-    const IndexT I = iter->first;
-    const std::vector<IndexT> & indexToCompare = iter->second;
+    const IndexT I = pairsList[p].first;
+    const IndexT J = pairsList[p].second;
 
     const feature::Regions &regionsI = regionsPerView.getRegions(I, descType);
-    if (regionsI.RegionCount() == 0)
+    if (regionsI.RegionCount() == 0 || !regionsPerView.viewExist(J))
     {
-      my_progress_bar += indexToCompare.size();
+      #pragma omp critical
+      ++my_progress_bar;
+      continue;
+    }
+
+    const feature::Regions &regionsJ = regionsPerView.getRegions(J, descType);
+    if (regionsI.Type_id() != regionsJ.Type_id())
+    {
+      #pragma omp critical
+      ++my_progress_bar;
       continue;
     }
 
-    const std::vector<feature::PointFeature> pointFeaturesI = regionsI.GetRegionsPositions();
-    const ScalarT * tabI =
-      reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
     const size_t dimension = regionsI.DescriptorLength();
+
+    // Matrix representation of the database and query input data;
+    const ScalarT * tabI = reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
     Eigen::Map<BaseMat> mat_I( (ScalarT*)tabI, regionsI.RegionCount(), dimension);
-    #pragma omp parallel for schedule(dynamic)
-    for (int j = 0; j < (int)indexToCompare.size(); ++j)
+    const ScalarT * tabJ = reinterpret_cast<const ScalarT*>(regionsJ.DescriptorRawData());
+    Eigen::Map<BaseMat> mat_J( (ScalarT*)tabJ, regionsJ.RegionCount(), dimension);
+
+    IndMatches pvec_indices;
+    typedef typename Accumulator<ScalarT>::Type ResultType;
+    std::vector<ResultType> pvec_distances;
+    pvec_distances.reserve(regionsJ.RegionCount() * 2);
+    pvec_indices.reserve(regionsJ.RegionCount() * 2);
+
+    // Match the query descriptors to the database
+    cascade_hasher.Match_HashedDescriptions<BaseMat, ResultType>(
+      hashed_base_[hashedIndex(J)], mat_J,
+      hashed_base_[hashedIndex(I)], mat_I,
+      &pvec_indices, &pvec_distances);
+
+    std::vector<int> vec_nn_ratio_idx;
+    // Filter the matches using a distance ratio test:
+    //   The probability that a match is correct is determined by taking
+    //   the ratio of distance from the closest neighbor to the distance
+    //   of the second closest.
+    matching::NNdistanceRatio(
+      pvec_distances.begin(), // distance start
+      pvec_distances.end(),   // distance end
+      2, // Number of neighbor in iterator sequence (minimum required 2)
+      vec_nn_ratio_idx, // output (indices that respect the distance Ratio)
+      Square(fDistRatio));
+
+    matching::IndMatches& vec_putative_matches = pairsMatches[p];
+    vec_putative_matches.reserve(vec_nn_ratio_idx.size());
+    for (size_t k=0; k < vec_nn_ratio_idx.size(); ++k)
     {
-      size_t J = indexToCompare[j];
-      const feature::Regions &regionsJ = regionsPerView.getRegions(I, descType);
-
-      if (!regionsPerView.viewExist(J)
-          || regionsI.Type_id() != regionsJ.Type_id())
-      {
-        #pragma omp critical
-        ++my_progress_bar;
-        continue;
-      }
-
-      // Matrix representation of the query input data;
-      const ScalarT * tabJ = reinterpret_cast<const ScalarT*>(regionsJ.DescriptorRawData());
-      Eigen::Map<BaseMat> mat_J( (ScalarT*)tabJ, regionsJ.RegionCount(), dimension);
-
-      IndMatches pvec_indices;
-      typedef typename Accumulator<ScalarT>::Type ResultType;
-      std::vector<ResultType> pvec_distances;
-      pvec_distances.reserve(regionsJ.RegionCount() * 2);
-      pvec_indices.reserve(regionsJ.RegionCount() * 2);
-
-      // Match the query descriptors to the database
-      cascade_hasher.Match_HashedDescriptions<BaseMat, ResultType>(
-        hashed_base_[J], mat_J,
-        hashed_base_[I], mat_I,
-        &pvec_indices, &pvec_distances);
-
-      std::vector<int> vec_nn_ratio_idx;
-      // Filter the matches using a distance ratio test:
-      //   The probability that a match is correct is determined by taking
-      //   the ratio of distance from the closest neighbor to the distance
-      //   of the second closest.
-      matching::NNdistanceRatio(
-        pvec_distances.begin(), // distance start
-        pvec_distances.end(),   // distance end
-        2, // Number of neighbor in iterator sequence (minimum required 2)
-        vec_nn_ratio_idx, // output (indices that respect the distance Ratio)
-        Square(fDistRatio));
-
-      matching::IndMatches vec_putative_matches;
-      vec_putative_matches.reserve(vec_nn_ratio_idx.size());
-      for (size_t k=0; k < vec_nn_ratio_idx.size(); ++k)
-      {
-        const size_t index = vec_nn_ratio_idx[k];
-        vec_putative_matches.emplace_back(pvec_indices[index*2]._j, pvec_indices[index*2]._i);
-      }
-
-      // Remove duplicates
-      matching::IndMatch::getDeduplicated(vec_putative_matches);
-
-      // Remove matches that have the same (X,Y) coordinates
-      const std::vector<feature::PointFeature> pointFeaturesJ = regionsJ.GetRegionsPositions();
-      matching::IndMatchDecorator<float> matchDeduplicator(vec_putative_matches,
-        pointFeaturesI, pointFeaturesJ);
-      matchDeduplicator.getDeduplicated(vec_putative_matches);
-
-      #pragma omp critical
-      {
-        ++my_progress_bar;
-        if (!vec_putative_matches.empty())
-        {
-          assert(map_PutativesMatches.count(std::make_pair(I,J)) == 0);
-          map_PutativesMatches[std::make_pair(I,J)].emplace(descType, std::move(vec_putative_matches));
-        }
-      }
+      const size_t index = vec_nn_ratio_idx[k];
+      vec_putative_matches.emplace_back(pvec_indices[index*2]._j, pvec_indices[index*2]._i);
     }
+
+    // Remove duplicates
+    matching::IndMatch::getDeduplicated(vec_putative_matches);
+
+    // Remove matches that have the same (X,Y) coordinates
+    matching::IndMatchDecorator<float> matchDeduplicator(vec_putative_matches,
+      regionsI.Features(), regionsJ.Features());
+    matchDeduplicator.getDeduplicated(vec_putative_matches);
+
+    #pragma omp critical
+    ++my_progress_bar;
+  }
+
+  // Export the putative matches in the pairs order (independent of the threads scheduling)
+  for (std::size_t p = 0; p < pairsList.size(); ++p)
+  {
+    if (pairsMatches[p].empty())
+      continue;
+    assert(map_PutativesMatches.count(pairsList[p]) == 0);
+    map_PutativesMatches[pairsList[p]].emplace(descType, std::move(pairsMatches[p]));
   }
 }
 } // namespace impl
@@ -230,10 +227,37 @@ void ImageCollectionMatcher_cascadeHashing::Match
   if (regions.IsBinary())
     return;
 
+  if(regions.Type_id() != typeid(unsigned char).name() &&
+     regions.Type_id() != typeid(float).name())
+  {
+    ALICEVISION_LOG_WARNING("Matcher not implemented for this region type");
+    return;
+  }
+
+  // Without hashing shared by all the pairs, compute it from the views of these pairs
+  Hashing pairsHashing;
+  const auto hashingIt = hashing_per_desc_type_.find(descType);
+  if (hashingIt == hashing_per_desc_type_.end())
+  {
+    std::set<IndexT> used_index;
+    for (const Pair& pair : pairs)
+    {
+      used_index.insert(pair.first);
+      used_index.insert(pair.second);
+    }
+    std::vector<Eigen::VectorXf> viewsMeanDescriptor;
+    viewsMeanDescriptor.reserve(used_index.size());
+    for (const IndexT viewId : used_index)
+      viewsMeanDescriptor.push_back(computeMeanDescriptor(regionsPerView.getRegions(viewId, descType)));
+    impl::initHashing(gen, viewsMeanDescriptor, pairsHashing.cascade_hasher, pairsHashing.zero_mean_descriptor);
+  }
+  const Hashing& hashing = (hashingIt == hashing_per_desc_type_.end()) ? pairsHashing : hashingIt->second;
+
   if(regions.Type_id() == typeid(unsigned char).name())
   {
     impl::Match<unsigned char>(
-      gen,
+      hashing.cascade_hasher,
+      hashing.zero_mean_descriptor,
       regionsPerView,
       pairs,
       descType,
@@ -241,20 +265,36 @@ void ImageCollectionMatcher_cascadeHashing::Match
       map_PutativesMatches);
   }
   else
-  if(regions.Type_id() == typeid(float).name())
   {
     impl::Match<float>(
-      gen,
+      hashing.cascade_hasher,
+      hashing.zero_mean_descriptor,
       regionsPerView,
       pairs,
       descType,
       f_dist_ratio_,
       map_PutativesMatches);
   }
-  else
-  {
-    ALICEVISION_LOG_WARNING("Matcher not implemented for this region type");
-  }
+}
+
+void ImageCollectionMatcher_cascadeHashing::initHashing
+(
+  std::mt19937 & gen,
+  feature::EImageDescriberType descType,
+  const std::vector<Eigen::VectorXf>& viewsMeanDescriptor
+)
+{
+  Hashing& hashing = hashing_per_desc_type_[descType];
+  impl::initHashing(gen, viewsMeanDescriptor, hashing.cascade_hasher, hashing.zero_mean_descriptor);
+}
+
+Eigen::VectorXf ImageCollectionMatcher_cascadeHashing::computeMeanDescriptor(const feature::Regions& regions)
+{
+  if(regions.Type_id() == typeid(unsigned char).name())
+    return impl::computeMeanDescriptor<unsigned char>(regions);
+  if(regions.Type_id() == typeid(float).name())
+    return impl::computeMeanDescriptor<float>(regions);
+  return Eigen::VectorXf::Zero(regions.DescriptorLength());
 }
 
 } // namespace aliceVision
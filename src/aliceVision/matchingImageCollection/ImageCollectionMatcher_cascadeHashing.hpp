@@ -8,6 +8,12 @@
 #pragma once
 
 #include "aliceVision/matchingImageCollection/IImageCollectionMatcher.hpp"
+#include "aliceVision/matching/CascadeHasher.hpp"
+
+#include <Eigen/Core>
+
+#include <map>
+#include <vector>
 
 namespace aliceVision {
 namespace matchingImageCollection {
@@ -19,7 +25,9 @@ namespace matchingImageCollection {
  * a threshold over the distance ratio of the 2 nearest neighbours.
  *
  * @note: Cascade hashing tables are computed once and used for all the regions.
- * @warning: all descriptors are loaded in memory. You need to ensure that it can fit in RAM.
+ *        They are computed for each call to Match from the views of its pairs,
+ *        or once for all the pairs with initHashing when the pairs are matched by batches.
+ * @warning: all descriptors of the pairs are loaded in memory. You need to ensure that it can fit in RAM.
  */
 class ImageCollectionMatcher_cascadeHashing : public IImageCollectionMatcher
 {
@@ -38,9 +46,38 @@ class ImageCollectionMatcher_cascadeHashing : public IImageCollectionMatcher
     matching::PairwiseMatches & map_PutativesMatches // the pairwise photometric corresponding points
   ) const;
 
+  /**
+   * @brief Draw the hashing projections and compute the zero mean descriptor of a describer type
+   *        once for all the pairs, instead of computing them in each call to Match.
+   *        The matches then do not depend on how the pairs are split between the calls to Match.
+   * @param[in] randomNumberGenerator
+   * @param[in] descType the describer type
+   * @param[in] viewsMeanDescriptor the mean descriptor of each view of all the pairs (sorted by view id),
+   *            see computeMeanDescriptor
+   */
+  void initHashing(std::mt19937 & randomNumberGenerator,
+                   feature::EImageDescriberType descType,
+                   const std::vector<Eigen::VectorXf>& viewsMeanDescriptor);
+
+  /**
+   * @brief Compute the mean descriptor of the regions of a view
+   * @param[in] regions the regions of the view (non binary)
+   * @return the mean descriptor, zero if there is no region
+   */
+  static Eigen::VectorXf computeMeanDescriptor(const feature::Regions& regions);
+
   private:
+  /// hashing projections and zero mean descriptor shared by all the pairs
+  struct Hashing
+  {
+    matching::CascadeHasher cascade_hasher;
+    Eigen::VectorXf zero_mean_descriptor;
+  };
+
   // Distance ratio used to discard spurious correspondence
   float f_dist_ratio_;
+  // Hashing initialized once for all the pairs, per describer type
+  std::map<feature::EImageDescriberType, Hashing> hashing_per_desc_type_;
 };
 
 } // namespace aliceVision
@@ -0,0 +1,125 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/matchingImageCollection/ImageCollectionMatcher_cascadeHashing.hpp"
+#include "aliceVision/feature/regionsFactory.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE matchingImageCollectionCascadeHashing
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::feature;
+using namespace aliceVision::matching;
+using namespace aliceVision::matchingImageCollection;
+
+namespace {
+
+const IndexT nbViews = 6;
+const std::size_t nbRegions = 200;
+
+// the descriptors of each view are noisy copies of a shared set of descriptors
+std::vector<SIFT_Regions> createViewsRegions()
+{
+  std::mt19937 randomNumberGenerator(0);
+  std::uniform_int_distribution<int> descriptorDistribution(0, 255);
+  std::uniform_int_distribution<int> noiseDistribution(-3, 3);
+
+  std::vector<SIFT_Regions::DescriptorT> sharedDescriptors(nbRegions);
+  for(SIFT_Regions::DescriptorT& descriptor : sharedDescriptors)
+  {
+    for(int j = 0; j < 128; ++j)
+      descriptor[j] = static_cast<unsigned char>(descriptorDistribution(randomNumberGenerator));
+  }
+
+  std::vector<SIFT_Regions> viewsRegions(nbViews);
+  for(IndexT viewId = 0; viewId < nbViews; ++viewId)
+  {
+    // a different subset of the shared descriptors in each view
+    for(std::size_t i = viewId; i < nbRegions; ++i)
+    {
+      viewsRegions[viewId].Features().emplace_back(float(i), float(viewId), 1.f, 0.f);
+      SIFT_Regions::DescriptorT descriptor = sharedDescriptors[i];
+      for(int j = 0; j < 128; ++j)
+        descriptor[j] = static_cast<unsigned char>(std::min(255, std::max(0, descriptor[j] + noiseDistribution(randomNumberGenerator))));
+      viewsRegions[viewId].Descriptors().push_back(descriptor);
+    }
+  }
+  return viewsRegions;
+}
+
+// only the regions of the views of the pairs, as loaded for a batch
+void getRegionsPerView(const std::vector<SIFT_Regions>& viewsRegions, const PairSet& pairs, RegionsPerView& regionsPerView)
+{
+  for(const Pair& pair : pairs)
+  {
+    for(const IndexT viewId : {pair.first, pair.second})
+    {
+      if(!regionsPerView.viewExist(viewId))
+        regionsPerView.addRegions(viewId, EImageDescriberType::SIFT, new SIFT_Regions(viewsRegions[viewId]));
+    }
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(matchingImageCollection_cascadeHashing_batches)
+{
+  const std::vector<SIFT_Regions> viewsRegions = createViewsRegions();
+
+  PairSet allPairs;
+  for(IndexT i = 0; i < nbViews; ++i)
+  {
+    for(IndexT j = i + 1; j < nbViews; ++j)
+      allPairs.emplace(i, j);
+  }
+
+  // all the pairs at once
+  PairwiseMatches allMatches;
+  {
+    RegionsPerView regionsPerView;
+    getRegionsPerView(viewsRegions, allPairs, regionsPerView);
+
+    std::mt19937 randomNumberGenerator(0);
+    const ImageCollectionMatcher_cascadeHashing matcher(0.8f);
+    matcher.Match(randomNumberGenerator, regionsPerView, allPairs, EImageDescriberType::SIFT, allMatches);
+  }
+  BOOST_REQUIRE_EQUAL(allMatches.size(), allPairs.size());
+
+  std::vector<Eigen::VectorXf> viewsMeanDescriptor;
+  for(const SIFT_Regions& regions : viewsRegions)
+    viewsMeanDescriptor.push_back(ImageCollectionMatcher_cascadeHashing::computeMeanDescriptor(regions));
+
+  // the pairs by batches, each batch with only the regions of its views
+  const std::vector<Pair> pairs(allPairs.begin(), allPairs.end());
+  for(const std::size_t batchSize : {1, 4, 7, 15})
+  {
+    std::mt19937 randomNumberGenerator(0);
+    ImageCollectionMatcher_cascadeHashing matcher(0.8f);
+    matcher.initHashing(randomNumberGenerator, EImageDescriberType::SIFT, viewsMeanDescriptor);
+
+    PairwiseMatches batchesMatches;
+    for(std::size_t batchBegin = 0; batchBegin < pairs.size(); batchBegin += batchSize)
+    {
+      const PairSet batchPairs(pairs.begin() + batchBegin, pairs.begin() + std::min(pairs.size(), batchBegin + batchSize));
+      RegionsPerView regionsPerView;
+      getRegionsPerView(viewsRegions, batchPairs, regionsPerView);
+      matcher.Match(randomNumberGenerator, regionsPerView, batchPairs, EImageDescriberType::SIFT, batchesMatches);
+    }
+
+    BOOST_REQUIRE_EQUAL(batchesMatches.size(), allMatches.size());
+    for(const auto& pairMatches : allMatches)
+    {
+      const IndMatches& matches = pairMatches.second.at(EImageDescriberType::SIFT);
+      BOOST_CHECK(!matches.empty());
+      BOOST_CHECK(batchesMatches.at(pairMatches.first).at(EImageDescriberType::SIFT) == matches);
+    }
+  }
+}
@@ -0,0 +1,104 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/matchingImageCollection/GeometricFilter.hpp"
+#include "aliceVision/matchingImageCollection/GeometricFilterMatrix_H_AC.hpp"
+#include "aliceVision/feature/regionsFactory.hpp"
+#include "aliceVision/sfmData/SfMData.hpp"
+
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE matchingImageCollectionGeometricFilter
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::feature;
+using namespace aliceVision::matching;
+using namespace aliceVision::matchingImageCollection;
+
+namespace {
+
+const IndexT nbViews = 8;
+const std::size_t nbPoints = 100;
+const std::size_t nbInliers = 80;
+const int width = 640;
+const int height = 480;
+
+// the same plane points seen through a different homography in each view, with noise
+void createScene(sfmData::SfMData& sfmData, RegionsPerView& regionsPerView)
+{
+  std::mt19937 randomNumberGenerator(0);
+  std::uniform_real_distribution<double> xDistribution(0.0, width);
+  std::uniform_real_distribution<double> yDistribution(0.0, height);
+  std::normal_distribution<double> noiseDistribution(0.0, 1.0);
+
+  std::vector<Vec2> points(nbPoints);
+  for(Vec2& point : points)
+    point = Vec2(xDistribution(randomNumberGenerator), yDistribution(randomNumberGenerator));
+
+  for(IndexT viewId = 0; viewId < nbViews; ++viewId)
+  {
+    Mat3 H;
+    H << 1.0 + 0.01 * viewId, 0.02 * viewId, 5.0 * viewId,
+         -0.01 * viewId, 1.0, 3.0 * viewId,
+         1e-5 * viewId, 0.0, 1.0;
+
+    SIFT_Regions* regions = new SIFT_Regions();
+    for(const Vec2& point : points)
+    {
+      const Vec3 x = H * point.homogeneous();
+      regions->Features().emplace_back(float(x(0) / x(2) + noiseDistribution(randomNumberGenerator)),
+                                       float(x(1) / x(2) + noiseDistribution(randomNumberGenerator)), 1.f, 0.f);
+    }
+    regions->Descriptors().resize(nbPoints);
+    regionsPerView.addRegions(viewId, EImageDescriberType::SIFT, regions);
+
+    sfmData.views.emplace(viewId, std::make_shared<sfmData::View>("", viewId, UndefinedIndexT, viewId, width, height));
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(GeometricFilter_threadsIndependence)
+{
+  sfmData::SfMData sfmData;
+  RegionsPerView regionsPerView;
+  createScene(sfmData, regionsPerView);
+
+  // the first points are matched with themselves, the others with another point
+  PairwiseMatches putativeMatches;
+  for(IndexT i = 0; i < nbViews; ++i)
+  {
+    for(IndexT j = i + 1; j < nbViews; ++j)
+    {
+      IndMatches& matches = putativeMatches[Pair(i, j)][EImageDescriberType::SIFT];
+      for(IndexT k = 0; k < nbPoints; ++k)
+        matches.emplace_back(k, k < nbInliers ? k : (k + 7) % nbPoints);
+    }
+  }
+
+  PairwiseMatches referenceMatches;
+  for(const int nbThreads : {1, 2, 4})
+  {
+    omp_set_num_threads(nbThreads);
+
+    std::mt19937 randomNumberGenerator(0);
+    PairwiseMatches geometricMatches;
+    robustModelEstimation(geometricMatches, &sfmData, regionsPerView, GeometricFilterMatrix_H_AC(4.0), putativeMatches, randomNumberGenerator);
+
+    if(nbThreads == 1)
+    {
+      referenceMatches = geometricMatches;
+      BOOST_REQUIRE_EQUAL(referenceMatches.size(), putativeMatches.size());
+      for(const auto& pairMatches : referenceMatches)
+        BOOST_CHECK_GE(pairMatches.second.at(EImageDescriberType::SIFT).size(), nbInliers / 2);
+    }
+
+    BOOST_CHECK(geometricMatches == referenceMatches);
+  }
+}
@@ -27,6 +27,7 @@ std::unique_ptr<IImageCollectionMatcher> createImageCollectionMatcher(matching::
     case matching::ANN_L2:                  matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, crossMatching, matching::ANN_L2)); break;
     case matching::CASCADE_HASHING_L2:      matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, crossMatching, matching::CASCADE_HASHING_L2)); break;
     case matching::FAST_CASCADE_HASHING_L2: matcherPtr.reset(new ImageCollectionMatcher_cascadeHashing(distRatio)); break;
+    case matching::BLOCKED_BRUTE_FORCE_L2:  matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, crossMatching, matching::BLOCKED_BRUTE_FORCE_L2)); break;
     case matching::BRUTE_FORCE_HAMMING:     matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, crossMatching, matching::BRUTE_FORCE_HAMMING)); break;
     
     default: throw std::out_of_range("Invalid matcherType enum");
@@ -0,0 +1,173 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "pairScheduler.hpp"
+
+#include <algorithm>
+#include <set>
+#include <tuple>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+namespace {
+
+/**
+ * @brief Breadth-first traversal from a node, visiting the neighbors by increasing degree.
+ * @param[in] graph the adjacency lists
+ * @param[in] start the start node
+ * @param[in,out] visited the visited nodes
+ * @param[out] order the nodes in visit order
+ * @return the first node of the last level
+ */
+std::size_t breadthFirstOrder(const std::vector<std::vector<std::size_t>>& graph,
+                              std::size_t start,
+                              std::vector<bool>& visited,
+                              std::vector<std::size_t>& order)
+{
+  const std::size_t begin = order.size();
+  std::size_t lastLevelBegin = begin;
+
+  visited[start] = true;
+  order.push_back(start);
+
+  std::size_t levelBegin = begin;
+  while(levelBegin < order.size())
+  {
+    lastLevelBegin = levelBegin;
+    const std::size_t levelEnd = order.size();
+    for(std::size_t i = levelBegin; i < levelEnd; ++i)
+    {
+      for(const std::size_t neighbor : graph[order[i]])
+      {
+        if(visited[neighbor])
+          continue;
+        visited[neighbor] = true;
+        order.push_back(neighbor);
+      }
+    }
+    levelBegin = levelEnd;
+  }
+
+  // the node of minimal degree of the last level
+  return *std::min_element(order.begin() + lastLevelBegin, order.end(),
+                           [&graph](std::size_t a, std::size_t b) { return graph[a].size() < graph[b].size(); });
+}
+
+} // namespace
+
+PairVec orderPairsByLocality(const PairSet& pairs)
+{
+  // views graph
+  std::map<IndexT, std::size_t> nodePerView;
+  std::vector<IndexT> viewPerNode;
+  for(const Pair& pair : pairs)
+  {
+    for(const IndexT viewId : {pair.first, pair.second})
+    {
+      if(nodePerView.emplace(viewId, viewPerNode.size()).second)
+        viewPerNode.push_back(viewId);
+    }
+  }
+
+  std::vector<std::vector<std::size_t>> graph(viewPerNode.size());
+  for(const Pair& pair : pairs)
+  {
+    const std::size_t a = nodePerView.at(pair.first);
+    const std::size_t b = nodePerView.at(pair.second);
+    graph[a].push_back(b);
+    graph[b].push_back(a);
+  }
+  for(std::vector<std::size_t>& neighbors : graph)
+  {
+    std::sort(neighbors.begin(), neighbors.end(),
+              [&graph](std::size_t a, std::size_t b) { return std::make_tuple(graph[a].size(), a) < std::make_tuple(graph[b].size(), b); });
+  }
+
+  // Cuthill-McKee ordering of each connected component,
+  // starting from a pseudo-peripheral node (last level of a first traversal from a node of minimal degree)
+  std::vector<std::size_t> nodesByDegree(graph.size());
+  for(std::size_t i = 0; i < graph.size(); ++i)
+    nodesByDegree[i] = i;
+  std::stable_sort(nodesByDegree.begin(), nodesByDegree.end(),
+                   [&graph](std::size_t a, std::size_t b) { return graph[a].size() < graph[b].size(); });
+
+  std::vector<std::size_t> order;
+  order.reserve(graph.size());
+  std::vector<bool> visited(graph.size(), false);
+  std::vector<bool> componentVisited(graph.size(), false);
+  std::vector<std::size_t> componentOrder;
+
+  for(const std::size_t node : nodesByDegree)
+  {
+    if(visited[node])
+      continue;
+
+    componentOrder.clear();
+    const std::size_t peripheralNode = breadthFirstOrder(graph, node, componentVisited, componentOrder);
+    breadthFirstOrder(graph, peripheralNode, visited, order);
+  }
+
+  // reverse Cuthill-McKee ranks
+  std::map<IndexT, std::size_t> rankPerView;
+  for(std::size_t i = 0; i < order.size(); ++i)
+    rankPerView[viewPerNode[order[i]]] = order.size() - 1 - i;
+
+  PairVec orderedPairs(pairs.begin(), pairs.end());
+  std::sort(orderedPairs.begin(), orderedPairs.end(), [&rankPerView](const Pair& a, const Pair& b)
+  {
+    const std::size_t a0 = rankPerView.at(a.first);
+    const std::size_t a1 = rankPerView.at(a.second);
+    const std::size_t b0 = rankPerView.at(b.first);
+    const std::size_t b1 = rankPerView.at(b.second);
+    return std::make_tuple(std::min(a0, a1), std::max(a0, a1)) < std::make_tuple(std::min(b0, b1), std::max(b0, b1));
+  });
+  return orderedPairs;
+}
+
+std::vector<PairSet> splitPairsByMemory(const PairVec& pairs,
+                                        const std::map<IndexT, std::size_t>& viewsMemory,
+                                        std::size_t maxMemory)
+{
+  const auto getViewMemory = [&viewsMemory](IndexT viewId) -> std::size_t
+  {
+    const auto it = viewsMemory.find(viewId);
+    return (it == viewsMemory.end()) ? 0 : it->second;
+  };
+
+  std::vector<PairSet> batches;
+  std::set<IndexT> batchViews;
+  std::size_t batchMemory = 0;
+
+  for(const Pair& pair : pairs)
+  {
+    std::size_t pairMemory = 0;
+    if(batchViews.count(pair.first) == 0)
+      pairMemory += getViewMemory(pair.first);
+    if(batchViews.count(pair.second) == 0 && pair.second != pair.first)
+      pairMemory += getViewMemory(pair.second);
+
+    if(batches.empty() || batchMemory + pairMemory > maxMemory)
+    {
+      // start a new batch
+      batches.emplace_back();
+      batchViews.clear();
+      batchMemory = getViewMemory(pair.first) + (pair.second != pair.first ? getViewMemory(pair.second) : 0);
+    }
+    else
+    {
+      batchMemory += pairMemory;
+    }
+
+    batches.back().insert(pair);
+    batchViews.insert(pair.first);
+    batchViews.insert(pair.second);
+  }
+  return batches;
+}
+
+} // namespace matchingImageCollection
+} // namespace aliceVision
@@ -0,0 +1,39 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+/**
+ * @brief Order the pairs to maximize the locality of the views.
+ *        The views are ranked with a reverse Cuthill-McKee ordering of the views graph (bandwidth reduction)
+ *        and the pairs are sorted by the ranks of their views, so consecutive pairs share most of their views.
+ * @param[in] pairs the pairs to order
+ * @return the ordered pairs
+ */
+PairVec orderPairsByLocality(const PairSet& pairs);
+
+/**
+ * @brief Split ordered pairs in consecutive batches whose views fit in a memory budget.
+ * @param[in] pairs the ordered pairs (see orderPairsByLocality)
+ * @param[in] viewsMemory the memory needed by each view (views not in the map are considered free)
+ * @param[in] maxMemory the memory budget of the views of a batch
+ * @return the batches of pairs, each batch contains at least one pair (even if its views exceed the budget)
+ */
+std::vector<PairSet> splitPairsByMemory(const PairVec& pairs,
+                                        const std::map<IndexT, std::size_t>& viewsMemory,
+                                        std::size_t maxMemory);
+
+} // namespace matchingImageCollection
+} // namespace aliceVision
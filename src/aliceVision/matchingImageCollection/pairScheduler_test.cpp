@@ -0,0 +1,119 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/matchingImageCollection/pairScheduler.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <set>
+
+#define BOOST_TEST_MODULE matchingImageCollectionPairScheduler
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::matchingImageCollection;
+
+// views along a trajectory with shuffled ids, each view is paired with its 3 next neighbors
+PairSet createTrajectoryPairs(std::size_t nbViews, std::vector<IndexT>& viewIds)
+{
+  viewIds.resize(nbViews);
+  std::iota(viewIds.begin(), viewIds.end(), 100);
+  std::mt19937 randomNumberGenerator(0);
+  std::shuffle(viewIds.begin(), viewIds.end(), randomNumberGenerator);
+
+  PairSet pairs;
+  for(std::size_t i = 0; i < nbViews; ++i)
+  {
+    for(std::size_t j = i + 1; j < std::min(nbViews, i + 4); ++j)
+      pairs.insert(std::make_pair(std::min(viewIds[i], viewIds[j]), std::max(viewIds[i], viewIds[j])));
+  }
+  return pairs;
+}
+
+BOOST_AUTO_TEST_CASE(matchingImageCollection_orderPairsByLocality)
+{
+  BOOST_CHECK(orderPairsByLocality(PairSet()).empty());
+
+  std::vector<IndexT> viewIds;
+  const PairSet pairs = createTrajectoryPairs(200, viewIds);
+
+  // add a second connected component
+  PairSet allPairs = pairs;
+  allPairs.insert(std::make_pair(1, 2));
+  allPairs.insert(std::make_pair(2, 3));
+
+  const PairVec orderedPairs = orderPairsByLocality(allPairs);
+
+  // same pairs
+  BOOST_CHECK_EQUAL(orderedPairs.size(), allPairs.size());
+  BOOST_CHECK(PairSet(orderedPairs.begin(), orderedPairs.end()) == allPairs);
+
+  // the views of consecutive pairs stay close:
+  // a view is not used anymore after a few pairs
+  std::map<IndexT, std::size_t> firstUse;
+  std::map<IndexT, std::size_t> lastUse;
+  for(std::size_t i = 0; i < orderedPairs.size(); ++i)
+  {
+    for(const IndexT viewId : {orderedPairs[i].first, orderedPairs[i].second})
+    {
+      firstUse.emplace(viewId, i);
+      lastUse[viewId] = i;
+    }
+  }
+  for(const auto& viewUse : firstUse)
+    BOOST_CHECK_LE(lastUse.at(viewUse.first) - viewUse.second, 12);
+}
+
+BOOST_AUTO_TEST_CASE(matchingImageCollection_splitPairsByMemory)
+{
+  std::vector<IndexT> viewIds;
+  const PairSet pairs = createTrajectoryPairs(200, viewIds);
+  const PairVec orderedPairs = orderPairsByLocality(pairs);
+
+  std::map<IndexT, std::size_t> viewsMemory;
+  for(const IndexT viewId : viewIds)
+    viewsMemory[viewId] = 10;
+
+  const std::size_t maxMemory = 200;
+  const std::vector<PairSet> batches = splitPairsByMemory(orderedPairs, viewsMemory, maxMemory);
+
+  std::size_t nbPairs = 0;
+  std::size_t nbLoadedViews = 0;
+  std::size_t previousEnd = 0;
+  for(const PairSet& batch : batches)
+  {
+    BOOST_CHECK(!batch.empty());
+
+    std::set<IndexT> batchViews;
+    for(const Pair& pair : batch)
+    {
+      batchViews.insert(pair.first);
+      batchViews.insert(pair.second);
+    }
+    std::size_t batchMemory = 0;
+    for(const IndexT viewId : batchViews)
+      batchMemory += viewsMemory.at(viewId);
+    BOOST_CHECK_LE(batchMemory, maxMemory);
+
+    // consecutive pairs
+    for(std::size_t i = previousEnd; i < previousEnd + batch.size(); ++i)
+      BOOST_CHECK(batch.count(orderedPairs[i]));
+    previousEnd += batch.size();
+
+    nbPairs += batch.size();
+    nbLoadedViews += batchViews.size();
+  }
+  BOOST_CHECK_EQUAL(nbPairs, pairs.size());
+
+  // each view is loaded in a few batches only
+  BOOST_CHECK_LE(nbLoadedViews, 2 * viewIds.size());
+
+  // a pair exceeding the budget is alone in its batch
+  const std::vector<PairSet> smallBatches = splitPairsByMemory(orderedPairs, viewsMemory, 5);
+  BOOST_CHECK_EQUAL(smallBatches.size(), pairs.size());
+}
@@ -51,6 +51,13 @@ public:
     return Square(KernelBase::error(sample, model));
   }
 
+  inline void errors(const ModelT_& model, std::vector<double>& errors) const override
+  {
+    KernelBase::errors(model, errors);
+    for(double& error : errors)
+      error = Square(error);
+  }
+
   void unnormalize(ModelT_& model) const override
   {
     // do nothing, no normalization in the angular case
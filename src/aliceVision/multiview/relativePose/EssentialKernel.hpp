@@ -70,6 +70,14 @@ public:
     return KernelBase::_errorEstimator.error(modelF, KernelBase::_x1.col(sample), KernelBase::_x2.col(sample));
   }
 
+  void errors(const ModelT& model, std::vector<double>& errors) const
+  {
+    Mat3 F;
+    fundamentalFromEssential(model.getMatrix(), _K1, _K2, &F);
+    const robustEstimation::Mat3Model modelF(F);
+    robustEstimation::BatchErrors<ErrorT, robustEstimation::Mat3Model>::compute(KernelBase::_errorEstimator, modelF, KernelBase::_x1, KernelBase::_x2, errors);
+  }
+
 protected:
 
   // The two camera calibrated camera matrix
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <aliceVision/robustEstimation/ISolver.hpp>
+#include <aliceVision/robustEstimation/PointFittingKernel.hpp>
 #include <aliceVision/multiview/relativePose/ISolverErrorRelativePose.hpp>
 
 namespace aliceVision {
@@ -77,6 +78,96 @@ struct EpipolarSphericalDistanceError
 };
 
 
+/**
+ * @brief Compute an epipolar error for all the 2D correspondences,
+ *        without temporaries and with contiguous accesses to the points.
+ * @param[in] F the fundamental matrix
+ * @param[in] x1 left points (2xN)
+ * @param[in] x2 right points (2xN)
+ * @param[out] errors the error of each correspondence
+ * @param[in] errorFromEpipolar error from y^t.F.x, F.x and F^t.y (first 2 coordinates)
+ */
+template<typename ErrorFromEpipolarT>
+inline void fundamentalBatchErrors(const Mat3& F, const Mat& x1, const Mat& x2, std::vector<double>& errors, ErrorFromEpipolarT errorFromEpipolar)
+{
+  assert(x1.rows() == 2 && x2.rows() == 2);
+  assert(x1.cols() == x2.cols());
+
+  const Mat::Index nbSamples = x1.cols();
+  errors.resize(nbSamples);
+
+  const double f00 = F(0, 0), f01 = F(0, 1), f02 = F(0, 2);
+  const double f10 = F(1, 0), f11 = F(1, 1), f12 = F(1, 2);
+  const double f20 = F(2, 0), f21 = F(2, 1), f22 = F(2, 2);
+  const double* p1 = x1.data();
+  const double* p2 = x2.data();
+  double* e = errors.data();
+
+  for(Mat::Index i = 0; i < nbSamples; ++i)
+  {
+    const double u1 = p1[2 * i], v1 = p1[2 * i + 1];
+    const double u2 = p2[2 * i], v2 = p2[2 * i + 1];
+
+    const double Fx0 = f00 * u1 + f01 * v1 + f02;
+    const double Fx1 = f10 * u1 + f11 * v1 + f12;
+    const double Fx2 = f20 * u1 + f21 * v1 + f22;
+    const double Fty0 = f00 * u2 + f10 * v2 + f20;
+    const double Fty1 = f01 * u2 + f11 * v2 + f21;
+    const double ytFx = u2 * Fx0 + v2 * Fx1 + Fx2;
+
+    e[i] = errorFromEpipolar(ytFx, Fx0 * Fx0 + Fx1 * Fx1, Fty0 * Fty0 + Fty1 * Fty1);
+  }
+}
+
 }  // namespace relativePose
 }  // namespace multiview
+
+namespace robustEstimation {
+
+template<>
+struct BatchErrors<multiview::relativePose::FundamentalSampsonError, Mat3Model>
+{
+  static void compute(const multiview::relativePose::FundamentalSampsonError& errorEstimator, const Mat3Model& model, const Mat& x1, const Mat& x2, std::vector<double>& errors)
+  {
+    if(x1.rows() != 2)
+      return BatchErrors<multiview::relativePose::ISolverErrorRelativePose<Mat3Model>, Mat3Model>::compute(errorEstimator, model, x1, x2, errors);
+
+    multiview::relativePose::fundamentalBatchErrors(model.getMatrix(), x1, x2, errors, [](double ytFx, double nFx, double nFty)
+    {
+      return Square(ytFx) / (nFx + nFty);
+    });
+  }
+};
+
+template<>
+struct BatchErrors<multiview::relativePose::FundamentalSymmetricEpipolarDistanceError, Mat3Model>
+{
+  static void compute(const multiview::relativePose::FundamentalSymmetricEpipolarDistanceError& errorEstimator, const Mat3Model& model, const Mat& x1, const Mat& x2, std::vector<double>& errors)
+  {
+    if(x1.rows() != 2)
+      return BatchErrors<multiview::relativePose::ISolverErrorRelativePose<Mat3Model>, Mat3Model>::compute(errorEstimator, model, x1, x2, errors);
+
+    multiview::relativePose::fundamentalBatchErrors(model.getMatrix(), x1, x2, errors, [](double ytFx, double nFx, double nFty)
+    {
+      return Square(ytFx) * (1.0 / nFx + 1.0 / nFty) / 4.0;
+    });
+  }
+};
+
+template<>
+struct BatchErrors<multiview::relativePose::FundamentalEpipolarDistanceError, Mat3Model>
+{
+  static void compute(const multiview::relativePose::FundamentalEpipolarDistanceError& errorEstimator, const Mat3Model& model, const Mat& x1, const Mat& x2, std::vector<double>& errors)
+  {
+    if(x1.rows() != 2)
+      return BatchErrors<multiview::relativePose::ISolverErrorRelativePose<Mat3Model>, Mat3Model>::compute(errorEstimator, model, x1, x2, errors);
+
+    multiview::relativePose::fundamentalBatchErrors(model.getMatrix(), x1, x2, errors, [](double ytFx, double nFx, double nFty)
+    {
+      return Square(ytFx) / nFx;
+    });
+  }
+};
+
+}  // namespace robustEstimation
 }  // namespace aliceVision
@@ -10,6 +10,7 @@
 
 #include <aliceVision/numeric/projection.hpp>
 #include <aliceVision/robustEstimation/ISolver.hpp>
+#include <aliceVision/robustEstimation/PointFittingKernel.hpp>
 #include <aliceVision/multiview/relativePose/ISolverErrorRelativePose.hpp>
 
 namespace aliceVision {
@@ -32,4 +33,38 @@ struct HomographyAsymmetricError : ISolverErrorRelativePose<robustEstimation::Ma
 
 }  // namespace relativePose
 }  // namespace multiview
+
+namespace robustEstimation {
+
+template<>
+struct BatchErrors<multiview::relativePose::HomographyAsymmetricError, Mat3Model>
+{
+  static void compute(const multiview::relativePose::HomographyAsymmetricError& errorEstimator, const Mat3Model& model, const Mat& x1, const Mat& x2, std::vector<double>& errors)
+  {
+    assert(x1.rows() == 2 && x2.rows() == 2);
+    assert(x1.cols() == x2.cols());
+
+    const Mat::Index nbSamples = x1.cols();
+    errors.resize(nbSamples);
+
+    const Mat3& H = model.getMatrix();
+    const double h00 = H(0, 0), h01 = H(0, 1), h02 = H(0, 2);
+    const double h10 = H(1, 0), h11 = H(1, 1), h12 = H(1, 2);
+    const double h20 = H(2, 0), h21 = H(2, 1), h22 = H(2, 2);
+    const double* p1 = x1.data();
+    const double* p2 = x2.data();
+    double* e = errors.data();
+
+    for(Mat::Index i = 0; i < nbSamples; ++i)
+    {
+      const double u1 = p1[2 * i], v1 = p1[2 * i + 1];
+      const double w = h20 * u1 + h21 * v1 + h22;
+      const double du = p2[2 * i] - (h00 * u1 + h01 * v1 + h02) / w;
+      const double dv = p2[2 * i + 1] - (h10 * u1 + h11 * v1 + h12) / w;
+      e[i] = du * du + dv * dv;
+    }
+  }
+};
+
+}  // namespace robustEstimation
 }  // namespace aliceVision
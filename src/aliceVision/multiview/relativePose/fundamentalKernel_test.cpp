@@ -133,3 +133,32 @@ BOOST_AUTO_TEST_CASE(NormalizedFundamental8PKernel_EasyCase)
 
   BOOST_CHECK(expectKernelProperties<relativePose::NormalizedFundamental8PKernel>(x1, x2));
 }
+
+// the batched residuals must be the per sample residuals
+template<typename ErrorT>
+void checkBatchErrors(const Mat& x1, const Mat& x2, const robustEstimation::Mat3Model& model)
+{
+  const ErrorT errorEstimator;
+  std::vector<double> errors;
+  robustEstimation::BatchErrors<ErrorT, robustEstimation::Mat3Model>::compute(errorEstimator, model, x1, x2, errors);
+
+  BOOST_REQUIRE_EQUAL(errors.size(), x1.cols());
+  for(Mat::Index i = 0; i < x1.cols(); ++i)
+  {
+    const double error = errorEstimator.error(model, x1.col(i), x2.col(i));
+    BOOST_CHECK_SMALL(errors[i] - error, 1e-12 * std::max(1.0, error));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(FundamentalError_BatchErrors)
+{
+  makeRandomOperationsReproducible();
+
+  const Mat x1 = Mat::Random(2, 50) * 100.0;
+  const Mat x2 = Mat::Random(2, 50) * 100.0;
+  const robustEstimation::Mat3Model model(Mat3::Random());
+
+  checkBatchErrors<relativePose::FundamentalSampsonError>(x1, x2, model);
+  checkBatchErrors<relativePose::FundamentalSymmetricEpipolarDistanceError>(x1, x2, model);
+  checkBatchErrors<relativePose::FundamentalEpipolarDistanceError>(x1, x2, model);
+}
@@ -100,3 +100,26 @@ BOOST_AUTO_TEST_CASE(Homography4PKernel_Fitting)
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(HomographyAsymmetricError_BatchErrors)
+{
+  makeRandomOperationsReproducible();
+
+  const Mat x1 = Mat::Random(2, 50) * 100.0;
+  const Mat x2 = Mat::Random(2, 50) * 100.0;
+  Mat3 H = Mat3::Random();
+  H(2, 2) = 200.0; // keep the points away from the line at infinity
+  const robustEstimation::Mat3Model model(H);
+
+  const relativePose::HomographyAsymmetricError errorEstimator;
+  std::vector<double> errors;
+  robustEstimation::BatchErrors<relativePose::HomographyAsymmetricError, robustEstimation::Mat3Model>::compute(errorEstimator, model, x1, x2, errors);
+
+  // the batched residuals must be the per sample residuals
+  BOOST_REQUIRE_EQUAL(errors.size(), x1.cols());
+  for(Mat::Index i = 0; i < x1.cols(); ++i)
+  {
+    const double error = errorEstimator.error(model, x1.col(i), x2.col(i));
+    BOOST_CHECK_SMALL(errors[i] - error, 1e-12 * std::max(1.0, error));
+  }
+}
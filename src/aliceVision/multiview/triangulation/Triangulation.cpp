@@ -85,23 +85,41 @@ double Triangulation::error(const Vec3 &X) const
   return squared_reproj_error;
 }
 
-Vec3 Triangulation::compute(int iter) const
+namespace {
+
+/**
+ * @brief Iterative weighted linear least squares triangulation.
+ * @param[in] nviews the number of observations
+ * @param[in] getP returns the projection matrix of the i-th observation
+ * @param[in] getX returns the image point of the i-th observation
+ * @param[in] iter the number of iterations
+ * @param[in,out] weights buffer of the observations weights
+ * @param[out] zmin the min depth
+ * @param[out] zmax the max depth
+ * @param[out] err the re-projection error
+ * @return the 3D point
+ */
+template <typename ProjectionAccessor, typename PointAccessor>
+Vec3 iteratedLinearTriangulation(std::size_t nviews,
+                                 const ProjectionAccessor& getP,
+                                 const PointAccessor& getX,
+                                 int iter,
+                                 std::vector<double>& weights,
+                                 double& zmin,
+                                 double& zmax,
+                                 double& err)
 {
-  const auto nviews = views.size();
-  assert(nviews >= 2);
-
-  // Iterative weighted linear least squares
   Mat3 AtA;
   Vec3 Atb, X;
-  std::vector<double> weights(nviews, double(1.0));
+  weights.assign(nviews, 1.0);
   for(int it = 0; it < iter; ++it)
   {
     AtA.fill(0.0);
     Atb.fill(0.0);
     for(std::size_t i = 0; i < nviews; ++i)
     {
-      const Mat34& PMat = views[i].first;
-      const Vec2 & p = views[i].second;
+      const Mat34& PMat = getP(i);
+      const auto& p = getX(i);
       const double w = weights[i];
 
       Vec3 v1, v2;
@@ -132,8 +150,8 @@ Vec3 Triangulation::compute(int iter) const
     err = 0;
     for(std::size_t i = 0; i < nviews; ++i)
     {
-      const Mat34& PMat = views[i].first;
-      const Vec2 & p = views[i].second;
+      const Mat34& PMat = getP(i);
+      const auto& p = getX(i);
       const Vec3 xProj = PMat * Vec4(X(0), X(1), X(2), 1.0);
       const double z = xProj(2);
       const Vec2 x = xProj.head<2>() / z;
@@ -146,6 +164,55 @@ Vec3 Triangulation::compute(int iter) const
   return X;
 }
 
+} // namespace
+
+Vec3 Triangulation::compute(int iter) const
+{
+  const auto nviews = views.size();
+  assert(nviews >= 2);
+
+  std::vector<double> weights;
+  return iteratedLinearTriangulation(nviews,
+                                     [&](std::size_t i) -> const Mat34& { return views[i].first; },
+                                     [&](std::size_t i) -> const Vec2& { return views[i].second; },
+                                     iter, weights, zmin, zmax, err);
+}
+
+void TriangulateNViewsBatch(const std::vector<Mat34>& Ps,
+                            const Mat2X& x,
+                            const std::vector<std::size_t>& cameraIndexes,
+                            const std::vector<std::size_t>& offsets,
+                            Mat3X& X,
+                            Vec& minDepths,
+                            int iter)
+{
+  assert(!offsets.empty());
+  assert(static_cast<std::size_t>(x.cols()) == cameraIndexes.size());
+  assert(offsets.back() == cameraIndexes.size());
+
+  const std::size_t nbPoints = offsets.size() - 1;
+  X.setZero(3, nbPoints);
+  minDepths.setZero(nbPoints);
+
+  // reused by all the points of the batch
+  std::vector<double> weights;
+
+  for(std::size_t i = 0; i < nbPoints; ++i)
+  {
+    const std::size_t begin = offsets[i];
+    const std::size_t nviews = offsets[i + 1] - begin;
+    if(nviews < 2)
+      continue;
+
+    double zmin, zmax, err;
+    X.col(i) = iteratedLinearTriangulation(nviews,
+                                           [&](std::size_t j) -> const Mat34& { return Ps[cameraIndexes[begin + j]]; },
+                                           [&](std::size_t j) { return x.col(begin + j); },
+                                           iter, weights, zmin, zmax, err);
+    minDepths(i) = zmin;
+  }
+}
+
 void TriangulateNViewsSolver::solve(const Mat2X& x, const std::vector<Mat34>& Ps, std::vector<robustEstimation::MatrixModel<Vec4>> &X) const
 {
   Vec4 pt3d;
@@ -70,6 +70,28 @@ void TriangulateNViewLORANSAC(const Mat2X &x,
                               std::vector<std::size_t> *inliersIndex = NULL,
                               const double & thresholdError = 4.0);                               
 
+/**
+ * @brief Compute the 3D positions of a batch of points seen by a common set of cameras
+ * with the iterated linear method of Triangulation::compute.
+ * The projection matrices are given once for the whole batch and each observation refers to its camera by index.
+ * Points with less than 2 observations are not triangulated and keep a null minimal depth.
+ *
+ * @param[in] Ps is the list of projective matrices for each camera
+ * @param[in] x are the 2D coordinates of the observations of all the points
+ * @param[in] cameraIndexes is the index in Ps of the camera of each observation
+ * @param[in] offsets is the index of the first observation of each point, followed by the total number of observations
+ * @param[out] X are the estimated 3D points
+ * @param[out] minDepths is the min depth of each estimated 3D point in its cameras
+ * @param[in] iter the number of iterations of the linear method
+ */
+void TriangulateNViewsBatch(const std::vector<Mat34>& Ps,
+                            const Mat2X& x,
+                            const std::vector<std::size_t>& cameraIndexes,
+                            const std::vector<std::size_t>& offsets,
+                            Mat3X& X,
+                            Vec& minDepths,
+                            int iter = 3);
+
 //Iterated linear method
 
 class Triangulation
@@ -13,6 +13,7 @@
 #include <aliceVision/system/Logger.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iostream>
 #include <iterator>
@@ -130,6 +131,59 @@ inline ErrorIndex bestNFA(int startIndex, //number of point required for estimat
 }
 
 
+/**
+ * @brief Lower bound of the NFA of the residuals of a model (see bestNFA), without sorting them.
+ *        The residuals are binned by powers of 2: the k-th smallest residual is at least
+ *        the lower edge of its bin, which bounds its probability alpha.
+ * @param[in] startIndex number of point required for estimation
+ * @param[in] logalpha0
+ * @param[in] residuals the residuals (unsorted)
+ * @param[in] maxThreshold only the residuals under this threshold are considered
+ * @param[in] loge0
+ * @param[in] multError
+ * @return lower bound of the NFA
+ */
+inline double lowerBoundNFA(int startIndex,
+                            double logalpha0,
+                            const std::vector<double>& residuals,
+                            double maxThreshold,
+                            double loge0,
+                            double multError = 1.0)
+{
+  const int nbBins = 64;
+  std::array<std::size_t, nbBins> histogram{};
+
+  // the last bin contains the threshold
+  const int maxExponent = (maxThreshold > 0.0) ? std::ilogb(maxThreshold) : 0;
+  const int minExponent = maxExponent - (nbBins - 1);
+
+  for(const double residual : residuals)
+  {
+    if(residual > maxThreshold)
+      continue;
+    const int exponent = (residual > 0.0) ? std::ilogb(residual) : minExponent;
+    ++histogram[std::max(exponent, minExponent) - minExponent];
+  }
+
+  // logc_n and logc_k are positive, for a rank k in the bin b (e_k >= lower edge l_b):
+  // NFA(k) >= loge0 + min(0, logalpha(l_b)) * (k - startIndex)
+  double lowerBound = std::numeric_limits<double>::infinity();
+  std::size_t nbResiduals = 0;
+  for(int b = 0; b < nbBins; ++b)
+  {
+    if(histogram[b] == 0)
+      continue;
+    nbResiduals += histogram[b];
+    if(nbResiduals <= static_cast<std::size_t>(startIndex))
+      continue;
+
+    const double lowerEdge = (b == 0) ? 0.0 : std::ldexp(1.0, minExponent + b);
+    const double logalpha = logalpha0 + multError * log10(lowerEdge + std::numeric_limits<float>::epsilon());
+    lowerBound = std::min(lowerBound, loge0 + std::min(0.0, logalpha) * static_cast<double>(nbResiduals - startIndex));
+  }
+  return lowerBound;
+}
+
 /**
  * @brief ACRANSAC routine (ErrorThreshold, NFA)
  *
@@ -138,6 +192,7 @@ inline ErrorIndex bestNFA(int startIndex, //number of point required for estimat
  * @param[in] nIter maximum number of consecutive iterations
  * @param[out] model returned model if found
  * @param[in] precision upper bound of the precision (squared error)
+ * @param[in] pruneNFASearch skip the models and residuals which cannot improve the best NFA (the result is unchanged)
  *
  * @return (errorMax, minNFA)
  */
@@ -147,7 +202,8 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
                                    std::vector<size_t>& vec_inliers,
                                    std::size_t nIter = 1024,
                                    typename Kernel::ModelT* model = nullptr,
-                                   double precision = std::numeric_limits<double>::infinity())
+                                   double precision = std::numeric_limits<double>::infinity(),
+                                   bool pruneNFASearch = true)
 {
   vec_inliers.clear();
 
@@ -160,9 +216,17 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
     std::numeric_limits<double>::infinity() :
     precision * kernel.normalizer2()(0,0) * kernel.normalizer2()(0,0);
 
-  std::vector<ErrorIndex> vec_residuals(nData); // [residual,index]
+  std::vector<ErrorIndex> vec_residuals; // [residual,index]
+  vec_residuals.reserve(nData);
   std::vector<double> vec_residuals_(nData);
 
+  // Residuals over this threshold have a probability alpha >= 1
+  const double meaningfulThreshold = (kernel.multError() > 0) ?
+    std::pow(10.0, -kernel.logalpha0() / kernel.multError()) :
+    std::numeric_limits<double>::infinity();
+  // Tolerance on the NFA lower bound (rounding errors)
+  const double nfaTolerance = 1e-6;
+
   // Possible sampling indices [0,..,nData] (will change in the optimization phase)
   std::vector<size_t> vec_index(nData);
   std::iota(vec_index.begin(), vec_index.end(), 0);
@@ -214,10 +278,22 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
       }
       if (bACRansacMode)
       {
+        // Only the residuals under the threshold can lead to a better NFA.
+        // Once a meaningful model is found (minNFA < 0), residuals with alpha >= 1 cannot (NFA >= loge0 >= 0).
+        const double errorThreshold = (pruneNFASearch && minNFA < 0) ? std::min(maxThreshold, meaningfulThreshold) : maxThreshold;
+
+        // Skip the models which cannot improve the best NFA
+        if (pruneNFASearch && minNFA < 0 &&
+            lowerBoundNFA(sizeSample, kernel.logalpha0(), vec_residuals_, errorThreshold, loge0, kernel.multError()) > minNFA + nfaTolerance)
+          continue;
+
+        // Sort only the residuals under the threshold
+        vec_residuals.clear();
         for (size_t i = 0; i < nData; ++i)
         {
           const double error = vec_residuals_[i];
-          vec_residuals[i] = ErrorIndex(error, i);
+          if (error <= errorThreshold)
+            vec_residuals.emplace_back(error, i);
         }
         std::sort(vec_residuals.begin(), vec_residuals.end());
 
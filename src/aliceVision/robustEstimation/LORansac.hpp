@@ -10,7 +10,9 @@
 #include <aliceVision/robustEstimation/ACRansac.hpp>
 #include <aliceVision/robustEstimation/ransacTools.hpp>
 #include <aliceVision/robustEstimation/IRansacKernel.hpp>
+#include <aliceVision/robustEstimation/SprtVerification.hpp>
 #include <limits>
+#include <memory>
 #include <numeric>
 #include <iostream>
 #include <vector>
@@ -301,6 +303,7 @@ double localOptimization(const Kernel& kernel,
  * @param[in] bVerbose Enable/Disable log messages
  * @param[in] max_iterations Maximum number of iterations for the ransac part.
  * @param[in] outliers_probability The wanted probability of picking outliers.
+ * @param[in] useSprt Verify the hypotheses with a SPRT before scoring them (@see SprtVerification).
  * @return The best model found.
  */
 template<typename Kernel, typename Scorer>
@@ -311,7 +314,8 @@ typename Kernel::ModelT LO_RANSAC(const Kernel& kernel,
                                   double* best_score = NULL,
                                   bool bVerbose = false,
                                   std::size_t max_iterations = 100,
-                                  double outliers_probability = 1e-2)
+                                  double outliers_probability = 1e-2,
+                                  bool useSprt = false)
 {
   assert(outliers_probability < 1.0);
   assert(outliers_probability > 0.0);
@@ -339,6 +343,12 @@ typename Kernel::ModelT LO_RANSAC(const Kernel& kernel,
   std::vector<std::size_t> all_samples(total_samples);
   std::iota(all_samples.begin(), all_samples.end(), 0);
 
+  std::unique_ptr<SprtVerification> sprt;
+  if(useSprt)
+  {
+    sprt.reset(new SprtVerification(total_samples, 0.01, 200.0, kernel.getMaximumNbModels()));
+  }
+
   for(iteration = 0; iteration < max_iterations; ++iteration) 
   {
     std::vector<std::size_t> sample;
@@ -350,6 +360,10 @@ typename Kernel::ModelT LO_RANSAC(const Kernel& kernel,
     // Compute the inlier list for each fit.
     for(std::size_t i = 0; i < models.size(); ++i) 
     {
+      // reject the hypotheses which are not worth being scored
+      if(sprt && !sprt->verify(kernel, models.at(i), scorer.getThreshold()))
+        continue;
+
       std::vector<std::size_t> inliers;
       double score = scorer.score(kernel, models.at(i), all_samples, inliers);
       if(bVerbose)
@@ -402,7 +416,11 @@ typename Kernel::ModelT LO_RANSAC(const Kernel& kernel,
         }
         if (bestInlierRatio) 
         {
-          max_iterations = iterationsRequired(min_samples,
+          if(sprt)
+            sprt->setInlierRatio(bestInlierRatio);
+
+          max_iterations = sprt ? sprt->iterationsRequired(min_samples, outliers_probability, bestInlierRatio) :
+                                  iterationsRequired(min_samples,
                                               outliers_probability,
                                               bestInlierRatio);
           // safeguard to not get stuck in a big number of iterations
@@ -18,6 +18,30 @@
 namespace aliceVision {
 namespace robustEstimation {
 
+/**
+ * @brief Compute the errors of a model for all the correspondences.
+ *        The error functors can specialize it with a batched implementation.
+ * @tparam ErrorT the error functor
+ * @tparam ModelT the model type
+ */
+template<typename ErrorT, typename ModelT>
+struct BatchErrors
+{
+  /**
+   * @param[in] errorEstimator the error functor
+   * @param[in] model the model
+   * @param[in] x1 left corresponding data
+   * @param[in] x2 right corresponding data
+   * @param[out] errors the error of each correspondence
+   */
+  static void compute(const ErrorT& errorEstimator, const ModelT& model, const Mat& x1, const Mat& x2, std::vector<double>& errors)
+  {
+    errors.resize(x1.cols());
+    for(Mat::Index sample = 0; sample < x1.cols(); ++sample)
+      errors[sample] = errorEstimator.error(model, x1.col(sample), x2.col(sample));
+  }
+};
+
 /**
  * @brief This is one example (targeted at solvers that operate on correspondences
  * between two views) that shows the "kernel" part of a robust fitting
@@ -106,9 +130,7 @@ public:
    */
   inline virtual void errors(const ModelT& model, std::vector<double>& errors) const
   {
-    errors.resize(_x1.cols());
-    for(std::size_t sample = 0; sample < _x1.cols(); ++sample)
-      errors.at(sample) = error(sample, model);
+    BatchErrors<ErrorT, ModelT>::compute(_errorEstimator, model, _x1, _x2, errors);
   }
 
   /**
@@ -10,7 +10,9 @@
 #include <aliceVision/system/Logger.hpp>
 #include "aliceVision/robustEstimation/randSampling.hpp"
 #include "aliceVision/robustEstimation/ransacTools.hpp"
+#include "aliceVision/robustEstimation/SprtVerification.hpp"
 #include <limits>
+#include <memory>
 #include <numeric>
 #include <vector>
 #include <iostream>
@@ -31,6 +33,9 @@ namespace robustEstimation{
 // 2. Kernel::getMinimumNbRequiredSamples()
 // 3. Kernel::fit(vector<int>, vector<Kernel::Model> *)
 // 4. Kernel::error(Model, int) -> error
+//
+// With useSprt, the hypotheses are verified with a SPRT before being scored
+// (see SprtVerification).
 template<typename Kernel, typename Scorer>
 typename Kernel::ModelT RANSAC(
   const Kernel& kernel,
@@ -39,7 +44,8 @@ typename Kernel::ModelT RANSAC(
   std::vector<std::size_t>* best_inliers = nullptr,
   double* best_score = nullptr,
   bool bVerbose = true,
-  double outliers_probability = 1e-2)
+  double outliers_probability = 1e-2,
+  bool useSprt = false)
 {
   assert(outliers_probability < 1.0);
   assert(outliers_probability > 0.0);
@@ -68,6 +74,12 @@ typename Kernel::ModelT RANSAC(
   std::vector<size_t> all_samples(total_samples);
   std::iota(all_samples.begin(), all_samples.end(), 0);
 
+  std::unique_ptr<SprtVerification> sprt;
+  if(useSprt)
+  {
+    sprt.reset(new SprtVerification(total_samples, 0.01, 200.0, kernel.getMaximumNbModels()));
+  }
+
   for (iteration = 0;
     iteration < max_iterations &&
     iteration < really_max_iterations; ++iteration) 
@@ -81,6 +93,9 @@ typename Kernel::ModelT RANSAC(
       // Compute the inlier list for each fit.
       for (size_t i = 0; i < models.size(); ++i) 
       {
+        if (sprt && !sprt->verify(kernel, models[i], scorer.getThreshold()))
+          continue;
+
         std::vector<size_t> inliers;
         scorer.score(kernel, models[i], all_samples, inliers);
 
@@ -102,7 +117,10 @@ typename Kernel::ModelT RANSAC(
         }
           if (best_inlier_ratio) 
           {
-          max_iterations = iterationsRequired(min_samples,
+          if (sprt)
+            sprt->setInlierRatio(best_inlier_ratio);
+          max_iterations = sprt ? sprt->iterationsRequired(min_samples, outliers_probability, best_inlier_ratio) :
+            iterationsRequired(min_samples,
             outliers_probability,
             best_inlier_ratio);
             if(bVerbose)
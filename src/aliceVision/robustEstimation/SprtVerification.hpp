@@ -0,0 +1,190 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/robustEstimation/ransacTools.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace aliceVision {
+namespace robustEstimation {
+
+/**
+ * @brief Verification of the ransac hypotheses with the Wald's Sequential Probability Ratio Test (SPRT).
+ *
+ * The data are evaluated in a random order and a hypothesis is rejected as soon as the likelihood ratio
+ * between a bad and a good model exceeds the decision threshold, most of the bad hypotheses
+ * are thus rejected after a few residuals.
+ * The probability of a datum to be consistent with a good model (epsilon) is the inlier ratio of the best model,
+ * the probability to be consistent with a bad model (delta) is estimated from the rejected hypotheses.
+ * Epsilon is unknown until a first hypothesis is accepted, so all the hypotheses are fully scored until then.
+ *
+ * @ref Chum, O. and Matas, J. Optimal Randomized RANSAC. PAMI 2008
+ */
+class SprtVerification
+{
+public:
+  /**
+   * @param[in] nbSamples The number of data
+   * @param[in] badInlierRatio The initial probability of a datum to be consistent with a bad model (delta)
+   * @param[in] modelCost The cost of the model estimation relatively to the evaluation of a datum
+   * @param[in] nbModelsPerSample The average number of models estimated from a sample
+   */
+  explicit SprtVerification(std::size_t nbSamples,
+                            double badInlierRatio = 0.01,
+                            double modelCost = 200.0,
+                            double nbModelsPerSample = 1.0)
+    : _samplesOrder(nbSamples)
+    , _delta(badInlierRatio)
+    , _modelCost(modelCost)
+    , _nbModelsPerSample(nbModelsPerSample)
+  {
+    // the evaluation order has its own generator to not change the samples drawn by the ransac
+    std::mt19937 shuffleGenerator(static_cast<std::mt19937::result_type>(nbSamples));
+    std::iota(_samplesOrder.begin(), _samplesOrder.end(), 0);
+    std::shuffle(_samplesOrder.begin(), _samplesOrder.end(), shuffleGenerator);
+  }
+
+  /**
+   * @brief Verify a hypothesis, the residuals are evaluated until the hypothesis is rejected.
+   * @param[in] kernel The kernel containing the data
+   * @param[in] model The hypothesis
+   * @param[in] threshold The inlier threshold (same as the scorer)
+   * @return false if the hypothesis is rejected as a bad model, always true until setInlierRatio is called
+   */
+  template<typename Kernel>
+  bool verify(const Kernel& kernel, const typename Kernel::ModelT& model, double threshold)
+  {
+    if(!_isActive)
+      return true;
+
+    const double consistentRatio = _delta / _epsilon;
+    const double inconsistentRatio = (1.0 - _delta) / (1.0 - _epsilon);
+
+    double likelihoodRatio = 1.0;
+    std::size_t nbConsistent = 0;
+
+    for(std::size_t i = 0; i < _samplesOrder.size(); ++i)
+    {
+      if(kernel.error(_samplesOrder[i], model) < threshold)
+      {
+        likelihoodRatio *= consistentRatio;
+        ++nbConsistent;
+      }
+      else
+      {
+        likelihoodRatio *= inconsistentRatio;
+      }
+
+      if(likelihoodRatio > _decisionThreshold)
+      {
+        updateBadInlierRatio(nbConsistent / static_cast<double>(i + 1));
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Set the inlier ratio of the best model found so far (epsilon), the test starts rejecting hypotheses
+   * @param[in] inlierRatio The inlier ratio
+   */
+  void setInlierRatio(double inlierRatio)
+  {
+    // keep a chance for the good models with a few outliers
+    _epsilon = std::min(inlierRatio, 0.99);
+    _isActive = true;
+    updateDecisionThreshold();
+  }
+
+  /**
+   * @brief Number of iterations to reach the given probability of missing the best model,
+   *        taking into account the good models wrongly rejected by the test.
+   * @param[in] minSamples The number of data of a sample
+   * @param[in] outliersProbability The probability of missing the best model
+   * @param[in] inlierRatio The inlier ratio of the best model
+   * @return the number of iterations
+   */
+  std::size_t iterationsRequired(std::size_t minSamples, double outliersProbability, double inlierRatio) const
+  {
+    // probability of a good model to be accepted
+    const double acceptance = 1.0 - 1.0 / _decisionThreshold;
+    return robustEstimation::iterationsRequired(minSamples, outliersProbability, inlierRatio * std::pow(acceptance, 1.0 / minSamples));
+  }
+
+private:
+  /**
+   * @brief Update the probability of a datum to be consistent with a bad model (delta)
+   *        from the data evaluated for a rejected hypothesis.
+   */
+  void updateBadInlierRatio(double badInlierRatio)
+  {
+    ++_nbRejected;
+    _badInlierRatioSum += badInlierRatio;
+
+    const double delta = std::max(_badInlierRatioSum / _nbRejected, 1e-4);
+    // a new test is designed only if the estimation changes significantly
+    if(std::abs(delta - _delta) > 0.05 * _delta)
+    {
+      _delta = delta;
+      if(_isActive)
+        updateDecisionThreshold();
+    }
+  }
+
+  /**
+   * @brief Compute the optimal decision threshold A from epsilon and delta
+   *        (solution of A = K + 1 + log(A) with K = modelCost * C / nbModelsPerSample).
+   */
+  void updateDecisionThreshold()
+  {
+    if(_delta >= _epsilon)
+    {
+      // the bad and good models cannot be distinguished, no hypothesis is rejected
+      _decisionThreshold = std::numeric_limits<double>::infinity();
+      return;
+    }
+
+    // Kullback-Leibler divergence between the bad and good models
+    const double C = (1.0 - _delta) * std::log((1.0 - _delta) / (1.0 - _epsilon)) + _delta * std::log(_delta / _epsilon);
+    const double K = _modelCost * C / _nbModelsPerSample;
+
+    double A = K + 1.0;
+    for(int i = 0; i < 10; ++i)
+    {
+      const double previousA = A;
+      A = K + 1.0 + std::log(A);
+      if(std::abs(A - previousA) < 1e-6)
+        break;
+    }
+    _decisionThreshold = A;
+  }
+
+  /// data evaluation order
+  std::vector<std::size_t> _samplesOrder;
+  /// probability of a datum to be consistent with a good model
+  double _epsilon = 1.0;
+  /// probability of a datum to be consistent with a bad model
+  double _delta;
+  double _modelCost;
+  double _nbModelsPerSample;
+  /// decision threshold A
+  double _decisionThreshold = std::numeric_limits<double>::infinity();
+  /// true once a hypothesis has been accepted and epsilon is known
+  bool _isActive = false;
+  /// sum of the consistent data ratio of the rejected hypotheses
+  double _badInlierRatioSum = 0.0;
+  std::size_t _nbRejected = 0;
+};
+
+} // namespace robustEstimation
+} // namespace aliceVision
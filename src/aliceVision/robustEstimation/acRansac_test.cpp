@@ -271,3 +271,44 @@ BOOST_AUTO_TEST_CASE(RansacLineFitter_ACRANSACSimu)
 
   }
 }
+
+// the models and residuals skipped by the lowerBoundNFA pruning cannot improve the NFA:
+// the search must give the same model, inliers and threshold as the unpruned one
+BOOST_AUTO_TEST_CASE(RansacLineFitter_PrunedNFASearch)
+{
+  const int S = 100;
+  const float outlierRatio = .3f;
+  Vec2 GTModel;
+  GTModel << -2, .3;
+  std::mt19937 gen;
+
+  for(std::size_t i = 0; i < 10; ++i)
+  {
+    const double gaussianNoiseLevel = i / 10. * 5.;
+    const std::size_t numPoints = 2.0 * S * sqrt(2.0);
+
+    Mat2X points(2, numPoints);
+    std::vector<std::size_t> vec_inliersGT;
+    generateLine(numPoints, outlierRatio, gaussianNoiseLevel, GTModel, gen, points, vec_inliersGT);
+
+    LineKernel lineKernel(points, S, S);
+
+    for(const double precision : {std::numeric_limits<double>::infinity(), 4.0})
+    {
+      std::mt19937 randomNumberGeneratorPruned(i);
+      std::mt19937 randomNumberGenerator(i);
+      robustEstimation::MatrixModel<Vec2> modelPruned;
+      robustEstimation::MatrixModel<Vec2> model;
+      std::vector<std::size_t> inliersPruned;
+      std::vector<std::size_t> inliers;
+
+      const std::pair<double, double> retPruned = ACRANSAC(lineKernel, randomNumberGeneratorPruned, inliersPruned, 1000, &modelPruned, precision, true);
+      const std::pair<double, double> ret = ACRANSAC(lineKernel, randomNumberGenerator, inliers, 1000, &model, precision, false);
+
+      BOOST_CHECK_EQUAL(retPruned.first, ret.first);
+      BOOST_CHECK_EQUAL(retPruned.second, ret.second);
+      BOOST_CHECK(inliersPruned == inliers);
+      BOOST_CHECK(modelPruned.getMatrix() == model.getMatrix());
+    }
+  }
+}
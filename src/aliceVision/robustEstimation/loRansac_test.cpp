@@ -113,3 +113,77 @@ BOOST_AUTO_TEST_CASE(LoRansacLineFitter_RealCaseLoRansac)
     BOOST_CHECK_EQUAL(expectedInliers, inliers.size());
   }
 }
+
+BOOST_AUTO_TEST_CASE(LoRansacLineFitter_SprtLoRansac)
+{
+  const std::size_t numPoints = 1000;
+  const double outlierRatio = .8;
+  const double gaussianNoiseLevel = 0.0;
+  const std::size_t numTrials = 10;
+
+  Vec2 GTModel; // y = 2x + 6.3
+  GTModel <<  -2.0, 6.3;
+
+  std::mt19937 gen;
+
+  for(std::size_t trial = 0; trial < numTrials; ++trial)
+  {
+    Mat2X xy(2, numPoints);
+    std::vector<std::size_t> vec_inliersGT;
+    generateLine(numPoints, outlierRatio, gaussianNoiseLevel, GTModel, gen, xy, vec_inliersGT);
+
+    LineKernel kernel(xy);
+    std::vector<std::size_t> inliers;
+    const LineKernel::ModelT model = LO_RANSAC(kernel, ScoreEvaluator<LineKernel>(0.3), gen, &inliers, nullptr, false, 100, 1e-2, true);
+    const Vec2 estimatedModel = model.getMatrix();
+
+    // the hypotheses rejected by the SPRT do not prevent to find the line
+    BOOST_CHECK_EQUAL(vec_inliersGT.size(), inliers.size());
+    BOOST_CHECK_SMALL(GTModel[0]-estimatedModel[0], 1e-2);
+    BOOST_CHECK_SMALL(GTModel[1]-estimatedModel[1], 1e-2);
+  }
+}
+
+// with a high outlier ratio the SPRT must not reject the good model before it is found,
+// the hypotheses being drawn from the same random sequence both estimations give the same model
+BOOST_AUTO_TEST_CASE(LoRansacLineFitter_SprtHighOutlierRatio)
+{
+  const std::size_t numPoints = 1000;
+  const double outlierRatio = .95;
+  const double gaussianNoiseLevel = 0.0;
+  const std::size_t numTrials = 10;
+
+  Vec2 GTModel; // y = 2x + 6.3
+  GTModel <<  -2.0, 6.3;
+
+  std::mt19937 gen;
+  std::size_t nbFound = 0;
+
+  for(std::size_t trial = 0; trial < numTrials; ++trial)
+  {
+    Mat2X xy(2, numPoints);
+    std::vector<std::size_t> vec_inliersGT;
+    generateLine(numPoints, outlierRatio, gaussianNoiseLevel, GTModel, gen, xy, vec_inliersGT);
+
+    LineKernel kernel(xy);
+
+    std::mt19937 genScoring(gen);
+    std::vector<std::size_t> inliersScoring;
+    const Vec2 modelScoring = LO_RANSAC(kernel, ScoreEvaluator<LineKernel>(0.3), genScoring, &inliersScoring, nullptr, false, 100, 1e-2, false).getMatrix();
+
+    std::mt19937 genSprt(gen);
+    std::vector<std::size_t> inliersSprt;
+    const Vec2 modelSprt = LO_RANSAC(kernel, ScoreEvaluator<LineKernel>(0.3), genSprt, &inliersSprt, nullptr, false, 100, 1e-2, true).getMatrix();
+
+    gen = genScoring;
+
+    BOOST_CHECK_EQUAL(inliersScoring.size(), inliersSprt.size());
+    BOOST_CHECK_SMALL(modelScoring[0]-modelSprt[0], 1e-2);
+    BOOST_CHECK_SMALL(modelScoring[1]-modelSprt[1], 1e-2);
+
+    if(inliersScoring.size() == vec_inliersGT.size())
+      ++nbFound;
+  }
+
+  BOOST_CHECK_GE(nbFound, numTrials / 2);
+}
@@ -0,0 +1,338 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/geometry/Pose3.hpp>
+#include <aliceVision/sfmData/Landmark.hpp>
+#include <aliceVision/camera/IntrinsicBase.hpp>
+#include <aliceVision/camera/IntrinsicsScaleOffset.hpp>
+#include <aliceVision/camera/DistortionRadial.hpp>
+#include <aliceVision/camera/DistortionFisheye.hpp>
+#include <aliceVision/camera/Distortion3DE.hpp>
+
+#include <ceres/ceres.h>
+#include "liealgebra.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Reprojection error of a landmark in a view, for any camera model.
+ *        The intrinsic object is updated with the estimated parameters and its virtual jacobians are used.
+ */
+class CostProjection : public ceres::CostFunction {
+public:
+  CostProjection(const sfmData::Observation& measured, const std::shared_ptr<camera::IntrinsicBase> & intrinsics, bool withRig) : _measured(measured), _intrinsics(intrinsics), _withRig(withRig)
+  {
+    set_num_residuals(2);
+
+    mutable_parameter_block_sizes()->push_back(16);
+    mutable_parameter_block_sizes()->push_back(16);
+    mutable_parameter_block_sizes()->push_back(intrinsics->getParams().size());
+    mutable_parameter_block_sizes()->push_back(3);
+  }
+
+  bool Evaluate(double const * const * parameters, double * residuals, double ** jacobians) const override
+  {
+    const double * parameter_pose = parameters[0];
+    const double * parameter_rig = parameters[1];
+    const double * parameter_intrinsics = parameters[2];
+    const double * parameter_landmark = parameters[3];
+
+    const Eigen::Map<const SE3::Matrix> rTo(parameter_pose);
+    const Eigen::Map<const SE3::Matrix> cTr(parameter_rig);
+    const Eigen::Map<const Vec3> pt(parameter_landmark);
+
+    /*Update intrinsics object with estimated parameters*/
+    size_t params_size = _intrinsics->getParams().size();
+    std::vector<double> params;
+    for (size_t param_id = 0; param_id < params_size; param_id++) {
+      params.push_back(parameter_intrinsics[param_id]);
+    }
+    _intrinsics->updateFromParams(params);
+
+    const SE3::Matrix T = cTr * rTo;
+    const geometry::Pose3 T_pose3(T.block<3, 4>(0, 0));
+
+    const Vec4 pth = pt.homogeneous();
+
+    const Vec2 pt_est = _intrinsics->project(T_pose3, pth, true);
+    const double scale = (_measured.scale > 1e-12) ? _measured.scale : 1.0;
+
+    residuals[0] = (pt_est(0) - _measured.x(0)) / scale;
+    residuals[1] = (pt_est(1) - _measured.x(1)) / scale;
+
+    if (jacobians == nullptr) {
+      return true;
+    }
+
+    Eigen::Matrix2d d_res_d_pt_est = Eigen::Matrix2d::Identity() / scale;
+
+    if (jacobians[0] != nullptr) {
+      Eigen::Map<Eigen::Matrix<double, 2, 16, Eigen::RowMajor>> J(jacobians[0]);
+
+      J = d_res_d_pt_est * _intrinsics->getDerivativeProjectWrtPose(T_pose3, pth) * getJacobian_AB_wrt_B<4, 4, 4>(cTr, rTo) * getJacobian_AB_wrt_A<4, 4, 4>(Eigen::Matrix4d::Identity(), rTo);
+    }
+
+    if (jacobians[1] != nullptr) {
+      Eigen::Map<Eigen::Matrix<double, 2, 16, Eigen::RowMajor>> J(jacobians[1]);
+
+      J = d_res_d_pt_est * _intrinsics->getDerivativeProjectWrtPose(T_pose3, pth) * getJacobian_AB_wrt_A<4, 4, 4>(cTr, rTo) * getJacobian_AB_wrt_A<4, 4, 4>(Eigen::Matrix4d::Identity(), cTr);
+    }
+
+    if (jacobians[2] != nullptr) {
+      Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> J(jacobians[2], 2, params_size);
+
+      J = d_res_d_pt_est * _intrinsics->getDerivativeProjectWrtParams(T_pose3, pth);
+    }
+
+    if (jacobians[3] != nullptr) {
+      Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor>> J(jacobians[3]);
+
+
+      J = d_res_d_pt_est * _intrinsics->getDerivativeProjectWrtPoint(T_pose3, pth) * Eigen::Matrix<double, 4, 3>::Identity();
+    }
+
+    return true;
+  }
+
+private:
+  const sfmData::Observation & _measured;
+  const std::shared_ptr<camera::IntrinsicBase> _intrinsics;
+  bool _withRig;
+};
+
+/**
+ * @brief Identity distortion, with the static interface of the distortion models
+ *        used by CostProjectionPinhole.
+ */
+struct NoDistortion
+{
+  static constexpr int nbParams = 0;
+
+  static Vec2 addDistortion(const double* params, const Vec2 & p)
+  {
+    return p;
+  }
+
+  static Eigen::Matrix2d getDerivativeAddDistoWrtPt(const double* params, const Vec2 & p)
+  {
+    return Eigen::Matrix2d::Identity();
+  }
+
+  static Eigen::Matrix<double, 2, nbParams> getDerivativeAddDistoWrtDisto(const double* params, const Vec2 & p)
+  {
+    return Eigen::Matrix<double, 2, nbParams>();
+  }
+};
+
+/**
+ * @brief Reprojection error of a landmark in a view, for a pinhole camera with the given distortion model.
+ *
+ * The projection and its jacobians are computed from the parameter blocks with fixed-size matrices
+ * and the static functions of the distortion model: no allocation, no virtual call
+ * and the shared intrinsic object is never modified.
+ *
+ * Intrinsic parameters: [fx, fy, offsetX, offsetY, distortion parameters...]
+ */
+template <typename DistortionT>
+class CostProjectionPinhole : public ceres::CostFunction {
+public:
+  static constexpr int nbIntrinsicParams = 4 + DistortionT::nbParams;
+
+  CostProjectionPinhole(const sfmData::Observation& measured, const camera::IntrinsicsScaleOffset& intrinsic)
+    : _measured(measured)
+    , _halfSize(0.5 * double(intrinsic.w()), 0.5 * double(intrinsic.h()))
+  {
+    set_num_residuals(2);
+
+    mutable_parameter_block_sizes()->push_back(16);
+    mutable_parameter_block_sizes()->push_back(16);
+    mutable_parameter_block_sizes()->push_back(int(nbIntrinsicParams));
+    mutable_parameter_block_sizes()->push_back(3);
+  }
+
+  bool Evaluate(double const * const * parameters, double * residuals, double ** jacobians) const override
+  {
+    const double * parameter_pose = parameters[0];
+    const double * parameter_rig = parameters[1];
+    const double * parameter_intrinsics = parameters[2];
+    const double * parameter_landmark = parameters[3];
+
+    const Eigen::Map<const SE3::Matrix> rTo(parameter_pose);
+    const Eigen::Map<const SE3::Matrix> cTr(parameter_rig);
+    const Eigen::Map<const Vec3> pt(parameter_landmark);
+    const Eigen::Map<const Vec2> focal(parameter_intrinsics);
+    const Eigen::Map<const Vec2> offset(parameter_intrinsics + 2);
+    const double * parameter_distortion = parameter_intrinsics + 4;
+
+    const SE3::Matrix T = cTr * rTo;
+    const Vec4 pth = pt.homogeneous();
+    const Vec4 X = T * pth;
+    const Vec2 P = X.head<2>() / X(2);
+
+    const Vec2 distorted = DistortionT::addDistortion(parameter_distortion, P);
+    const Vec2 pt_est = distorted.cwiseProduct(focal) + offset + _halfSize;
+    const double scale = (_measured.scale > 1e-12) ? _measured.scale : 1.0;
+
+    residuals[0] = (pt_est(0) - _measured.x(0)) / scale;
+    residuals[1] = (pt_est(1) - _measured.x(1)) / scale;
+
+    if (jacobians == nullptr) {
+      return true;
+    }
+
+    const double invScale = 1.0 / scale;
+
+    // derivative of the residual wrt the undistorted point in the camera plane
+    Eigen::Matrix2d d_res_d_P = DistortionT::getDerivativeAddDistoWrtPt(parameter_distortion, P);
+    d_res_d_P.row(0) *= focal(0) * invScale;
+    d_res_d_P.row(1) *= focal(1) * invScale;
+
+    Eigen::Matrix<double, 2, 3> d_P_d_X;
+    d_P_d_X(0, 0) = 1 / X(2);
+    d_P_d_X(0, 1) = 0;
+    d_P_d_X(0, 2) = - X(0) / (X(2) * X(2));
+    d_P_d_X(1, 0) = 0;
+    d_P_d_X(1, 1) = 1 / X(2);
+    d_P_d_X(1, 2) = - X(1) / (X(2) * X(2));
+
+    const Eigen::Matrix<double, 2, 3> d_res_d_X = d_res_d_P * d_P_d_X;
+
+    // the poses are updated by a left multiplication (see SE3::LocalParameterization):
+    // with X = A * Y, dX/dvec(A) = kron(Y.t, I) and the blocks of the jacobians are outer products
+
+    if (jacobians[0] != nullptr) {
+      Eigen::Map<Eigen::Matrix<double, 2, 16, Eigen::RowMajor>> J(jacobians[0]);
+
+      // X = cTr * A * (rTo * pth)
+      const Eigen::Matrix<double, 2, 4> d_res_d_AY = d_res_d_X * cTr.block<3, 4>(0, 0);
+      const Vec4 Y = rTo * pth;
+
+      for (int j = 0; j < 4; ++j) {
+        J.block<2, 4>(0, 4 * j) = d_res_d_AY * Y(j);
+      }
+    }
+
+    if (jacobians[1] != nullptr) {
+      Eigen::Map<Eigen::Matrix<double, 2, 16, Eigen::RowMajor>> J(jacobians[1]);
+
+      // X = A * (cTr * rTo * pth)
+      for (int j = 0; j < 4; ++j) {
+        J.block<2, 3>(0, 4 * j) = d_res_d_X * X(j);
+        J.block<2, 1>(0, 4 * j + 3).setZero();
+      }
+    }
+
+    if (jacobians[2] != nullptr) {
+      Eigen::Map<Eigen::Matrix<double, 2, nbIntrinsicParams, Eigen::RowMajor>> J(jacobians[2]);
+
+      J.setZero();
+      // focal
+      J(0, 0) = distorted(0) * invScale;
+      J(1, 1) = distorted(1) * invScale;
+      // principal point
+      J(0, 2) = invScale;
+      J(1, 3) = invScale;
+
+      if (DistortionT::nbParams > 0) {
+        const Eigen::Matrix<double, 2, DistortionT::nbParams> d_disto_d_params = DistortionT::getDerivativeAddDistoWrtDisto(parameter_distortion, P);
+
+        J.template rightCols<DistortionT::nbParams>().row(0) = (focal(0) * invScale) * d_disto_d_params.row(0);
+        J.template rightCols<DistortionT::nbParams>().row(1) = (focal(1) * invScale) * d_disto_d_params.row(1);
+      }
+    }
+
+    if (jacobians[3] != nullptr) {
+      Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor>> J(jacobians[3]);
+
+      J = d_res_d_X * T.template block<3, 3>(0, 0);
+    }
+
+    return true;
+  }
+
+private:
+  const sfmData::Observation & _measured;
+  /// half of the image size (the principal point is the offset from the image center)
+  const Vec2 _halfSize;
+};
+
+/// Function creating the reprojection cost function of an observation in a view
+using CostProjectionCreator = ceres::CostFunction* (*)(const sfmData::Observation& measured, const std::shared_ptr<camera::IntrinsicBase>& intrinsic, bool withRig);
+
+template <typename DistortionT>
+ceres::CostFunction* createCostProjectionPinhole(const sfmData::Observation& measured, const std::shared_ptr<camera::IntrinsicBase>& intrinsic, bool withRig)
+{
+  return new CostProjectionPinhole<DistortionT>(measured, dynamic_cast<const camera::IntrinsicsScaleOffset&>(*intrinsic));
+}
+
+inline ceres::CostFunction* createCostProjection(const sfmData::Observation& measured, const std::shared_ptr<camera::IntrinsicBase>& intrinsic, bool withRig)
+{
+  return new CostProjection(measured, intrinsic, withRig);
+}
+
+/**
+ * @brief Get the creator of the reprojection cost functions of a camera, to choose the cost function once per camera.
+ *        The pinhole cameras with an analytic derivative of their distortion get a fixed-size cost function,
+ *        the other camera models use the generic CostProjection.
+ * @param[in] intrinsic The camera intrinsic
+ * @return the cost function creator
+ */
+inline CostProjectionCreator getCostProjectionCreator(const camera::IntrinsicBase& intrinsic)
+{
+  CostProjectionCreator creator = &createCostProjection;
+  std::size_t nbDistortionParams = 0;
+
+  switch(intrinsic.getType())
+  {
+    case camera::EINTRINSIC::PINHOLE_CAMERA:
+      creator = &createCostProjectionPinhole<NoDistortion>;
+      nbDistortionParams = NoDistortion::nbParams;
+      break;
+    case camera::EINTRINSIC::PINHOLE_CAMERA_RADIAL1:
+      creator = &createCostProjectionPinhole<camera::DistortionRadialK1>;
+      nbDistortionParams = camera::DistortionRadialK1::nbParams;
+      break;
+    case camera::EINTRINSIC::PINHOLE_CAMERA_RADIAL3:
+      creator = &createCostProjectionPinhole<camera::DistortionRadialK3>;
+      nbDistortionParams = camera::DistortionRadialK3::nbParams;
+      break;
+    case camera::EINTRINSIC::PINHOLE_CAMERA_FISHEYE:
+      creator = &createCostProjectionPinhole<camera::DistortionFisheye>;
+      nbDistortionParams = camera::DistortionFisheye::nbParams;
+      break;
+    case camera::EINTRINSIC::PINHOLE_CAMERA_3DERADIAL4:
+      creator = &createCostProjectionPinhole<camera::Distortion3DERadial4>;
+      nbDistortionParams = camera::Distortion3DERadial4::nbParams;
+      break;
+    case camera::EINTRINSIC::PINHOLE_CAMERA_3DEANAMORPHIC4:
+      creator = &createCostProjectionPinhole<camera::Distortion3DEAnamorphic4>;
+      nbDistortionParams = camera::Distortion3DEAnamorphic4::nbParams;
+      break;
+    case camera::EINTRINSIC::PINHOLE_CAMERA_3DECLASSICLD:
+      creator = &createCostProjectionPinhole<camera::Distortion3DEClassicLD>;
+      nbDistortionParams = camera::Distortion3DEClassicLD::nbParams;
+      break;
+    default:
+      // no analytic derivative of the distortion (Brown, Fisheye1) or not a pinhole camera (Equidistant)
+      return creator;
+  }
+
+  // the distortion of the intrinsic should match its type
+  if(intrinsic.getParams().size() != 4 + nbDistortionParams)
+    return &createCostProjection;
+
+  return creator;
+}
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,136 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/CostProjection.hpp>
+#include <aliceVision/camera/camera.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#define BOOST_TEST_MODULE costProjection
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+using namespace aliceVision::sfm;
+
+// small distortion parameters for each camera model
+std::vector<double> getDistortionParams(EINTRINSIC intrinsicType)
+{
+  switch(intrinsicType)
+  {
+    case EINTRINSIC::PINHOLE_CAMERA_RADIAL1:        return {-0.1};
+    case EINTRINSIC::PINHOLE_CAMERA_RADIAL3:        return {-0.1, 0.02, -0.001};
+    case EINTRINSIC::PINHOLE_CAMERA_FISHEYE:        return {0.01, -0.02, 0.003, -0.001};
+    case EINTRINSIC::PINHOLE_CAMERA_3DERADIAL4:     return {-0.1, 0.02, 0.001, -0.002, 0.0005, 0.0003};
+    case EINTRINSIC::PINHOLE_CAMERA_3DEANAMORPHIC4: return {-0.1, 0.02, -0.05, 0.01};
+    case EINTRINSIC::PINHOLE_CAMERA_3DECLASSICLD:   return {-0.1, 0.8, 0.01, -0.02, 0.001};
+    default:                                        return {};
+  }
+}
+
+// parameters and jacobians buffers of the evaluation of a reprojection cost
+struct CostEvaluation
+{
+  explicit CostEvaluation(const std::vector<std::vector<double>>& parameterBlocks)
+    : jacobians(parameterBlocks.size())
+  {
+    for(std::size_t i = 0; i < parameterBlocks.size(); ++i)
+    {
+      jacobians[i].resize(2 * parameterBlocks[i].size());
+      parameters.push_back(parameterBlocks[i].data());
+      jacobiansPtr.push_back(jacobians[i].data());
+    }
+  }
+
+  void evaluate(const ceres::CostFunction& costFunction)
+  {
+    costFunction.Evaluate(parameters.data(), residuals.data(), jacobiansPtr.data());
+  }
+
+  std::array<double, 2> residuals;
+  std::vector<std::vector<double>> jacobians;
+  std::vector<const double*> parameters;
+  std::vector<double*> jacobiansPtr;
+};
+
+// Test summary:
+// - for each pinhole camera model with an analytic derivative of the distortion,
+//   check that the fixed-size cost function gives the same residuals and jacobians as the generic one
+// (the evaluation time of both cost functions is measured by the costProjectionBenchmark sample)
+BOOST_AUTO_TEST_CASE(CostProjection_fixedSizeJacobians)
+{
+  const std::vector<EINTRINSIC> intrinsicTypes = {
+    EINTRINSIC::PINHOLE_CAMERA,
+    EINTRINSIC::PINHOLE_CAMERA_RADIAL1,
+    EINTRINSIC::PINHOLE_CAMERA_RADIAL3,
+    EINTRINSIC::PINHOLE_CAMERA_FISHEYE,
+    EINTRINSIC::PINHOLE_CAMERA_3DERADIAL4,
+    EINTRINSIC::PINHOLE_CAMERA_3DEANAMORPHIC4,
+    EINTRINSIC::PINHOLE_CAMERA_3DECLASSICLD};
+
+  sfmData::Observation observation(Vec2(1000.0, 600.0), 0, 2.0);
+
+  // pose, rig and landmark
+  SE3::Matrix rTo = SE3::Matrix::Identity();
+  rTo.block<3, 3>(0, 0) = RotationAroundY(0.2) * RotationAroundX(-0.1);
+  rTo.block<3, 1>(0, 3) = Vec3(0.1, -0.2, 0.3);
+  SE3::Matrix cTr = SE3::Matrix::Identity();
+  cTr.block<3, 3>(0, 0) = RotationAroundZ(0.05);
+  cTr.block<3, 1>(0, 3) = Vec3(0.05, 0.0, 0.0);
+  const Vec3 X(0.4, 0.3, 4.0);
+
+  for(const EINTRINSIC intrinsicType : intrinsicTypes)
+  {
+    std::shared_ptr<IntrinsicBase> intrinsic = createIntrinsic(intrinsicType, 1920, 1080, 1500.0, 1520.0, 10.0, -5.0);
+    std::shared_ptr<IntrinsicsScaleOffsetDisto> intrinsicDisto = std::dynamic_pointer_cast<IntrinsicsScaleOffsetDisto>(intrinsic);
+    BOOST_REQUIRE(intrinsicDisto);
+    if(intrinsicDisto->hasDistortion())
+      intrinsicDisto->setDistortionParams(getDistortionParams(intrinsicType));
+
+    const std::vector<std::vector<double>> parameterBlocks = {
+      std::vector<double>(rTo.data(), rTo.data() + 16),
+      std::vector<double>(cTr.data(), cTr.data() + 16),
+      intrinsic->getParams(),
+      std::vector<double>(X.data(), X.data() + 3)};
+
+    const CostProjectionCreator creator = getCostProjectionCreator(*intrinsic);
+    BOOST_CHECK(creator != &createCostProjection);
+
+    std::unique_ptr<ceres::CostFunction> genericCost(createCostProjection(observation, intrinsic, true));
+    std::unique_ptr<ceres::CostFunction> fixedSizeCost(creator(observation, intrinsic, true));
+
+    BOOST_CHECK(genericCost->parameter_block_sizes() == fixedSizeCost->parameter_block_sizes());
+
+    CostEvaluation generic(parameterBlocks);
+    CostEvaluation fixedSize(parameterBlocks);
+
+    generic.evaluate(*genericCost);
+    fixedSize.evaluate(*fixedSizeCost);
+
+    for(int i = 0; i < 2; ++i)
+      BOOST_CHECK_SMALL(generic.residuals[i] - fixedSize.residuals[i], 1e-9);
+
+    for(std::size_t b = 0; b < parameterBlocks.size(); ++b)
+      for(std::size_t i = 0; i < generic.jacobians[b].size(); ++i)
+        BOOST_CHECK_SMALL(generic.jacobians[b][i] - fixedSize.jacobians[b][i], 1e-6);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(CostProjection_genericFallback)
+{
+  // no analytic derivative of the distortion
+  for(const EINTRINSIC intrinsicType : {EINTRINSIC::PINHOLE_CAMERA_BROWN,
+                                        EINTRINSIC::PINHOLE_CAMERA_FISHEYE1,
+                                        EINTRINSIC::EQUIDISTANT_CAMERA_RADIAL3})
+  {
+    std::shared_ptr<IntrinsicBase> intrinsic = createIntrinsic(intrinsicType, 1920, 1080, 1500.0, 1500.0, 0.0, 0.0);
+    BOOST_CHECK(getCostProjectionCreator(*intrinsic) == &createCostProjection);
+  }
+}
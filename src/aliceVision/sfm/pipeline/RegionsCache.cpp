@@ -0,0 +1,238 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "RegionsCache.hpp"
+#include <aliceVision/sfm/pipeline/regionsIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision {
+namespace sfm {
+
+RegionsCache::RegionsCache(const sfmData::SfMData& sfmData,
+                           const std::vector<std::string>& folders,
+                           const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
+                           std::size_t maxMemory,
+                           bool memoryMappedDescriptors)
+  : _imageDescriberTypes(imageDescriberTypes)
+  , _maxMemory(maxMemory)
+  , _memoryMappedDescriptors(memoryMappedDescriptors)
+{
+  _folders = sfmData.getFeaturesFolders(); // add sfm features folders
+  _folders.insert(_folders.end(), folders.begin(), folders.end()); // add user features folders
+  auto last = std::unique(_folders.begin(), _folders.end());
+  _folders.erase(last, _folders.end());
+
+  for(const feature::EImageDescriberType imageDescriberType : _imageDescriberTypes)
+    _imageDescribers.push_back(createImageDescriber(imageDescriberType));
+}
+
+RegionsCache::~RegionsCache()
+{
+  if(_prefetchedRegions.valid())
+    _prefetchedRegions.wait();
+}
+
+std::size_t RegionsCache::getViewMemory(IndexT viewId) const
+{
+  const auto it = _viewsMemory.find(viewId);
+  if(it != _viewsMemory.end())
+    return it->second;
+
+  std::size_t memory = 0;
+  const std::string basename = std::to_string(viewId);
+
+  for(const feature::EImageDescriberType imageDescriberType : _imageDescriberTypes)
+  {
+    const std::string imageDescriberTypeName = feature::EImageDescriberType_enumToString(imageDescriberType);
+    std::size_t regionsMemory = 0;
+
+    // same files as loadRegions
+    for(const std::string& folder : _folders)
+    {
+      const fs::path featPath = fs::path(folder) / std::string(basename + "." + imageDescriberTypeName + ".feat");
+      const fs::path descPath = fs::path(folder) / std::string(basename + "." + imageDescriberTypeName + ".desc");
+
+      if(fs::exists(featPath) && fs::exists(descPath))
+        regionsMemory = fs::file_size(featPath) + (_memoryMappedDescriptors ? 0 : fs::file_size(descPath));
+    }
+    memory += regionsMemory;
+  }
+
+  _viewsMemory.emplace(viewId, memory);
+  return memory;
+}
+
+void RegionsCache::load(const std::set<IndexT>& viewIds)
+{
+  waitPrefetch();
+
+  _requiredViews = viewIds;
+
+  std::vector<IndexT> missingViews;
+  std::size_t missingMemory = 0;
+  for(const IndexT viewId : viewIds)
+  {
+    if(!_regionsPerView.viewExist(viewId))
+    {
+      missingViews.push_back(viewId);
+      missingMemory += getViewMemory(viewId);
+    }
+  }
+
+  release(missingMemory, viewIds);
+
+  feature::MapRegionsPerView loadedRegions = loadViews(missingViews, true);
+  for(auto& regionsPerDesc : loadedRegions)
+    _regionsPerView.getData()[regionsPerDesc.first] = std::move(regionsPerDesc.second);
+  _memory += missingMemory;
+
+  ++_useCounter;
+  for(const IndexT viewId : viewIds)
+    _lastUse[viewId] = _useCounter;
+
+  if(_memory > _maxMemory)
+    ALICEVISION_LOG_WARNING("The regions of " << viewIds.size() << " views (" << (_memory >> 20) << " MB) exceed the memory budget (" << (_maxMemory >> 20) << " MB).");
+
+  ALICEVISION_LOG_DEBUG("Regions cache: " << _regionsPerView.getData().size() << " views loaded (" << (_memory >> 20) << " MB).");
+}
+
+void RegionsCache::prefetch(const std::set<IndexT>& viewIds)
+{
+  waitPrefetch();
+
+  std::vector<IndexT> missingViews;
+  std::size_t missingMemory = 0;
+  for(const IndexT viewId : viewIds)
+  {
+    if(!_regionsPerView.viewExist(viewId))
+    {
+      missingViews.push_back(viewId);
+      missingMemory += getViewMemory(viewId);
+    }
+  }
+
+  if(missingViews.empty())
+    return;
+
+  std::set<IndexT> viewIdsToKeep = _requiredViews;
+  viewIdsToKeep.insert(viewIds.begin(), viewIds.end());
+  release(missingMemory, viewIdsToKeep);
+
+  // only prefetch the views that fit in the memory budget, the others will be loaded on demand
+  std::vector<IndexT> prefetchedViews;
+  for(const IndexT viewId : missingViews)
+  {
+    const std::size_t viewMemory = getViewMemory(viewId);
+    if(_memory + viewMemory > _maxMemory)
+      break;
+    _memory += viewMemory;
+    _prefetchedMemory += viewMemory;
+    prefetchedViews.push_back(viewId);
+  }
+
+  if(prefetchedViews.empty())
+    return;
+
+  _prefetchedRegions = std::async(std::launch::async, [this, prefetchedViews]()
+  {
+    return loadViews(prefetchedViews, false);
+  });
+}
+
+feature::MapRegionsPerView RegionsCache::loadViews(const std::vector<IndexT>& viewIds, bool parallel) const
+{
+  feature::MapRegionsPerView regionsPerView;
+  std::string error;
+
+  #pragma omp parallel for if(parallel)
+  for(int i = 0; i < static_cast<int>(viewIds.size()); ++i)
+  {
+    const IndexT viewId = viewIds.at(i);
+    feature::MapRegionsPerDesc regionsPerDesc;
+    try
+    {
+      for(std::size_t d = 0; d < _imageDescriberTypes.size(); ++d)
+        regionsPerDesc[_imageDescriberTypes.at(d)] = loadRegions(_folders, viewId, *(_imageDescribers.at(d)), _memoryMappedDescriptors);
+    }
+    catch(const std::exception& e)
+    {
+      #pragma omp critical
+      error = e.what();
+      continue;
+    }
+
+    #pragma omp critical
+    regionsPerView[viewId] = std::move(regionsPerDesc);
+  }
+
+  if(!error.empty())
+    throw std::runtime_error(error);
+
+  return regionsPerView;
+}
+
+void RegionsCache::waitPrefetch()
+{
+  if(!_prefetchedRegions.valid())
+    return;
+
+  // the memory of the prefetched views is charged in prefetch(), give it back if their loading failed
+  const std::size_t prefetchedMemory = _prefetchedMemory;
+  _prefetchedMemory = 0;
+
+  feature::MapRegionsPerView prefetchedRegions;
+  try
+  {
+    prefetchedRegions = _prefetchedRegions.get();
+  }
+  catch(...)
+  {
+    _memory -= prefetchedMemory;
+    throw;
+  }
+
+  ++_useCounter;
+  for(auto& regionsPerDesc : prefetchedRegions)
+  {
+    _lastUse[regionsPerDesc.first] = _useCounter;
+    _regionsPerView.getData()[regionsPerDesc.first] = std::move(regionsPerDesc.second);
+  }
+}
+
+void RegionsCache::release(std::size_t additionalMemory, const std::set<IndexT>& viewIdsToKeep)
+{
+  if(_memory + additionalMemory <= _maxMemory)
+    return;
+
+  // loaded views by last use
+  std::vector<std::pair<std::size_t, IndexT>> releasableViews;
+  for(const auto& regionsPerDesc : _regionsPerView.getData())
+  {
+    if(viewIdsToKeep.count(regionsPerDesc.first) == 0)
+      releasableViews.emplace_back(_lastUse[regionsPerDesc.first], regionsPerDesc.first);
+  }
+  std::sort(releasableViews.begin(), releasableViews.end());
+
+  for(const auto& view : releasableViews)
+  {
+    if(_memory + additionalMemory <= _maxMemory)
+      break;
+
+    _regionsPerView.removeRegions(view.second);
+    _lastUse.erase(view.second);
+    _memory -= getViewMemory(view.second);
+  }
+}
+
+} // namespace sfm
+} // namespace aliceVision
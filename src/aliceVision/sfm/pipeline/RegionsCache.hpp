@@ -0,0 +1,122 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/feature/ImageDescriber.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/feature/RegionsPerView.hpp>
+
+#include <future>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Regions (Features & Descriptors) of a subset of the views, loaded on demand under a memory budget.
+ *
+ * The memory of the regions of a view is estimated from the size of its regions files.
+ * The regions of the views which are not required anymore are kept as long as the memory budget allows,
+ * the least recently used ones are released first.
+ * The regions of the next required views can be loaded asynchronously while the current ones are used.
+ */
+class RegionsCache
+{
+public:
+  /**
+   * @param[in] sfmData The provided SfMData container
+   * @param[in] folders The feature Folders
+   * @param[in] imageDescriberTypes The imageDescriber types
+   * @param[in] maxMemory The memory budget (in bytes) of the loaded regions
+   * @param[in] memoryMappedDescriptors Map the descriptors files instead of loading them in memory
+   */
+  RegionsCache(const sfmData::SfMData& sfmData,
+               const std::vector<std::string>& folders,
+               const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
+               std::size_t maxMemory,
+               bool memoryMappedDescriptors = false);
+
+  ~RegionsCache();
+
+  /**
+   * @brief Get the estimated memory of the regions of a view
+   * @param[in] viewId The view id
+   * @return the size (in bytes) of the regions files of the view
+   */
+  std::size_t getViewMemory(IndexT viewId) const;
+
+  /**
+   * @brief Get the estimated memory of the loaded regions (including the prefetched ones)
+   */
+  std::size_t getMemory() const
+  {
+    return _memory;
+  }
+
+  /**
+   * @brief Load the regions of the given views, the least recently used other views
+   *        are released to stay under the memory budget.
+   * @note The regions of the views which are not in the given list should not be used anymore.
+   * @param[in] viewIds The required views
+   */
+  void load(const std::set<IndexT>& viewIds);
+
+  /**
+   * @brief Start loading asynchronously the regions of the given views, as far as the memory budget allows.
+   *        The views required by the last call to load() are kept.
+   * @param[in] viewIds The next required views
+   */
+  void prefetch(const std::set<IndexT>& viewIds);
+
+  /**
+   * @brief Get the loaded regions, which contain at least the views given to the last call to load()
+   */
+  const feature::RegionsPerView& getRegionsPerView() const
+  {
+    return _regionsPerView;
+  }
+
+private:
+  /// Load the regions of the given views (in parallel or not)
+  feature::MapRegionsPerView loadViews(const std::vector<IndexT>& viewIds, bool parallel) const;
+
+  /// Wait the end of the prefetching and add the prefetched regions
+  void waitPrefetch();
+
+  /// Release the least recently used views (except the given ones) until the additional memory fits in the budget
+  void release(std::size_t additionalMemory, const std::set<IndexT>& viewIdsToKeep);
+
+  std::vector<std::string> _folders;
+  std::vector<feature::EImageDescriberType> _imageDescriberTypes;
+  std::vector<std::unique_ptr<feature::ImageDescriber>> _imageDescribers;
+  std::size_t _maxMemory;
+  bool _memoryMappedDescriptors;
+
+  feature::RegionsPerView _regionsPerView;
+  /// estimated memory of the loaded and prefetched regions
+  std::size_t _memory = 0;
+  /// estimated memory of the views regions
+  mutable std::map<IndexT, std::size_t> _viewsMemory;
+  /// last use of the loaded views (use counter)
+  std::map<IndexT, std::size_t> _lastUse;
+  std::size_t _useCounter = 0;
+  /// views required by the last call to load()
+  std::set<IndexT> _requiredViews;
+  /// regions being prefetched
+  std::future<feature::MapRegionsPerView> _prefetchedRegions;
+  /// estimated memory of the regions being prefetched
+  std::size_t _prefetchedMemory = 0;
+};
+
+} // namespace sfm
+} // namespace aliceVision
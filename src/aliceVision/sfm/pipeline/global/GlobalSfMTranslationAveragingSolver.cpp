@@ -39,6 +39,64 @@ using namespace aliceVision::camera;
 using namespace aliceVision::geometry;
 using namespace aliceVision::sfmData;
 
+void buildPosePairMatchesIndex(const SfMData& sfmData,
+                               const matching::PairwiseMatches& pairwiseMatches,
+                               PosePairMatchesIndex& index)
+{
+  index.clear();
+  for (const auto & match_iterator : pairwiseMatches)
+  {
+    const Pair& pair = match_iterator.first;
+    const IndexT poseI = sfmData.getViews().at(pair.first)->getPoseId();
+    const IndexT poseJ = sfmData.getViews().at(pair.second)->getPoseId();
+    if (poseI == poseJ)
+      continue;
+    index[std::minmax(poseI, poseJ)].push_back(&match_iterator);
+  }
+}
+
+void getTripletMatches(const PosePairMatchesIndex& index,
+                       const graph::Triplet& triplet,
+                       matching::PairwiseMatches& tripletMatches)
+{
+  tripletMatches.clear();
+  const Pair edges[3] = {std::minmax(triplet.i, triplet.j),
+                         std::minmax(triplet.i, triplet.k),
+                         std::minmax(triplet.j, triplet.k)};
+  for (const Pair& edge : edges)
+  {
+    const auto it = index.find(edge);
+    if (it == index.end())
+      continue;
+    for (const matching::PairwiseMatches::value_type* matches : it->second)
+      tripletMatches.insert(*matches);
+  }
+}
+
+void computeTracksPerTriplet(const PosePairMatchesIndex& index,
+                             const std::vector<graph::Triplet>& triplets,
+                             std::vector<std::size_t>& tracksPerTriplet)
+{
+  tracksPerTriplet.assign(triplets.size(), 0);
+
+  // one tracks builder per thread, its buffers are reused from one triplet to the next
+  std::vector<track::TracksBuilder> tracksBuilders(omp_get_max_threads());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < (int)triplets.size(); ++i)
+  {
+    // List matches that belong to the triplet of poses
+    matching::PairwiseMatches tripletMatches;
+    getTripletMatches(index, triplets[i], tripletMatches);
+
+    // Compute tracks:
+    track::TracksBuilder& tracksBuilder = tracksBuilders[omp_get_thread_num()];
+    tracksBuilder.build(tripletMatches);
+    tracksBuilder.filter(true, 3, false);
+    tracksPerTriplet[i] = tracksBuilder.nbTracks(); //count the # of matches in the UF tree
+  }
+}
+
 /// Use features in normalized camera frames
 bool GlobalSfMTranslationAveragingSolver::Run(ETranslationAveragingMethod eTranslationAveragingMethod,
                     SfMData& sfmData,
@@ -325,19 +383,15 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
   std::transform(map_globalR.begin(), map_globalR.end(),
     std::inserter(set_pose_ids, set_pose_ids.begin()), stl::RetrieveKey());
   // List shared correspondences (pairs) between poses
-  for (const auto & match_iterator : pairwiseMatches)
+  PosePairMatchesIndex posePairMatches;
+  buildPosePairMatchesIndex(sfmData, pairwiseMatches, posePairMatches);
+  for (const auto & posePair : posePairMatches)
   {
-    const Pair pair = match_iterator.first;
-    const View * v1 = sfmData.getViews().at(pair.first).get();
-    const View * v2 = sfmData.getViews().at(pair.second).get();
-
-    if (// Consider the pair iff it is supported by the rotation graph
-        (v1->getPoseId() != v2->getPoseId())
-        && set_pose_ids.count(v1->getPoseId())
-        && set_pose_ids.count(v2->getPoseId()))
+    // Consider the pair iff it is supported by the rotation graph
+    if (set_pose_ids.count(posePair.first.first)
+        && set_pose_ids.count(posePair.first.second))
     {
-      rotation_pose_id_graph.insert(
-        std::make_pair(v1->getPoseId(), v2->getPoseId()));
+      rotation_pose_id_graph.insert(posePair.first);
     }
   }
   // List putative triplets (from global rotations Ids)
@@ -351,39 +405,8 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
     // An estimated triplets of translation mark three edges as estimated.
 
     //-- precompute the number of track per triplet:
-    HashMap<IndexT, IndexT> map_tracksPerTriplets;
-
-    #pragma omp parallel for schedule(dynamic)
-    for (int i = 0; i < (int)vec_triplets.size(); ++i)
-    {
-      // List matches that belong to the triplet of poses
-      const graph::Triplet & triplet = vec_triplets[i];
-      matching::PairwiseMatches map_triplet_matches;
-      const std::set<IndexT> set_triplet_pose_ids = {triplet.i, triplet.j, triplet.k};
-      // List shared correspondences (pairs) between the triplet poses
-      for (const auto & match_iterator : pairwiseMatches)
-      {
-        const Pair pair = match_iterator.first;
-        const View * v1 = sfmData.getViews().at(pair.first).get();
-        const View * v2 = sfmData.getViews().at(pair.second).get();
-        if (// Consider the pair iff it is supported by the triplet graph & 2 different pose id
-            (v1->getPoseId() != v2->getPoseId())
-            && set_triplet_pose_ids.count(v1->getPoseId())
-            && set_triplet_pose_ids.count(v2->getPoseId()))
-        {
-          map_triplet_matches.insert( match_iterator );
-        }
-      }
-      // Compute tracks:
-      {
-        aliceVision::track::TracksBuilder tracksBuilder;
-        tracksBuilder.build(map_triplet_matches);
-        tracksBuilder.filter(true,3);
-
-        #pragma omp critical
-        map_tracksPerTriplets[i] = tracksBuilder.nbTracks(); //count the # of matches in the UF tree
-      }
-    }
+    std::vector<std::size_t> vec_tracksPerTriplets;
+    computeTracksPerTriplet(posePairMatches, vec_triplets, vec_tracksPerTriplets);
 
     typedef Pair myEdge;
 
@@ -429,7 +452,7 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
         std::vector<size_t> vec_commonTracksPerTriplets;
         for (const size_t triplet_index : vec_possibleTripletIndexes)
         {
-          vec_commonTracksPerTriplets.push_back(map_tracksPerTriplets[triplet_index]);
+          vec_commonTracksPerTriplets.push_back(vec_tracksPerTriplets[triplet_index]);
         }
 
         using namespace stl::indexed_sort;
@@ -468,7 +491,7 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
               sfmData,
               map_globalR,
               normalizedFeaturesPerView,
-              pairwiseMatches,
+              posePairMatches,
               triplet,
               randomNumberGenerator,
               vec_tis,
@@ -590,7 +613,7 @@ bool GlobalSfMTranslationAveragingSolver::Estimate_T_triplet(
   const SfMData& sfmData,
   const HashMap<IndexT, Mat3>& map_globalR,
   const feature::FeaturesPerView& normalizedFeaturesPerView,
-  const matching::PairwiseMatches& pairwiseMatches,
+  const PosePairMatchesIndex& posePairMatches,
   const graph::Triplet& poses_id,
   std::mt19937 & randomNumberGenerator,
   std::vector<Vec3>& vec_tis,
@@ -601,21 +624,7 @@ bool GlobalSfMTranslationAveragingSolver::Estimate_T_triplet(
 {
   // List matches that belong to the triplet of poses
   matching::PairwiseMatches map_triplet_matches;
-  const std::set<IndexT> set_pose_ids = {poses_id.i, poses_id.j, poses_id.k};
-  // List shared correspondences (pairs) between poses
-  for (const auto & match_iterator : pairwiseMatches)
-  {
-    const Pair& pair = match_iterator.first;
-    const View* v1 = sfmData.getViews().at(pair.first).get();
-    const View* v2 = sfmData.getViews().at(pair.second).get();
-    if (// Consider the pair iff it is supported by the triplet graph & 2 different pose id
-        (v1->getPoseId() != v2->getPoseId())
-        && set_pose_ids.count(v1->getPoseId())
-        && set_pose_ids.count(v2->getPoseId()))
-    {
-      map_triplet_matches.insert( match_iterator );
-    }
-  }
+  getTripletMatches(posePairMatches, poses_id, map_triplet_matches);
 
   aliceVision::track::TracksBuilder tracksBuilder;
   tracksBuilder.build(map_triplet_matches);
@@ -14,6 +14,9 @@
 #include <aliceVision/track/TracksBuilder.hpp>
 #include <aliceVision/graph/graph.hpp>
 
+#include <map>
+#include <vector>
+
 namespace aliceVision {
 namespace sfm {
 
@@ -60,6 +63,43 @@ inline std::istream& operator>>(std::istream& in, ETranslationAveragingMethod& t
     return in;
 }
 
+/**
+ * @brief Pairwise matches grouped by pair of poses (smallest pose id first).
+ * Pairs of views sharing the same pose are not indexed.
+ */
+using PosePairMatchesIndex = std::map<Pair, std::vector<const matching::PairwiseMatches::value_type*>>;
+
+/**
+ * @brief Build the index of the pairwise matches per pair of poses
+ * @param[in] sfmData The scene (for the pose id of each view)
+ * @param[in] pairwiseMatches The pairwise matches, must outlive the index
+ * @param[out] index The pairwise matches per pair of poses
+ */
+void buildPosePairMatchesIndex(const sfmData::SfMData& sfmData,
+                               const matching::PairwiseMatches& pairwiseMatches,
+                               PosePairMatchesIndex& index);
+
+/**
+ * @brief Get the pairwise matches between the poses of a triplet,
+ *        only the three edges of the triplet are looked up in the index.
+ * @param[in] index The pairwise matches per pair of poses
+ * @param[in] triplet The triplet of poses
+ * @param[out] tripletMatches The pairwise matches of the triplet
+ */
+void getTripletMatches(const PosePairMatchesIndex& index,
+                       const graph::Triplet& triplet,
+                       matching::PairwiseMatches& tripletMatches);
+
+/**
+ * @brief Count the tracks visible in the three poses of each triplet
+ * @param[in] index The pairwise matches per pair of poses
+ * @param[in] triplets The triplets of poses
+ * @param[out] tracksPerTriplet The number of tracks of each triplet
+ */
+void computeTracksPerTriplet(const PosePairMatchesIndex& index,
+                             const std::vector<graph::Triplet>& triplets,
+                             std::vector<std::size_t>& tracksPerTriplet);
+
 class GlobalSfMTranslationAveragingSolver
 {
   translationAveraging::RelativeInfoVec m_vec_initialRijTijEstimates;
@@ -109,7 +149,7 @@ private:
   bool Estimate_T_triplet(const sfmData::SfMData& sfmData,
            const HashMap<IndexT, Mat3>& map_globalR,
            const feature::FeaturesPerView& normalizedFeaturesPerView,
-           const matching::PairwiseMatches& pairwiseMatches,
+           const PosePairMatchesIndex& posePairMatches,
            const graph::Triplet& poses_id,
            std::mt19937 & randomNumberGenerator,
            std::vector<Vec3>& vec_tis,
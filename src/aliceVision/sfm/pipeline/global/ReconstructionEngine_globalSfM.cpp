@@ -285,25 +285,24 @@ bool ReconstructionEngine_globalSfM::Compute_Initial_Structure(matching::Pairwis
     tracksBuilder.build(tripletWise_matches);
 #endif
     tracksBuilder.filter(true,3);
-    TracksMap map_selectedTracks; // reconstructed track (visibility per 3D point)
-    tracksBuilder.exportToSTL(map_selectedTracks);
+    TracksCSR selectedTracks; // reconstructed track (visibility per 3D point)
+    tracksBuilder.exportToCSR(selectedTracks);
 
     // Fill sfm_data with the computed tracks (no 3D yet)
     Landmarks & structure = _sfmData.structure;
-    IndexT idx(0);
-    for (TracksMap::const_iterator itTracks = map_selectedTracks.begin();
-      itTracks != map_selectedTracks.end();
-      ++itTracks, ++idx)
+    const std::vector<IndexT>& obsViewIds = selectedTracks.obsViewIds();
+    const std::vector<IndexT>& obsFeatIds = selectedTracks.obsFeatIds();
+    for (std::size_t t = 0; t < selectedTracks.nbTracks(); ++t)
     {
-      const Track & track = itTracks->second;
-      Landmark& newLandmark = structure[idx];
-      newLandmark.descType = track.descType;
+      const feature::EImageDescriberType descType = selectedTracks.descType(t);
+      Landmark& newLandmark = structure[IndexT(t)];
+      newLandmark.descType = descType;
       Observations & obs = newLandmark.observations;
-      for (Track::FeatureIdPerView::const_iterator it = track.featPerView.begin(); it != track.featPerView.end(); ++it)
+      for (std::size_t i = selectedTracks.trackBegin(t); i < selectedTracks.trackEnd(t); ++i)
       {
-        const size_t imaIndex = it->first;
-        const size_t featIndex = it->second;
-        const PointFeature & pt = _featuresPerView->getFeatures(imaIndex, track.descType)[featIndex];
+        const size_t imaIndex = obsViewIds[i];
+        const size_t featIndex = obsFeatIds[i];
+        const PointFeature & pt = _featuresPerView->getFeatures(imaIndex, descType)[featIndex];
 
         const double scale = (_featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : pt.scale();
         obs[imaIndex] = Observation(pt.coords().cast<double>(), featIndex, scale);
@@ -316,19 +315,19 @@ bool ReconstructionEngine_globalSfM::Compute_Initial_Structure(matching::Pairwis
       //-- Display stats:
       //    - number of images
       //    - number of tracks
-      std::set<size_t> set_imagesId;
-      imageIdInTracks(map_selectedTracks, set_imagesId);
+      const std::vector<IndexT>& imagesId = selectedTracks.viewIds();
       osTrack << "------------------" << "\n"
         << "-- Tracks Stats --" << "\n"
         << " Tracks number: " << tracksBuilder.nbTracks() << "\n"
         << " Images Id: " << "\n";
-      std::copy(set_imagesId.begin(),
-        set_imagesId.end(),
-        std::ostream_iterator<size_t>(osTrack, ", "));
+      std::copy(imagesId.begin(),
+        imagesId.end(),
+        std::ostream_iterator<IndexT>(osTrack, ", "));
       osTrack << "\n------------------" << "\n";
 
       std::map<size_t, size_t> map_Occurence_TrackLength;
-      tracksLength(map_selectedTracks, map_Occurence_TrackLength);
+      for (std::size_t t = 0; t < selectedTracks.nbTracks(); ++t)
+        ++map_Occurence_TrackLength[selectedTracks.trackLength(t)];
       osTrack << "TrackLength, Occurrence" << "\n";
       for (std::map<size_t, size_t>::const_iterator iter = map_Occurence_TrackLength.begin();
         iter != map_Occurence_TrackLength.end(); ++iter)  {
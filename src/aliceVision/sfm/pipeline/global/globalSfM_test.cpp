@@ -10,6 +10,7 @@
 #include <aliceVision/feature/FeaturesPerView.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/sfm/sfm.hpp>
+#include <aliceVision/sfm/pipeline/global/GlobalSfMTranslationAveragingSolver.hpp>
 
 #include <boost/filesystem.hpp>
 
@@ -245,3 +246,56 @@ BOOST_AUTO_TEST_CASE(GLOBAL_SFM_RotationAveragingL2_TranslationAveragingSoftL1)
   BOOST_CHECK(sfmEngine.getSfMData().getPoses().size() == nviews);
   BOOST_CHECK(sfmEngine.getSfMData().getLandmarks().size() == npoints);
 }
+
+// Compare the tracks per triplet computed from the pose pair index
+// with the scan of all the pairwise matches for each triplet.
+BOOST_AUTO_TEST_CASE(GLOBAL_SFM_TracksPerTriplet)
+{
+  const int nviews = 16;
+  const int npoints = 256;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  const SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+  PosePairMatchesIndex posePairMatches;
+  buildPosePairMatchesIndex(sfmData, pairwiseMatches, posePairMatches);
+
+  PairSet posePairs;
+  for(const auto& posePair : posePairMatches)
+    posePairs.insert(posePair.first);
+  const std::vector<graph::Triplet> triplets = graph::tripletListing(posePairs);
+  // each view is matched with its two next neighbors on the ring
+  BOOST_CHECK_EQUAL(triplets.size(), nviews);
+
+  std::vector<std::size_t> tracksPerTriplet;
+  computeTracksPerTriplet(posePairMatches, triplets, tracksPerTriplet);
+
+  // reference: scan all the pairwise matches for each triplet
+  std::vector<std::size_t> refTracksPerTriplet(triplets.size());
+  for(std::size_t i = 0; i < triplets.size(); ++i)
+  {
+    const graph::Triplet& triplet = triplets[i];
+    const std::set<IndexT> tripletPoseIds = {triplet.i, triplet.j, triplet.k};
+    matching::PairwiseMatches tripletMatches;
+    for(const auto& matches : pairwiseMatches)
+    {
+      const IndexT poseI = sfmData.getViews().at(matches.first.first)->getPoseId();
+      const IndexT poseJ = sfmData.getViews().at(matches.first.second)->getPoseId();
+      if(poseI != poseJ && tripletPoseIds.count(poseI) && tripletPoseIds.count(poseJ))
+        tripletMatches.insert(matches);
+    }
+    track::TracksBuilder tracksBuilder;
+    tracksBuilder.build(tripletMatches);
+    tracksBuilder.filter(true, 3);
+    refTracksPerTriplet[i] = tracksBuilder.nbTracks();
+  }
+
+  BOOST_CHECK(tracksPerTriplet == refTracksPerTriplet);
+  for(const std::size_t nbTracks : tracksPerTriplet)
+    BOOST_CHECK_EQUAL(nbTracks, npoints);
+}
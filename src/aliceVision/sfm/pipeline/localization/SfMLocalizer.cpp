@@ -131,7 +131,8 @@ bool SfMLocalizer::Localize(const Pair& imageSize,
         const double threshold = resectionData.error_max * resectionData.error_max * (kernel.normalizer2()(0, 0) * kernel.normalizer2()(0, 0));
         robustEstimation::ScoreEvaluator<KernelT> scorer(threshold);
 
-        const robustEstimation::Mat34Model model = robustEstimation::LO_RANSAC(kernel, scorer, randomNumberGenerator, &resectionData.vec_inliers);
+        const robustEstimation::Mat34Model model = robustEstimation::LO_RANSAC(kernel, scorer, randomNumberGenerator, &resectionData.vec_inliers,
+                                                                               nullptr, false, 100, 1e-2, resectionData.useSprt);
         P = model.getMatrix();
 
         break;
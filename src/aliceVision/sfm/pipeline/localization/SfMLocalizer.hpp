@@ -42,6 +42,8 @@ struct ImageLocalizerMatchData
   /// Upper bound pixel(s) tolerance for residual errors
   double error_max = std::numeric_limits<double>::infinity();
   size_t max_iteration = 4096;
+  /// Verify the hypotheses with a SPRT (LORansac only)
+  bool useSprt = false;
 };
 
 class SfMLocalizer
@@ -0,0 +1,546 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/pipeline/partitioned/ReconstructionEngine_partitionedSfM.hpp>
+#include <aliceVision/sfm/utils/alignment.hpp>
+#include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
+#include <aliceVision/sfm/sfmFilters.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <tuple>
+
+namespace aliceVision {
+namespace sfm {
+
+using namespace aliceVision::sfmData;
+
+namespace fs = boost::filesystem;
+
+void buildViewGraph(const matching::PairwiseMatches& pairwiseMatches, ViewGraph& viewGraph)
+{
+  viewGraph.clear();
+
+  for(const auto& matchesPair : pairwiseMatches)
+  {
+    const std::size_t nbMatches = matchesPair.second.getNbAllMatches();
+    if(nbMatches == 0)
+      continue;
+
+    const Pair& pair = matchesPair.first;
+    viewGraph[pair.first][pair.second] += nbMatches;
+    viewGraph[pair.second][pair.first] += nbMatches;
+  }
+}
+
+void partitionViewGraph(const ViewGraph& viewGraph,
+                        std::size_t maxClusterSize,
+                        double clusterOverlap,
+                        std::vector<std::set<IndexT>>& clusters)
+{
+  clusters.clear();
+
+  // a cluster needs at least an initial pair
+  const std::size_t clusterSize = std::max(maxClusterSize, std::size_t(2));
+
+  // seeds are taken from the most connected views
+  std::vector<std::pair<std::size_t, IndexT>> seeds;
+  seeds.reserve(viewGraph.size());
+  for(const auto& viewEdges : viewGraph)
+  {
+    std::size_t nbMatches = 0;
+    for(const auto& edge : viewEdges.second)
+      nbMatches += edge.second;
+    seeds.emplace_back(nbMatches, viewEdges.first);
+  }
+  std::sort(seeds.begin(), seeds.end(), std::greater<std::pair<std::size_t, IndexT>>());
+
+  // grow disjoint cores following the strongest connections to the core
+  std::map<IndexT, std::size_t> clusterPerView;
+  std::vector<std::set<IndexT>> cores;
+
+  for(const auto& seed : seeds)
+  {
+    if(clusterPerView.count(seed.second))
+      continue;
+
+    const std::size_t coreId = cores.size();
+    std::set<IndexT> core;
+    std::map<IndexT, std::size_t> connections;
+
+    const auto addToCore = [&](IndexT viewId)
+    {
+      core.insert(viewId);
+      clusterPerView[viewId] = coreId;
+      connections.erase(viewId);
+      for(const auto& edge : viewGraph.at(viewId))
+      {
+        if(!clusterPerView.count(edge.first))
+          connections[edge.first] += edge.second;
+      }
+    };
+
+    addToCore(seed.second);
+    while(core.size() < clusterSize && !connections.empty())
+    {
+      const auto bestIt = std::max_element(connections.begin(), connections.end(),
+        [](const std::pair<const IndexT, std::size_t>& a, const std::pair<const IndexT, std::size_t>& b)
+        {
+          return a.second < b.second;
+        });
+      addToCore(bestIt->first);
+    }
+
+    // a core surrounded by assigned views is too small to be reconstructed alone,
+    // attach it to its most connected core
+    if(core.size() < 3 && !cores.empty())
+    {
+      std::map<std::size_t, std::size_t> connectionsPerCore;
+      for(const IndexT viewId : core)
+      {
+        for(const auto& edge : viewGraph.at(viewId))
+        {
+          const std::size_t neighbourCoreId = clusterPerView.at(edge.first);
+          if(neighbourCoreId != coreId)
+            connectionsPerCore[neighbourCoreId] += edge.second;
+        }
+      }
+
+      if(!connectionsPerCore.empty())
+      {
+        const std::size_t bestCoreId = std::max_element(connectionsPerCore.begin(), connectionsPerCore.end(),
+          [](const std::pair<const std::size_t, std::size_t>& a, const std::pair<const std::size_t, std::size_t>& b)
+          {
+            return a.second < b.second;
+          })->first;
+
+        for(const IndexT viewId : core)
+        {
+          cores.at(bestCoreId).insert(viewId);
+          clusterPerView[viewId] = bestCoreId;
+        }
+        continue;
+      }
+    }
+    cores.push_back(std::move(core));
+  }
+
+  if(cores.size() == 1)
+  {
+    clusters = std::move(cores);
+    return;
+  }
+
+  // extend each core with its most connected neighbouring views to share them with the other clusters
+  clusters.reserve(cores.size());
+  for(const std::set<IndexT>& core : cores)
+  {
+    std::map<IndexT, std::size_t> connections;
+    for(const IndexT viewId : core)
+    {
+      for(const auto& edge : viewGraph.at(viewId))
+      {
+        if(!core.count(edge.first))
+          connections[edge.first] += edge.second;
+      }
+    }
+
+    std::vector<std::pair<std::size_t, IndexT>> neighbours;
+    neighbours.reserve(connections.size());
+    for(const auto& connection : connections)
+      neighbours.emplace_back(connection.second, connection.first);
+    std::sort(neighbours.begin(), neighbours.end(), std::greater<std::pair<std::size_t, IndexT>>());
+
+    const std::size_t nbOverlapViews = std::min(neighbours.size(), static_cast<std::size_t>(std::ceil(clusterOverlap * core.size())));
+
+    std::set<IndexT> cluster = core;
+    for(std::size_t i = 0; i < nbOverlapViews; ++i)
+      cluster.insert(neighbours.at(i).second);
+
+    clusters.push_back(std::move(cluster));
+  }
+}
+
+std::size_t mergeSfMData(SfMData& sfmData, const SfMData& clusterSfMData)
+{
+  // intrinsics: keep the first reconstruction of each intrinsic
+  const std::set<IndexT> reconstructedIntrinsics = sfmData.getReconstructedIntrinsics();
+  for(const IndexT intrinsicId : clusterSfMData.getReconstructedIntrinsics())
+  {
+    if(!reconstructedIntrinsics.count(intrinsicId))
+      sfmData.getIntrinsics()[intrinsicId] = std::shared_ptr<camera::IntrinsicBase>(clusterSfMData.getIntrinsics().at(intrinsicId)->clone());
+  }
+
+  // poses: keep the poses already in the scene
+  for(const auto& posePair : clusterSfMData.getPoses())
+    sfmData.getPoses().emplace(posePair.first, posePair.second);
+
+  // rigs: keep the rigs already initialized in the scene
+  for(const auto& rigPair : clusterSfMData.getRigs())
+  {
+    auto rigIt = sfmData.getRigs().find(rigPair.first);
+    if(rigIt == sfmData.getRigs().end())
+      sfmData.getRigs().emplace(rigPair.first, rigPair.second);
+    else if(!rigIt->second.isInitialized() && rigPair.second.isInitialized())
+      rigIt->second = rigPair.second;
+  }
+
+  // landmarks: a feature belongs to a single landmark, fuse the landmarks sharing a feature
+  using ObservationKey = std::tuple<feature::EImageDescriberType, IndexT, IndexT>;
+  std::map<ObservationKey, IndexT> landmarkPerObservation;
+  IndexT nextLandmarkId = 0;
+  std::size_t nbConflictingLandmarks = 0;
+
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    nextLandmarkId = std::max(nextLandmarkId, landmarkPair.first + 1);
+    for(const auto& observationPair : landmarkPair.second.observations)
+      landmarkPerObservation.emplace(ObservationKey(landmarkPair.second.descType, observationPair.first, observationPair.second.id_feat), landmarkPair.first);
+  }
+
+  for(const auto& landmarkPair : clusterSfMData.getLandmarks())
+  {
+    const Landmark& clusterLandmark = landmarkPair.second;
+
+    // scene landmarks sharing a feature with the cluster landmark
+    std::set<IndexT> sceneLandmarkIds;
+    for(const auto& observationPair : clusterLandmark.observations)
+    {
+      const auto it = landmarkPerObservation.find(ObservationKey(clusterLandmark.descType, observationPair.first, observationPair.second.id_feat));
+      if(it != landmarkPerObservation.end())
+        sceneLandmarkIds.insert(it->second);
+    }
+
+    // the track joins several scene landmarks
+    if(sceneLandmarkIds.size() > 1)
+    {
+      ++nbConflictingLandmarks;
+      continue;
+    }
+
+    IndexT landmarkId = UndefinedIndexT;
+    if(sceneLandmarkIds.empty())
+    {
+      landmarkId = nextLandmarkId++;
+      sfmData.getLandmarks().emplace(landmarkId, Landmark(clusterLandmark.X, clusterLandmark.descType, Observations(), clusterLandmark.rgb));
+    }
+    else
+    {
+      landmarkId = *sceneLandmarkIds.begin();
+
+      // the track observes another feature than the scene landmark in a view
+      const Observations& observations = sfmData.getLandmarks().at(landmarkId).observations;
+      const bool isConflicting = std::any_of(clusterLandmark.observations.begin(), clusterLandmark.observations.end(),
+        [&](const Observations::value_type& observationPair)
+        {
+          const auto it = observations.find(observationPair.first);
+          return it != observations.end() && it->second.id_feat != observationPair.second.id_feat;
+        });
+
+      if(isConflicting)
+      {
+        ++nbConflictingLandmarks;
+        continue;
+      }
+    }
+
+    Landmark& landmark = sfmData.getLandmarks().at(landmarkId);
+    for(const auto& observationPair : clusterLandmark.observations)
+    {
+      if(!landmark.observations.emplace(observationPair.first, observationPair.second).second)
+        continue;
+      landmarkPerObservation.emplace(ObservationKey(clusterLandmark.descType, observationPair.first, observationPair.second.id_feat), landmarkId);
+    }
+  }
+  return nbConflictingLandmarks;
+}
+
+ReconstructionEngine_partitionedSfM::ReconstructionEngine_partitionedSfM(const SfMData& sfmData,
+                                                                         const Params& params,
+                                                                         const std::string& outputFolder)
+  : ReconstructionEngine(sfmData, outputFolder)
+  , _params(params)
+{}
+
+bool ReconstructionEngine_partitionedSfM::process()
+{
+  ViewGraph viewGraph;
+  buildViewGraph(*_pairwiseMatches, viewGraph);
+  partitionViewGraph(viewGraph, _params.maxClusterSize, _params.clusterOverlap, _clusters);
+
+  if(_clusters.empty())
+  {
+    ALICEVISION_LOG_ERROR("Partitioned SfM: no view is connected.");
+    return false;
+  }
+
+  {
+    std::stringstream ss;
+    for(std::size_t i = 0; i < _clusters.size(); ++i)
+      ss << "\t- cluster " << i << ": " << _clusters.at(i).size() << " views" << std::endl;
+
+    ALICEVISION_LOG_INFO("Partitioned SfM: " << viewGraph.size() << " connected views cut into " << _clusters.size() << " clusters:" << std::endl << ss.str());
+  }
+
+  if(!reconstructClusters())
+    return false;
+
+  return adjust();
+}
+
+bool ReconstructionEngine_partitionedSfM::reconstructClusters()
+{
+  aliceVision::system::Timer timer;
+
+  // index the pairs by their first view, the clusters reference their matches without copy
+  std::map<IndexT, std::vector<matching::PairwiseMatches::const_iterator>> pairsPerView;
+  for(matching::PairwiseMatches::const_iterator it = _pairwiseMatches->begin(); it != _pairwiseMatches->end(); ++it)
+    pairsPerView[it->first.first].push_back(it);
+
+  // draw the seeds beforehand to keep the reconstruction deterministic
+  std::vector<int> clusterSeeds(_clusters.size());
+  std::uniform_int_distribution<int> seedDistribution(0, std::numeric_limits<int>::max());
+  for(int& seed : clusterSeeds)
+    seed = seedDistribution(_randomNumberGenerator);
+
+  // the clusters are reconstructed by batches of nbParallelClusters and merged after each batch,
+  // only the reconstructions waiting for enough common views with the scene are kept
+  const std::size_t batchSize = static_cast<std::size_t>(std::max(_params.nbParallelClusters, 1));
+  std::map<std::size_t, SfMData> waitingClusters;
+  std::set<IndexT> droppedViews;
+
+  for(std::size_t batchStart = 0; batchStart < _clusters.size(); batchStart += batchSize)
+  {
+    const std::size_t batchEnd = std::min(batchStart + batchSize, _clusters.size());
+    std::vector<SfMData> batchSfMData(batchEnd - batchStart);
+
+#pragma omp parallel for schedule(dynamic) num_threads(static_cast<int>(batchSize))
+    for(int i = static_cast<int>(batchStart); i < static_cast<int>(batchEnd); ++i)
+      reconstructCluster(i, pairsPerView, clusterSeeds.at(i), batchSfMData.at(i - batchStart));
+
+    for(std::size_t i = batchStart; i < batchEnd; ++i)
+    {
+      if(!batchSfMData.at(i - batchStart).getPoses().empty())
+        waitingClusters.emplace(i, std::move(batchSfMData.at(i - batchStart)));
+    }
+
+    mergeClusters(waitingClusters, droppedViews);
+  }
+
+  ALICEVISION_LOG_INFO("Partitioned SfM: clusters reconstruction took (s): " << timer.elapsed());
+
+  if(_sfmData.getPoses().empty())
+  {
+    ALICEVISION_LOG_ERROR("Partitioned SfM: no cluster has been reconstructed.");
+    return false;
+  }
+
+  // the views reconstructed only in clusters that cannot be merged are lost
+  for(const auto& clusterPair : waitingClusters)
+  {
+    const std::set<IndexT> clusterViews = clusterPair.second.getValidViews();
+    droppedViews.insert(clusterViews.begin(), clusterViews.end());
+  }
+
+  _unmergedViews.clear();
+  for(const IndexT viewId : droppedViews)
+  {
+    if(!_sfmData.isPoseAndIntrinsicDefined(viewId))
+      _unmergedViews.insert(viewId);
+  }
+
+  if(!waitingClusters.empty() || !_unmergedViews.empty())
+  {
+    std::stringstream ss;
+    for(const IndexT viewId : _unmergedViews)
+      ss << " " << viewId;
+
+    ALICEVISION_LOG_WARNING("Partitioned SfM: " << waitingClusters.size() << " reconstructed cluster(s) do not share enough views with the scene to be merged, "
+                            << _unmergedViews.size() << " reconstructed view(s) are lost:" << ss.str());
+  }
+
+  return true;
+}
+
+void ReconstructionEngine_partitionedSfM::reconstructCluster(std::size_t clusterId,
+                                                             const std::map<IndexT, std::vector<matching::PairwiseMatches::const_iterator>>& pairsPerView,
+                                                             int seed,
+                                                             SfMData& clusterSfMData)
+{
+  const std::set<IndexT>& cluster = _clusters.at(clusterId);
+
+  for(const IndexT viewId : cluster)
+  {
+    const View& view = _sfmData.getView(viewId);
+    clusterSfMData.getViews().emplace(viewId, std::make_shared<View>(view));
+
+    const IndexT intrinsicId = view.getIntrinsicId();
+    const auto intrinsicIt = _sfmData.getIntrinsics().find(intrinsicId);
+    if(intrinsicIt != _sfmData.getIntrinsics().end() && !clusterSfMData.getIntrinsics().count(intrinsicId))
+      clusterSfMData.getIntrinsics().emplace(intrinsicId, std::shared_ptr<camera::IntrinsicBase>(intrinsicIt->second->clone()));
+
+    if(_sfmData.existsPose(view))
+      clusterSfMData.getPoses().emplace(view.getPoseId(), _sfmData.getPoses().at(view.getPoseId()));
+
+    if(view.isPartOfRig() && !clusterSfMData.getRigs().count(view.getRigId()))
+      clusterSfMData.getRigs().emplace(view.getRigId(), _sfmData.getRigs().at(view.getRigId()));
+  }
+
+  // the pairs between the views of the cluster
+  std::vector<matching::PairwiseMatches::const_iterator> clusterPairs;
+  for(const IndexT viewId : cluster)
+  {
+    const auto pairsIt = pairsPerView.find(viewId);
+    if(pairsIt == pairsPerView.end())
+      continue;
+
+    for(const matching::PairwiseMatches::const_iterator& matchesIt : pairsIt->second)
+    {
+      if(cluster.count(matchesIt->first.second))
+        clusterPairs.push_back(matchesIt);
+    }
+  }
+
+  ReconstructionEngine_sequentialSfM::Params clusterParams = _params.clusterParams;
+  if(!cluster.count(clusterParams.userInitialImagePair.first) || !cluster.count(clusterParams.userInitialImagePair.second))
+    clusterParams.userInitialImagePair = Pair(UndefinedIndexT, UndefinedIndexT);
+
+  const fs::path clusterFolder = fs::path(_outputFolder) / ("cluster_" + std::to_string(clusterId));
+  fs::create_directories(clusterFolder);
+
+  ReconstructionEngine_sequentialSfM sfmEngine(
+    clusterSfMData,
+    clusterParams,
+    clusterFolder.string(),
+    (clusterFolder / "sfm_log.html").string());
+
+  sfmEngine.initRandomSeed(seed);
+  sfmEngine.setFeatures(_featuresPerView);
+  sfmEngine.setMatches(_pairwiseMatches, clusterPairs);
+
+  if(!sfmEngine.process())
+  {
+    ALICEVISION_LOG_WARNING("Partitioned SfM: the reconstruction of the cluster " << clusterId << " failed.");
+    clusterSfMData = SfMData();
+    return;
+  }
+
+  clusterSfMData = std::move(sfmEngine.getSfMData());
+
+  ALICEVISION_LOG_INFO("Partitioned SfM: cluster " << clusterId << " reconstructed:" << std::endl
+    << "\t- # views: " << cluster.size() << std::endl
+    << "\t- # poses: " << clusterSfMData.getPoses().size() << std::endl
+    << "\t- # landmarks: " << clusterSfMData.getLandmarks().size());
+}
+
+void ReconstructionEngine_partitionedSfM::mergeClusters(std::map<std::size_t, SfMData>& waitingClusters, std::set<IndexT>& droppedViews)
+{
+  if(waitingClusters.empty())
+    return;
+
+  // without a previous reconstruction, the largest cluster defines the coordinate system of the scene
+  if(_sfmData.getValidViews().empty())
+  {
+    const auto referenceIt = std::max_element(waitingClusters.begin(), waitingClusters.end(),
+      [](const std::pair<const std::size_t, SfMData>& a, const std::pair<const std::size_t, SfMData>& b)
+      {
+        return a.second.getPoses().size() < b.second.getPoses().size();
+      });
+
+    const std::size_t nbConflictingLandmarks = mergeSfMData(_sfmData, referenceIt->second);
+
+    ALICEVISION_LOG_INFO("Partitioned SfM: cluster " << referenceIt->first << " used as reference (" << nbConflictingLandmarks << " conflicting landmarks dropped).");
+    waitingClusters.erase(referenceIt);
+  }
+
+  while(!waitingClusters.empty())
+  {
+    // merge first the cluster sharing the most reconstructed views with the scene
+    std::size_t bestClusterId = 0;
+    std::size_t bestNbCommonViews = 0;
+    for(const auto& clusterPair : waitingClusters)
+    {
+      std::vector<IndexT> commonViewIds;
+      getCommonViewsWithPoses(clusterPair.second, _sfmData, commonViewIds);
+      if(commonViewIds.size() > bestNbCommonViews)
+      {
+        bestClusterId = clusterPair.first;
+        bestNbCommonViews = commonViewIds.size();
+      }
+    }
+
+    // the remaining clusters wait for the next ones
+    if(bestNbCommonViews < _params.minNbCommonViews)
+      break;
+
+    SfMData clusterSfMData = std::move(waitingClusters.at(bestClusterId));
+    waitingClusters.erase(bestClusterId);
+
+    double S;
+    Mat3 R;
+    Vec3 t;
+    if(!computeSimilarityFromCommonCameras_viewId(clusterSfMData, _sfmData, _randomNumberGenerator, &S, &R, &t))
+    {
+      ALICEVISION_LOG_WARNING("Partitioned SfM: cannot align the cluster " << bestClusterId << " on the scene.");
+      const std::set<IndexT> clusterViews = clusterSfMData.getValidViews();
+      droppedViews.insert(clusterViews.begin(), clusterViews.end());
+      continue;
+    }
+
+    applyTransform(clusterSfMData, S, R, t);
+    const std::size_t nbConflictingLandmarks = mergeSfMData(_sfmData, clusterSfMData);
+
+    ALICEVISION_LOG_INFO("Partitioned SfM: cluster " << bestClusterId << " merged on " << bestNbCommonViews << " common views ("
+                         << nbConflictingLandmarks << " conflicting landmarks dropped).");
+  }
+}
+
+bool ReconstructionEngine_partitionedSfM::adjust()
+{
+  aliceVision::system::Timer timer;
+
+  const ReconstructionEngine_sequentialSfM::Params& clusterParams = _params.clusterParams;
+
+  BundleAdjustmentCeres::CeresOptions options;
+  BundleAdjustmentCeres BA(options, clusterParams.minNbCamerasToRefinePrincipalPoint);
+
+  BundleAdjustment::ERefineOptions refineOptions = BundleAdjustment::REFINE_ROTATION | BundleAdjustment::REFINE_TRANSLATION | BundleAdjustment::REFINE_STRUCTURE;
+  if(!clusterParams.lockAllIntrinsics)
+    refineOptions |= BundleAdjustment::REFINE_INTRINSICS_ALL;
+
+  if(!BA.adjust(_sfmData, refineOptions))
+  {
+    ALICEVISION_LOG_ERROR("Partitioned SfM: the bundle adjustment of the merged scene failed.");
+    return false;
+  }
+
+  // the clusters are reconstructed independently, the fused landmarks may disagree
+  const std::size_t nbOutliersResidual = RemoveOutliers_PixelResidualError(_sfmData, clusterParams.featureConstraint, clusterParams.maxReprojectionError, clusterParams.minTrackLength);
+  const std::size_t nbOutliersAngle = RemoveOutliers_AngleError(_sfmData, clusterParams.minAngleForLandmark);
+  const bool hasUnstablePoses = eraseUnstablePosesAndObservations(_sfmData, clusterParams.minPointsPerPose, clusterParams.minTrackLength);
+
+  ALICEVISION_LOG_INFO("Partitioned SfM: outliers removal of the merged scene:" << std::endl
+    << "\t- # outliers residual error: " << nbOutliersResidual << std::endl
+    << "\t- # outliers angular error: " << nbOutliersAngle);
+
+  if((nbOutliersResidual + nbOutliersAngle > 0 || hasUnstablePoses) && !BA.adjust(_sfmData, refineOptions))
+  {
+    ALICEVISION_LOG_ERROR("Partitioned SfM: the bundle adjustment of the merged scene failed.");
+    return false;
+  }
+
+  ALICEVISION_LOG_INFO("Partitioned SfM: final bundle adjustment took (s): " << timer.elapsed());
+  return true;
+}
+
+} // namespace sfm
+} // namespace aliceVision
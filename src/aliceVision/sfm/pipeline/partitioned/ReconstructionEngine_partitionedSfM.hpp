@@ -0,0 +1,166 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfm/pipeline/ReconstructionEngine.hpp>
+#include <aliceVision/sfm/pipeline/sequential/ReconstructionEngine_sequentialSfM.hpp>
+#include <aliceVision/feature/FeaturesPerView.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/// View graph: for each view, the number of matches shared with each connected view
+using ViewGraph = std::map<IndexT, std::map<IndexT, std::size_t>>;
+
+/**
+ * @brief Build the view graph from the pairwise matches.
+ * @param[in] pairwiseMatches The pairwise matches of the scene
+ * @param[out] viewGraph The view graph, weighted by the number of matches of each pair
+ */
+void buildViewGraph(const matching::PairwiseMatches& pairwiseMatches, ViewGraph& viewGraph);
+
+/**
+ * @brief Cut the view graph into overlapping clusters.
+ *        Disjoint cores are grown from the most connected remaining view, following the strongest edges,
+ *        then each core is extended with its most connected neighbouring views to share them with the other clusters.
+ * @param[in] viewGraph The view graph
+ * @param[in] maxClusterSize The maximum number of views in the core of a cluster
+ * @param[in] clusterOverlap The ratio of the core size added to each cluster from the neighbouring clusters
+ * @param[out] clusters The views of each cluster
+ */
+void partitionViewGraph(const ViewGraph& viewGraph,
+                        std::size_t maxClusterSize,
+                        double clusterOverlap,
+                        std::vector<std::set<IndexT>>& clusters);
+
+/**
+ * @brief Merge a reconstructed cluster, already expressed in the scene coordinate system, into the scene.
+ *        Poses and intrinsics already reconstructed in the scene are kept,
+ *        landmarks sharing an observation with a scene landmark are fused with it.
+ *        A cluster landmark sharing observations with several scene landmarks,
+ *        or observing another feature than its scene landmark in a view, is dropped.
+ * @param[in,out] sfmData The scene
+ * @param[in] clusterSfMData The reconstructed cluster
+ * @return the number of conflicting cluster landmarks dropped
+ */
+std::size_t mergeSfMData(sfmData::SfMData& sfmData, const sfmData::SfMData& clusterSfMData);
+
+/**
+ * @brief Partitioned SfM Pipeline Reconstruction Engine.
+ *        Reconstruct very large collections by cutting the view graph into overlapping clusters,
+ *        reconstructing each cluster with the sequential engine, merging the clusters
+ *        on their shared views and running a final bundle adjustment on the whole scene.
+ */
+class ReconstructionEngine_partitionedSfM : public ReconstructionEngine
+{
+public:
+  struct Params
+  {
+    /// maximum number of views in the core of a cluster
+    std::size_t maxClusterSize = 100;
+    /// ratio of the core size shared with the neighbouring clusters
+    double clusterOverlap = 0.25;
+    /// minimum number of reconstructed views shared by a cluster with the scene to merge it
+    std::size_t minNbCommonViews = 3;
+    /// number of clusters reconstructed at the same time
+    int nbParallelClusters = 1;
+    /// parameters of the sequential reconstruction of each cluster
+    ReconstructionEngine_sequentialSfM::Params clusterParams;
+  };
+
+  ReconstructionEngine_partitionedSfM(const sfmData::SfMData& sfmData,
+                                      const Params& params,
+                                      const std::string& outputFolder);
+
+  void setFeatures(feature::FeaturesPerView* featuresPerView)
+  {
+    _featuresPerView = featuresPerView;
+  }
+
+  void setMatches(matching::PairwiseMatches* pairwiseMatches)
+  {
+    _pairwiseMatches = pairwiseMatches;
+  }
+
+  /**
+   * @brief Get the views of each cluster
+   * @return the clusters computed by the last process
+   */
+  const std::vector<std::set<IndexT>>& getClusters() const
+  {
+    return _clusters;
+  }
+
+  /**
+   * @brief Get the views reconstructed in a cluster that could not be merged into the scene
+   * @return the views lost by the last process
+   */
+  const std::set<IndexT>& getUnmergedViews() const
+  {
+    return _unmergedViews;
+  }
+
+  /**
+   * @brief Process the partitioned reconstruction
+   * @return true if done
+   */
+  virtual bool process();
+
+private:
+  /**
+   * @brief Reconstruct the clusters with the sequential engine, by batches of nbParallelClusters,
+   *        and merge each batch into the scene
+   * @return true if at least one cluster has been merged
+   */
+  bool reconstructClusters();
+
+  /**
+   * @brief Reconstruct a cluster independently with the sequential engine
+   * @param[in] clusterId The cluster index
+   * @param[in] pairsPerView The pairwise matches indexed by the first view of the pair
+   * @param[in] seed The random seed of the cluster reconstruction
+   * @param[out] clusterSfMData The reconstruction of the cluster (empty if failed)
+   */
+  void reconstructCluster(std::size_t clusterId,
+                          const std::map<IndexT, std::vector<matching::PairwiseMatches::const_iterator>>& pairsPerView,
+                          int seed,
+                          sfmData::SfMData& clusterSfMData);
+
+  /**
+   * @brief Align the reconstructed clusters on their shared views and merge them into the scene,
+   *        starting from the largest one if the scene is empty
+   * @param[in,out] waitingClusters The reconstructed clusters, released once merged
+   * @param[in,out] droppedViews The views of the clusters that cannot be aligned on the scene
+   */
+  void mergeClusters(std::map<std::size_t, sfmData::SfMData>& waitingClusters, std::set<IndexT>& droppedViews);
+
+  /**
+   * @brief Bundle adjustment of the merged scene and outliers removal
+   * @return true if the bundle adjustment succeed
+   */
+  bool adjust();
+
+  // Parameters
+  Params _params;
+
+  // Data providers
+  feature::FeaturesPerView* _featuresPerView = nullptr;
+  matching::PairwiseMatches* _pairwiseMatches = nullptr;
+
+  // Clusters
+  std::vector<std::set<IndexT>> _clusters;
+  /// views reconstructed in a cluster that could not be merged
+  std::set<IndexT> _unmergedViews;
+};
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,163 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/sfm/utils/statistics.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/sfm/sfm.hpp>
+
+#include <iostream>
+
+#define BOOST_TEST_MODULE PARTITIONED_SFM
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+using namespace aliceVision::geometry;
+using namespace aliceVision::sfm;
+using namespace aliceVision::sfmData;
+
+// Test summary:
+// - Cut the view graph of a ring of cameras into overlapping clusters
+// - Assert that:
+//   - each view belongs to at least one cluster,
+//   - each cluster shares views with another cluster.
+BOOST_AUTO_TEST_CASE(PARTITIONED_SFM_ViewGraphPartition)
+{
+  const IndexT nviews = 50;
+  const std::size_t maxClusterSize = 8;
+
+  // each view is matched with its 2 next neighbours
+  matching::PairwiseMatches pairwiseMatches;
+  for(IndexT i = 0; i < nviews; ++i)
+  {
+    pairwiseMatches[Pair(i, (i + 1) % nviews)][feature::EImageDescriberType::UNKNOWN].resize(100);
+    pairwiseMatches[Pair(i, (i + 2) % nviews)][feature::EImageDescriberType::UNKNOWN].resize(50);
+  }
+
+  ViewGraph viewGraph;
+  buildViewGraph(pairwiseMatches, viewGraph);
+  BOOST_CHECK_EQUAL(viewGraph.size(), nviews);
+
+  std::vector<std::set<IndexT>> clusters;
+  partitionViewGraph(viewGraph, maxClusterSize, 0.5, clusters);
+  BOOST_CHECK_GT(clusters.size(), 1);
+
+  std::map<IndexT, std::size_t> nbClustersPerView;
+  for(const std::set<IndexT>& cluster : clusters)
+  {
+    for(const IndexT viewId : cluster)
+      ++nbClustersPerView[viewId];
+  }
+  BOOST_CHECK_EQUAL(nbClustersPerView.size(), nviews);
+
+  for(const std::set<IndexT>& cluster : clusters)
+  {
+    std::size_t nbSharedViews = 0;
+    for(const IndexT viewId : cluster)
+      nbSharedViews += (nbClustersPerView.at(viewId) > 1);
+    BOOST_CHECK_GE(nbSharedViews, 3);
+  }
+}
+
+// Test summary:
+// - Create features points and matching from the synthetic dataset
+// - Init a SfMData scene View and Intrinsic from a synthetic dataset
+// - Perform Partitioned SfM on the data
+// - Assert that:
+//   - mean residual error is below the gaussian noise added to observation
+//   - the landmarks of the clusters are fused,
+//   - the desired number of poses are found.
+BOOST_AUTO_TEST_CASE(PARTITIONED_SFM_Known_Intrinsics)
+{
+  const int nviews = 12;
+  const int npoints = 128;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  const SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+
+  // Remove poses and structure
+  SfMData sfmData2 = sfmData;
+  sfmData2.getPoses().clear();
+  sfmData2.structure.clear();
+
+  ReconstructionEngine_partitionedSfM::Params sfmParams;
+  sfmParams.maxClusterSize = 6;
+  sfmParams.clusterOverlap = 0.5;
+  sfmParams.clusterParams.lockAllIntrinsics = true;
+
+  ReconstructionEngine_partitionedSfM sfmEngine(
+    sfmData2,
+    sfmParams,
+    "./");
+
+  // Add a tiny noise in 2D observations to make data more realistic
+  std::normal_distribution<double> distribution(0.0,0.5);
+
+  // Configure the featuresPerView & the matches_provider from the synthetic dataset
+  feature::FeaturesPerView featuresPerView;
+  generateSyntheticFeatures(featuresPerView, feature::EImageDescriberType::UNKNOWN, sfmData, distribution);
+
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+  // Configure data provider (Features and Matches)
+  sfmEngine.setFeatures(&featuresPerView);
+  sfmEngine.setMatches(&pairwiseMatches);
+
+  BOOST_CHECK (sfmEngine.process());
+  BOOST_CHECK_GT(sfmEngine.getClusters().size(), 1);
+
+  const double residual = RMSE(sfmEngine.getSfMData());
+  ALICEVISION_LOG_DEBUG("RMSE residual: " << residual);
+  BOOST_CHECK_LT(residual, 0.5);
+  BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getPoses().size(), nviews);
+  BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getLandmarks().size(), npoints);
+  BOOST_CHECK(sfmEngine.getUnmergedViews().empty());
+}
+
+// Test summary:
+// - Merge cluster landmarks into a scene with two landmarks
+// - Assert that:
+//   - a landmark sharing a feature with a scene landmark is fused with it,
+//   - a landmark sharing features with two scene landmarks is dropped,
+//   - a landmark observing another feature than its scene landmark in a view is dropped,
+//   - a landmark without shared feature is added.
+BOOST_AUTO_TEST_CASE(PARTITIONED_SFM_MergeLandmarks)
+{
+  const feature::EImageDescriberType descType = feature::EImageDescriberType::UNKNOWN;
+
+  const auto makeLandmark = [&](const std::vector<std::pair<IndexT, IndexT>>& viewFeatures)
+  {
+    Landmark landmark(Vec3::Zero(), descType);
+    for(const auto& viewFeature : viewFeatures)
+      landmark.observations[viewFeature.first] = Observation(Vec2::Zero(), viewFeature.second, 0.0);
+    return landmark;
+  };
+
+  SfMData sfmData;
+  sfmData.structure[0] = makeLandmark({{0, 0}, {1, 1}});
+  sfmData.structure[1] = makeLandmark({{2, 2}, {3, 3}});
+
+  SfMData clusterSfMData;
+  clusterSfMData.structure[0] = makeLandmark({{0, 0}, {4, 4}}); // fused with the landmark 0
+  clusterSfMData.structure[1] = makeLandmark({{1, 1}, {2, 2}}); // joins the landmarks 0 and 1
+  clusterSfMData.structure[2] = makeLandmark({{3, 3}, {2, 5}}); // another feature in the view 2
+  clusterSfMData.structure[3] = makeLandmark({{5, 6}, {6, 7}}); // new landmark
+
+  BOOST_CHECK_EQUAL(mergeSfMData(sfmData, clusterSfMData), 2);
+  BOOST_CHECK_EQUAL(sfmData.getLandmarks().size(), 3);
+
+  const Observations& fusedObservations = sfmData.getLandmarks().at(0).observations;
+  BOOST_CHECK_EQUAL(fusedObservations.size(), 3);
+  BOOST_CHECK_EQUAL(fusedObservations.at(4).id_feat, 4);
+  BOOST_CHECK_EQUAL(sfmData.getLandmarks().at(1).observations.size(), 2);
+  BOOST_CHECK_EQUAL(sfmData.getLandmarks().at(2).observations.size(), 2);
+}
@@ -0,0 +1,157 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/pipeline/RegionsCache.hpp>
+#include <aliceVision/feature/regionsFactory.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <set>
+#include <string>
+
+#define BOOST_TEST_MODULE sfmRegionsCache
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::feature;
+using namespace aliceVision::sfm;
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+const IndexT nbViews = 4;
+const std::size_t nbRegions = 50;
+
+// the regions files of the views, each feature position identifies the view
+void createRegionsFiles(const std::string& folder, sfmData::SfMData& sfmData)
+{
+  for(IndexT viewId = 0; viewId < nbViews; ++viewId)
+  {
+    SIFT_Regions regions;
+    for(std::size_t i = 0; i < nbRegions; ++i)
+    {
+      regions.Features().emplace_back(float(i), float(viewId), 1.f, 0.f);
+      SIFT_Regions::DescriptorT descriptor;
+      for(int j = 0; j < 128; ++j)
+        descriptor[j] = static_cast<unsigned char>(viewId);
+      regions.Descriptors().push_back(descriptor);
+    }
+
+    const std::string basename = (fs::path(folder) / (std::to_string(viewId) + ".sift")).string();
+    regions.Save(basename + ".feat", basename + ".desc");
+
+    sfmData.views.emplace(viewId, std::make_shared<sfmData::View>("", viewId, 0, viewId, 640, 480));
+  }
+}
+
+// the loaded views, after checking their regions
+std::set<IndexT> getLoadedViews(const RegionsCache& regionsCache)
+{
+  std::set<IndexT> viewIds;
+  for(const auto& regionsPerDesc : regionsCache.getRegionsPerView().getData())
+  {
+    const Regions& regions = *regionsPerDesc.second.at(EImageDescriberType::SIFT);
+    BOOST_CHECK_EQUAL(regions.RegionCount(), nbRegions);
+    for(const PointFeature& feature : regions.Features())
+      BOOST_CHECK_EQUAL(feature.y(), float(regionsPerDesc.first));
+    viewIds.insert(regionsPerDesc.first);
+  }
+  return viewIds;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(RegionsCache_evictionAndReload)
+{
+  const fs::path folder = fs::temp_directory_path() / fs::unique_path("sfm_regionsCache_%%%%");
+  fs::create_directories(folder);
+
+  sfmData::SfMData sfmData;
+  createRegionsFiles(folder.string(), sfmData);
+
+  const std::vector<EImageDescriberType> describerTypes = {EImageDescriberType::SIFT};
+  const std::size_t viewMemory = RegionsCache(sfmData, {folder.string()}, describerTypes, 0).getViewMemory(0);
+  BOOST_REQUIRE_GT(viewMemory, 0);
+
+  // room for the regions of two views
+  RegionsCache regionsCache(sfmData, {folder.string()}, describerTypes, 2 * viewMemory);
+
+  regionsCache.load({0, 1});
+  BOOST_CHECK(getLoadedViews(regionsCache) == std::set<IndexT>({0, 1}));
+  BOOST_CHECK_EQUAL(regionsCache.getMemory(), 2 * viewMemory);
+
+  // the least recently used view is released
+  regionsCache.load({1});
+  regionsCache.load({2});
+  BOOST_CHECK(getLoadedViews(regionsCache) == std::set<IndexT>({1, 2}));
+  BOOST_CHECK_EQUAL(regionsCache.getMemory(), 2 * viewMemory);
+
+  // the required views are kept
+  regionsCache.load({2, 3});
+  BOOST_CHECK(getLoadedViews(regionsCache) == std::set<IndexT>({2, 3}));
+
+  // a released view is reloaded
+  regionsCache.load({0});
+  BOOST_CHECK(getLoadedViews(regionsCache) == std::set<IndexT>({0, 3}));
+  BOOST_CHECK_EQUAL(regionsCache.getMemory(), 2 * viewMemory);
+
+  // the prefetched views replace the not required ones
+  regionsCache.load({0});
+  regionsCache.prefetch({1});
+  regionsCache.load({0, 1});
+  BOOST_CHECK(getLoadedViews(regionsCache) == std::set<IndexT>({0, 1}));
+  BOOST_CHECK_EQUAL(regionsCache.getMemory(), 2 * viewMemory);
+
+  // the views beyond the memory budget are not prefetched but loaded on demand
+  regionsCache.prefetch({2, 3});
+  BOOST_CHECK(getLoadedViews(regionsCache) == std::set<IndexT>({0, 1}));
+  regionsCache.load({2, 3});
+  BOOST_CHECK(getLoadedViews(regionsCache) == std::set<IndexT>({2, 3}));
+  BOOST_CHECK_EQUAL(regionsCache.getMemory(), 2 * viewMemory);
+
+  // views over the memory budget are still loaded
+  regionsCache.load({0, 1, 2});
+  BOOST_CHECK(getLoadedViews(regionsCache) == std::set<IndexT>({0, 1, 2}));
+  BOOST_CHECK_EQUAL(regionsCache.getMemory(), 3 * viewMemory);
+
+  fs::remove_all(folder);
+}
+
+BOOST_AUTO_TEST_CASE(RegionsCache_failedPrefetch)
+{
+  const fs::path folder = fs::temp_directory_path() / fs::unique_path("sfm_regionsCache_%%%%");
+  fs::create_directories(folder);
+
+  sfmData::SfMData sfmData;
+  createRegionsFiles(folder.string(), sfmData);
+
+  const std::vector<EImageDescriberType> describerTypes = {EImageDescriberType::SIFT};
+  const std::size_t viewMemory = RegionsCache(sfmData, {folder.string()}, describerTypes, 0).getViewMemory(0);
+
+  // room for the regions of all the views
+  RegionsCache regionsCache(sfmData, {folder.string()}, describerTypes, nbViews * viewMemory);
+
+  regionsCache.load({0});
+  const std::size_t memory = regionsCache.getMemory();
+
+  // the regions files of the prefetched view disappear once its memory is estimated
+  BOOST_REQUIRE_GT(regionsCache.getViewMemory(1), 0);
+  fs::remove(folder / "1.sift.feat");
+  fs::remove(folder / "1.sift.desc");
+
+  regionsCache.prefetch({1});
+  BOOST_CHECK_THROW(regionsCache.load({1}), std::runtime_error);
+
+  // the memory charged for the failed prefetching is given back
+  BOOST_CHECK_EQUAL(regionsCache.getMemory(), memory);
+  regionsCache.load({0, 2});
+  BOOST_CHECK(getLoadedViews(regionsCache) == std::set<IndexT>({0, 2}));
+  BOOST_CHECK_EQUAL(regionsCache.getMemory(), memory + viewMemory);
+
+  fs::remove_all(folder);
+}
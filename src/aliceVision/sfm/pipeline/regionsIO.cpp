@@ -22,7 +22,8 @@ using namespace sfmData;
 
 std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& folders,
                                               IndexT viewId,
-                                              const feature::ImageDescriber& imageDescriber)
+                                              const feature::ImageDescriber& imageDescriber,
+                                              bool memoryMappedDescriptors)
 {
   assert(!folders.empty());
 
@@ -53,6 +54,9 @@ std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& fo
   std::unique_ptr<feature::Regions> regionsPtr;
   imageDescriber.allocate(regionsPtr);
 
+  if(memoryMappedDescriptors)
+    regionsPtr.reset(regionsPtr->EmptyMappedClone());
+
   try
   {
     regionsPtr->Load(featFilename, descFilename);
@@ -184,7 +188,8 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
             const SfMData& sfmData,
             const std::vector<std::string>& folders,
             const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
-            const std::set<IndexT>& viewIdFilter)
+            const std::set<IndexT>& viewIdFilter,
+            bool memoryMappedDescriptors)
 {
   std::vector<std::string> featuresFolders = sfmData.getFeaturesFolders(); // add sfm features folders
   featuresFolders.insert(featuresFolders.end(), folders.begin(), folders.end()); // add user features folders
@@ -210,7 +215,7 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
      {
        if(viewIdFilter.empty() || viewIdFilter.find(iter->second.get()->getViewId()) != viewIdFilter.end())
        {
-         std::unique_ptr<feature::Regions> regionsPtr = loadRegions(featuresFolders, iter->second.get()->getViewId(), *(imageDescribers.at(i)));
+         std::unique_ptr<feature::Regions> regionsPtr = loadRegions(featuresFolders, iter->second.get()->getViewId(), *(imageDescribers.at(i)), memoryMappedDescriptors);
          if(regionsPtr)
          {
 #pragma omp critical
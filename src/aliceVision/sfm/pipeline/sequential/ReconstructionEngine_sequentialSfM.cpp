@@ -59,7 +59,7 @@ using namespace aliceVision::sfmData;
  * These precomputed values are useful to the next best view selection for incremental SfM.
  *
  * @param[in] tracksPerView: The list of TrackID per view
- * @param[in] map_tracks: All putative tracks
+ * @param[in] tracks: All putative tracks in CSR arrays
  * @param[in] views: All views
  * @param[in] featuresProvider: Input features and descriptors
  * @param[in] pyramidDepth: Depth of the pyramid.
@@ -68,7 +68,7 @@ using namespace aliceVision::sfmData;
  */
 void computeTracksPyramidPerView(
     const track::TracksPerView& tracksPerView,
-    const track::TracksMap& map_tracks,
+    const track::TracksCSR& tracks,
     const Views& views,
     const feature::FeaturesPerView& featuresProvider,
     const std::size_t pyramidBase,
@@ -105,12 +105,14 @@ void computeTracksPyramidPerView(
       cellWidthPerLevel[level] = (double)view.getWidth() / (double)widthPerLevel[level];
       cellHeightPerLevel[level] = (double)view.getHeight() / (double)widthPerLevel[level];
     }
-    for(std::size_t i = 0; i < viewTracks.second.size(); ++i)
+    // the tracks of the view with their feature ids
+    const track::TracksCSR::ViewRange range = tracks.getViewRange(viewId);
+    for(std::size_t i = range.begin; i < range.end; ++i)
     {
-      const std::size_t trackId = viewTracks.second[i];
-      const track::Track& track = map_tracks.at(trackId);
-      const std::size_t featIndex = track.featPerView.at(viewId);
-      const auto& feature = featuresProvider.getFeatures(viewId, track.descType)[featIndex]; 
+      const IndexT trackIndex = tracks.viewTrackIndexes()[i];
+      const std::size_t trackId = tracks.trackId(trackIndex);
+      const std::size_t featIndex = tracks.viewFeatIds()[i];
+      const auto& feature = featuresProvider.getFeatures(viewId, tracks.descType(trackIndex))[featIndex];
       
       for(std::size_t level = 0; level < pyramidDepth; ++level)
       {
@@ -244,18 +246,16 @@ std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
   track::TracksBuilder tracksBuilder;
 
   {
-    // list of features matches for each couple of images
-    const aliceVision::matching::PairwiseMatches& matches = *_pairwiseMatches;
-
     ALICEVISION_LOG_DEBUG("Track building");
-    tracksBuilder.build(matches);
+    // list of features matches for each couple of images
+    tracksBuilder.build(_usedPairwiseMatches);
 
     ALICEVISION_LOG_DEBUG("Track filtering");
     tracksBuilder.filter(_params.filterTrackForks, _params.minInputTrackLength);
 
     ALICEVISION_LOG_DEBUG("Track export to internal structure");
-    // build tracks with STL compliant type
-    tracksBuilder.exportToSTL(_map_tracks);
+    // build tracks in CSR arrays
+    tracksBuilder.exportToCSR(_tracksCSR);
     ALICEVISION_LOG_DEBUG("Build tracks per view");
 
     // Init tracksPerView to have an entry in the map for each view (even if there is no track at all)
@@ -264,10 +264,10 @@ std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
         // create an entry in the map
         _map_tracksPerView[viewIt.first];
     }
-    track::computeTracksPerView(_map_tracks, _map_tracksPerView);
+    track::computeTracksPerView(_tracksCSR, _map_tracksPerView);
     ALICEVISION_LOG_DEBUG("Build tracks pyramid per view");
     computeTracksPyramidPerView(
-            _map_tracksPerView, _map_tracks, _sfmData.views, *_featuresPerView, _params.pyramidBase, _params.pyramidDepth, _map_featsPyramidPerView);
+            _map_tracksPerView, _tracksCSR, _sfmData.views, *_featuresPerView, _params.pyramidBase, _params.pyramidDepth, _map_featsPyramidPerView);
 
     // display stats
     {
@@ -279,7 +279,7 @@ std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
         << "\t- # images in tracks: " << imagesId.size());
 
       std::map<size_t, size_t> map_Occurence_TrackLength;
-      track::tracksLength(_map_tracks, map_Occurence_TrackLength);
+      track::tracksLength(_tracksCSR, map_Occurence_TrackLength);
       ALICEVISION_LOG_INFO("TrackLength, Occurrence");
       for(const auto& iter: map_Occurence_TrackLength)
       {
@@ -289,7 +289,7 @@ std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
       }
     }
   }
-  return _map_tracks.size();
+  return _tracksCSR.nbTracks();
 }
 
 std::vector<Pair> ReconstructionEngine_sequentialSfM::getInitialImagePairsCandidates()
@@ -364,14 +364,16 @@ void ReconstructionEngine_sequentialSfM::remapLandmarkIdsToTrackIds()
   ALICEVISION_LOG_DEBUG("Find corresponding landmark id per track id");
 
   // find corresponding landmark id per track id
-  for(const auto& trackPair : _map_tracks)
+  const std::vector<IndexT>& obsViewIds = _tracksCSR.obsViewIds();
+  const std::vector<IndexT>& obsFeatIds = _tracksCSR.obsFeatIds();
+
+  for(std::size_t trackIndex = 0; trackIndex < _tracksCSR.nbTracks(); ++trackIndex)
   {
-    const IndexT trackId = trackPair.first;
-    const Track& track = trackPair.second;
+    const IndexT trackId = _tracksCSR.trackId(trackIndex);
 
-    for(const auto& featView : track.featPerView)
+    for(std::size_t i = _tracksCSR.trackBegin(trackIndex); i < _tracksCSR.trackEnd(trackIndex); ++i)
     {
-      const ObsToLandmark::const_iterator it = obsToLandmark.find(ObsKey(featView.first, featView.second, track.descType));
+      const ObsToLandmark::const_iterator it = obsToLandmark.find(ObsKey(obsViewIds[i], obsFeatIds[i], _tracksCSR.descType(trackIndex)));
 
       if(it != obsToLandmark.end())
       {
@@ -383,7 +385,7 @@ void ReconstructionEngine_sequentialSfM::remapLandmarkIdsToTrackIds()
   }
 
   ALICEVISION_LOG_INFO("Landmark ids to track ids remapping: " << std::endl
-                        << "\t- # tracks: " << _map_tracks.size() << std::endl
+                        << "\t- # tracks: " << _tracksCSR.nbTracks() << std::endl
                         << "\t- # input landmarks: " << landmarks.size() << std::endl
                         << "\t- # output landmarks: " << _sfmData.getLandmarks().size());
 }
@@ -445,7 +447,9 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
                          << "\t- # remaining images: " << remainingViewIds.size()
                          );
     // compute robust resection of remaining images
-    while(findNextBestViews(bestViewCandidates, remainingViewIds))
+    std::vector<IndexT> nextViewCandidates;
+    bool hasNextViews = findNextBestViews(bestViewCandidates, remainingViewIds);
+    while(hasNextViews)
     {
       ALICEVISION_LOG_INFO("Update Reconstruction:" << std::endl
         << "\t- resection id: " << resectionId << std::endl
@@ -458,9 +462,25 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
       std::set<IndexT> newReconstructedViews = resection(resectionId, bestViewCandidates, prevReconstructedViews, remainingViewIds);
 
       if(newReconstructedViews.empty())
+      {
+        hasNextViews = findNextBestViews(bestViewCandidates, remainingViewIds);
         continue;
+      }
 
       triangulate(prevReconstructedViews, newReconstructedViews);
+
+      // pipelined mode: select the next group on the triangulated scene
+      // and resect it on a snapshot while the bundle adjustment runs
+      hasNextViews = _params.pipelinedResection && findNextBestViews(nextViewCandidates, remainingViewIds);
+      if(hasNextViews)
+      {
+        std::shared_ptr<SfMData> snapshot = std::make_shared<SfMData>(createResectionSnapshot(nextViewCandidates));
+        _speculativeResections = std::async(std::launch::async, [this, snapshot, nextViewCandidates]()
+        {
+          return computeSpeculativeResections(*snapshot, nextViewCandidates);
+        });
+      }
+
       bundleAdjustment(newReconstructedViews);
 
       // scene logging for visual debug
@@ -474,6 +494,11 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
       }
 
       ++resectionId;
+
+      if(hasNextViews)
+        std::swap(bestViewCandidates, nextViewCandidates);
+      else
+        hasNextViews = findNextBestViews(bestViewCandidates, remainingViewIds);
     }
 
     if(_params.rig.useRigConstraint && !_sfmData.getRigs().empty())
@@ -519,6 +544,31 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
 {
   auto chrono_start = std::chrono::steady_clock::now();
 
+  // resections computed on a snapshot during the previous bundle adjustment (pipelined mode),
+  // validated one by one as the pose refinement may update the shared intrinsics
+  std::map<IndexT, ResectionData> speculativeResections;
+  if(_speculativeResections.valid())
+  {
+    std::map<IndexT, ResectionData> computedResections = _speculativeResections.get();
+    _speculativeResectionStats.nbComputed += computedResections.size();
+
+    for(auto& resectionPair : computedResections)
+    {
+      const bool isValid = validateSpeculativeResection(resectionPair.first, resectionPair.second);
+      htmlLogResection(resectionPair.first, resectionPair.second, isValid, true);
+
+      if(isValid)
+      {
+        speculativeResections.insert(std::move(resectionPair));
+      }
+      else
+      {
+        ALICEVISION_LOG_DEBUG("Speculative resection of view id: " << resectionPair.first << " is no longer valid.");
+        ++_speculativeResectionStats.nbRejected;
+      }
+    }
+  }
+
   // add images to the 3D reconstruction
 #pragma omp parallel for
   for(int i = 0; i < bestViewIds.size(); ++i)
@@ -564,15 +614,32 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
     }
 
     ResectionData newResectionData;
-    newResectionData.error_max = _params.localizerEstimatorError;
-    newResectionData.max_iteration = _params.localizerEstimatorMaxIterations;
-    const bool hasResected = computeResection(viewId, newResectionData);
+    bool hasResected = false;
+
+    // the resection may have been computed during the previous bundle adjustment
+    const auto speculativeIt = speculativeResections.find(viewId);
+    const bool isSpeculative = (speculativeIt != speculativeResections.end());
+    if(isSpeculative)
+    {
+      newResectionData = speculativeIt->second;
+      hasResected = true;
+    }
+    else
+    {
+      newResectionData = ResectionData();
+      newResectionData.error_max = _params.localizerEstimatorError;
+      newResectionData.max_iteration = _params.localizerEstimatorMaxIterations;
+      newResectionData.useSprt = _params.localizerUseSprt;
+      hasResected = computeResection(viewId, newResectionData);
+    }
 
 #pragma omp critical
     {
       if(hasResected)
       {
         updateScene(viewId, newResectionData);
+        if(isSpeculative)
+          ++_speculativeResectionStats.nbUsed;
         ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) succeed.");
         _sfmData.getViews().at(viewId)->setResectionId(resectionId);
       }
@@ -865,35 +932,44 @@ void ReconstructionEngine_sequentialSfM::calibrateRigs(std::set<IndexT>& updated
 
 bool ReconstructionEngine_sequentialSfM::findConnectedViews(
   std::vector<ViewConnectionScore>& out_connectedViews,
-  const std::set<IndexT>& remainingViewIds) const
+  const std::set<IndexT>& remainingViewIds,
+  std::size_t maxNbConnectedViews)
 {
   out_connectedViews.clear();
 
+  // Take into account the landmarks added or removed since the last call
+  updateViewsScore();
+
   if (remainingViewIds.empty() || _sfmData.getLandmarks().empty())
     return false;
 
-  // Collect tracksIds
-  std::set<size_t> reconstructed_trackId;
-  std::transform(_sfmData.getLandmarks().begin(), _sfmData.getLandmarks().end(),
-                 std::inserter(reconstructed_trackId, reconstructed_trackId.begin()),
-                 stl::RetrieveKey());
-
   const std::set<IndexT> reconstructedIntrinsics = _sfmData.getReconstructedIntrinsics();
 
-#pragma omp parallel for
-  for(int i = 0; i < remainingViewIds.size(); ++i)
+  // Candidates extracted from the queue which stay candidates for the next calls
+  std::vector<std::pair<std::size_t, IndexT>> candidates;
+  std::set<IndexT> visitedViewIds;
+
+  while(!_viewsScoreQueue.empty() && out_connectedViews.size() < maxNbConnectedViews)
   {
-    std::set<IndexT>::const_iterator iter = remainingViewIds.cbegin();
-    std::advance(iter, i);
-    const IndexT viewId = *iter;
-    const IndexT intrinsicId = _sfmData.getViews().at(viewId)->getIntrinsicId();
-    const bool isIntrinsicsReconstructed = reconstructedIntrinsics.count(intrinsicId);
+    const std::pair<std::size_t, IndexT> entry = _viewsScoreQueue.top();
+    _viewsScoreQueue.pop();
+
+    const IndexT viewId = entry.second;
+
+    // Views leave the candidates once resected (or rejected)
+    if(remainingViewIds.count(viewId) == 0)
+      continue;
 
-    // Compute 2D - 3D possible content
-    const aliceVision::track::TrackIdSet& set_tracksIds = _map_tracksPerView.at(viewId);
-    if (set_tracksIds.empty())
+    // Skip outdated or duplicated entries
+    const auto viewScoreIt = _viewsScore.find(viewId);
+    if(viewScoreIt == _viewsScore.end() ||
+       viewScoreIt->second.nbTracks == 0 ||
+       viewScoreIt->second.score != entry.first ||
+       !visitedViewIds.insert(viewId).second)
       continue;
 
+    candidates.push_back(entry);
+
     // Check if the view is part of a rig
     {
       const View& view = *_sfmData.views.at(viewId);
@@ -920,39 +996,158 @@ bool ReconstructionEngine_sequentialSfM::findConnectedViews(
       }
     }
 
-    // Count the common possible putative point
-    //  with the already 3D reconstructed trackId
-    std::vector<std::size_t> vec_trackIdForResection;
-    vec_trackIdForResection.reserve(set_tracksIds.size());
-    std::set_intersection(set_tracksIds.begin(), set_tracksIds.end(),
-                          reconstructed_trackId.begin(),
-                          reconstructed_trackId.end(),
-                          std::back_inserter(vec_trackIdForResection));
-    // Compute an image score based on the number of matches to the 3D scene
-    // and the repartition of these features in the image.
-    std::size_t score = computeCandidateImageScore(viewId, vec_trackIdForResection);
-#pragma omp critical
+    const IndexT intrinsicId = _sfmData.getViews().at(viewId)->getIntrinsicId();
+    const bool isIntrinsicsReconstructed = reconstructedIntrinsics.count(intrinsicId);
+
+    out_connectedViews.emplace_back(viewId, viewScoreIt->second.nbTracks, viewScoreIt->second.score, isIntrinsicsReconstructed);
+  }
+
+  // Put back the extracted candidates (the selected ones will be discarded once resected)
+  for(const auto& entry : candidates)
+    _viewsScoreQueue.push(entry);
+
+  return !out_connectedViews.empty();
+}
+
+void ReconstructionEngine_sequentialSfM::updateViewsScore()
+{
+  const Landmarks& landmarks = _sfmData.getLandmarks();
+
+  // Note: each landmark has a corresponding track with the same id (landmarkId == trackId).
+  std::vector<std::size_t> removedTrackIds;
+  for(std::size_t trackId : _scoredTrackIds)
+  {
+    if(landmarks.count(trackId) == 0)
+      removedTrackIds.push_back(trackId);
+  }
+
+  std::vector<std::size_t> addedTrackIds;
+  for(const auto& landmarkPair : landmarks)
+  {
+    if(_tracksCSR.findTrackIndex(landmarkPair.first) != UndefinedIndexT && _scoredTrackIds.count(landmarkPair.first) == 0)
+      addedTrackIds.push_back(landmarkPair.first);
+  }
+
+  if(removedTrackIds.empty() && addedTrackIds.empty())
+    return;
+
+  std::set<IndexT> updatedViewIds;
+  for(std::size_t trackId : removedTrackIds)
+  {
+    updateTrackInViewsScore(trackId, false);
+    _scoredTrackIds.erase(trackId);
+    const std::size_t trackIndex = _tracksCSR.findTrackIndex(trackId);
+    updatedViewIds.insert(_tracksCSR.obsViewIds().begin() + _tracksCSR.trackBegin(trackIndex),
+                          _tracksCSR.obsViewIds().begin() + _tracksCSR.trackEnd(trackIndex));
+  }
+  for(std::size_t trackId : addedTrackIds)
+  {
+    updateTrackInViewsScore(trackId, true);
+    _scoredTrackIds.insert(trackId);
+    const std::size_t trackIndex = _tracksCSR.findTrackIndex(trackId);
+    updatedViewIds.insert(_tracksCSR.obsViewIds().begin() + _tracksCSR.trackBegin(trackIndex),
+                          _tracksCSR.obsViewIds().begin() + _tracksCSR.trackEnd(trackIndex));
+  }
+
+  // The outdated entries are skipped lazily, rebuild the queue when they become dominant
+  if(_viewsScoreQueue.size() + updatedViewIds.size() > 4 * _viewsScore.size())
+  {
+    _viewsScoreQueue = std::priority_queue<std::pair<std::size_t, IndexT>>();
+    for(const auto& viewScorePair : _viewsScore)
     {
-      out_connectedViews.emplace_back(viewId, vec_trackIdForResection.size(), score, isIntrinsicsReconstructed);
+      if(viewScorePair.second.nbTracks > 0)
+        _viewsScoreQueue.emplace(viewScorePair.second.score, viewScorePair.first);
     }
+    return;
   }
 
-  // Sort by the image score
-  std::sort(out_connectedViews.begin(), out_connectedViews.end(),
-            [](const ViewConnectionScore& t1, const ViewConnectionScore& t2) {
-    return std::get<2>(t1) > std::get<2>(t2);
-  });
-  return !out_connectedViews.empty();
+  for(IndexT viewId : updatedViewIds)
+  {
+    const ViewScore& viewScore = _viewsScore.at(viewId);
+    if(viewScore.nbTracks > 0)
+      _viewsScoreQueue.emplace(viewScore.score, viewId);
+  }
+}
+
+std::size_t ReconstructionEngine_sequentialSfM::getViewScore(IndexT viewId)
+{
+  updateViewsScore();
+
+  const auto viewScoreIt = _viewsScore.find(viewId);
+  if(viewScoreIt == _viewsScore.end() || viewScoreIt->second.nbTracks == 0)
+    return 0;
+  return viewScoreIt->second.score;
+}
+
+std::size_t ReconstructionEngine_sequentialSfM::computeViewScore(IndexT viewId) const
+{
+  const Landmarks& landmarks = _sfmData.getLandmarks();
+
+  std::vector<std::size_t> reconstructedTrackIds;
+  for(const std::size_t trackId : _map_tracksPerView.at(viewId))
+  {
+    if(landmarks.count(trackId))
+      reconstructedTrackIds.push_back(trackId);
+  }
+
+  if(reconstructedTrackIds.empty())
+    return 0;
+  return computeCandidateImageScore(viewId, reconstructedTrackIds);
+}
+
+void ReconstructionEngine_sequentialSfM::updateTrackInViewsScore(std::size_t trackId, bool isReconstructed)
+{
+  const std::size_t trackIndex = _tracksCSR.findTrackIndex(trackId);
+  for(std::size_t i = _tracksCSR.trackBegin(trackIndex); i < _tracksCSR.trackEnd(trackIndex); ++i)
+  {
+    const IndexT viewId = _tracksCSR.obsViewIds()[i];
+    ViewScore& viewScore = _viewsScore[viewId];
+
+    if(isReconstructed)
+      ++viewScore.nbTracks;
+    else
+      --viewScore.nbTracks;
+
+#ifdef ALICEVISION_NEXTBESTVIEW_WITHOUT_SCORE
+    viewScore.score = viewScore.nbTracks;
+#else
+    // A pyramid cell contributes to the score as soon as it contains one reconstructed track
+    const auto& featsPyramid = _map_featsPyramidPerView.at(viewId);
+    for(std::size_t level = 0; level < _params.pyramidDepth; ++level)
+    {
+      const std::size_t pyramidIndex = featsPyramid.at(trackId * _params.pyramidDepth + level);
+
+      if(isReconstructed)
+      {
+        if(viewScore.cellsCount[pyramidIndex]++ == 0)
+          viewScore.score += _pyramidWeights[level];
+      }
+      else
+      {
+        auto cellIt = viewScore.cellsCount.find(pyramidIndex);
+        if(--(cellIt->second) == 0)
+        {
+          viewScore.cellsCount.erase(cellIt);
+          viewScore.score -= _pyramidWeights[level];
+        }
+      }
+    }
+#endif
+  }
 }
 
 bool ReconstructionEngine_sequentialSfM::findNextBestViews(
   std::vector<IndexT> & out_selectedViewIds,
-  const std::set<IndexT>& remainingViewIds) const
+  const std::set<IndexT>& remainingViewIds)
 {
+  // Limit to a maximum number of cameras added to ensure that
+  // we don't add too much data in one step without bundle adjustment.
+  static const std::size_t maxImagesPerGroup = 30;
+
   out_selectedViewIds.clear();
   auto chrono_start = std::chrono::steady_clock::now();
   std::vector<ViewConnectionScore> vec_viewsScore;
-  if(!findConnectedViews(vec_viewsScore, remainingViewIds))
+  if(!findConnectedViews(vec_viewsScore, remainingViewIds, maxImagesPerGroup))
   {
     ALICEVISION_LOG_DEBUG("FindConnectedViews does not find connected new views ");
     return false;
@@ -1038,10 +1233,6 @@ bool ReconstructionEngine_sequentialSfM::findNextBestViews(
     out_selectedViewIds.resize(1);
   }
 
-  // Limit to a maximum number of cameras added to ensure that
-  // we don't add too much data in one step without bundle adjustment.
-  static const std::size_t maxImagesPerGroup = 30;
-
   if(out_selectedViewIds.size() > maxImagesPerGroup)
     out_selectedViewIds.resize(maxImagesPerGroup);
 
@@ -1090,7 +1281,7 @@ bool ReconstructionEngine_sequentialSfM::makeInitialPair3D(const Pair& currentPa
   // b. get common features between the two views
   // use the track to have a more dense match correspondence set
   aliceVision::track::TracksMap commonTracks;
-  track::getCommonTracksInImagesFast({I, J}, _map_tracks, _map_tracksPerView, commonTracks);
+  track::getCommonTracksInImagesFast({I, J}, _tracksCSR, commonTracks);
 
   // copy point to arrays
   const std::size_t n = commonTracks.size();
@@ -1245,17 +1436,16 @@ bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pa
   /// ImagePairScore contains <imagePairScore*scoring_angle, imagePairScore, scoring_angle, numberOfInliers, imagePair>
   typedef std::tuple<double, double, double, std::size_t, Pair> ImagePairScore;
   std::vector<ImagePairScore> bestImagePairs;
-  bestImagePairs.reserve(_pairwiseMatches->size());
+  bestImagePairs.reserve(_usedPairwiseMatches.size());
   
   // Compute the relative pose & the 'baseline score'
-  boost::progress_display my_progress_bar( _pairwiseMatches->size(),
+  boost::progress_display my_progress_bar( _usedPairwiseMatches.size(),
     std::cout,"Automatic selection of an initial pair:\n" );
 
 #pragma omp parallel for schedule(dynamic)
-  for (int i = 0; i < _pairwiseMatches->size(); ++i)
+  for (int i = 0; i < static_cast<int>(_usedPairwiseMatches.size()); ++i)
   {
-    matching::PairwiseMatches::const_iterator iter = _pairwiseMatches->begin();
-    std::advance(iter, i);
+    const matching::PairwiseMatches::const_iterator iter = _usedPairwiseMatches.at(i);
     
 #pragma omp critical
     ++my_progress_bar;
@@ -1283,7 +1473,7 @@ bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pa
 
     aliceVision::track::TracksMap map_tracksCommon;
     const std::set<size_t> set_imageIndex= {I, J};
-    track::getCommonTracksInImagesFast(set_imageIndex, _map_tracks, _map_tracksPerView, map_tracksCommon);
+    track::getCommonTracksInImagesFast(set_imageIndex, _tracksCSR, map_tracksCommon);
 
     // Copy points correspondences to arrays for relative pose estimation
     const size_t n = map_tracksCommon.size();
@@ -1423,6 +1613,36 @@ std::size_t ReconstructionEngine_sequentialSfM::computeCandidateImageScore(Index
  * D. Refine the pose of the found camera
  */
 bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, ResectionData& resectionData)
+{
+  const bool hasResected = computeResection(_sfmData, viewId, resectionData);
+  htmlLogResection(viewId, resectionData, hasResected, false);
+  return hasResected;
+}
+
+void ReconstructionEngine_sequentialSfM::htmlLogResection(const IndexT viewId, const ResectionData& resectionData, bool hasResected, bool isSpeculative)
+{
+  if (!_htmlLogFile.empty())
+  {
+    using namespace htmlDocument;
+    std::ostringstream os;
+    os << (isSpeculative ? "Speculative robust resection of view " : "Robust resection of view ") << viewId << ": <br>";
+    _htmlDocStream->pushInfo(htmlMarkup("h4",os.str()));
+
+    os.str("");
+    os << std::endl
+      << "- Image path: " << _sfmData.getView(viewId).getImagePath() << "<br>"
+      << "- Threshold (error max): " << resectionData.error_max << "<br>"
+      << "- Resection status: " << (hasResected ? "OK" : (isSpeculative ? "REJECTED" : "FAILED")) << "<br>"
+      << "- # points used for Resection: " << resectionData.featuresId.size() << "<br>"
+      << "- # points validated by robust estimation: " << resectionData.vec_inliers.size() << "<br>"
+      << "- % points validated: "
+      << resectionData.vec_inliers.size()/static_cast<float>(resectionData.featuresId.size()) << "<br>";
+
+    _htmlDocStream->pushInfo(os.str());
+  }
+}
+
+bool ReconstructionEngine_sequentialSfM::computeResection(const SfMData& scene, const IndexT viewId, ResectionData& resectionData)
 {
   using namespace track;
 
@@ -1432,7 +1652,7 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
 
   // A2. intersects the track list with the reconstructed
   std::set<std::size_t> reconstructed_trackId;
-  std::transform(_sfmData.getLandmarks().begin(), _sfmData.getLandmarks().end(),
+  std::transform(scene.getLandmarks().begin(), scene.getLandmarks().end(),
                  std::inserter(reconstructed_trackId, reconstructed_trackId.begin()),
                  stl::RetrieveKey());
   
@@ -1451,7 +1671,7 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
   
   // Get back featId associated to a tracksID already reconstructed.
   // These 2D/3D associations will be used for the resection.
-  getFeatureIdInViewPerTrack(_map_tracks,
+  getFeatureIdInViewPerTrack(_tracksCSR,
                                              resectionData.tracksId,
                                              viewId,
                                              &resectionData.featuresId);
@@ -1462,8 +1682,8 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
   resectionData.vec_descType.resize(resectionData.tracksId.size());
   
   // B. Look if intrinsic data is known or not
-  const View * view_I = _sfmData.getViews().at(viewId).get();
-  resectionData.optionalIntrinsic = _sfmData.getIntrinsicsharedPtr(view_I->getIntrinsicId());
+  const View * view_I = scene.getViews().at(viewId).get();
+  resectionData.optionalIntrinsic = scene.getIntrinsicsharedPtr(view_I->getIntrinsicId());
   
   std::size_t cpt = 0;
   std::set<std::size_t>::const_iterator iterTrackId = resectionData.tracksId.begin();
@@ -1472,13 +1692,13 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
        ++iterfeatId, ++iterTrackId, ++cpt)
   {
     const feature::EImageDescriberType descType = iterfeatId->first;
-    resectionData.pt3D.col(cpt) = _sfmData.getLandmarks().at(*iterTrackId).X;
+    resectionData.pt3D.col(cpt) = scene.getLandmarks().at(*iterTrackId).X;
     resectionData.pt2D.col(cpt) = _featuresPerView->getFeatures(viewId, descType)[iterfeatId->second].coords().cast<double>();
     resectionData.vec_descType.at(cpt) = descType;
   }
   
   // C. Do the resectioning: compute the camera pose.
-  ALICEVISION_LOG_INFO("[" << _sfmData.getValidViews().size()+1 << "/" << _sfmData.getViews().size() << "] Robust Resection of view: " << viewId);
+  ALICEVISION_LOG_INFO("[" << scene.getValidViews().size()+1 << "/" << scene.getViews().size() << "] Robust Resection of view: " << viewId);
 
   const bool bResection = sfm::SfMLocalizer::Localize(
       Pair(view_I->getWidth(), view_I->getHeight()),
@@ -1489,26 +1709,6 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
       _params.localizerEstimator
     );
 
-  if (!_htmlLogFile.empty())
-  {
-    using namespace htmlDocument;
-    std::ostringstream os;
-    os << "Robust resection of view " << viewId << ": <br>";
-    _htmlDocStream->pushInfo(htmlMarkup("h4",os.str()));
-
-    os.str("");
-    os << std::endl
-      << "- Image path: " << view_I->getImagePath() << "<br>"
-      << "- Threshold (error max): " << resectionData.error_max << "<br>"
-      << "- Resection status: " << (bResection ? "OK" : "FAILED") << "<br>"
-      << "- # points used for Resection: " << resectionData.featuresId.size() << "<br>"
-      << "- # points validated by robust estimation: " << resectionData.vec_inliers.size() << "<br>"
-      << "- % points validated: "
-      << resectionData.vec_inliers.size()/static_cast<float>(resectionData.featuresId.size()) << "<br>";
-
-    _htmlDocStream->pushInfo(os.str());
-  }
-  
   if (!bResection)
   {
     ALICEVISION_LOG_INFO("Resection of view " << viewId << " failed.");
@@ -1544,7 +1744,7 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
       pinhole_cam->setK(focal, principal_point(0), principal_point(1));
     }
 
-    const std::set<IndexT> reconstructedIntrinsics = _sfmData.getReconstructedIntrinsics();
+    const std::set<IndexT> reconstructedIntrinsics = scene.getReconstructedIntrinsics();
     // If we use a camera intrinsic for the first time we need to refine it.
     const bool intrinsicsFirstUsage = (reconstructedIntrinsics.count(view_I->getIntrinsicId()) == 0);
 
@@ -1559,6 +1759,135 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
   return true;
 }
 
+SfMData ReconstructionEngine_sequentialSfM::createResectionSnapshot(const std::vector<IndexT>& viewIds) const
+{
+  SfMData snapshot;
+
+  // views, poses and rigs are not modified by the bundle adjustment of the current group
+  snapshot.views = _sfmData.getViews();
+  snapshot.getPoses() = _sfmData.getPoses();
+  snapshot.getRigs() = _sfmData.getRigs();
+
+  // intrinsics are refined by the bundle adjustment and initialized by the resection
+  for(const auto& intrinsicPair : _sfmData.getIntrinsics())
+    snapshot.intrinsics.emplace(intrinsicPair.first, std::shared_ptr<camera::IntrinsicBase>(intrinsicPair.second->clone()));
+
+  // only the landmarks visible in the views to resect, without their observations
+  for(const IndexT viewId : viewIds)
+  {
+    for(const std::size_t trackId : _map_tracksPerView.at(viewId))
+    {
+      const auto landmarkIt = _sfmData.getLandmarks().find(trackId);
+      if(landmarkIt != _sfmData.getLandmarks().end())
+        snapshot.structure.emplace(landmarkIt->first, Landmark(landmarkIt->second.X, landmarkIt->second.descType));
+    }
+  }
+  return snapshot;
+}
+
+std::map<IndexT, ReconstructionEngine_sequentialSfM::ResectionData> ReconstructionEngine_sequentialSfM::computeSpeculativeResections(
+  const SfMData& snapshot,
+  const std::vector<IndexT>& viewIds)
+{
+  auto chrono_start = std::chrono::steady_clock::now();
+
+  std::map<IndexT, ResectionData> resections;
+
+#pragma omp parallel for
+  for(int i = 0; i < static_cast<int>(viewIds.size()); ++i)
+  {
+    const IndexT viewId = viewIds.at(i);
+
+    ResectionData resectionData;
+    resectionData.error_max = _params.localizerEstimatorError;
+    resectionData.max_iteration = _params.localizerEstimatorMaxIterations;
+    resectionData.useSprt = _params.localizerUseSprt;
+
+    if(!computeResection(snapshot, viewId, resectionData))
+      continue;
+
+#pragma omp critical
+    resections.emplace(viewId, std::move(resectionData));
+  }
+
+  ALICEVISION_LOG_DEBUG("Speculative resection of " << resections.size() << "/" << viewIds.size() << " images took "
+                        << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chrono_start).count() << " msec.");
+  return resections;
+}
+
+bool ReconstructionEngine_sequentialSfM::validateSpeculativeResection(const IndexT viewId, ResectionData& resectionData)
+{
+  // The bundle adjustment may have removed some inliers, the speculative pose
+  // is only kept if it is still supported by most of them.
+  static const double minValidInliersRatio = 0.8;
+
+  const Landmarks& landmarks = _sfmData.getLandmarks();
+  const std::size_t nbPoints = resectionData.featuresId.size();
+
+  // A. Update the 2D/3D matches with the landmarks of the current scene
+  std::set<std::size_t> tracksId;
+  std::vector<track::FeatureId> featuresId;
+  std::vector<feature::EImageDescriberType> vec_descType;
+  std::vector<int> newIndexes(nbPoints, -1);
+  Mat pt2D(2, nbPoints);
+  Mat pt3D(3, nbPoints);
+
+  std::size_t cpt = 0;
+  std::set<std::size_t>::const_iterator iterTrackId = resectionData.tracksId.begin();
+  for(std::size_t i = 0; i < nbPoints; ++i, ++iterTrackId)
+  {
+    const auto landmarkIt = landmarks.find(*iterTrackId);
+    if(landmarkIt == landmarks.end())
+      continue;
+
+    tracksId.insert(tracksId.end(), *iterTrackId);
+    featuresId.push_back(resectionData.featuresId[i]);
+    vec_descType.push_back(resectionData.vec_descType[i]);
+    pt2D.col(cpt) = resectionData.pt2D.col(i);
+    pt3D.col(cpt) = landmarkIt->second.X;
+    newIndexes[i] = cpt++;
+  }
+
+  std::vector<std::size_t> vec_inliers;
+  vec_inliers.reserve(resectionData.vec_inliers.size());
+  for(const std::size_t idx : resectionData.vec_inliers)
+  {
+    if(newIndexes[idx] >= 0)
+      vec_inliers.push_back(newIndexes[idx]);
+  }
+
+  if(vec_inliers.size() < minValidInliersRatio * resectionData.vec_inliers.size())
+    return false;
+
+  pt2D.conservativeResize(2, cpt);
+  pt3D.conservativeResize(3, cpt);
+
+  resectionData.tracksId.swap(tracksId);
+  resectionData.featuresId.swap(featuresId);
+  resectionData.vec_descType.swap(vec_descType);
+  resectionData.vec_inliers.swap(vec_inliers);
+  resectionData.pt2D = std::move(pt2D);
+  resectionData.pt3D = std::move(pt3D);
+
+  // B. Use the intrinsic of the current scene, initialized from the speculative one if needed
+  const View& view = *_sfmData.getViews().at(viewId);
+  std::shared_ptr<camera::IntrinsicBase> intrinsic = _sfmData.getIntrinsicsharedPtr(view.getIntrinsicId());
+
+  const camera::Pinhole* pinhole_cam = dynamic_cast<const camera::Pinhole*>(intrinsic.get());
+  if(resectionData.isNewIntrinsic && pinhole_cam != nullptr && !pinhole_cam->isValid())
+    intrinsic->assign(*resectionData.optionalIntrinsic);
+
+  resectionData.optionalIntrinsic = intrinsic;
+
+  // C. Refine the speculative pose with the current scene
+  const std::set<IndexT> reconstructedIntrinsics = _sfmData.getReconstructedIntrinsics();
+  const bool intrinsicsFirstUsage = (reconstructedIntrinsics.count(view.getIntrinsicId()) == 0);
+
+  return sfm::SfMLocalizer::RefinePose(
+    resectionData.optionalIntrinsic.get(), resectionData.pose,
+    resectionData, true, resectionData.isNewIntrinsic || intrinsicsFirstUsage);
+}
+
 void ReconstructionEngine_sequentialSfM::updateScene(const IndexT viewIndex, const ResectionData& resectionData)
 { 
   // A. Update the global scene with the new found camera pose, intrinsic (if not defined)
@@ -1633,7 +1962,7 @@ void ReconstructionEngine_sequentialSfM::getTracksToTriangulate(const std::set<I
   allReconstructedViews.insert(newReconstructedViews.begin(), newReconstructedViews.end());
   
   std::set<IndexT> allTracksInNewViews;
-  track::getTracksInImagesFast(newReconstructedViews, _map_tracksPerView, allTracksInNewViews);
+  track::getTracksInImagesFast(newReconstructedViews, _tracksCSR, allTracksInNewViews);
   
   std::set<IndexT>::iterator it;
 #pragma omp parallel private(it)
@@ -1644,12 +1973,11 @@ void ReconstructionEngine_sequentialSfM::getTracksToTriangulate(const std::set<I
       {
         const std::size_t trackId = *it;
         
-        const track::Track& track = _map_tracks.at(trackId);
-        
-        std::set<IndexT> allViewsSharingTheTrack;
-        std::transform(track.featPerView.begin(), track.featPerView.end(),
-                       std::inserter(allViewsSharingTheTrack, allViewsSharingTheTrack.begin()),
-                       stl::RetrieveKey());
+        const std::size_t trackIndex = _tracksCSR.findTrackIndex(trackId);
+
+        // the observations of a track are sorted by view id
+        const std::set<IndexT> allViewsSharingTheTrack(_tracksCSR.obsViewIds().begin() + _tracksCSR.trackBegin(trackIndex),
+                                                       _tracksCSR.obsViewIds().begin() + _tracksCSR.trackEnd(trackIndex));
         
         std::set<IndexT> allReconstructedViewsSharingTheTrack;
         std::set_intersection(allViewsSharingTheTrack.begin(), allViewsSharingTheTrack.end(),
@@ -1686,7 +2014,8 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
   {
     const IndexT trackId = setTracksId.at(i);
     bool isValidTrack = true;
-    const track::Track& track = _map_tracks.at(trackId);
+    const std::size_t trackIndex = _tracksCSR.findTrackIndex(trackId);
+    const feature::EImageDescriberType descType = _tracksCSR.descType(trackIndex);
     std::set<IndexT>& observations = mapTracksToTriangulate.at(trackId); // all the posed views possessing the track
     
     // The track needs to be seen by a min. number of views to be triangulated
@@ -1726,8 +2055,8 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
 
       const Pose3 poseI = scene.getPose(*viewI).getTransform();
       const Pose3 poseJ = scene.getPose(*viewJ).getTransform();
-      const Vec2 xI = _featuresPerView->getFeatures(I, track.descType)[track.featPerView.at(I)].coords().cast<double>();
-      const Vec2 xJ = _featuresPerView->getFeatures(J, track.descType)[track.featPerView.at(J)].coords().cast<double>();
+      const Vec2 xI = _featuresPerView->getFeatures(I, descType)[_tracksCSR.getFeatureInView(trackIndex, I)].coords().cast<double>();
+      const Vec2 xJ = _featuresPerView->getFeatures(J, descType)[_tracksCSR.getFeatureInView(trackIndex, J)].coords().cast<double>();
   
       // -- Triangulate:
       multiview::TriangulateDLT(camIPinHole->getProjectiveEquivalent(poseI),
@@ -1763,8 +2092,6 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
       Mat2X features(2, observations.size()); // undistorted 2D features (one per pose)
       std::vector<Mat34> Ps; // projective matrices (one per pose)
       {
-        const track::Track& track = _map_tracks.at(trackId);
-        
         int i = 0;
         for (const IndexT& viewId : observations)
         {
@@ -1777,7 +2104,7 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
             continue;
           }
 
-          const Vec2 x_ud = cam->get_ud_pixel(_featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)].coords().cast<double>()); // undistorted 2D point
+          const Vec2 x_ud = cam->get_ud_pixel(_featuresPerView->getFeatures(viewId, descType)[_tracksCSR.getFeatureInView(trackIndex, viewId)].coords().cast<double>()); // undistorted 2D point
           features(0,i) = x_ud(0); 
           features(1,i) = x_ud(1);  
           Ps.push_back(camPinHole->getProjectiveEquivalent(scene.getPose(*view).getTransform()));
@@ -1812,13 +2139,13 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
     {
       Landmark landmark;
       landmark.X = X_euclidean;
-      landmark.descType = track.descType;
+      landmark.descType = descType;
       for (const IndexT & viewId : inliers) // add inliers as observations
       {
-        const Vec2 x = _featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)].coords().cast<double>();
-        const feature::PointFeature& p = _featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)];
+        const Vec2 x = _featuresPerView->getFeatures(viewId, descType)[_tracksCSR.getFeatureInView(trackIndex, viewId)].coords().cast<double>();
+        const feature::PointFeature& p = _featuresPerView->getFeatures(viewId, descType)[_tracksCSR.getFeatureInView(trackIndex, viewId)];
         const double scale = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : p.scale();
-        landmark.observations[viewId] = Observation(x, track.featPerView.at(viewId), scale);
+        landmark.observations[viewId] = Observation(x, _tracksCSR.getFeatureInView(trackIndex, viewId), scale);
       }
 #pragma omp critical
       {
@@ -1872,7 +2199,7 @@ void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene, cons
       // Find track correspondences between I and J
       const std::set<std::size_t> set_viewIndex = { I, J };
       track::TracksMap map_tracksCommonIJ;
-      track::getCommonTracksInImagesFast(set_viewIndex, _map_tracks, _map_tracksPerView, map_tracksCommonIJ);
+      track::getCommonTracksInImagesFast(set_viewIndex, _tracksCSR, map_tracksCommonIJ);
 
       const View* viewI = scene.getViews().at(I).get();
       const View* viewJ = scene.getViews().at(J).get();
@@ -21,6 +21,9 @@
 #include <boost/filesystem.hpp>
 #include <boost/property_tree/ptree.hpp>
 
+#include <future>
+#include <queue>
+
 namespace fs = boost::filesystem;
 namespace pt = boost::property_tree;
 
@@ -64,6 +67,10 @@ public:
     robustEstimation::ERobustEstimator localizerEstimator = robustEstimation::ERobustEstimator::ACRANSAC;
     double localizerEstimatorError = std::numeric_limits<double>::infinity();
     size_t localizerEstimatorMaxIterations = 4096;
+    /// verify the localizer hypotheses with a SPRT (LORansac only)
+    bool localizerUseSprt = false;
+    /// resect the next group of views on a snapshot of the scene during the bundle adjustment
+    bool pipelinedResection = false;
 
     // Pyramid scoring
 
@@ -103,8 +110,55 @@ public:
   void setMatches(matching::PairwiseMatches* pairwiseMatches)
   {
     _pairwiseMatches = pairwiseMatches;
+    _usedPairwiseMatches.clear();
+    _usedPairwiseMatches.reserve(pairwiseMatches->size());
+    for(matching::PairwiseMatches::const_iterator it = pairwiseMatches->begin(); it != pairwiseMatches->end(); ++it)
+      _usedPairwiseMatches.push_back(it);
+  }
+
+  /**
+   * @brief Use only some pairs of the pairwise matches, referenced without copy
+   * @param[in] pairwiseMatches All the pairwise matches
+   * @param[in] usedPairwiseMatches The pairs used by the reconstruction
+   */
+  void setMatches(matching::PairwiseMatches* pairwiseMatches,
+                  const std::vector<matching::PairwiseMatches::const_iterator>& usedPairwiseMatches)
+  {
+    _pairwiseMatches = pairwiseMatches;
+    _usedPairwiseMatches = usedPairwiseMatches;
+  }
+
+  /// Statistics of the resections computed during the bundle adjustment (pipelined mode)
+  struct SpeculativeResectionStats
+  {
+    /// number of successful resections computed on a snapshot
+    std::size_t nbComputed = 0;
+    /// number of speculative resections added to the scene
+    std::size_t nbUsed = 0;
+    /// number of speculative resections no longer valid after the bundle adjustment, computed again
+    std::size_t nbRejected = 0;
+  };
+
+  const SpeculativeResectionStats& getSpeculativeResectionStats() const
+  {
+    return _speculativeResectionStats;
   }
 
+  /**
+   * @brief Get the next best view score of a view, maintained incrementally with the scene landmarks
+   * @param[in] viewId: the ID of the view
+   * @return the score of the view (0 if it does not observe any reconstructed track)
+   */
+  std::size_t getViewScore(IndexT viewId);
+
+  /**
+   * @brief Compute the next best view score of a view from all its tracks reconstructed in the scene,
+   *        without the incremental update (to check it)
+   * @param[in] viewId: the ID of the view
+   * @return the score of the view
+   */
+  std::size_t computeViewScore(IndexT viewId) const;
+
   /**
    * @brief Process the entire incremental reconstruction
    * @return true if done
@@ -190,16 +244,21 @@ public:
   void calibrateRigs(std::set<IndexT>& updatedViews);
 
   /**
-   * @brief Return all the images containing matches with already reconstructed 3D points.
+   * @brief Return the best images containing matches with already reconstructed 3D points.
    * The images are sorted by a score based on the number of features id shared with
    * the reconstruction and the repartition of these points in the image.
    *
+   * The scores are maintained incrementally (see updateViewsScore), so only the
+   * best candidates are extracted from the priority queue.
+   *
    * @param[out] out_connectedViews: output list of view IDs connected with the 3D reconstruction.
    * @param[in] remainingViewIds: input list of remaining view IDs in which we will search for connected views.
+   * @param[in] maxNbConnectedViews: maximum number of output views.
    * @return False if there is no view connected.
    */
   bool findConnectedViews(std::vector<ViewConnectionScore>& out_connectedViews,
-                          const std::set<IndexT>& remainingViewIds) const;
+                          const std::set<IndexT>& remainingViewIds,
+                          std::size_t maxNbConnectedViews);
 
   /**
    * @brief Estimate the best images on which we can compute the resectioning safely.
@@ -211,7 +270,7 @@ public:
    * @return False if there is no possible resection.
    */
   bool findNextBestViews(std::vector<IndexT>& out_selectedViewIds,
-                         const std::set<IndexT>& remainingViewIds) const;
+                         const std::set<IndexT>& remainingViewIds);
 
 private:
 
@@ -264,6 +323,20 @@ private:
    */
   std::size_t computeCandidateImageScore(IndexT viewId, const std::vector<std::size_t>& trackIds) const;
 
+  /**
+   * @brief Update the next best view scores with the landmarks added to or removed
+   * from the scene since the last call. Only the pyramid cells of the views
+   * observing these tracks are updated.
+   */
+  void updateViewsScore();
+
+  /**
+   * @brief Add or remove a reconstructed track in the pyramid cells of all the views observing it.
+   * @param[in] trackId: the track ID
+   * @param[in] isReconstructed: true if the track has been added to the scene, false if removed
+   */
+  void updateTrackInViewsScore(std::size_t trackId, bool isReconstructed);
+
   /**
    * @brief Apply the resection on a single view.
    * @param[in] viewIndex: image index to add to the reconstruction.
@@ -272,6 +345,54 @@ private:
    */
   bool computeResection(const IndexT viewIndex, ResectionData& resectionData);
 
+  /**
+   * @brief Add the result of a resection to the html report.
+   * @param[in] viewIndex: image index of the resected view.
+   * @param[in] resectionData: all the data used during the resection.
+   * @param[in] hasResected: the resection status
+   * @param[in] isSpeculative: true if the resection has been computed on a snapshot (pipelined mode)
+   */
+  void htmlLogResection(const IndexT viewIndex, const ResectionData& resectionData, bool hasResected, bool isSpeculative);
+
+  /**
+   * @brief Apply the resection on a single view against a given scene.
+   * @param[in] scene: the scene containing the reconstructed landmarks.
+   * @param[in] viewIndex: image index to add to the reconstruction.
+   * @param[out] resectionData: contains the result (P) and all the data used during the resection.
+   * @return false if resection failed
+   */
+  bool computeResection(const sfmData::SfMData& scene, const IndexT viewIndex, ResectionData& resectionData);
+
+  /**
+   * @brief Copy the part of the scene used by the resection of the given views,
+   * so they can be resected while the bundle adjustment updates the scene.
+   * The intrinsics are cloned and only the landmarks visible in the views are copied.
+   * @param[in] viewIds: the views to resect
+   * @return the scene snapshot
+   */
+  sfmData::SfMData createResectionSnapshot(const std::vector<IndexT>& viewIds) const;
+
+  /**
+   * @brief Compute the resection of the given views on a snapshot of the scene.
+   * @param[in] snapshot: the scene snapshot (see createResectionSnapshot)
+   * @param[in] viewIds: the views to resect
+   * @return the successful resections
+   */
+  std::map<IndexT, ResectionData> computeSpeculativeResections(const sfmData::SfMData& snapshot,
+                                                               const std::vector<IndexT>& viewIds);
+
+  /**
+   * @brief Validate a resection computed on a snapshot against the current scene.
+   * The 2D-3D correspondences are updated with the current landmarks and the pose
+   * is refined from the speculative one.
+   * @param[in] viewIndex: image index to add to the reconstruction.
+   * @param[in,out] resectionData: the speculative resection, updated with the current scene.
+   * @return false if the resection is no longer valid and has to be computed again
+   * @note The intrinsic of the view may be initialized and refined in the scene,
+   *       so the speculative resections are validated one by one.
+   */
+  bool validateSpeculativeResection(const IndexT viewIndex, ResectionData& resectionData);
+
   /**
    * @brief Update the global scene with the new found camera pose, intrinsic (if not defined) and 
    * Update its observations into the global scene structure.
@@ -348,6 +469,8 @@ private:
 
   feature::FeaturesPerView* _featuresPerView;
   matching::PairwiseMatches* _pairwiseMatches;
+  /// pairs of _pairwiseMatches used by the reconstruction
+  std::vector<matching::PairwiseMatches::const_iterator> _usedPairwiseMatches;
 
   // Pyramid scoring
 
@@ -355,16 +478,38 @@ private:
   std::vector<int> _pyramidWeights;
   int _pyramidThreshold;
 
+  /// Incremental next best view score of a view
+  struct ViewScore
+  {
+    /// number of reconstructed tracks visible in the view
+    std::size_t nbTracks = 0;
+    /// pyramid score of the reconstructed tracks (see computeCandidateImageScore)
+    std::size_t score = 0;
+    /// number of reconstructed tracks in each occupied pyramid cell
+    HashMap<std::size_t, std::size_t> cellsCount;
+  };
+
+  /// next best view score of each view observing reconstructed tracks
+  HashMap<IndexT, ViewScore> _viewsScore;
+  /// reconstructed track ids taken into account in _viewsScore
+  std::set<std::size_t> _scoredTrackIds;
+  /// <score, viewId> of the candidate views, outdated entries are skipped lazily
+  std::priority_queue<std::pair<std::size_t, IndexT>> _viewsScoreQueue;
+
   // Temporary data
 
-  /// Putative landmark tracks (visibility per potential 3D point)
-  track::TracksMap _map_tracks;
+  /// Putative landmark tracks (visibility per potential 3D point) in CSR arrays with the per view index
+  track::TracksCSR _tracksCSR;
   /// Putative tracks per view
   track::TracksPerView _map_tracksPerView;
   /// Precomputed pyramid index for each trackId of each viewId.
   track::TracksPyramidPerView _map_featsPyramidPerView;
   /// Per camera confidence (A contrario estimated threshold error)
   HashMap<IndexT, double> _map_ACThreshold;
+  /// Resections of the next group of views running during the bundle adjustment (pipelined mode)
+  std::future<std::map<IndexT, ResectionData>> _speculativeResections;
+  /// Statistics of the pipelined mode
+  SpeculativeResectionStats _speculativeResectionStats;
 
   // Local Bundle Adjustment data
 
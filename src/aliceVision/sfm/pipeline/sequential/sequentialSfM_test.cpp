@@ -83,6 +83,65 @@ BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Known_Intrinsics)
   BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getLandmarks().size(), npoints);
 }
 
+// Test the pipelined resection on a scene where all the camera intrinsics are known:
+// the speculative resections must be computed and used
+BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Pipelined_Resection)
+{
+  const int nviews = 6;
+  const int npoints = 128;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  const SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+
+  // Remove poses and structure
+  SfMData sfmData2 = sfmData;
+  sfmData2.getPoses().clear();
+  sfmData2.structure.clear();
+
+  ReconstructionEngine_sequentialSfM::Params sfmParams;
+  sfmParams.userInitialImagePair = Pair(0, 1);
+  sfmParams.lockAllIntrinsics = true;
+  sfmParams.pipelinedResection = true;
+
+  ReconstructionEngine_sequentialSfM sfmEngine(
+    sfmData2,
+    sfmParams,
+    "./",
+    "./Reconstruction_Report.html");
+
+  // Add a tiny noise in 2D observations to make data more realistic
+  std::normal_distribution<double> distribution(0.0,0.5);
+
+  // Configure the featuresPerView & the matches_provider from the synthetic dataset
+  feature::FeaturesPerView featuresPerView;
+  generateSyntheticFeatures(featuresPerView, feature::EImageDescriberType::UNKNOWN, sfmData, distribution);
+
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+  // Configure data provider (Features and Matches)
+  sfmEngine.setFeatures(&featuresPerView);
+  sfmEngine.setMatches(&pairwiseMatches);
+
+  BOOST_CHECK (sfmEngine.process());
+
+  const double residual = RMSE(sfmEngine.getSfMData());
+  ALICEVISION_LOG_DEBUG("RMSE residual: " << residual);
+  BOOST_CHECK_LT(residual, 0.5);
+  BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getPoses().size(), nviews);
+  BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getLandmarks().size(), npoints);
+
+  // the views are added one by one after the initial pair,
+  // each group but the first one is resected during the previous bundle adjustment
+  const ReconstructionEngine_sequentialSfM::SpeculativeResectionStats& stats = sfmEngine.getSpeculativeResectionStats();
+  BOOST_CHECK_GT(stats.nbComputed, 0);
+  BOOST_CHECK_LE(stats.nbComputed, nviews - 3);
+  BOOST_CHECK_EQUAL(stats.nbUsed + stats.nbRejected, stats.nbComputed);
+  BOOST_CHECK_GT(stats.nbUsed, 0);
+}
+
 // Test a scene where only the two first camera have known intrinsics
 BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Partially_Known_Intrinsics)
 {
@@ -194,3 +253,78 @@ BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Known_Rig)
   BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getLandmarks().size(), nbPoints);
 }
 
+
+// Test that the next best view scores maintained incrementally during the reconstruction,
+// and after landmarks are removed from and added back to the scene,
+// are the scores computed from all the reconstructed tracks of each view
+BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Incremental_View_Score)
+{
+  const int nviews = 6;
+  const int npoints = 128;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  const SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+
+  // Remove poses and structure
+  SfMData sfmData2 = sfmData;
+  sfmData2.getPoses().clear();
+  sfmData2.structure.clear();
+
+  ReconstructionEngine_sequentialSfM::Params sfmParams;
+  sfmParams.userInitialImagePair = Pair(0, 1);
+  sfmParams.lockAllIntrinsics = true;
+
+  ReconstructionEngine_sequentialSfM sfmEngine(
+    sfmData2,
+    sfmParams,
+    "./",
+    "./Reconstruction_Report.html");
+
+  // Add a tiny noise in 2D observations to make data more realistic
+  std::normal_distribution<double> distribution(0.0,0.5);
+
+  // Configure the featuresPerView & the matches_provider from the synthetic dataset
+  feature::FeaturesPerView featuresPerView;
+  generateSyntheticFeatures(featuresPerView, feature::EImageDescriberType::UNKNOWN, sfmData, distribution);
+
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+  // Configure data provider (Features and Matches)
+  sfmEngine.setFeatures(&featuresPerView);
+  sfmEngine.setMatches(&pairwiseMatches);
+
+  BOOST_CHECK (sfmEngine.process());
+
+  for(const auto& viewPair : sfmData.getViews())
+  {
+    BOOST_CHECK_GT(sfmEngine.computeViewScore(viewPair.first), 0);
+    BOOST_CHECK_EQUAL(sfmEngine.getViewScore(viewPair.first), sfmEngine.computeViewScore(viewPair.first));
+  }
+
+  // remove one landmark out of three
+  Landmarks& landmarks = sfmEngine.getSfMData().getLandmarks();
+  Landmarks removedLandmarks;
+  for(auto it = landmarks.begin(); it != landmarks.end();)
+  {
+    if(it->first % 3 == 0)
+    {
+      removedLandmarks.insert(*it);
+      it = landmarks.erase(it);
+    }
+    else
+      ++it;
+  }
+  BOOST_CHECK(!removedLandmarks.empty());
+
+  for(const auto& viewPair : sfmData.getViews())
+    BOOST_CHECK_EQUAL(sfmEngine.getViewScore(viewPair.first), sfmEngine.computeViewScore(viewPair.first));
+
+  // add them back
+  landmarks.insert(removedLandmarks.begin(), removedLandmarks.end());
+
+  for(const auto& viewPair : sfmData.getViews())
+    BOOST_CHECK_EQUAL(sfmEngine.getViewScore(viewPair.first), sfmEngine.computeViewScore(viewPair.first));
+}
@@ -10,6 +10,7 @@
 #include <aliceVision/stl/stl.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/sfm/BundleAdjustment.hpp>
+#include <aliceVision/sfm/utils/statistics.hpp>
 
 #include <iterator>
 
@@ -22,37 +23,43 @@ IndexT RemoveOutliers_PixelResidualError(sfmData::SfMData& sfmData,
                                          const unsigned int minTrackLength)
 {
   IndexT outlier_count = 0;
-  sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
 
+  // compute the residuals view by view, with a single batch projection per view
+  std::map<IndexT, ViewResiduals> residualsPerView;
+  computeViewsResiduals(sfmData, residualsPerView);
 
-  while(iterTracks != sfmData.structure.end())
+  for(const auto& viewResiduals : residualsPerView)
   {
-    sfmData::Observations & observations = iterTracks->second.observations;
-    sfmData::Observations::iterator itObs = observations.begin();
+    const IndexT viewId = viewResiduals.first;
+    const std::vector<IndexT>& landmarkIds = viewResiduals.second.landmarkIds;
+    const Mat2X& residuals = viewResiduals.second.residuals;
+    const geometry::Pose3 pose = sfmData.getPose(sfmData.getView(viewId)).getTransform();
 
-    while(itObs != observations.end())
+    for(std::size_t i = 0; i < landmarkIds.size(); ++i)
     {
-      const sfmData::View * view = sfmData.views.at(itObs->first).get();
-      const geometry::Pose3 pose = sfmData.getPose(*view).getTransform();
-      const camera::IntrinsicBase * intrinsic = sfmData.intrinsics.at(view->getIntrinsicId()).get();
+      sfmData::Landmark& landmark = sfmData.structure.at(landmarkIds[i]);
+      const sfmData::Observations::iterator itObs = landmark.observations.find(viewId);
 
-      Vec2 residual = intrinsic->residual(pose, iterTracks->second.X.homogeneous(), itObs->second.x);
+      double residualNorm = residuals.col(i).norm();
       if(featureConstraint == EFeatureConstraint::SCALE && itObs->second.scale > 0.0)
       {
           // Apply the scale of the feature to get a residual value
           // relative to the feature precision.
-          residual /= itObs->second.scale;
+          residualNorm /= itObs->second.scale;
       }
 
-      if((pose.depth(iterTracks->second.X) < 0) || (residual.norm() > dThresholdPixel))
+      if((pose.depth(landmark.X) < 0) || (residualNorm > dThresholdPixel))
       {
         ++outlier_count;
-        itObs = observations.erase(itObs);
+        landmark.observations.erase(itObs);
       }
-      else
-        ++itObs;
     }
+  }
 
+  sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
+  while(iterTracks != sfmData.structure.end())
+  {
+    const sfmData::Observations & observations = iterTracks->second.observations;
     if (observations.empty() || observations.size() < minTrackLength)
       iterTracks = sfmData.structure.erase(iterTracks);
     else
@@ -7,6 +7,7 @@
 #include "sfmStatistics.hpp"
 
 #include <aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp>
+#include <aliceVision/sfm/utils/statistics.hpp>
 
 #include <aliceVision/sfm/pipeline/regionsIO.hpp>
 #include <aliceVision/sfm/pipeline/pairwiseMatchesIO.hpp>
@@ -33,23 +34,14 @@ void computeResidualsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>
   std::vector<double> vec_residuals;
   vec_residuals.reserve(sfmData.structure.size());
 
-  for(const auto &track : sfmData.getLandmarks())
+  std::map<IndexT, ViewResiduals> residualsPerView;
+  computeViewsResiduals(sfmData, residualsPerView, specificViews);
+
+  for(const auto& viewResiduals : residualsPerView)
   {
-    const aliceVision::sfmData::Observations & observations = track.second.observations;
-    for(const auto& obs: observations)
-    {
-      if(!specificViews.empty())
-      {
-          if(specificViews.count(obs.first) == 0)
-              continue;
-      }
-      const sfmData::View& view = sfmData.getView(obs.first);
-      const aliceVision::geometry::Pose3 pose = sfmData.getPose(view).getTransform();
-      const std::shared_ptr<aliceVision::camera::IntrinsicBase> intrinsic = sfmData.getIntrinsics().find(view.getIntrinsicId())->second;
-      const Vec2 residual = intrinsic->residual(pose, track.second.X.homogeneous(), obs.second.x);
-      vec_residuals.push_back(residual.norm());
-      //ALICEVISION_LOG_INFO("[AliceVision] sfmtstatistics::computeResidualsHistogram track: " << track.first << ", residual: " << residual.norm());
-    }
+    const Mat2X& residuals = viewResiduals.second.residuals;
+    for(Mat2X::Index i = 0; i < residuals.cols(); ++i)
+      vec_residuals.push_back(residuals.col(i).norm());
   }
 
  // ALICEVISION_LOG_INFO("[AliceVision] sfmtstatistics::computeResidualsHistogram vec_residuals.size(): " << vec_residuals.size());
@@ -320,17 +312,16 @@ void computeResidualsPerView(const sfmData::SfMData& sfmData, int& nbViews, std:
 
     // Collect residuals (number of residuals per 3D points) of all landmarks visible in each view
     std::map<IndexT, std::vector<double>> residualsPerView;
-
-    for(const auto &landmark : sfmData.getLandmarks())
     {
-      const aliceVision::sfmData::Observations & observations = landmark.second.observations;
-      for(const auto& obs: observations)
+      std::map<IndexT, ViewResiduals> viewsResiduals;
+      computeViewsResiduals(sfmData, viewsResiduals);
+
+      for(const auto& viewResiduals : viewsResiduals)
       {
-        const sfmData::View& view = sfmData.getView(obs.first);
-        const aliceVision::geometry::Pose3 pose = sfmData.getPose(view).getTransform();
-        const std::shared_ptr<aliceVision::camera::IntrinsicBase> intrinsic = sfmData.getIntrinsics().find(view.getIntrinsicId())->second;
-        const Vec2 residual = intrinsic->residual(pose, landmark.second.X.homogeneous(), obs.second.x);
-        residualsPerView[obs.first].push_back(residual.norm());
+        const Mat2X& residuals = viewResiduals.second.residuals;
+        std::vector<double>& norms = residualsPerView[viewResiduals.first];
+        norms.resize(residuals.cols());
+        Eigen::Map<Eigen::RowVectorXd>(norms.data(), norms.size()) = residuals.colwise().norm();
       }
     }
 
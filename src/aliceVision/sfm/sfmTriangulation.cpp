@@ -9,11 +9,14 @@
 #include <aliceVision/multiview/triangulation/Triangulation.hpp>
 #include <aliceVision/robustEstimation/randSampling.hpp>
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/progress.hpp>
 
+#include <algorithm>
 #include <deque>
 #include <memory>
+#include <vector>
 
 namespace aliceVision {
 namespace sfm {
@@ -31,75 +34,107 @@ StructureComputation_blind::StructureComputation_blind(bool verbose)
 
 void StructureComputation_blind::triangulate(sfmData::SfMData& sfmData, std::mt19937 & randomNumberGenerator) const
 {
-  std::deque<IndexT> rejectedId;
+  // projection matrices of the reconstructed views, shared by all the landmarks
+  std::vector<Mat34> Ps;
+  std::vector<const IntrinsicBase*> intrinsics;
+  HashMap<IndexT, std::size_t> cameraIndexPerView;
+
+  for(const auto& viewPair : sfmData.getViews())
+  {
+    const sfmData::View* view = viewPair.second.get();
+    if(!sfmData.isPoseAndIntrinsicDefined(view))
+      continue;
+
+    const IntrinsicBase* cam = sfmData.getIntrinsics().at(view->getIntrinsicId()).get();
+    const camera::Pinhole* pinHoleCam = dynamic_cast<const camera::Pinhole*>(cam);
+    if(!pinHoleCam)
+    {
+      ALICEVISION_LOG_ERROR("Camera is not pinhole in triangulate");
+      continue;
+    }
+
+    cameraIndexPerView.emplace(viewPair.first, Ps.size());
+    Ps.push_back(pinHoleCam->getProjectiveEquivalent(sfmData.getPose(*view).getTransform()));
+    intrinsics.push_back(cam);
+  }
+
+  // flatten the landmarks to triangulate them by chunks
+  std::vector<sfmData::Landmarks::value_type*> landmarks;
+  landmarks.reserve(sfmData.structure.size());
+  for(auto& landmarkPair : sfmData.structure)
+    landmarks.push_back(&landmarkPair);
+
   std::unique_ptr<boost::progress_display> my_progress_bar;
   if (_bConsoleVerbose)
     my_progress_bar.reset( new boost::progress_display(
-    sfmData.structure.size(),
+    landmarks.size(),
     std::cout,
     "Blind triangulation progress:\n" ));
-  #pragma omp parallel
-  for(sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
-    iterTracks != sfmData.structure.end();
-    ++iterTracks)
+
+  const std::ptrdiff_t chunkSize = 1024;
+  const std::ptrdiff_t nbChunks = (static_cast<std::ptrdiff_t>(landmarks.size()) + chunkSize - 1) / chunkSize;
+
+  // the rejected landmarks are erased once all the chunks are triangulated
+  std::vector<std::vector<IndexT>> rejectedIdsPerThread(omp_get_max_threads());
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t c = 0; c < nbChunks; ++c)
   {
-    #pragma omp single nowait
+    const std::size_t begin = c * chunkSize;
+    const std::size_t end = std::min(begin + chunkSize, landmarks.size());
+
+    std::size_t nbObservations = 0;
+    for(std::size_t i = begin; i < end; ++i)
+      nbObservations += landmarks[i]->second.observations.size();
+
+    // observations of the chunk, in the reconstructed views
+    Mat2X x(2, nbObservations);
+    std::vector<std::size_t> cameraIndexes;
+    std::vector<std::size_t> offsets;
+    cameraIndexes.reserve(nbObservations);
+    offsets.reserve(end - begin + 1);
+
+    for(std::size_t i = begin; i < end; ++i)
     {
-      if (_bConsoleVerbose)
+      offsets.push_back(cameraIndexes.size());
+      for(const auto& itObs : landmarks[i]->second.observations)
       {
-        #pragma omp critical
-        ++(*my_progress_bar);
-      }
-      // Triangulate each landmark
-      multiview::Triangulation trianObj;
-      const sfmData::Observations & observations = iterTracks->second.observations;
-      for(const auto& itObs : observations)
-      {
-        const sfmData::View * view = sfmData.views.at(itObs.first).get();
-        if (sfmData.isPoseAndIntrinsicDefined(view))
-        {
-          std::shared_ptr<IntrinsicBase> cam = sfmData.getIntrinsics().at(view->getIntrinsicId());
-          std::shared_ptr<camera::Pinhole> pinHoleCam = std::dynamic_pointer_cast<camera::Pinhole>(cam);
-          if (!pinHoleCam) {
-            ALICEVISION_LOG_ERROR("Camera is not pinhole in triangulate");
-            continue;
-          }
-
-          const Pose3 pose = sfmData.getPose(*view).getTransform();
-          trianObj.add(
-            pinHoleCam->getProjectiveEquivalent(pose),
-            cam->get_ud_pixel(itObs.second.x));
-        }
-      }
-      if (trianObj.size() < 2)
-      {
-        #pragma omp critical
-        {
-          rejectedId.push_front(iterTracks->first);
-        }
+        const auto cameraIt = cameraIndexPerView.find(itObs.first);
+        if(cameraIt == cameraIndexPerView.end())
+          continue;
+
+        x.col(cameraIndexes.size()) = intrinsics[cameraIt->second]->get_ud_pixel(itObs.second.x);
+        cameraIndexes.push_back(cameraIt->second);
       }
+    }
+    offsets.push_back(cameraIndexes.size());
+
+    Mat3X X;
+    Vec minDepths;
+    multiview::TriangulateNViewsBatch(Ps, x.leftCols(cameraIndexes.size()), cameraIndexes, offsets, X, minDepths);
+
+    std::vector<IndexT>& rejectedIds = rejectedIdsPerThread[omp_get_thread_num()];
+    for(std::size_t i = begin; i < end; ++i)
+    {
+      // Keep the point only if it have a positive depth
+      if(minDepths(i - begin) > 0)
+        landmarks[i]->second.X = X.col(i - begin);
       else
-      {
-        // Compute the 3D point
-        const Vec3 X = trianObj.compute();
-        if (trianObj.minDepth() > 0) // Keep the point only if it have a positive depth
-        {
-          iterTracks->second.X = X;
-        }
-        else
-        {
-          #pragma omp critical
-          {
-            rejectedId.push_front(iterTracks->first);
-          }
-        }
-      }
+        rejectedIds.push_back(landmarks[i]->first);
+    }
+
+    if (_bConsoleVerbose)
+    {
+      #pragma omp critical
+      (*my_progress_bar) += end - begin;
     }
   }
+
   // Erase the unsuccessful triangulated tracks
-  for (auto& it : rejectedId)
+  for(const std::vector<IndexT>& rejectedIds : rejectedIdsPerThread)
   {
-    sfmData.structure.erase(it);
+    for(const IndexT landmarkId : rejectedIds)
+      sfmData.structure.erase(landmarkId);
   }
 }
 
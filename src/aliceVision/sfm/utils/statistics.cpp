@@ -14,30 +14,73 @@ namespace sfm {
 double RMSE(const sfmData::SfMData& sfmData)
 {
   // Compute residuals for each observation
-  std::vector<double> vec;
-  for(sfmData::Landmarks::const_iterator iterTracks = sfmData.getLandmarks().begin();
-      iterTracks != sfmData.getLandmarks().end();
-      ++iterTracks)
+  std::map<IndexT, ViewResiduals> residualsPerView;
+  computeViewsResiduals(sfmData, residualsPerView);
+
+  double squaredNorm = 0.0;
+  std::size_t nbResiduals = 0;
+  for(const auto& viewResiduals : residualsPerView)
   {
-    const sfmData::Observations& obs = iterTracks->second.observations;
-    for(sfmData::Observations::const_iterator itObs = obs.begin();
-      itObs != obs.end(); ++itObs)
-    {
-      const sfmData::View* view = sfmData.getViews().find(itObs->first)->second.get();
-      const geometry::Pose3 pose = sfmData.getPose(*view).getTransform();
-      const std::shared_ptr<camera::IntrinsicBase> intrinsic = sfmData.getIntrinsics().at(view->getIntrinsicId());
-      const Vec2 residual = intrinsic->residual(pose, iterTracks->second.X.homogeneous(), itObs->second.x);
-      vec.push_back(residual(0));
-      vec.push_back(residual(1));
-    }
+    squaredNorm += viewResiduals.second.residuals.squaredNorm();
+    nbResiduals += 2 * viewResiduals.second.residuals.cols();
   }
-  if(vec.empty())
+  if(nbResiduals == 0)
     return -1.0;
-  const Eigen::Map<Eigen::RowVectorXd> residuals(&vec[0], vec.size());
-  const double RMSE = std::sqrt(residuals.squaredNorm() / vec.size());
+  const double RMSE = std::sqrt(squaredNorm / nbResiduals);
   return RMSE;
 }
 
+void computeViewsResiduals(const sfmData::SfMData& sfmData,
+                           std::map<IndexT, ViewResiduals>& residualsPerView,
+                           const std::set<IndexT>& specificViews)
+{
+  residualsPerView.clear();
+
+  // group the observations by view
+  std::map<IndexT, std::vector<const sfmData::Landmarks::value_type*>> landmarksPerView;
+  for(const auto& landmark : sfmData.getLandmarks())
+  {
+    for(const auto& obs : landmark.second.observations)
+    {
+      if(!specificViews.empty() && specificViews.count(obs.first) == 0)
+        continue;
+      landmarksPerView[obs.first].push_back(&landmark);
+    }
+  }
+
+  std::vector<IndexT> viewIds;
+  viewIds.reserve(landmarksPerView.size());
+  for(const auto& viewLandmarks : landmarksPerView)
+  {
+    viewIds.push_back(viewLandmarks.first);
+    residualsPerView[viewLandmarks.first]; // pre-allocate the entry, the map is not modified in the parallel loop
+  }
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < (int)viewIds.size(); ++i)
+  {
+    const IndexT viewId = viewIds[i];
+    const std::vector<const sfmData::Landmarks::value_type*>& landmarks = landmarksPerView.at(viewId);
+    ViewResiduals& viewResiduals = residualsPerView.at(viewId);
+
+    const sfmData::View& view = sfmData.getView(viewId);
+    const geometry::Pose3 pose = sfmData.getPose(view).getTransform();
+    const camera::IntrinsicBase* intrinsic = sfmData.getIntrinsics().at(view.getIntrinsicId()).get();
+
+    Mat3X X(3, landmarks.size());
+    Mat2X x(2, landmarks.size());
+    viewResiduals.landmarkIds.resize(landmarks.size());
+    for(std::size_t j = 0; j < landmarks.size(); ++j)
+    {
+      viewResiduals.landmarkIds[j] = landmarks[j]->first;
+      X.col(j) = landmarks[j]->second.X;
+      x.col(j) = landmarks[j]->second.observations.at(viewId).x;
+    }
+
+    viewResiduals.residuals = intrinsic->residuals(pose, X, x);
+  }
+}
+
 } // namespace sfm
 } // namespace aliceVision
 
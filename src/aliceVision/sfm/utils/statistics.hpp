@@ -7,6 +7,13 @@
 
 #pragma once
 
+#include <aliceVision/types.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <map>
+#include <set>
+#include <vector>
+
 namespace aliceVision {
 
 namespace sfmData {
@@ -22,5 +29,27 @@ namespace sfm {
  */
 double RMSE(const sfmData::SfMData& sfmData);
 
+/**
+ * @brief Reprojection residuals of the observations of a single view
+ */
+struct ViewResiduals
+{
+  /// landmark id of each observation
+  std::vector<IndexT> landmarkIds;
+  /// residual of each observation (one per column, same order as landmarkIds)
+  Mat2X residuals;
+};
+
+/**
+ * @brief Compute the reprojection residuals of all the observations, grouped by view.
+ *        The landmarks of a view are projected in a single batch call to its intrinsic.
+ * @param[in] sfmData The given input SfMData
+ * @param[out] residualsPerView The residuals of each view with observations
+ * @param[in] specificViews If not empty, only compute the residuals of these views
+ */
+void computeViewsResiduals(const sfmData::SfMData& sfmData,
+                           std::map<IndexT, ViewResiduals>& residualsPerView,
+                           const std::set<IndexT>& specificViews = std::set<IndexT>());
+
 } // namespace sfm
 } // namespace aliceVision
@@ -8,11 +8,17 @@
 #include <aliceVision/camera/camera.hpp>
 #include <aliceVision/sfmDataIO/viewIO.hpp>
 
-#include <boost/property_tree/json_parser.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
+#include <algorithm>
+#include <fstream>
 #include <memory>
 #include <cassert>
 
+namespace fs = boost::filesystem;
+
 namespace aliceVision {
 namespace sfmDataIO {
 
@@ -367,6 +373,110 @@ void loadLandmark(IndexT& landmarkId, sfmData::Landmark& landmark, bpt::ptree& l
 }
 
 
+void saveLandmark(IndexT landmarkId, const sfmData::Landmark& landmark, JsonStreamWriter& writer, bool saveObservations, bool saveFeatures)
+{
+  writer.beginObject();
+
+  writer.add("landmarkId", landmarkId);
+  writer.add("descType", feature::EImageDescriberType_enumToString(landmark.descType));
+
+  writer.addMatrix("color", landmark.rgb);
+  writer.addMatrix("X", landmark.X);
+
+  // observations
+  if(saveObservations)
+  {
+    writer.beginArray("observations");
+    for(const auto& obsPair : landmark.observations)
+    {
+      const sfmData::Observation& observation = obsPair.second;
+
+      writer.beginObject();
+      writer.add("observationId", obsPair.first);
+
+      // features
+      if(saveFeatures)
+      {
+        writer.add("featureId", observation.id_feat);
+        writer.addMatrix("x", observation.x);
+        writer.add("scale", observation.scale);
+      }
+
+      writer.endObject();
+    }
+    writer.endArray();
+  }
+
+  writer.endObject();
+}
+
+void loadLandmark(IndexT& landmarkId, sfmData::Landmark& landmark, JsonStreamReader& reader, bool loadObservations, bool loadFeatures)
+{
+  bool hasLandmarkId = false;
+  bool hasDescType = false;
+  std::string key;
+
+  reader.beginObject();
+  while(reader.nextMember(key))
+  {
+    if(key == "landmarkId")
+    {
+      landmarkId = reader.read<IndexT>();
+      hasLandmarkId = true;
+    }
+    else if(key == "descType")
+    {
+      landmark.descType = feature::EImageDescriberType_stringToEnum(reader.readValue());
+      hasDescType = true;
+    }
+    else if(key == "color")
+    {
+      reader.readMatrix(landmark.rgb);
+    }
+    else if(key == "X")
+    {
+      reader.readMatrix(landmark.X);
+    }
+    else if(key == "observations" && loadObservations && reader.isContainer())
+    {
+      reader.beginArray();
+      while(reader.nextElement())
+      {
+        IndexT observationId = UndefinedIndexT;
+        sfmData::Observation observation;
+        std::string obsKey;
+
+        reader.beginObject();
+        while(reader.nextMember(obsKey))
+        {
+          if(obsKey == "observationId")
+            observationId = reader.read<IndexT>();
+          else if(loadFeatures && obsKey == "featureId")
+            observation.id_feat = reader.read<IndexT>();
+          else if(loadFeatures && obsKey == "x")
+            reader.readMatrix(observation.x);
+          else if(loadFeatures && obsKey == "scale")
+            observation.scale = reader.read<double>();
+          else
+            reader.skipValue();
+        }
+
+        if(observationId == UndefinedIndexT)
+          throw std::runtime_error("Invalid landmark observation: missing observationId.");
+
+        landmark.observations.emplace(observationId, observation);
+      }
+    }
+    else
+    {
+      reader.skipValue();
+    }
+  }
+
+  if(!hasLandmarkId || !hasDescType)
+    throw std::runtime_error("Invalid landmark: missing landmarkId or descType.");
+}
+
 bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
 {
   const Vec3i version = {ALICEVISION_SFMDATAIO_VERSION_MAJOR, ALICEVISION_SFMDATAIO_VERSION_MINOR, ALICEVISION_SFMDATAIO_VERSION_REVISION};
@@ -380,61 +490,73 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
   const bool saveFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
   const bool saveObservations = saveFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
 
-  // main tree
-  bpt::ptree fileTree;
+  std::ofstream stream(filename);
+  if(!stream.is_open())
+    throw std::runtime_error("Cannot open JSON file: " + filename);
+
+  // the buffer is flushed to the file after each section
+  std::string buffer;
+  JsonStreamWriter writer(buffer);
+
+  const auto flush = [&]()
+  {
+    stream.write(buffer.data(), buffer.size());
+    buffer.clear();
+  };
+
+  // small elements are converted with the property tree functions, one element at a time
+  const auto addElementTree = [&writer](const bpt::ptree& parentTree)
+  {
+    writer.addTree("", parentTree.back().second);
+  };
+
+  writer.beginObject();
 
   // file version
-  saveMatrix("version", version, fileTree);
+  writer.addMatrix("version", version);
 
   // folders
   if(!sfmData.getRelativeFeaturesFolders().empty())
   {
-    bpt::ptree featureFoldersTree;
-
+    writer.beginArray("featuresFolders");
     for(const std::string& featuresFolder : sfmData.getRelativeFeaturesFolders())
-    {
-      bpt::ptree featureFolderTree;
-      featureFolderTree.put("", featuresFolder);
-      featureFoldersTree.push_back(std::make_pair("", featureFolderTree));
-    }
-
-    fileTree.add_child("featuresFolders", featureFoldersTree);
+      writer.add("", featuresFolder);
+    writer.endArray();
   }
 
   if(!sfmData.getRelativeMatchesFolders().empty())
   {
-    bpt::ptree matchingFoldersTree;
-
+    writer.beginArray("matchesFolders");
     for(const std::string& matchesFolder : sfmData.getRelativeMatchesFolders())
-    {
-      bpt::ptree matchingFolderTree;
-      matchingFolderTree.put("", matchesFolder);
-      matchingFoldersTree.push_back(std::make_pair("", matchingFolderTree));
-    }
-
-    fileTree.add_child("matchesFolders", matchingFoldersTree);
+      writer.add("", matchesFolder);
+    writer.endArray();
   }
 
   // views
   if(saveViews && !sfmData.getViews().empty())
   {
-    bpt::ptree viewsTree;
-
+    writer.beginArray("views");
     for(const auto& viewPair : sfmData.getViews())
+    {
+      bpt::ptree viewsTree;
       saveView("", *(viewPair.second), viewsTree);
-
-    fileTree.add_child("views", viewsTree);
+      addElementTree(viewsTree);
+    }
+    writer.endArray();
+    flush();
   }
 
   // intrinsics
   if(saveIntrinsics && !sfmData.getIntrinsics().empty())
   {
-    bpt::ptree intrinsicsTree;
-
+    writer.beginArray("intrinsics");
     for(const auto& intrinsicPair : sfmData.getIntrinsics())
+    {
+      bpt::ptree intrinsicsTree;
       saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, intrinsicsTree);
-
-    fileTree.add_child("intrinsics", intrinsicsTree);
+      addElementTree(intrinsicsTree);
+    }
+    writer.endArray();
   }
 
   //extrinsics
@@ -443,64 +565,176 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
     // poses
     if(!sfmData.getPoses().empty())
     {
-      bpt::ptree posesTree;
-
+      writer.beginArray("poses");
       for(const auto& posePair : sfmData.getPoses())
       {
         bpt::ptree poseTree;
 
         poseTree.put("poseId", posePair.first);
         saveCameraPose("pose", posePair.second, poseTree);
-        posesTree.push_back(std::make_pair("", poseTree));
+        writer.addTree("", poseTree);
       }
-
-      fileTree.add_child("poses", posesTree);
+      writer.endArray();
+      flush();
     }
 
     // rigs
     if(!sfmData.getRigs().empty())
     {
-      bpt::ptree rigsTree;
-
+      writer.beginArray("rigs");
       for(const auto& rigPair : sfmData.getRigs())
+      {
+        bpt::ptree rigsTree;
         saveRig("", rigPair.first, rigPair.second, rigsTree);
-
-      fileTree.add_child("rigs", rigsTree);
+        addElementTree(rigsTree);
+      }
+      writer.endArray();
     }
   }
 
   // structure
   if(saveStructure && !sfmData.getLandmarks().empty())
   {
-    bpt::ptree structureTree;
-
+    std::vector<const sfmData::Landmarks::value_type*> landmarks;
+    landmarks.reserve(sfmData.getLandmarks().size());
     for(const auto& structurePair : sfmData.getLandmarks())
-      saveLandmark("", structurePair.first, structurePair.second, structureTree, saveObservations, saveFeatures);
+      landmarks.push_back(&structurePair);
+
+    writer.beginArray("structure");
+
+    // landmarks are formatted in parallel by batches, then written in order
+    const int landmarkDepth = writer.childDepth();
+    const std::size_t batchSize = 10000;
+    std::vector<std::string> formattedLandmarks(std::min(batchSize, landmarks.size()));
+    std::string errorMessage;
+
+    for(std::size_t batchStart = 0; batchStart < landmarks.size(); batchStart += batchSize)
+    {
+      const int batchCount = static_cast<int>(std::min(batchSize, landmarks.size() - batchStart));
+
+      #pragma omp parallel for
+      for(int i = 0; i < batchCount; ++i)
+      {
+        const sfmData::Landmarks::value_type& structurePair = *landmarks.at(batchStart + i);
+        std::string& formattedLandmark = formattedLandmarks.at(i);
+
+        formattedLandmark.clear();
+        try
+        {
+          JsonStreamWriter landmarkWriter(formattedLandmark, landmarkDepth);
+          saveLandmark(structurePair.first, structurePair.second, landmarkWriter, saveObservations, saveFeatures);
+        }
+        catch(const std::exception& e)
+        {
+          #pragma omp critical
+          errorMessage = e.what();
+        }
+      }
+
+      if(!errorMessage.empty())
+        throw std::runtime_error(errorMessage);
 
-    fileTree.add_child("structure", structureTree);
+      for(int i = 0; i < batchCount; ++i)
+        writer.addFormatted("", formattedLandmarks.at(i));
+
+      flush();
+    }
+
+    writer.endArray();
   }
 
   // control points
   if(saveControlPoints && !sfmData.getControlPoints().empty())
   {
-    bpt::ptree controlPointTree;
-
+    writer.beginArray("controlPoints");
     for(const auto& controlPointPair : sfmData.getControlPoints())
+    {
+      bpt::ptree controlPointTree;
       saveLandmark("", controlPointPair.first, controlPointPair.second, controlPointTree);
-
-    fileTree.add_child("controlPoints", controlPointTree);
+      addElementTree(controlPointTree);
+    }
+    writer.endArray();
   }
 
-  // write the json file with the tree
+  writer.endObject();
+  buffer += '\n';
+  flush();
 
-  bpt::write_json(filename, fileTree);
+  if(!stream.good())
+    throw std::runtime_error("Error while writing JSON file: " + filename);
 
   return true;
 }
 
+/**
+ * @brief Call a function for each element of the array at the current position of the reader.
+ * @param[in,out] reader The JSON reader
+ * @param[in] function The function called with the reader positioned on each element
+ */
+template<typename FunctionT>
+void forEachElement(JsonStreamReader& reader, FunctionT function)
+{
+  // empty arrays are written as empty strings
+  if(!reader.isContainer())
+  {
+    reader.skipValue();
+    return;
+  }
+
+  reader.beginArray();
+  while(reader.nextElement())
+    function();
+}
+
+/**
+ * @brief Load the landmarks of the array at the current position of the reader.
+ *        The landmark boundaries are found with a fast scan, then the landmarks are parsed in parallel.
+ * @param[in,out] reader The JSON reader
+ * @param[out] structure The output landmarks
+ * @param[in] loadObservations Load landmark observations
+ * @param[in] loadFeatures Load landmark observations features
+ */
+void loadStructure(JsonStreamReader& reader, sfmData::Landmarks& structure, bool loadObservations, bool loadFeatures)
+{
+  std::vector<std::pair<const char*, const char*>> landmarkSpans;
+
+  forEachElement(reader, [&]()
+  {
+    const char* landmarkBegin = reader.position();
+    reader.skipValue();
+    landmarkSpans.emplace_back(landmarkBegin, reader.position());
+  });
+
+  std::vector<std::pair<IndexT, sfmData::Landmark>> landmarks(landmarkSpans.size());
+  std::string errorMessage;
+
+  #pragma omp parallel for
+  for(int i = 0; i < static_cast<int>(landmarkSpans.size()); ++i)
+  {
+    try
+    {
+      JsonStreamReader landmarkReader(landmarkSpans.at(i).first, landmarkSpans.at(i).second);
+      loadLandmark(landmarks.at(i).first, landmarks.at(i).second, landmarkReader, loadObservations, loadFeatures);
+    }
+    catch(const std::exception& e)
+    {
+      #pragma omp critical
+      errorMessage = e.what();
+    }
+  }
+
+  if(!errorMessage.empty())
+    throw std::runtime_error(errorMessage);
+
+  for(auto& landmarkPair : landmarks)
+    structure.emplace_hint(structure.end(), landmarkPair.first, std::move(landmarkPair.second));
+}
+
 bool loadJSON(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag, bool incompleteViews,
               EViewIdMethod viewIdMethod, const std::string& viewIdRegex)
 {
+  namespace bip = boost::interprocess;
+
   Version version;
 
   // load flags
@@ -512,66 +746,142 @@ bool loadJSON(sfmData::SfMData& sfmData, const std::string& filename, ESfMData p
   const bool loadFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
   const bool loadObservations = loadFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
 
-  // main tree
-  bpt::ptree fileTree;
+  // map the json file in memory
+  if(!fs::exists(filename) || fs::file_size(filename) == 0)
+    throw std::runtime_error("Cannot open JSON file: " + filename);
+
+  bip::file_mapping mapping(filename.c_str(), bip::read_only);
+  bip::mapped_region region(mapping, bip::read_only);
 
-  // read the json file and initialize the tree
-  bpt::read_json(filename, fileTree);
+  const char* data = static_cast<const char*>(region.get_address());
+  JsonStreamReader reader(data, data + region.get_size());
 
-  // version
+  // intrinsics and views are loaded once the whole file has been read,
+  // since they depend on the file version and on each other
+  std::vector<bpt::ptree> intrinsicTrees;
+  std::vector<sfmData::View> loadedViews;
+
+  std::string key;
+  reader.beginObject();
+  while(reader.nextMember(key))
   {
-    Vec3i v;
-    loadMatrix("version", v, fileTree);
-    version = v;
-  }
+    if(key == "version")
+    {
+      Vec3i v;
+      reader.readMatrix(v);
+      version = Version(v);
+    }
+    else if(key == "featuresFolders")
+    {
+      forEachElement(reader, [&]() { sfmData.addFeaturesFolder(reader.readValue()); });
+    }
+    else if(key == "matchesFolders")
+    {
+      forEachElement(reader, [&]() { sfmData.addMatchesFolder(reader.readValue()); });
+    }
+    else if(key == "intrinsics" && loadIntrinsics)
+    {
+      forEachElement(reader, [&]()
+      {
+        intrinsicTrees.emplace_back();
+        reader.readTree(intrinsicTrees.back());
+      });
+    }
+    else if(key == "views" && loadViews)
+    {
+      forEachElement(reader, [&]()
+      {
+        bpt::ptree viewTree;
+        reader.readTree(viewTree);
+        loadedViews.emplace_back();
+        loadView(loadedViews.back(), viewTree);
+      });
+    }
+    else if(key == "poses" && loadExtrinsics)
+    {
+      sfmData::Poses& poses = sfmData.getPoses();
 
-  // folders
-  if(fileTree.count("featuresFolders"))
-    for(bpt::ptree::value_type& featureFolderNode : fileTree.get_child("featuresFolders"))
-      sfmData.addFeaturesFolder(featureFolderNode.second.get_value<std::string>());
+      forEachElement(reader, [&]()
+      {
+        bpt::ptree poseTree;
+        reader.readTree(poseTree);
+
+        sfmData::CameraPose pose;
+        loadCameraPose("pose", pose, poseTree);
+
+        poses.emplace(poseTree.get<IndexT>("poseId"), pose);
+      });
+    }
+    else if(key == "rigs" && loadExtrinsics)
+    {
+      sfmData::Rigs& rigs = sfmData.getRigs();
+
+      forEachElement(reader, [&]()
+      {
+        bpt::ptree rigTree;
+        reader.readTree(rigTree);
+
+        IndexT rigId;
+        sfmData::Rig rig;
+        loadRig(rigId, rig, rigTree);
+
+        rigs.emplace(rigId, rig);
+      });
+    }
+    else if(key == "structure" && loadStructure)
+    {
+      sfmDataIO::loadStructure(reader, sfmData.getLandmarks(), loadObservations, loadFeatures);
+    }
+    else if(key == "controlPoints" && loadControlPoints)
+    {
+      sfmData::Landmarks& controlPoints = sfmData.getControlPoints();
 
-  if(fileTree.count("matchesFolders"))
-    for(bpt::ptree::value_type& matchingFolderNode : fileTree.get_child("matchesFolders"))
-      sfmData.addMatchesFolder(matchingFolderNode.second.get_value<std::string>());
+      forEachElement(reader, [&]()
+      {
+        bpt::ptree landmarkTree;
+        reader.readTree(landmarkTree);
+
+        IndexT landmarkId;
+        sfmData::Landmark landmark;
+        loadLandmark(landmarkId, landmark, landmarkTree);
+
+        controlPoints.emplace(landmarkId, landmark);
+      });
+    }
+    else
+    {
+      reader.skipValue();
+    }
+  }
 
   // intrinsics
-  if(loadIntrinsics && fileTree.count("intrinsics"))
+  if(loadIntrinsics)
   {
     sfmData::Intrinsics& intrinsics = sfmData.getIntrinsics();
 
-    for(bpt::ptree::value_type &intrinsicNode : fileTree.get_child("intrinsics"))
+    for(bpt::ptree& intrinsicTree : intrinsicTrees)
     {
       IndexT intrinsicId;
       std::shared_ptr<camera::IntrinsicBase> intrinsic;
 
-      loadIntrinsic(version, intrinsicId, intrinsic, intrinsicNode.second);
+      loadIntrinsic(version, intrinsicId, intrinsic, intrinsicTree);
 
       intrinsics.emplace(intrinsicId, intrinsic);
     }
   }
 
   // views
-  if(loadViews && fileTree.count("views"))
+  if(loadViews)
   {
     sfmData::Views& views = sfmData.getViews();
 
     if(incompleteViews)
     {
-      // store incomplete views in a vector
-      std::vector<sfmData::View> incompleteViews(fileTree.get_child("views").size());
-
-      int viewIndex = 0;
-      for(bpt::ptree::value_type &viewNode : fileTree.get_child("views"))
-      {
-        loadView(incompleteViews.at(viewIndex), viewNode.second);
-        ++viewIndex;
-      }
-
       // update incomplete views
       #pragma omp parallel for
-      for(int i = 0; i < incompleteViews.size(); ++i)
+      for(int i = 0; i < loadedViews.size(); ++i)
       {
-        sfmData::View& v = incompleteViews.at(i);
+        sfmData::View& v = loadedViews.at(i);
 
         // if we have the intrinsics and the view has an valid associated intrinsics
         // update the width and height field of View (they are mirrored)
@@ -590,91 +900,13 @@ bool loadJSON(sfmData::SfMData& sfmData, const std::string& filename, ESfMData p
           v.setWidth(intrinsics->w());
           v.setHeight(intrinsics->h());
         }
-        updateIncompleteView(incompleteViews.at(i), viewIdMethod, viewIdRegex);
-      }
-
-      // copy complete views in the SfMData views map
-      for(const sfmData::View& view : incompleteViews)
-        views.emplace(view.getViewId(), std::make_shared<sfmData::View>(view));
-    }
-    else
-    {
-      // store directly in the SfMData views map
-      for(bpt::ptree::value_type &viewNode : fileTree.get_child("views"))
-      {
-        sfmData::View view;
-        loadView(view, viewNode.second);
-        views.emplace(view.getViewId(), std::make_shared<sfmData::View>(view));
-      }
-    }
-  }
-
-  // extrinsics
-  if(loadExtrinsics)
-  {
-    // poses
-    if(fileTree.count("poses"))
-    {
-      sfmData::Poses& poses = sfmData.getPoses();
-
-      for(bpt::ptree::value_type &poseNode : fileTree.get_child("poses"))
-      {
-        bpt::ptree& poseTree = poseNode.second;
-        sfmData::CameraPose pose;
-
-        loadCameraPose("pose", pose, poseTree);
-
-        poses.emplace(poseTree.get<IndexT>("poseId"), pose);
-      }
-    }
-
-    // rigs
-    if(fileTree.count("rigs"))
-    {
-      sfmData::Rigs& rigs = sfmData.getRigs();
-
-      for(bpt::ptree::value_type &rigNode : fileTree.get_child("rigs"))
-      {
-        IndexT rigId;
-        sfmData::Rig rig;
-
-        loadRig(rigId, rig, rigNode.second);
-
-        rigs.emplace(rigId, rig);
+        updateIncompleteView(loadedViews.at(i), viewIdMethod, viewIdRegex);
       }
     }
-  }
-
-  // structure
-  if(loadStructure && fileTree.count("structure"))
-  {
-    sfmData::Landmarks& structure = sfmData.getLandmarks();
-
-    for(bpt::ptree::value_type &landmarkNode : fileTree.get_child("structure"))
-    {
-      IndexT landmarkId;
-      sfmData::Landmark landmark;
-
-      loadLandmark(landmarkId, landmark, landmarkNode.second, loadObservations, loadFeatures);
-
-      structure.emplace(landmarkId, landmark);
-    }
-  }
 
-  // control points
-  if(loadControlPoints && fileTree.count("controlPoints"))
-  {
-    sfmData::Landmarks& controlPoints = sfmData.getControlPoints();
-
-    for(bpt::ptree::value_type &landmarkNode : fileTree.get_child("controlPoints"))
-    {
-      IndexT landmarkId;
-      sfmData::Landmark landmark;
-
-      loadLandmark(landmarkId, landmark, landmarkNode.second);
-
-      controlPoints.emplace(landmarkId, landmark);
-    }
+    // copy views in the SfMData views map
+    for(const sfmData::View& view : loadedViews)
+      views.emplace(view.getViewId(), std::make_shared<sfmData::View>(view));
   }
 
   return true;
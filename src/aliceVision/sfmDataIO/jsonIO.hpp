@@ -8,6 +8,7 @@
 
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/sfmDataIO/viewIO.hpp>
+#include <aliceVision/sfmDataIO/jsonStream.hpp>
 
 #include <boost/property_tree/ptree.hpp>
 
@@ -207,7 +208,30 @@ void saveLandmark(const std::string& name, IndexT landmarkId, const sfmData::Lan
 void loadLandmark(IndexT& landmarkId, sfmData::Landmark& landmark, bpt::ptree& landmarkTree, bool loadObservations = true, bool loadFeatures = true);
 
 /**
- * @brief Save an SfMData in a JSON file with a boost property tree.
+ * @brief Save a Landmark with a streaming JSON writer.
+ *        The output is identical to the boost property tree one.
+ * @param[in] landmarkId The landmark Id
+ * @param[in] landmark The landmark
+ * @param[in,out] writer The JSON writer, the landmark is added as an object in its current container
+ * @param[in] saveObservations Save landmark observations
+ * @param[in] saveFeatures Save landmark observations features
+ */
+void saveLandmark(IndexT landmarkId, const sfmData::Landmark& landmark, JsonStreamWriter& writer, bool saveObservations, bool saveFeatures);
+
+/**
+ * @brief Load a Landmark with a streaming JSON reader.
+ * @param[out] landmarkId The output Landmark Id
+ * @param[out] landmark The output Landmmark
+ * @param[in,out] reader The JSON reader, positioned on the landmark object
+ * @param[in] loadObservations Load landmark observations
+ * @param[in] loadFeatures Load landmark observations features
+ */
+void loadLandmark(IndexT& landmarkId, sfmData::Landmark& landmark, JsonStreamReader& reader, bool loadObservations, bool loadFeatures);
+
+/**
+ * @brief Save an SfMData in a JSON file.
+ *        The file is written with a streaming JSON writer (the landmarks are formatted in parallel),
+ *        the output is identical to the one of boost::property_tree::write_json.
  * @param[in] sfmData The input SfMData
  * @param[in] filename The filename
  * @param[in] partFlag The ESfMData save flag
@@ -217,6 +241,8 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
 
 /**
  * @brief Load a JSON SfMData file.
+ *        The file is memory-mapped and read with a streaming JSON reader,
+ *        the landmarks are parsed in parallel.
  * @param[out] sfmData The output SfMData
  * @param[in] filename The filename
  * @param[in] partFlag The ESfMData load flag
@@ -0,0 +1,411 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "jsonStream.hpp"
+
+#include <stdexcept>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+std::string escapeJsonString(const std::string& str)
+{
+  std::string result;
+  result.reserve(str.size());
+
+  for(const char ch : str)
+  {
+    const unsigned char c = static_cast<unsigned char>(ch);
+
+    // same escaping rules as boost::property_tree::json_parser::create_escapes
+    if(c == 0x20 || c == 0x21 || (c >= 0x23 && c <= 0x2E) ||
+       (c >= 0x30 && c <= 0x5B) || (c >= 0x5D))
+      result += ch;
+    else if(ch == '\b') result += "\\b";
+    else if(ch == '\f') result += "\\f";
+    else if(ch == '\n') result += "\\n";
+    else if(ch == '\r') result += "\\r";
+    else if(ch == '\t') result += "\\t";
+    else if(ch == '/')  result += "\\/";
+    else if(ch == '"')  result += "\\\"";
+    else if(ch == '\\') result += "\\\\";
+    else
+    {
+      const char* hexdigits = "0123456789ABCDEF";
+      result += "\\u00";
+      result += hexdigits[c / 16];
+      result += hexdigits[c % 16];
+    }
+  }
+  return result;
+}
+
+void JsonStreamWriter::addValue(const std::string& key, const std::string& value)
+{
+  prepareChild(key);
+  _buffer += '"';
+  _buffer += escapeJsonString(value);
+  _buffer += '"';
+}
+
+void JsonStreamWriter::addTree(const std::string& key, const bpt::ptree& tree)
+{
+  // same rules as boost::property_tree::json_parser::write_json_helper
+  if(tree.empty())
+  {
+    addValue(key, tree.data());
+  }
+  else if(tree.count("") == tree.size())
+  {
+    beginArray(key);
+    for(const auto& child : tree)
+      addTree("", child.second);
+    endArray();
+  }
+  else
+  {
+    beginObject(key);
+    for(const auto& child : tree)
+      addTree(child.first, child.second);
+    endObject();
+  }
+}
+
+void JsonStreamWriter::addFormatted(const std::string& key, const std::string& formatted)
+{
+  prepareChild(key);
+  _buffer += formatted;
+}
+
+void JsonStreamWriter::beginContainer(const std::string& key, bool isArray)
+{
+  int depth = _baseDepth;
+
+  if(!_frames.empty())
+  {
+    prepareChild(key);
+    depth = _frames.back().depth + 1;
+  }
+
+  // the opening character is written with the first child,
+  // since empty containers are written as empty strings
+  _frames.push_back({isArray, depth, 0});
+}
+
+void JsonStreamWriter::endContainer()
+{
+  if(_frames.empty())
+    throw std::logic_error("JsonStreamWriter: no container to close.");
+
+  const Frame frame = _frames.back();
+  _frames.pop_back();
+
+  if(frame.count == 0)
+  {
+    // the document root is always written as an object
+    _buffer += (frame.depth == 0) ? "{\n}" : "\"\"";
+    return;
+  }
+
+  _buffer += '\n';
+  indent(frame.depth);
+  _buffer += frame.isArray ? ']' : '}';
+}
+
+void JsonStreamWriter::prepareChild(const std::string& key)
+{
+  if(_frames.empty())
+    throw std::logic_error("JsonStreamWriter: values must be added in a container.");
+
+  Frame& frame = _frames.back();
+
+  if(frame.count == 0)
+  {
+    _buffer += frame.isArray ? '[' : '{';
+    _buffer += '\n';
+  }
+  else
+  {
+    _buffer += ",\n";
+  }
+
+  ++frame.count;
+  indent(frame.depth + 1);
+
+  if(!frame.isArray)
+  {
+    _buffer += '"';
+    _buffer += escapeJsonString(key);
+    _buffer += "\": ";
+  }
+}
+
+bool JsonStreamReader::nextMember(std::string& key)
+{
+  skipWhitespace();
+  if(_current == _end)
+    throwError("unexpected end of data in object");
+
+  if(*_current == '}')
+  {
+    ++_current;
+    return false;
+  }
+  if(*_current == ',')
+  {
+    ++_current;
+    skipWhitespace();
+  }
+
+  key = readString();
+  expect(':');
+  return true;
+}
+
+bool JsonStreamReader::nextElement()
+{
+  skipWhitespace();
+  if(_current == _end)
+    throwError("unexpected end of data in array");
+
+  if(*_current == ']')
+  {
+    ++_current;
+    return false;
+  }
+  if(*_current == ',')
+  {
+    ++_current;
+    skipWhitespace();
+  }
+  return true;
+}
+
+char JsonStreamReader::peek()
+{
+  skipWhitespace();
+  return (_current == _end) ? 0 : *_current;
+}
+
+std::string JsonStreamReader::readValue()
+{
+  const char c = peek();
+
+  if(c == '"')
+    return readString();
+  if(c == '{' || c == '[')
+    throwError("expected a value");
+
+  // number or literal (true, false, null): keep the raw text
+  const char* begin = _current;
+  while(_current != _end && *_current != ',' && *_current != '}' && *_current != ']' &&
+        *_current != ' ' && *_current != '\n' && *_current != '\r' && *_current != '\t')
+    ++_current;
+
+  if(begin == _current)
+    throwError("expected a value");
+
+  return std::string(begin, _current);
+}
+
+void JsonStreamReader::skipValue()
+{
+  if(!isContainer())
+  {
+    if(peek() == '"')
+      readString();
+    else
+      readValue();
+    return;
+  }
+
+  // skip a whole object or array by counting the brackets
+  int depth = 0;
+  while(_current != _end)
+  {
+    const char c = *_current++;
+
+    if(c == '"')
+    {
+      while(_current != _end && *_current != '"')
+      {
+        if(*_current == '\\')
+          ++_current;
+        if(_current != _end)
+          ++_current;
+      }
+      if(_current == _end)
+        break;
+      ++_current;
+    }
+    else if(c == '{' || c == '[')
+    {
+      ++depth;
+    }
+    else if(c == '}' || c == ']')
+    {
+      if(--depth == 0)
+        return;
+    }
+  }
+  throwError("unexpected end of data");
+}
+
+void JsonStreamReader::readTree(bpt::ptree& tree)
+{
+  const char c = peek();
+
+  if(c == '{')
+  {
+    beginObject();
+    std::string key;
+    while(nextMember(key))
+    {
+      bpt::ptree child;
+      readTree(child);
+      tree.push_back(std::make_pair(key, std::move(child)));
+    }
+  }
+  else if(c == '[')
+  {
+    beginArray();
+    while(nextElement())
+    {
+      bpt::ptree child;
+      readTree(child);
+      tree.push_back(std::make_pair(std::string(), std::move(child)));
+    }
+  }
+  else
+  {
+    tree.put_value(readValue());
+  }
+}
+
+void JsonStreamReader::skipWhitespace()
+{
+  while(_current != _end && (*_current == ' ' || *_current == '\n' || *_current == '\r' || *_current == '\t'))
+    ++_current;
+}
+
+void JsonStreamReader::expect(char c)
+{
+  skipWhitespace();
+  if(_current == _end || *_current != c)
+    throwError(std::string("expected '") + c + "'");
+  ++_current;
+}
+
+std::string JsonStreamReader::readString()
+{
+  expect('"');
+
+  std::string result;
+  const char* begin = _current;
+
+  while(true)
+  {
+    if(_current == _end)
+      throwError("unterminated string");
+
+    const char c = *_current;
+
+    if(c == '"')
+    {
+      result.append(begin, _current);
+      ++_current;
+      return result;
+    }
+
+    if(c != '\\')
+    {
+      ++_current;
+      continue;
+    }
+
+    result.append(begin, _current);
+    ++_current;
+    if(_current == _end)
+      throwError("unterminated string");
+
+    switch(*_current++)
+    {
+      case '"':  result += '"';  break;
+      case '\\': result += '\\'; break;
+      case '/':  result += '/';  break;
+      case 'b':  result += '\b'; break;
+      case 'f':  result += '\f'; break;
+      case 'n':  result += '\n'; break;
+      case 'r':  result += '\r'; break;
+      case 't':  result += '\t'; break;
+      case 'u':
+      {
+        const auto readHex = [this]()
+        {
+          if(_end - _current < 4)
+            throwError("invalid unicode escape");
+          unsigned int codepoint = 0;
+          for(int i = 0; i < 4; ++i)
+          {
+            const char h = *_current++;
+            codepoint <<= 4;
+            if(h >= '0' && h <= '9') codepoint += h - '0';
+            else if(h >= 'a' && h <= 'f') codepoint += h - 'a' + 10;
+            else if(h >= 'A' && h <= 'F') codepoint += h - 'A' + 10;
+            else throwError("invalid unicode escape");
+          }
+          return codepoint;
+        };
+
+        unsigned int codepoint = readHex();
+
+        // surrogate pair
+        if(codepoint >= 0xD800 && codepoint <= 0xDBFF && _end - _current >= 2 && _current[0] == '\\' && _current[1] == 'u')
+        {
+          _current += 2;
+          const unsigned int low = readHex();
+          codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+        }
+
+        // encode in UTF-8
+        if(codepoint < 0x80)
+        {
+          result += static_cast<char>(codepoint);
+        }
+        else if(codepoint < 0x800)
+        {
+          result += static_cast<char>(0xC0 | (codepoint >> 6));
+          result += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+        else if(codepoint < 0x10000)
+        {
+          result += static_cast<char>(0xE0 | (codepoint >> 12));
+          result += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+          result += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+        else
+        {
+          result += static_cast<char>(0xF0 | (codepoint >> 18));
+          result += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+          result += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+          result += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+        break;
+      }
+      default:
+        throwError("invalid escape sequence");
+    }
+    begin = _current;
+  }
+}
+
+void JsonStreamReader::throwError(const std::string& message) const
+{
+  throw std::runtime_error("Invalid JSON data (offset " + std::to_string(_current - _begin) + "): " + message + ".");
+}
+
+} // namespace sfmDataIO
+} // namespace aliceVision
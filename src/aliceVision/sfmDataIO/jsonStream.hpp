@@ -0,0 +1,263 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+namespace bpt = boost::property_tree;
+
+/**
+ * @brief Escape a string the same way the boost property tree JSON writer does.
+ * @param[in] str The input string
+ * @return the escaped string (without quotes)
+ */
+std::string escapeJsonString(const std::string& str);
+
+/**
+ * @brief Convert a value to its JSON string representation.
+ *        The formatting is the same as the boost property tree one (all values are stored as strings).
+ */
+inline std::string toJsonValue(const std::string& value) { return value; }
+inline std::string toJsonValue(const char* value) { return value; }
+inline std::string toJsonValue(bool value) { return value ? "true" : "false"; }
+
+template<typename T>
+inline typename std::enable_if<std::is_integral<T>::value, std::string>::type toJsonValue(T value)
+{
+  return std::to_string(value);
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, std::string>::type toJsonValue(T value)
+{
+  // same as an std::ostream with a max_digits10 precision
+  char buffer[64];
+  std::snprintf(buffer, sizeof(buffer), "%.*g", std::numeric_limits<T>::max_digits10, static_cast<double>(value));
+  return buffer;
+}
+
+/**
+ * @brief Convert a JSON string value to the given type.
+ *        Throws std::runtime_error if the value cannot be converted.
+ */
+template<typename T>
+inline typename std::enable_if<std::is_same<T, std::string>::value, T>::type fromJsonValue(const std::string& value)
+{
+  return value;
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_same<T, bool>::value, T>::type fromJsonValue(const std::string& value)
+{
+  if(value == "true" || value == "1")
+    return true;
+  if(value == "false" || value == "0")
+    return false;
+  throw std::runtime_error("Invalid JSON boolean value: '" + value + "'.");
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, T>::type fromJsonValue(const std::string& value)
+{
+  char* end = nullptr;
+  const T result = std::is_signed<T>::value ? static_cast<T>(std::strtoll(value.c_str(), &end, 10))
+                                            : static_cast<T>(std::strtoull(value.c_str(), &end, 10));
+  if(value.empty() || *end != '\0')
+    throw std::runtime_error("Invalid JSON integer value: '" + value + "'.");
+  return result;
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, T>::type fromJsonValue(const std::string& value)
+{
+  char* end = nullptr;
+  const T result = static_cast<T>(std::strtod(value.c_str(), &end));
+  if(value.empty() || *end != '\0')
+    throw std::runtime_error("Invalid JSON floating point value: '" + value + "'.");
+  return result;
+}
+
+/**
+ * @brief SAX-style JSON writer.
+ *
+ * The output is written in a string buffer, without building any DOM, and
+ * is byte-identical to boost::property_tree::write_json with pretty printing:
+ * all values are quoted strings and empty objects/arrays are written as "".
+ * The caller is responsible for flushing the buffer to its final destination.
+ */
+class JsonStreamWriter
+{
+public:
+  /**
+   * @param[out] buffer The output buffer (data is appended)
+   * @param[in] depth The depth of the root value written by this writer in the whole document
+   */
+  explicit JsonStreamWriter(std::string& buffer, int depth = 0)
+    : _buffer(buffer)
+    , _baseDepth(depth)
+  {}
+
+  /// Begin an object (the key is ignored inside arrays and for the root value)
+  void beginObject(const std::string& key = "") { beginContainer(key, false); }
+  void endObject() { endContainer(); }
+
+  /// Begin an array (the key is ignored inside arrays and for the root value)
+  void beginArray(const std::string& key = "") { beginContainer(key, true); }
+  void endArray() { endContainer(); }
+
+  /// Add a value in the current container
+  template<typename T>
+  void add(const std::string& key, const T& value)
+  {
+    addValue(key, toJsonValue(value));
+  }
+
+  /// Add an Eigen Matrix (or Vector) as an array of values, as saveMatrix does
+  template<typename Derived>
+  void addMatrix(const std::string& key, const Eigen::MatrixBase<Derived>& matrix)
+  {
+    beginArray(key);
+    const int size = matrix.size();
+    for(int i = 0; i < size; ++i)
+      addValue("", toJsonValue(matrix(i)));
+    endArray();
+  }
+
+  /// Add a string value in the current container
+  void addValue(const std::string& key, const std::string& value);
+
+  /// Add a boost property tree in the current container
+  void addTree(const std::string& key, const bpt::ptree& tree);
+
+  /// Add a value already formatted by a JsonStreamWriter created with depth childDepth()
+  void addFormatted(const std::string& key, const std::string& formatted);
+
+  /// Depth of the values added in the current container
+  int childDepth() const { return _frames.empty() ? _baseDepth : _frames.back().depth + 1; }
+
+private:
+  struct Frame
+  {
+    bool isArray;
+    int depth;
+    std::size_t count;
+  };
+
+  void beginContainer(const std::string& key, bool isArray);
+  void endContainer();
+  void prepareChild(const std::string& key);
+  void indent(int depth) { _buffer.append(4 * depth, ' '); }
+
+  std::string& _buffer;
+  const int _baseDepth;
+  std::vector<Frame> _frames;
+};
+
+/**
+ * @brief SAX-style JSON reader working on an in-memory buffer.
+ *
+ * Values are read one by one, without building any DOM.
+ * Numbers and literals (true, false, null) are returned as their raw text.
+ * Throws std::runtime_error on malformed input.
+ */
+class JsonStreamReader
+{
+public:
+  JsonStreamReader(const char* begin, const char* end)
+    : _begin(begin)
+    , _current(begin)
+    , _end(end)
+  {}
+
+  /// Consume the opening brace of an object
+  void beginObject() { expect('{'); }
+
+  /**
+   * @brief Move to the next member of the current object.
+   * @param[out] key The member key
+   * @return false if the end of the object has been reached
+   */
+  bool nextMember(std::string& key);
+
+  /// Consume the opening bracket of an array
+  void beginArray() { expect('['); }
+
+  /**
+   * @brief Move to the next element of the current array.
+   * @return false if the end of the array has been reached
+   */
+  bool nextElement();
+
+  /// Next non-whitespace character (0 at the end of the buffer)
+  char peek();
+
+  /// @return true if the next value is an object or an array
+  bool isContainer() { const char c = peek(); return c == '{' || c == '['; }
+
+  /// Read a string (unescaped) or a literal value
+  std::string readValue();
+
+  /// Skip the next value (including objects and arrays)
+  void skipValue();
+
+  /// Read the next value and convert it to the given type
+  template<typename T>
+  T read() { return fromJsonValue<T>(readValue()); }
+
+  /// Read an Eigen Matrix (or Vector) stored as an array of values, as loadMatrix does
+  template<typename Derived>
+  void readMatrix(Eigen::MatrixBase<Derived>& matrix)
+  {
+    // empty arrays are written as empty strings
+    if(!isContainer())
+    {
+      readValue();
+      return;
+    }
+
+    beginArray();
+    int i = 0;
+    while(nextElement())
+    {
+      if(i >= matrix.size())
+        throwError("too many values for the matrix / vector type");
+      matrix(i++) = read<typename Derived::Scalar>();
+    }
+  }
+
+  /// Read the next value in a boost property tree, as boost::property_tree::read_json does
+  void readTree(bpt::ptree& tree);
+
+  /// Current position in the buffer
+  const char* position() const { return _current; }
+
+private:
+  void skipWhitespace();
+  void expect(char c);
+  std::string readString();
+  [[noreturn]] void throwError(const std::string& message) const;
+
+  const char* _begin;
+  const char* _current;
+  const char* _end;
+};
+
+} // namespace sfmDataIO
+} // namespace aliceVision
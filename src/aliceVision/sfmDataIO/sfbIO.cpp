@@ -0,0 +1,799 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "sfbIO.hpp"
+#include <aliceVision/camera/camera.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+namespace {
+
+using LandmarkPtrs = std::vector<const sfmData::Landmarks::value_type*>;
+
+/// size in bytes of a landmark record: id, nb observations, describer type index, color, position
+constexpr std::size_t landmarkRecordSize = 2 * sizeof(std::uint32_t) + 4 * sizeof(std::uint8_t) + 3 * sizeof(double);
+
+/// size in bytes of an observation record
+std::size_t observationRecordSize(bool withFeatures)
+{
+  return withFeatures ? 2 * sizeof(std::uint32_t) + 3 * sizeof(double) : sizeof(std::uint32_t);
+}
+
+/**
+ * @brief Buffered binary writer on an output file stream.
+ */
+class SfbStreamWriter
+{
+public:
+  explicit SfbStreamWriter(std::ofstream& stream)
+    : _stream(stream)
+  {}
+
+  template<typename T>
+  void write(const T& value)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written.");
+    _buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    if(_buffer.size() >= _bufferSize)
+      flush();
+  }
+
+  void writeString(const std::string& str)
+  {
+    write(static_cast<std::uint32_t>(str.size()));
+    _buffer.append(str);
+  }
+
+  template<typename Derived>
+  void writeMatrix(const Eigen::MatrixBase<Derived>& matrix)
+  {
+    for(int i = 0; i < matrix.size(); ++i)
+      write(static_cast<double>(matrix(i)));
+  }
+
+  void flush()
+  {
+    _stream.write(_buffer.data(), _buffer.size());
+    _buffer.clear();
+  }
+
+  std::uint64_t position()
+  {
+    flush();
+    return static_cast<std::uint64_t>(_stream.tellp());
+  }
+
+private:
+  static constexpr std::size_t _bufferSize = 1 << 20;
+  std::ofstream& _stream;
+  std::string _buffer;
+};
+
+/**
+ * @brief Binary reader on a memory buffer (typically a section of a mapped file).
+ *        Throws std::runtime_error when reading past the end of the buffer.
+ */
+class SfbReader
+{
+public:
+  SfbReader(const char* begin, const char* end)
+    : _current(begin)
+    , _end(end)
+  {}
+
+  template<typename T>
+  T read()
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read.");
+    T value;
+    std::memcpy(&value, data(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string readString()
+  {
+    const std::uint32_t size = read<std::uint32_t>();
+    return std::string(data(size), size);
+  }
+
+  template<typename Derived>
+  void readMatrix(Eigen::MatrixBase<Derived>& matrix)
+  {
+    for(int i = 0; i < matrix.size(); ++i)
+      matrix(i) = static_cast<typename Derived::Scalar>(read<double>());
+  }
+
+  /// Consume \p size bytes and return a pointer on them
+  const char* data(std::size_t size)
+  {
+    if(static_cast<std::size_t>(_end - _current) < size)
+      throw std::runtime_error("Invalid SFB file: unexpected end of section.");
+    const char* result = _current;
+    _current += size;
+    return result;
+  }
+
+  /// Consume \p count records of \p recordSize bytes and return a pointer on them
+  const char* records(std::uint64_t count, std::size_t recordSize)
+  {
+    // check the count before the multiplication, which may overflow with a corrupted count
+    if(count > static_cast<std::size_t>(_end - _current) / recordSize)
+      throw std::runtime_error("Invalid SFB file: unexpected end of section.");
+    return data(count * recordSize);
+  }
+
+private:
+  const char* _current;
+  const char* _end;
+};
+
+void writePose3(SfbStreamWriter& writer, const geometry::Pose3& pose)
+{
+  writer.writeMatrix(pose.rotation());
+  writer.writeMatrix(pose.center());
+}
+
+geometry::Pose3 readPose3(SfbReader& reader)
+{
+  Mat3 rotation;
+  Vec3 center;
+  reader.readMatrix(rotation);
+  reader.readMatrix(center);
+  return geometry::Pose3(rotation, center);
+}
+
+void writeFolders(SfbStreamWriter& writer, const sfmData::SfMData& sfmData)
+{
+  for(const auto* folders : {&sfmData.getRelativeFeaturesFolders(), &sfmData.getRelativeMatchesFolders()})
+  {
+    writer.write(static_cast<std::uint32_t>(folders->size()));
+    for(const std::string& folder : *folders)
+      writer.writeString(folder);
+  }
+}
+
+void readFolders(SfbReader& reader, sfmData::SfMData& sfmData)
+{
+  std::vector<std::string> featuresFolders(reader.read<std::uint32_t>());
+  for(std::string& folder : featuresFolders)
+    folder = reader.readString();
+
+  std::vector<std::string> matchesFolders(reader.read<std::uint32_t>());
+  for(std::string& folder : matchesFolders)
+    folder = reader.readString();
+
+  sfmData.addFeaturesFolders(featuresFolders);
+  sfmData.addMatchesFolders(matchesFolders);
+}
+
+void writeViews(SfbStreamWriter& writer, const sfmData::Views& views)
+{
+  writer.write(static_cast<std::uint32_t>(views.size()));
+
+  for(const auto& viewPair : views)
+  {
+    const sfmData::View& view = *viewPair.second;
+
+    writer.write(static_cast<std::uint32_t>(view.getViewId()));
+    writer.write(static_cast<std::uint32_t>(view.getPoseId()));
+    writer.write(static_cast<std::uint32_t>(view.getRigId()));
+    writer.write(static_cast<std::uint32_t>(view.getSubPoseId()));
+    writer.write(static_cast<std::uint32_t>(view.getFrameId()));
+    writer.write(static_cast<std::uint32_t>(view.getIntrinsicId()));
+    writer.write(static_cast<std::uint32_t>(view.getResectionId()));
+    writer.write(static_cast<std::uint8_t>(view.isPoseIndependant()));
+    writer.write(static_cast<std::uint64_t>(view.getWidth()));
+    writer.write(static_cast<std::uint64_t>(view.getHeight()));
+    writer.writeString(view.getImagePath());
+
+    writer.write(static_cast<std::uint32_t>(view.getMetadata().size()));
+    for(const auto& metadataPair : view.getMetadata())
+    {
+      writer.writeString(metadataPair.first);
+      writer.writeString(metadataPair.second);
+    }
+  }
+}
+
+void readViews(SfbReader& reader, sfmData::Views& views)
+{
+  const std::uint32_t nbViews = reader.read<std::uint32_t>();
+
+  for(std::uint32_t i = 0; i < nbViews; ++i)
+  {
+    auto view = std::make_shared<sfmData::View>();
+
+    view->setViewId(reader.read<std::uint32_t>());
+    view->setPoseId(reader.read<std::uint32_t>());
+    const IndexT rigId = reader.read<std::uint32_t>();
+    const IndexT subPoseId = reader.read<std::uint32_t>();
+    if(rigId != UndefinedIndexT)
+      view->setRigAndSubPoseId(rigId, subPoseId);
+    view->setFrameId(reader.read<std::uint32_t>());
+    view->setIntrinsicId(reader.read<std::uint32_t>());
+    view->setResectionId(reader.read<std::uint32_t>());
+    view->setIndependantPose(reader.read<std::uint8_t>() != 0);
+    view->setWidth(reader.read<std::uint64_t>());
+    view->setHeight(reader.read<std::uint64_t>());
+    view->setImagePath(reader.readString());
+
+    const std::uint32_t nbMetadata = reader.read<std::uint32_t>();
+    for(std::uint32_t m = 0; m < nbMetadata; ++m)
+    {
+      const std::string key = reader.readString();
+      view->addMetadata(key, reader.readString());
+    }
+
+    views.emplace(view->getViewId(), view);
+  }
+}
+
+void writeIntrinsics(SfbStreamWriter& writer, const sfmData::Intrinsics& intrinsics)
+{
+  writer.write(static_cast<std::uint32_t>(intrinsics.size()));
+
+  for(const auto& intrinsicPair : intrinsics)
+  {
+    const camera::IntrinsicBase& intrinsic = *intrinsicPair.second;
+
+    writer.write(static_cast<std::uint32_t>(intrinsicPair.first));
+    writer.writeString(camera::EINTRINSIC_enumToString(intrinsic.getType()));
+    writer.write(static_cast<std::uint32_t>(intrinsic.w()));
+    writer.write(static_cast<std::uint32_t>(intrinsic.h()));
+    writer.write(intrinsic.sensorWidth());
+    writer.write(intrinsic.sensorHeight());
+    writer.writeString(intrinsic.serialNumber());
+    writer.writeString(camera::EIntrinsicInitMode_enumToString(intrinsic.getInitializationMode()));
+    writer.write(static_cast<std::uint8_t>(intrinsic.isLocked()));
+
+    // scale and offset are stored in pixels, so no conversion is needed at loading
+    const auto* intrinsicScaleOffset = dynamic_cast<const camera::IntrinsicsScaleOffset*>(&intrinsic);
+    writer.write(static_cast<std::uint8_t>(intrinsicScaleOffset != nullptr));
+    if(intrinsicScaleOffset)
+    {
+      writer.writeMatrix(intrinsicScaleOffset->getScale());
+      writer.writeMatrix(intrinsicScaleOffset->getOffset());
+      writer.writeMatrix(intrinsicScaleOffset->getInitialScale());
+      writer.write(static_cast<std::uint8_t>(intrinsicScaleOffset->isRatioLocked()));
+    }
+
+    const auto* intrinsicScaleOffsetDisto = dynamic_cast<const camera::IntrinsicsScaleOffsetDisto*>(&intrinsic);
+    const std::vector<double> distortionParams = intrinsicScaleOffsetDisto ? intrinsicScaleOffsetDisto->getDistortionParams() : std::vector<double>();
+    writer.write(static_cast<std::uint32_t>(distortionParams.size()));
+    for(double param : distortionParams)
+      writer.write(param);
+
+    const auto* intrinsicEquidistant = dynamic_cast<const camera::EquiDistant*>(&intrinsic);
+    writer.write(static_cast<std::uint8_t>(intrinsicEquidistant != nullptr));
+    if(intrinsicEquidistant)
+    {
+      writer.write(intrinsicEquidistant->getCircleCenterX());
+      writer.write(intrinsicEquidistant->getCircleCenterY());
+      writer.write(intrinsicEquidistant->getCircleRadius());
+    }
+  }
+}
+
+void readIntrinsics(SfbReader& reader, sfmData::Intrinsics& intrinsics)
+{
+  const std::uint32_t nbIntrinsics = reader.read<std::uint32_t>();
+
+  for(std::uint32_t i = 0; i < nbIntrinsics; ++i)
+  {
+    const IndexT intrinsicId = reader.read<std::uint32_t>();
+    const camera::EINTRINSIC intrinsicType = camera::EINTRINSIC_stringToEnum(reader.readString());
+    const unsigned int width = reader.read<std::uint32_t>();
+    const unsigned int height = reader.read<std::uint32_t>();
+
+    std::shared_ptr<camera::IntrinsicBase> intrinsic = camera::createIntrinsic(intrinsicType, width, height);
+    if(intrinsic == nullptr)
+      throw std::runtime_error("Invalid SFB file: intrinsic " + std::to_string(intrinsicId) + " has an unsupported type.");
+
+    intrinsic->setSensorWidth(reader.read<double>());
+    intrinsic->setSensorHeight(reader.read<double>());
+    intrinsic->setSerialNumber(reader.readString());
+    intrinsic->setInitializationMode(camera::EIntrinsicInitMode_stringToEnum(reader.readString()));
+
+    if(reader.read<std::uint8_t>())
+      intrinsic->lock();
+    else
+      intrinsic->unlock();
+
+    if(reader.read<std::uint8_t>())
+    {
+      std::shared_ptr<camera::IntrinsicsScaleOffset> intrinsicScaleOffset = std::dynamic_pointer_cast<camera::IntrinsicsScaleOffset>(intrinsic);
+      if(!intrinsicScaleOffset)
+        throw std::runtime_error("Invalid SFB file: intrinsic " + std::to_string(intrinsicId) + " has no scale and offset.");
+
+      Vec2 scale, offset, initialScale;
+      reader.readMatrix(scale);
+      reader.readMatrix(offset);
+      reader.readMatrix(initialScale);
+
+      intrinsicScaleOffset->setScale(scale);
+      intrinsicScaleOffset->setOffset(offset);
+      intrinsicScaleOffset->setInitialScale(initialScale);
+      intrinsicScaleOffset->setRatioLocked(reader.read<std::uint8_t>() != 0);
+    }
+
+    std::vector<double> distortionParams(reader.read<std::uint32_t>());
+    for(double& param : distortionParams)
+      param = reader.read<double>();
+
+    std::shared_ptr<camera::IntrinsicsScaleOffsetDisto> intrinsicScaleOffsetDisto = std::dynamic_pointer_cast<camera::IntrinsicsScaleOffsetDisto>(intrinsic);
+    if(intrinsicScaleOffsetDisto)
+    {
+      distortionParams.resize(intrinsicScaleOffsetDisto->getDistortionParams().size(), 0.0);
+      intrinsicScaleOffsetDisto->setDistortionParams(distortionParams);
+    }
+
+    if(reader.read<std::uint8_t>())
+    {
+      std::shared_ptr<camera::EquiDistant> intrinsicEquidistant = std::dynamic_pointer_cast<camera::EquiDistant>(intrinsic);
+      if(!intrinsicEquidistant)
+        throw std::runtime_error("Invalid SFB file: intrinsic " + std::to_string(intrinsicId) + " is not equidistant.");
+
+      intrinsicEquidistant->setCircleCenterX(reader.read<double>());
+      intrinsicEquidistant->setCircleCenterY(reader.read<double>());
+      intrinsicEquidistant->setCircleRadius(reader.read<double>());
+    }
+
+    intrinsics.emplace(intrinsicId, intrinsic);
+  }
+}
+
+void writePoses(SfbStreamWriter& writer, const sfmData::Poses& poses)
+{
+  writer.write(static_cast<std::uint32_t>(poses.size()));
+
+  for(const auto& posePair : poses)
+  {
+    writer.write(static_cast<std::uint32_t>(posePair.first));
+    writePose3(writer, posePair.second.getTransform());
+    writer.write(static_cast<std::uint8_t>(posePair.second.isLocked()));
+  }
+}
+
+void readPoses(SfbReader& reader, sfmData::Poses& poses)
+{
+  const std::uint32_t nbPoses = reader.read<std::uint32_t>();
+
+  for(std::uint32_t i = 0; i < nbPoses; ++i)
+  {
+    const IndexT poseId = reader.read<std::uint32_t>();
+    const geometry::Pose3 transform = readPose3(reader);
+    const bool locked = reader.read<std::uint8_t>() != 0;
+
+    poses.emplace(poseId, sfmData::CameraPose(transform, locked));
+  }
+}
+
+void writeRigs(SfbStreamWriter& writer, const sfmData::Rigs& rigs)
+{
+  writer.write(static_cast<std::uint32_t>(rigs.size()));
+
+  for(const auto& rigPair : rigs)
+  {
+    writer.write(static_cast<std::uint32_t>(rigPair.first));
+    writer.write(static_cast<std::uint32_t>(rigPair.second.getNbSubPoses()));
+
+    for(const sfmData::RigSubPose& subPose : rigPair.second.getSubPoses())
+    {
+      writer.write(static_cast<std::uint8_t>(subPose.status));
+      writePose3(writer, subPose.pose);
+    }
+  }
+}
+
+void readRigs(SfbReader& reader, sfmData::Rigs& rigs)
+{
+  const std::uint32_t nbRigs = reader.read<std::uint32_t>();
+
+  for(std::uint32_t i = 0; i < nbRigs; ++i)
+  {
+    const IndexT rigId = reader.read<std::uint32_t>();
+    const std::uint32_t nbSubPoses = reader.read<std::uint32_t>();
+
+    sfmData::Rig rig(nbSubPoses);
+
+    for(std::uint32_t subPoseId = 0; subPoseId < nbSubPoses; ++subPoseId)
+    {
+      const std::uint8_t status = reader.read<std::uint8_t>();
+      if(status > static_cast<std::uint8_t>(sfmData::ERigSubPoseStatus::CONSTANT))
+        throw std::runtime_error("Invalid SFB file: unrecognized rig sub-pose status.");
+
+      sfmData::RigSubPose subPose;
+      subPose.status = static_cast<sfmData::ERigSubPoseStatus>(status);
+      subPose.pose = readPose3(reader);
+      rig.setSubPose(subPoseId, subPose);
+    }
+
+    rigs.emplace(rigId, rig);
+  }
+}
+
+/**
+ * @brief Write the landmarks as fixed size records, preceded by the table of their describer types.
+ */
+void writeLandmarks(SfbStreamWriter& writer, const LandmarkPtrs& landmarks)
+{
+  std::map<feature::EImageDescriberType, std::uint8_t> descTypeIndexes;
+  for(const auto* landmarkPair : landmarks)
+    descTypeIndexes.emplace(landmarkPair->second.descType, 0);
+
+  if(descTypeIndexes.size() > std::numeric_limits<std::uint8_t>::max())
+    throw std::runtime_error("Too many describer types to be saved in an SFB file.");
+
+  writer.write(static_cast<std::uint32_t>(descTypeIndexes.size()));
+  std::uint8_t descTypeIndex = 0;
+  for(auto& descTypePair : descTypeIndexes)
+  {
+    descTypePair.second = descTypeIndex++;
+    writer.writeString(feature::EImageDescriberType_enumToString(descTypePair.first));
+  }
+
+  writer.write(static_cast<std::uint64_t>(landmarks.size()));
+  for(const auto* landmarkPair : landmarks)
+  {
+    const sfmData::Landmark& landmark = landmarkPair->second;
+
+    writer.write(static_cast<std::uint32_t>(landmarkPair->first));
+    writer.write(static_cast<std::uint32_t>(landmark.observations.size()));
+    writer.write(descTypeIndexes.at(landmark.descType));
+    writer.write(landmark.rgb.r());
+    writer.write(landmark.rgb.g());
+    writer.write(landmark.rgb.b());
+    writer.writeMatrix(landmark.X);
+  }
+}
+
+/**
+ * @brief Write the observations of the landmarks as fixed size records, in the order of the landmarks.
+ */
+void writeObservations(SfbStreamWriter& writer, const LandmarkPtrs& landmarks, bool withFeatures)
+{
+  std::uint64_t nbObservations = 0;
+  for(const auto* landmarkPair : landmarks)
+    nbObservations += landmarkPair->second.observations.size();
+
+  writer.write(nbObservations);
+  for(const auto* landmarkPair : landmarks)
+  {
+    for(const auto& observationPair : landmarkPair->second.observations)
+    {
+      writer.write(static_cast<std::uint32_t>(observationPair.first));
+
+      if(withFeatures)
+      {
+        const sfmData::Observation& observation = observationPair.second;
+        writer.write(static_cast<std::uint32_t>(observation.id_feat));
+        writer.writeMatrix(observation.x);
+        writer.write(observation.scale);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Read the landmarks written by writeLandmarks.
+ * @param[in,out] reader The section reader
+ * @param[out] landmarks The landmarks, without observations
+ * @param[out] nbObservations The number of observations of each landmark
+ */
+void readLandmarks(SfbReader& reader, std::vector<std::pair<IndexT, sfmData::Landmark>>& landmarks, std::vector<std::uint32_t>& nbObservations)
+{
+  std::vector<feature::EImageDescriberType> descTypes(reader.read<std::uint32_t>());
+  for(feature::EImageDescriberType& descType : descTypes)
+    descType = feature::EImageDescriberType_stringToEnum(reader.readString());
+
+  const std::uint64_t nbLandmarks = reader.read<std::uint64_t>();
+  const char* records = reader.records(nbLandmarks, landmarkRecordSize);
+
+  landmarks.resize(nbLandmarks);
+  nbObservations.resize(nbLandmarks);
+
+  for(std::uint64_t i = 0; i < nbLandmarks; ++i)
+  {
+    SfbReader recordReader(records + i * landmarkRecordSize, records + (i + 1) * landmarkRecordSize);
+    sfmData::Landmark& landmark = landmarks[i].second;
+
+    landmarks[i].first = recordReader.read<std::uint32_t>();
+    nbObservations[i] = recordReader.read<std::uint32_t>();
+
+    const std::uint8_t descTypeIndex = recordReader.read<std::uint8_t>();
+    if(descTypeIndex >= descTypes.size())
+      throw std::runtime_error("Invalid SFB file: landmark " + std::to_string(landmarks[i].first) + " has an invalid describer type.");
+    landmark.descType = descTypes[descTypeIndex];
+
+    landmark.rgb.r() = recordReader.read<std::uint8_t>();
+    landmark.rgb.g() = recordReader.read<std::uint8_t>();
+    landmark.rgb.b() = recordReader.read<std::uint8_t>();
+    recordReader.readMatrix(landmark.X);
+  }
+}
+
+/**
+ * @brief Read the observations written by writeObservations, in parallel.
+ * @param[in,out] reader The section reader
+ * @param[in,out] landmarks The landmarks read by readLandmarks
+ * @param[in] nbObservations The number of observations of each landmark
+ * @param[in] withFeatures The observations records contain the features
+ * @param[in] loadFeatures Load the observations features
+ */
+void readObservations(SfbReader& reader, std::vector<std::pair<IndexT, sfmData::Landmark>>& landmarks,
+                      const std::vector<std::uint32_t>& nbObservations, bool withFeatures, bool loadFeatures)
+{
+  std::vector<std::uint64_t> firstObservation(landmarks.size() + 1, 0);
+  for(std::size_t i = 0; i < landmarks.size(); ++i)
+    firstObservation[i + 1] = firstObservation[i] + nbObservations[i];
+
+  const std::uint64_t nbTotalObservations = reader.read<std::uint64_t>();
+  if(nbTotalObservations != firstObservation.back())
+    throw std::runtime_error("Invalid SFB file: the number of observations does not match the landmarks.");
+
+  const std::size_t recordSize = observationRecordSize(withFeatures);
+  const char* records = reader.records(nbTotalObservations, recordSize);
+
+  #pragma omp parallel for
+  for(int i = 0; i < static_cast<int>(landmarks.size()); ++i)
+  {
+    sfmData::Observations& observations = landmarks[i].second.observations;
+    observations.reserve(nbObservations[i]);
+
+    for(std::uint64_t o = firstObservation[i]; o < firstObservation[i + 1]; ++o)
+    {
+      const char* record = records + o * recordSize;
+
+      std::uint32_t viewId;
+      std::memcpy(&viewId, record, sizeof(viewId));
+
+      sfmData::Observation observation;
+      if(withFeatures && loadFeatures)
+      {
+        std::uint32_t featureId;
+        double values[3];
+        std::memcpy(&featureId, record + sizeof(viewId), sizeof(featureId));
+        std::memcpy(values, record + sizeof(viewId) + sizeof(featureId), sizeof(values));
+
+        observation.id_feat = featureId;
+        observation.x = Vec2(values[0], values[1]);
+        observation.scale = values[2];
+      }
+
+      // observations are written in ascending view id order
+      observations.emplace_hint(observations.end(), viewId, observation);
+    }
+  }
+}
+
+/// Sort the landmarks by id, so the files do not depend on the hash map order
+LandmarkPtrs getSortedLandmarks(const sfmData::Landmarks& landmarks)
+{
+  LandmarkPtrs sortedLandmarks;
+  sortedLandmarks.reserve(landmarks.size());
+  for(const auto& landmarkPair : landmarks)
+    sortedLandmarks.push_back(&landmarkPair);
+
+  std::sort(sortedLandmarks.begin(), sortedLandmarks.end(),
+            [](const sfmData::Landmarks::value_type* a, const sfmData::Landmarks::value_type* b) { return a->first < b->first; });
+  return sortedLandmarks;
+}
+
+void moveLandmarks(std::vector<std::pair<IndexT, sfmData::Landmark>>& landmarks, sfmData::Landmarks& output)
+{
+  for(auto& landmarkPair : landmarks)
+    output.emplace_hint(output.end(), landmarkPair.first, std::move(landmarkPair.second));
+}
+
+} // namespace
+
+bool saveSFB(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+{
+  // save flags
+  const bool saveViews = (partFlag & VIEWS) == VIEWS;
+  const bool saveIntrinsics = (partFlag & INTRINSICS) == INTRINSICS;
+  const bool saveExtrinsics = (partFlag & EXTRINSICS) == EXTRINSICS;
+  const bool saveStructure = (partFlag & STRUCTURE) == STRUCTURE;
+  const bool saveControlPoints = (partFlag & CONTROL_POINTS) == CONTROL_POINTS;
+  const bool saveFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
+  const bool saveObservations = saveFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
+
+  std::vector<SfbSectionEntry> sections;
+  const auto addSection = [&sections](ESfbSection type, std::uint32_t flags = 0)
+  {
+    sections.push_back({type, flags, 0, 0});
+  };
+
+  addSection(ESfbSection::FOLDERS);
+  if(saveViews)
+    addSection(ESfbSection::VIEWS);
+  if(saveIntrinsics)
+    addSection(ESfbSection::INTRINSICS);
+  if(saveExtrinsics)
+  {
+    addSection(ESfbSection::POSES);
+    addSection(ESfbSection::RIGS);
+  }
+  if(saveStructure)
+  {
+    addSection(ESfbSection::LANDMARKS);
+    if(saveObservations)
+      addSection(ESfbSection::OBSERVATIONS, saveFeatures ? SfbSectionEntry::FLAG_WITH_FEATURES : 0);
+  }
+  if(saveControlPoints)
+    addSection(ESfbSection::CONTROL_POINTS, SfbSectionEntry::FLAG_WITH_FEATURES);
+
+  std::ofstream stream(filename, std::ios::out | std::ios::binary);
+  if(!stream.is_open())
+    throw std::runtime_error("Cannot open SFB file: " + filename);
+
+  SfbHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, SfbHeader::MAGIC, std::strlen(SfbHeader::MAGIC));
+  header.version = SfbHeader::CURRENT_VERSION;
+  header.nbSections = static_cast<std::uint32_t>(sections.size());
+
+  // the section table is written again once the sections offsets are known
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  stream.write(reinterpret_cast<const char*>(sections.data()), sections.size() * sizeof(SfbSectionEntry));
+
+  SfbStreamWriter writer(stream);
+  LandmarkPtrs landmarks;
+
+  for(SfbSectionEntry& section : sections)
+  {
+    section.offset = writer.position();
+
+    switch(section.type)
+    {
+      case ESfbSection::FOLDERS:        writeFolders(writer, sfmData); break;
+      case ESfbSection::VIEWS:          writeViews(writer, sfmData.getViews()); break;
+      case ESfbSection::INTRINSICS:     writeIntrinsics(writer, sfmData.getIntrinsics()); break;
+      case ESfbSection::POSES:          writePoses(writer, sfmData.getPoses()); break;
+      case ESfbSection::RIGS:           writeRigs(writer, sfmData.getRigs()); break;
+      case ESfbSection::LANDMARKS:
+        landmarks = getSortedLandmarks(sfmData.getLandmarks());
+        writeLandmarks(writer, landmarks);
+        break;
+      case ESfbSection::OBSERVATIONS:   writeObservations(writer, landmarks, saveFeatures); break;
+      case ESfbSection::CONTROL_POINTS:
+      {
+        const LandmarkPtrs controlPoints = getSortedLandmarks(sfmData.getControlPoints());
+        writeLandmarks(writer, controlPoints);
+        writeObservations(writer, controlPoints, true);
+        break;
+      }
+    }
+
+    section.size = writer.position() - section.offset;
+  }
+
+  stream.seekp(sizeof(header));
+  stream.write(reinterpret_cast<const char*>(sections.data()), sections.size() * sizeof(SfbSectionEntry));
+
+  if(!stream.good())
+    throw std::runtime_error("Error while writing SFB file: " + filename);
+
+  return true;
+}
+
+bool loadSFB(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+{
+  namespace bip = boost::interprocess;
+
+  // load flags
+  const bool loadViews = (partFlag & VIEWS) == VIEWS;
+  const bool loadIntrinsics = (partFlag & INTRINSICS) == INTRINSICS;
+  const bool loadExtrinsics = (partFlag & EXTRINSICS) == EXTRINSICS;
+  const bool loadStructure = (partFlag & STRUCTURE) == STRUCTURE;
+  const bool loadControlPoints = (partFlag & CONTROL_POINTS) == CONTROL_POINTS;
+  const bool loadFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
+  const bool loadObservations = loadFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
+
+  // map the file in memory, only the required sections are read
+  if(!fs::exists(filename) || fs::file_size(filename) < sizeof(SfbHeader))
+    throw std::runtime_error("Cannot open SFB file: " + filename);
+
+  bip::file_mapping mapping(filename.c_str(), bip::read_only);
+  bip::mapped_region region(mapping, bip::read_only);
+
+  const char* data = static_cast<const char*>(region.get_address());
+  const char* dataEnd = data + region.get_size();
+  SfbReader fileReader(data, dataEnd);
+
+  const SfbHeader header = fileReader.read<SfbHeader>();
+
+  if(std::strncmp(header.magic, SfbHeader::MAGIC, sizeof(header.magic)) != 0)
+    throw std::runtime_error("Invalid SFB file: " + filename);
+
+  if(header.version > SfbHeader::CURRENT_VERSION)
+    throw std::runtime_error("Unsupported SFB file version " + std::to_string(header.version) + ": " + filename);
+
+  std::vector<SfbSectionEntry> sections(header.nbSections);
+  for(SfbSectionEntry& section : sections)
+  {
+    section = fileReader.read<SfbSectionEntry>();
+    if(section.offset > region.get_size() || section.size > region.get_size() - section.offset)
+      throw std::runtime_error("Invalid SFB file: section out of bounds in " + filename);
+  }
+
+  // landmarks and their observations are stored in two sections
+  std::vector<std::pair<IndexT, sfmData::Landmark>> landmarks;
+  std::vector<std::uint32_t> nbObservations;
+
+  for(const SfbSectionEntry& section : sections)
+  {
+    SfbReader reader(data + section.offset, data + section.offset + section.size);
+
+    switch(section.type)
+    {
+      case ESfbSection::FOLDERS:
+        readFolders(reader, sfmData);
+        break;
+      case ESfbSection::VIEWS:
+        if(loadViews)
+          readViews(reader, sfmData.getViews());
+        break;
+      case ESfbSection::INTRINSICS:
+        if(loadIntrinsics)
+          readIntrinsics(reader, sfmData.getIntrinsics());
+        break;
+      case ESfbSection::POSES:
+        if(loadExtrinsics)
+          readPoses(reader, sfmData.getPoses());
+        break;
+      case ESfbSection::RIGS:
+        if(loadExtrinsics)
+          readRigs(reader, sfmData.getRigs());
+        break;
+      case ESfbSection::LANDMARKS:
+        if(loadStructure)
+          readLandmarks(reader, landmarks, nbObservations);
+        break;
+      case ESfbSection::OBSERVATIONS:
+        if(loadStructure && loadObservations)
+          readObservations(reader, landmarks, nbObservations, (section.flags & SfbSectionEntry::FLAG_WITH_FEATURES) != 0, loadFeatures);
+        break;
+      case ESfbSection::CONTROL_POINTS:
+        if(loadControlPoints)
+        {
+          std::vector<std::pair<IndexT, sfmData::Landmark>> controlPoints;
+          std::vector<std::uint32_t> nbControlPointObservations;
+          readLandmarks(reader, controlPoints, nbControlPointObservations);
+          readObservations(reader, controlPoints, nbControlPointObservations, true, true);
+          moveLandmarks(controlPoints, sfmData.getControlPoints());
+        }
+        break;
+      default:
+        ALICEVISION_LOG_WARNING("Unknown section " << static_cast<std::uint32_t>(section.type) << " in SFB file: " << filename);
+        break;
+    }
+  }
+
+  moveLandmarks(landmarks, sfmData.getLandmarks());
+
+  return true;
+}
+
+} // namespace sfmDataIO
+} // namespace aliceVision
@@ -0,0 +1,96 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+// AliceVision SFB file (binary SfMData):
+// -- Header (32 bytes)
+// magic "AVSFMB", format version, number of sections
+// -- Section table (24 bytes per section)
+// section type, section flags, offset and size in bytes
+// -- Sections
+// folders, views, intrinsics, poses, rigs, landmarks, observations, control points
+// --
+// Landmarks and their observations are stored in two separate sections of fixed size records,
+// so the structure (or only its observations) can be skipped without being decoded.
+// All values are stored in little-endian, strings are stored as [uint32 length, characters].
+
+/**
+ * @brief Type of a section of an SFB file.
+ */
+enum class ESfbSection : std::uint32_t
+{
+  FOLDERS = 0,
+  VIEWS = 1,
+  INTRINSICS = 2,
+  POSES = 3,
+  RIGS = 4,
+  LANDMARKS = 5,
+  OBSERVATIONS = 6,
+  CONTROL_POINTS = 7
+};
+
+/**
+ * @brief Header of the SFB file format, followed by \p nbSections SfbSectionEntry.
+ */
+struct SfbHeader
+{
+  static constexpr const char* MAGIC = "AVSFMB";
+  static constexpr std::uint32_t CURRENT_VERSION = 1;
+
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t nbSections;
+  char reserved[16];
+};
+
+static_assert(sizeof(SfbHeader) == 32, "The SFB header must be 32 bytes.");
+
+/**
+ * @brief Entry of the SFB section table.
+ */
+struct SfbSectionEntry
+{
+  /// observations section flag: features (id, position and scale) are stored
+  static constexpr std::uint32_t FLAG_WITH_FEATURES = 1;
+
+  ESfbSection type;
+  std::uint32_t flags;
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+
+static_assert(sizeof(SfbSectionEntry) == 24, "The SFB section table entries must be 24 bytes.");
+
+/**
+ * @brief Save SfMData in a binary SFB file.
+ * @param[in] sfmData The input SfMData
+ * @param[in] filename The filename
+ * @param[in] partFlag The ESfMData save flag
+ * @return true if completed
+ */
+bool saveSFB(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag);
+
+/**
+ * @brief Load a binary SFB file.
+ *        The file is memory-mapped and only the sections required by the given flag are decoded.
+ * @param[out] sfmData The output SfMData
+ * @param[in] filename The filename
+ * @param[in] partFlag The ESfMData load flag
+ * @return true if completed
+ */
+bool loadSFB(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag);
+
+} // namespace sfmDataIO
+} // namespace aliceVision
@@ -8,9 +8,13 @@
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/sfmDataIO/jsonIO.hpp>
 
 #include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
 
+#include <fstream>
+#include <iterator>
 #include <sstream>
 
 #define BOOST_TEST_MODULE sfmDataIO
@@ -70,7 +74,7 @@ sfmData::SfMData createTestScene(std::size_t viewsCount = 2, std::size_t observa
 
 BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD)
 {
-    std::vector<std::string> ext_Type = {"sfm", "json"};
+    std::vector<std::string> ext_Type = {"sfm", "json", "sfb"};
 
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
     ext_Type.push_back("abc");
@@ -178,11 +182,165 @@ BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD)
     }
 }
 
+BOOST_AUTO_TEST_CASE(SfMData_IO_JSON_PropertyTreeCompatibility)
+{
+  sfmData::SfMData sfmData = createTestScene(3, 4, false);
+  sfmData.getViews().at(0)->addMetadata("Make", "Some \"camera\"/maker");
+  sfmData.getViews().at(1)->setIndependantPose(false);
+  sfmData.getRigs().emplace(0, sfmData::Rig(2));
+  sfmData.getLandmarks()[1].X = Vec3(-1.0 / 3.0, 1e-12, 42.0);
+  sfmData.getLandmarks()[1].rgb = image::RGBColor(12, 0, 255);
+  sfmData.getLandmarks()[1].descType = feature::EImageDescriberType::AKAZE;
+  sfmData.getControlPoints()[0].X = Vec3(1.0, 2.0, 3.0);
+  sfmData.getControlPoints()[0].descType = feature::EImageDescriberType::UNKNOWN;
+  sfmData.addFeaturesFolder("features");
+
+  const std::string filename = "SAVE_LOAD_PTREE.sfm";
+  const std::string ptreeFilename = "SAVE_LOAD_PTREE_REF.sfm";
+  BOOST_CHECK(saveJSON(sfmData, filename, ALL));
+
+  // write the same file with a boost property tree
+  {
+    const Vec3i version = {ALICEVISION_SFMDATAIO_VERSION_MAJOR, ALICEVISION_SFMDATAIO_VERSION_MINOR, ALICEVISION_SFMDATAIO_VERSION_REVISION};
+    bpt::ptree fileTree;
+    saveMatrix("version", version, fileTree);
+
+    bpt::ptree featureFoldersTree;
+    for(const std::string& featuresFolder : sfmData.getRelativeFeaturesFolders())
+    {
+      bpt::ptree featureFolderTree;
+      featureFolderTree.put("", featuresFolder);
+      featureFoldersTree.push_back(std::make_pair("", featureFolderTree));
+    }
+    fileTree.add_child("featuresFolders", featureFoldersTree);
+
+    bpt::ptree viewsTree;
+    for(const auto& viewPair : sfmData.getViews())
+      saveView("", *(viewPair.second), viewsTree);
+    fileTree.add_child("views", viewsTree);
+
+    bpt::ptree intrinsicsTree;
+    for(const auto& intrinsicPair : sfmData.getIntrinsics())
+      saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, intrinsicsTree);
+    fileTree.add_child("intrinsics", intrinsicsTree);
+
+    bpt::ptree posesTree;
+    for(const auto& posePair : sfmData.getPoses())
+    {
+      bpt::ptree poseTree;
+      poseTree.put("poseId", posePair.first);
+      saveCameraPose("pose", posePair.second, poseTree);
+      posesTree.push_back(std::make_pair("", poseTree));
+    }
+    fileTree.add_child("poses", posesTree);
+
+    bpt::ptree rigsTree;
+    for(const auto& rigPair : sfmData.getRigs())
+      saveRig("", rigPair.first, rigPair.second, rigsTree);
+    fileTree.add_child("rigs", rigsTree);
+
+    bpt::ptree structureTree;
+    for(const auto& structurePair : sfmData.getLandmarks())
+      saveLandmark("", structurePair.first, structurePair.second, structureTree);
+    fileTree.add_child("structure", structureTree);
+
+    bpt::ptree controlPointTree;
+    for(const auto& controlPointPair : sfmData.getControlPoints())
+      saveLandmark("", controlPointPair.first, controlPointPair.second, controlPointTree);
+    fileTree.add_child("controlPoints", controlPointTree);
+
+    bpt::write_json(ptreeFilename, fileTree);
+  }
+
+  // the streaming writer output must be byte-identical
+  {
+    std::ifstream streamFile(filename);
+    std::ifstream ptreeFile(ptreeFilename);
+    const std::string streamContent((std::istreambuf_iterator<char>(streamFile)), std::istreambuf_iterator<char>());
+    const std::string ptreeContent((std::istreambuf_iterator<char>(ptreeFile)), std::istreambuf_iterator<char>());
+    BOOST_CHECK(!streamContent.empty());
+    BOOST_CHECK(streamContent == ptreeContent);
+  }
+
+  // the streaming reader must load the same data
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK(loadJSON(sfmDataLoad, ptreeFilename, ALL));
+    BOOST_CHECK(sfmData == sfmDataLoad);
+    BOOST_CHECK_EQUAL(sfmDataLoad.getViews().at(0)->getMetadata().at("Make"), "Some \"camera\"/maker");
+    BOOST_CHECK_EQUAL(sfmDataLoad.getRigs().size(), 1);
+    BOOST_CHECK_EQUAL(sfmDataLoad.getControlPoints().size(), 1);
+  }
+
+  fs::remove(filename);
+  fs::remove(ptreeFilename);
+}
+
+BOOST_AUTO_TEST_CASE(SfMData_IO_SFB_Sections)
+{
+  sfmData::SfMData sfmData = createTestScene(3, 3, false);
+  sfmData.getIntrinsics()[2] = std::make_shared<PinholeRadialK3>(1500, 1000, 700.123456789, 701.5, 10.25, -20.5, 0.1, -0.01, 0.001);
+  sfmData.getViews().at(0)->addMetadata("Make", "maker");
+  sfmData.getViews().at(1)->setRigAndSubPoseId(0, 1);
+  sfmData.getRigs().emplace(0, sfmData::Rig(2));
+  sfmData.getLandmarks()[1].X = Vec3(-1.0 / 3.0, 1e-12, 42.0);
+  sfmData.getLandmarks()[1].descType = feature::EImageDescriberType::AKAZE;
+  sfmData.getLandmarks()[1].observations[2] = sfmData::Observation(Vec2(0.5, 1.5), 7, 2.0);
+  sfmData.getControlPoints()[0].X = Vec3(1.0, 2.0, 3.0);
+  sfmData.getControlPoints()[0].descType = feature::EImageDescriberType::UNKNOWN;
+  sfmData.addFeaturesFolder("features");
+
+  const std::string filename = "SAVE_LOAD_SECTIONS.sfb";
+  BOOST_CHECK(Save(sfmData, filename, ALL));
+
+  // all the values are stored exactly
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK(Load(sfmDataLoad, filename, ALL));
+    BOOST_CHECK(sfmData == sfmDataLoad);
+    BOOST_CHECK_EQUAL(sfmDataLoad.getRelativeFeaturesFolders().size(), 1);
+    BOOST_CHECK_EQUAL(sfmDataLoad.getViews().at(1)->getRigId(), 0);
+    BOOST_CHECK_EQUAL(sfmDataLoad.getLandmarks().at(1).X.x(), -1.0 / 3.0);
+    BOOST_CHECK_EQUAL(sfmDataLoad.getLandmarks().at(1).observations.at(2).scale, 2.0);
+    BOOST_CHECK_EQUAL(sfmDataLoad.getControlPoints().size(), 1);
+  }
+
+  // structure without observations
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK(Load(sfmDataLoad, filename, STRUCTURE));
+    BOOST_CHECK_EQUAL(sfmDataLoad.getViews().size(), 0);
+    BOOST_CHECK_EQUAL(sfmDataLoad.getLandmarks().size(), 2);
+    BOOST_CHECK(sfmDataLoad.getLandmarks().at(0).observations.empty());
+    BOOST_CHECK(sfmDataLoad.getLandmarks().at(0).X == sfmData.getLandmarks().at(0).X);
+  }
+
+  // observations without features
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK(Load(sfmDataLoad, filename, ESfMData(STRUCTURE | OBSERVATIONS)));
+    BOOST_CHECK_EQUAL(sfmDataLoad.getLandmarks().at(0).observations.size(), 3);
+    BOOST_CHECK_EQUAL(sfmDataLoad.getLandmarks().at(0).observations.at(1).id_feat, UndefinedIndexT);
+  }
+
+  // saved without the structure
+  {
+    BOOST_CHECK(Save(sfmData, filename, ESfMData(VIEWS | INTRINSICS | EXTRINSICS)));
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK(Load(sfmDataLoad, filename, ALL));
+    BOOST_CHECK_EQUAL(sfmDataLoad.getViews().size(), sfmData.getViews().size());
+    BOOST_CHECK_EQUAL(sfmDataLoad.getLandmarks().size(), 0);
+    BOOST_CHECK_EQUAL(sfmDataLoad.getControlPoints().size(), 0);
+  }
+
+  fs::remove(filename);
+}
+
 /*
 BOOST_AUTO_TEST_CASE(SfMData_IO_BigFile) {
   const int nbViews = 1000;
   const int nbObservationPerView = 100000;
-  std::vector<std::string> ext_Type = {"sfm","json"};
+  std::vector<std::string> ext_Type = {"sfm","json","sfb"};
 
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
   ext_Type.push_back("abc");
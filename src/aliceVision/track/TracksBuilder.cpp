@@ -7,41 +7,108 @@
 
 #include "TracksBuilder.hpp"
 
-#include <lemon/list_graph.h>
-#include <lemon/unionfind.h>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
 
 
 namespace aliceVision {
 namespace track {
 
 using namespace aliceVision::matching;
-using namespace lemon;
 
-/// IndexedFeaturePair is: map<viewId, keypointId>
-using IndexedFeaturePair = std::pair<std::size_t, KeypointId>;
-using IndexMap = lemon::ListDigraph::NodeMap<std::size_t>;
-using UnionFindObject = lemon::UnionFindEnum< IndexMap >;
+namespace {
 
-using MapNodeToIndex = stl::flat_map< lemon::ListDigraph::Node, IndexedFeaturePair>;
-using MapIndexToNode = stl::flat_map< IndexedFeaturePair, lemon::ListDigraph::Node >;
+/// index of a feature in the union-find forest
+using NodeIndex = std::uint32_t;
 
-struct TracksBuilderData
+constexpr NodeIndex UndefinedNodeIndex = std::numeric_limits<NodeIndex>::max();
+
+/**
+ * @brief Contiguous range of nodes of the features of a describer type in a view.
+ *        The node of the feature i is (offset + i).
+ */
+struct FeatureRange
 {
-  /// graph container to create the node
-  lemon::ListDigraph graph;
-  /// node to index map
-  MapNodeToIndex map_nodeToIndex;
-  std::unique_ptr<IndexMap> index;
-  std::unique_ptr<UnionFindObject> tracksUF;
+  std::size_t viewId;
+  feature::EImageDescriberType descType;
+  NodeIndex offset;
+};
 
-  const UnionFindObject& getUnionFindEnum() const
+/**
+ * @brief Matches of a pair of views for a describer type, with the node ranges of the two views.
+ */
+struct PairMatchesRef
+{
+  NodeIndex offsetI;
+  NodeIndex offsetJ;
+  const IndMatches* matches;
+};
+
+/**
+ * @brief Find the root of a node with path halving.
+ *        Concurrent calls and unions are allowed: a failed compression is simply skipped.
+ */
+inline NodeIndex findRoot(std::vector<std::atomic<NodeIndex>>& parents, NodeIndex node)
+{
+  NodeIndex parent = parents[node].load();
+  while(parent != node)
   {
-    return *tracksUF;
+    const NodeIndex grandParent = parents[parent].load();
+    if(grandParent != parent)
+      parents[node].compare_exchange_weak(parent, grandParent);
+    node = grandParent;
+    parent = parents[node].load();
   }
+  return node;
+}
 
-  const MapNodeToIndex& getReverseMap() const
+/**
+ * @brief Lock-free union of the sets of two nodes.
+ *        The root with the largest index is always linked to the other one,
+ *        so the root of a set is its smallest node whatever the order of the unions.
+ */
+inline void unite(std::vector<std::atomic<NodeIndex>>& parents, NodeIndex a, NodeIndex b)
+{
+  while(true)
   {
-    return map_nodeToIndex;
+    a = findRoot(parents, a);
+    b = findRoot(parents, b);
+    if(a == b)
+      return;
+    if(a < b)
+      std::swap(a, b);
+    NodeIndex expected = a;
+    if(parents[a].compare_exchange_strong(expected, b))
+      return;
+    // a is not a root anymore: another thread linked it, retry
+  }
+}
+
+} // namespace
+
+struct TracksBuilderData
+{
+  /// feature ranges sorted by (viewId, descType) and node offset
+  std::vector<FeatureRange> ranges;
+  /// tracks are stored as ranges [trackOffsets[t], trackOffsets[t+1]) of trackNodes
+  std::vector<std::size_t> trackOffsets;
+  /// nodes of each track, sorted by (viewId, descType, featureIndex)
+  std::vector<NodeIndex> trackNodes;
+
+  inline std::size_t nbTracks() const
+  {
+    return trackOffsets.empty() ? 0 : trackOffsets.size() - 1;
+  }
+
+  inline const FeatureRange& getRange(NodeIndex node) const
+  {
+    const auto it = std::upper_bound(ranges.begin(), ranges.end(), node,
+                                     [](NodeIndex n, const FeatureRange& r) { return n < r.offset; });
+    return *(it - 1);
   }
 };
 
@@ -54,74 +121,141 @@ TracksBuilder::~TracksBuilder() = default;
 
 void TracksBuilder::build(const PairwiseMatches& pairwiseMatches)
 {
-  typedef std::set<IndexedFeaturePair> SetIndexedPair;
+  std::vector<PairwiseMatches::const_iterator> pairs;
+  pairs.reserve(pairwiseMatches.size());
+  for(PairwiseMatches::const_iterator it = pairwiseMatches.begin(); it != pairwiseMatches.end(); ++it)
+    pairs.push_back(it);
+
+  build(pairs);
+}
+
+void TracksBuilder::build(const std::vector<PairwiseMatches::const_iterator>& pairwiseMatches)
+{
+  using RangeKey = std::pair<std::size_t, feature::EImageDescriberType>;
+
+  // number of features of each (viewId, descType), from the largest referenced feature index
+  std::map<RangeKey, std::size_t> rangeSizes;
+
+  struct PairMatchesInfo
+  {
+    RangeKey keyI;
+    RangeKey keyJ;
+    const IndMatches* matches;
+  };
+  std::vector<PairMatchesInfo> allPairMatches;
+
+  for(const PairwiseMatches::const_iterator& matchesPerDescIt: pairwiseMatches)
+  {
+    const std::size_t I = matchesPerDescIt->first.first;
+    const std::size_t J = matchesPerDescIt->first.second;
 
-  // set of all features of all images: (imageIndex, featureIndex)
-  SetIndexedPair allFeatures;
+    for(const auto& matchesIt: matchesPerDescIt->second)
+    {
+      if(matchesIt.second.empty())
+        continue;
+      allPairMatches.push_back({RangeKey(I, matchesIt.first), RangeKey(J, matchesIt.first), &matchesIt.second});
+    }
+  }
 
-  // for each couple of images make the union according the pair matches
-  for(const auto& matchesPerDescIt: pairwiseMatches)
   {
-    const std::size_t& I = matchesPerDescIt.first.first;
-    const std::size_t& J = matchesPerDescIt.first.second;
-    const MatchesPerDescType& matchesPerDesc = matchesPerDescIt.second;
+    std::vector<std::pair<std::size_t, std::size_t>> pairMaxFeatures(allPairMatches.size());
 
-    for(const auto& matchesIt: matchesPerDesc)
+#pragma omp parallel for
+    for(std::size_t p = 0; p < allPairMatches.size(); ++p)
     {
-      const feature::EImageDescriberType descType = matchesIt.first;
-      const IndMatches& matches = matchesIt.second;
-      // we have correspondences between I and J image index.
-      for(const IndMatch& m: matches)
+      std::size_t maxI = 0;
+      std::size_t maxJ = 0;
+      for(const IndMatch& m: *allPairMatches[p].matches)
       {
-        IndexedFeaturePair pairI(I, KeypointId(descType, m._i));
-        IndexedFeaturePair pairJ(J, KeypointId(descType, m._j));
-        allFeatures.insert(pairI);
-        allFeatures.insert(pairJ);
+        maxI = std::max(maxI, std::size_t(m._i));
+        maxJ = std::max(maxJ, std::size_t(m._j));
       }
+      pairMaxFeatures[p] = std::make_pair(maxI + 1, maxJ + 1);
+    }
+
+    for(std::size_t p = 0; p < allPairMatches.size(); ++p)
+    {
+      std::size_t& sizeI = rangeSizes[allPairMatches[p].keyI];
+      std::size_t& sizeJ = rangeSizes[allPairMatches[p].keyJ];
+      sizeI = std::max(sizeI, pairMaxFeatures[p].first);
+      sizeJ = std::max(sizeJ, pairMaxFeatures[p].second);
     }
   }
 
-  // build the node indirection for each referenced feature
-  MapIndexToNode map_indexToNode;
-  map_indexToNode.reserve(allFeatures.size());
-  _d->map_nodeToIndex.reserve(allFeatures.size());
+  // assign a contiguous range of nodes to each (viewId, descType)
+  _d->ranges.clear();
+  _d->ranges.reserve(rangeSizes.size());
 
-  for(const IndexedFeaturePair& featPair: allFeatures)
+  std::size_t nbNodes = 0;
+  std::map<RangeKey, NodeIndex> rangeOffsets;
+  for(const auto& rangeSize: rangeSizes)
   {
-    lemon::ListDigraph::Node node = _d->graph.addNode();
-    map_indexToNode.insert(std::make_pair(featPair, node));
-    _d->map_nodeToIndex.insert(std::make_pair(node, featPair));
+    _d->ranges.push_back({rangeSize.first.first, rangeSize.first.second, NodeIndex(nbNodes)});
+    rangeOffsets[rangeSize.first] = NodeIndex(nbNodes);
+    nbNodes += rangeSize.second;
+
+    if(nbNodes >= UndefinedNodeIndex)
+      throw std::runtime_error("TracksBuilder: too many features to build tracks.");
   }
 
-  // add the element of myset to the UnionFind insert method.
-  _d->index.reset(new IndexMap(_d->graph));
-  _d->tracksUF.reset(new UnionFindObject(*_d->index));
+  std::vector<PairMatchesRef> pairMatchesRefs;
+  pairMatchesRefs.reserve(allPairMatches.size());
+  for(const PairMatchesInfo& pairMatches: allPairMatches)
+    pairMatchesRefs.push_back({rangeOffsets.at(pairMatches.keyI), rangeOffsets.at(pairMatches.keyJ), pairMatches.matches});
 
-  for(ListDigraph::NodeIt it(_d->graph); it != INVALID; ++it)
+  // make the union according the pair matches
+  std::vector<NodeIndex> nodeRoots(nbNodes);
   {
-    _d->tracksUF->insert(it);
+    std::vector<std::atomic<NodeIndex>> parents(nbNodes);
+
+#pragma omp parallel for
+    for(std::ptrdiff_t i = 0; i < std::ptrdiff_t(nbNodes); ++i)
+      parents[i].store(NodeIndex(i));
+
+#pragma omp parallel for schedule(dynamic)
+    for(std::size_t p = 0; p < pairMatchesRefs.size(); ++p)
+    {
+      const PairMatchesRef& pairMatches = pairMatchesRefs[p];
+      for(const IndMatch& m: *pairMatches.matches)
+        unite(parents, pairMatches.offsetI + NodeIndex(m._i), pairMatches.offsetJ + NodeIndex(m._j));
+    }
+
+#pragma omp parallel for
+    for(std::ptrdiff_t i = 0; i < std::ptrdiff_t(nbNodes); ++i)
+      nodeRoots[i] = findRoot(parents, NodeIndex(i));
   }
 
-  // make the union according the pair matches
-  for(const auto& matchesPerDescIt: pairwiseMatches)
-  {
-    const std::size_t& I = matchesPerDescIt.first.first;
-    const std::size_t& J = matchesPerDescIt.first.second;
-    const MatchesPerDescType& matchesPerDesc = matchesPerDescIt.second;
+  // group the nodes per track with a counting sort on their root,
+  // singletons are features that have not been matched
+  std::vector<NodeIndex> trackPositions(nbNodes, 0);
+  for(std::size_t i = 0; i < nbNodes; ++i)
+    ++trackPositions[nodeRoots[i]];
 
-    for(const auto& matchesIt: matchesPerDesc)
+  _d->trackOffsets.assign(1, 0);
+  std::size_t nbTrackNodes = 0;
+  for(std::size_t i = 0; i < nbNodes; ++i)
+  {
+    // the root of a track is its smallest node
+    if(nodeRoots[i] == i && trackPositions[i] > 1)
     {
-      const feature::EImageDescriberType descType = matchesIt.first;
-      const IndMatches& matches = matchesIt.second;
-      // we have correspondences between I and J image index.
-      for(const IndMatch& m: matches)
-      {
-        IndexedFeaturePair pairI(I, KeypointId(descType, m._i));
-        IndexedFeaturePair pairJ(J, KeypointId(descType, m._j));
-        _d->tracksUF->join(map_indexToNode[pairI], map_indexToNode[pairJ]);
-      }
+      const std::size_t trackSize = trackPositions[i];
+      trackPositions[i] = NodeIndex(nbTrackNodes);
+      nbTrackNodes += trackSize;
+      _d->trackOffsets.push_back(nbTrackNodes);
+    }
+    else if(nodeRoots[i] == i)
+    {
+      trackPositions[i] = UndefinedNodeIndex;
     }
   }
+
+  _d->trackNodes.resize(nbTrackNodes);
+  for(std::size_t i = 0; i < nbNodes; ++i)
+  {
+    NodeIndex& position = trackPositions[nodeRoots[i]];
+    if(position != UndefinedNodeIndex)
+      _d->trackNodes[position++] = NodeIndex(i);
+  }
 }
 
 void TracksBuilder::filter(bool clearForks, std::size_t minTrackLength, bool multithreaded)
@@ -132,49 +266,64 @@ void TracksBuilder::filter(bool clearForks, std::size_t minTrackLength, bool mul
   if(!clearForks && minTrackLength == 0)
       return;
 
-  std::set<int> set_classToErase;
+  const std::size_t nbTracks = _d->nbTracks();
+  std::vector<char> keepTrack(nbTracks, 0);
 
-#pragma omp parallel if(multithreaded)
-  for(lemon::UnionFindEnum<IndexMap>::ClassIt cit(*_d->tracksUF); cit != INVALID; ++cit)
+#pragma omp parallel for if(multithreaded)
+  for(std::size_t t = 0; t < nbTracks; ++t)
   {
+    const std::size_t begin = _d->trackOffsets[t];
+    const std::size_t end = _d->trackOffsets[t + 1];
 
-#pragma omp single nowait
+    // track nodes are sorted by view
+    std::size_t nbViews = 0;
+    std::size_t prevViewId = 0;
+    for(std::size_t i = begin; i < end; ++i)
     {
-      std::size_t cpt = 0;
-      std::set<std::size_t> myset;
-      for(lemon::UnionFindEnum<IndexMap>::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
-      {
-        myset.insert(_d->map_nodeToIndex[iit].first);
-        ++cpt;
-      }
-      if((clearForks && myset.size() != cpt) || myset.size() < minTrackLength)
-      {
-#pragma omp critical
-        set_classToErase.insert(cit.operator int());
-      }
+      const std::size_t viewId = _d->getRange(_d->trackNodes[i]).viewId;
+      if(i == begin || viewId != prevViewId)
+        ++nbViews;
+      prevViewId = viewId;
     }
+
+    const std::size_t cpt = end - begin;
+    keepTrack[t] = !((clearForks && nbViews != cpt) || nbViews < minTrackLength);
   }
 
-  std::for_each(set_classToErase.begin(), set_classToErase.end(),
-    std::bind1st(std::mem_fun(&UnionFindObject::eraseClass), _d->tracksUF.get()));
+  // compact the kept tracks
+  std::size_t nbTrackNodes = 0;
+  std::size_t nbKeptTracks = 0;
+  for(std::size_t t = 0; t < nbTracks; ++t)
+  {
+    const std::size_t begin = _d->trackOffsets[t];
+    const std::size_t end = _d->trackOffsets[t + 1];
+
+    if(!keepTrack[t])
+      continue;
+
+    std::copy(_d->trackNodes.begin() + begin, _d->trackNodes.begin() + end, _d->trackNodes.begin() + nbTrackNodes);
+    nbTrackNodes += end - begin;
+    _d->trackOffsets[++nbKeptTracks] = nbTrackNodes;
+  }
+  _d->trackOffsets.resize(nbKeptTracks + 1);
+  _d->trackNodes.resize(nbTrackNodes);
 }
 
 bool TracksBuilder::exportToStream(std::ostream& os)
 {
-  std::size_t cpt = 0;
-  for(lemon::UnionFindEnum< IndexMap >::ClassIt cit(*_d->tracksUF); cit != INVALID; ++cit)
+  for(std::size_t t = 0; t < _d->nbTracks(); ++t)
   {
-    os << "Class: " << cpt++ << std::endl;
-    std::size_t cptTrackLength = 0;
-    for(lemon::UnionFindEnum< IndexMap >::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
-    {
-      ++cptTrackLength;
-    }
-    os << "\t" << "track length: " << cptTrackLength << std::endl;
+    const std::size_t begin = _d->trackOffsets[t];
+    const std::size_t end = _d->trackOffsets[t + 1];
 
-    for(lemon::UnionFindEnum< IndexMap >::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
+    os << "Class: " << t << std::endl;
+    os << "\t" << "track length: " << (end - begin) << std::endl;
+
+    for(std::size_t i = begin; i < end; ++i)
     {
-      os << _d->map_nodeToIndex[ iit ].first << "  " << _d->map_nodeToIndex[ iit ].second << std::endl;
+      const NodeIndex node = _d->trackNodes[i];
+      const FeatureRange& range = _d->getRange(node);
+      os << range.viewId << "  " << KeypointId(range.descType, node - range.offset) << std::endl;
     }
   }
   return os.good();
@@ -184,30 +333,91 @@ void TracksBuilder::exportToSTL(TracksMap& allTracks) const
 {
   allTracks.clear();
 
-  std::size_t trackIndex = 0;
-  for(lemon::UnionFindEnum< IndexMap >::ClassIt cit(*_d->tracksUF); cit != INVALID; ++cit, ++trackIndex)
+  const std::size_t nbTracks = _d->nbTracks();
+  allTracks.reserve(nbTracks);
+
+  // track indexes are sorted, so they are inserted at the end of the flat map
+  for(std::size_t trackIndex = 0; trackIndex < nbTracks; ++trackIndex)
+    allTracks.emplace_hint(allTracks.end(), trackIndex, Track());
+
+#pragma omp parallel for
+  for(std::size_t t = 0; t < nbTracks; ++t)
   {
-    // create the output track
-    std::pair<TracksMap::iterator, bool> ret = allTracks.insert(std::make_pair(trackIndex, Track()));
+    Track& outTrack = (allTracks.begin() + t)->second;
+
+    const std::size_t begin = _d->trackOffsets[t];
+    const std::size_t end = _d->trackOffsets[t + 1];
 
-    Track& outTrack = ret.first->second;
+    outTrack.featPerView.reserve(end - begin);
 
-    for(lemon::UnionFindEnum< IndexMap >::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
+    for(std::size_t i = begin; i < end; ++i)
     {
-      const IndexedFeaturePair & currentPair = _d->map_nodeToIndex.at(iit);
+      const NodeIndex node = _d->trackNodes[i];
+      const FeatureRange& range = _d->getRange(node);
       // all descType inside the track will be the same
-      outTrack.descType = currentPair.second.descType;
-      outTrack.featPerView[currentPair.first] = currentPair.second.featIndex;
+      outTrack.descType = range.descType;
+      outTrack.featPerView[range.viewId] = node - range.offset;
+    }
+  }
+}
+
+void TracksBuilder::exportToCSR(TracksCSR& allTracks) const
+{
+  const std::size_t nbTracks = _d->nbTracks();
+
+  std::vector<std::size_t> trackIds(nbTracks);
+  std::vector<feature::EImageDescriberType> descTypes(nbTracks);
+  std::vector<std::size_t> trackOffsets(nbTracks + 1, 0);
+  std::vector<IndexT> obsViewIds(_d->trackNodes.size());
+  std::vector<IndexT> obsFeatIds(_d->trackNodes.size());
+
+  // number of observations per track:
+  // if the track has a fork, keep the last feature in the view like exportToSTL
+#pragma omp parallel for
+  for(std::size_t t = 0; t < nbTracks; ++t)
+  {
+    const std::size_t begin = _d->trackOffsets[t];
+    const std::size_t end = _d->trackOffsets[t + 1];
+
+    // track nodes are sorted by view, observations are written in place at the begin of the track range
+    std::size_t nbObservations = 0;
+    for(std::size_t i = begin; i < end; ++i)
+    {
+      const NodeIndex node = _d->trackNodes[i];
+      const FeatureRange& range = _d->getRange(node);
+      descTypes[t] = range.descType;
+      if(nbObservations == 0 || obsViewIds[begin + nbObservations - 1] != range.viewId)
+        ++nbObservations;
+      obsViewIds[begin + nbObservations - 1] = range.viewId;
+      obsFeatIds[begin + nbObservations - 1] = node - range.offset;
     }
+    trackIds[t] = t;
+    trackOffsets[t + 1] = nbObservations;
   }
+
+  for(std::size_t t = 0; t < nbTracks; ++t)
+    trackOffsets[t + 1] += trackOffsets[t];
+
+  // compact the observations (in order, each track is moved backward)
+  for(std::size_t t = 0; t < nbTracks; ++t)
+  {
+    const std::size_t srcBegin = _d->trackOffsets[t];
+    const std::size_t dstBegin = trackOffsets[t];
+    const std::size_t length = trackOffsets[t + 1] - dstBegin;
+    if(srcBegin == dstBegin)
+      continue;
+    std::copy(obsViewIds.begin() + srcBegin, obsViewIds.begin() + srcBegin + length, obsViewIds.begin() + dstBegin);
+    std::copy(obsFeatIds.begin() + srcBegin, obsFeatIds.begin() + srcBegin + length, obsFeatIds.begin() + dstBegin);
+  }
+  obsViewIds.resize(trackOffsets.back());
+  obsFeatIds.resize(trackOffsets.back());
+
+  allTracks.build(std::move(trackIds), std::move(descTypes), std::move(trackOffsets), std::move(obsViewIds), std::move(obsFeatIds));
 }
 
 std::size_t TracksBuilder::nbTracks() const
 {
-    std::size_t cpt = 0;
-    for(lemon::UnionFindEnum< IndexMap >::ClassIt cit(*_d->tracksUF); cit != lemon::INVALID; ++cit)
-        ++cpt;
-    return cpt;
+    return _d->nbTracks();
 }
 
 } // namespace track
@@ -7,8 +7,10 @@
 #pragma once
 
 #include <aliceVision/track/Track.hpp>
+#include <aliceVision/track/TracksCSR.hpp>
 
 #include <memory>
+#include <vector>
 
 
 namespace aliceVision {
@@ -30,6 +32,10 @@ struct TracksBuilderData;
  *
  * From map< [imageI,ImageJ], [indexed matches array] > it builds tracks.
  *
+ * Features of each (view, describer type) are mapped to a contiguous range of nodes
+ * of a flat union-find forest, merged in parallel over the pairs of views.
+ * Tracks are then grouped by their root (counting sort) and sorted by their first feature.
+ *
  * Usage:
  * @code{.cpp}
  *  PairWiseMatches matches;
@@ -54,6 +60,12 @@ public:
     */
     void build(const PairwiseMatches& pairwiseMatches);
 
+    /**
+    * @brief Build tracks for a subset of pairWise matches, referenced without copy
+    * @param[in] pairwiseMatches The pairs of views to use and their matches
+    */
+    void build(const std::vector<PairwiseMatches::const_iterator>& pairwiseMatches);
+
     /**
     * @brief Remove bad tracks (too short or track with ids collision)
     * @param[in] clearForks: remove tracks with multiple observation in a single image
@@ -75,6 +87,11 @@ public:
     */
     void exportToSTL(TracksMap& allTracks) const;
 
+    /**
+    * @brief Export tracks as CSR arrays, with the same track indexes than exportToSTL
+    */
+    void exportToCSR(TracksCSR& allTracks) const;
+
     /**
     * @brief Return the number of connected set in the UnionFind structure (tree forest)
     * @return number of connected set in the UnionFind structure
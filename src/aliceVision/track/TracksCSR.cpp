@@ -0,0 +1,199 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "TracksCSR.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace aliceVision {
+namespace track {
+
+TracksCSR::TracksCSR(const TracksMap& tracks)
+{
+  build(tracks);
+}
+
+void TracksCSR::build(const TracksMap& tracks)
+{
+  std::vector<std::size_t> trackIds;
+  std::vector<feature::EImageDescriberType> descTypes;
+  std::vector<std::size_t> trackOffsets;
+  std::vector<IndexT> obsViewIds;
+  std::vector<IndexT> obsFeatIds;
+
+  trackIds.reserve(tracks.size());
+  descTypes.reserve(tracks.size());
+  trackOffsets.reserve(tracks.size() + 1);
+  trackOffsets.push_back(0);
+
+  for(const auto& trackIt : tracks)
+  {
+    trackIds.push_back(trackIt.first);
+    descTypes.push_back(trackIt.second.descType);
+
+    // featPerView is sorted by view id
+    for(const auto& featIt : trackIt.second.featPerView)
+    {
+      obsViewIds.push_back(IndexT(featIt.first));
+      obsFeatIds.push_back(IndexT(featIt.second));
+    }
+    trackOffsets.push_back(obsViewIds.size());
+  }
+
+  build(std::move(trackIds), std::move(descTypes), std::move(trackOffsets), std::move(obsViewIds), std::move(obsFeatIds));
+}
+
+void TracksCSR::build(std::vector<std::size_t>&& trackIds,
+                      std::vector<feature::EImageDescriberType>&& descTypes,
+                      std::vector<std::size_t>&& trackOffsets,
+                      std::vector<IndexT>&& obsViewIds,
+                      std::vector<IndexT>&& obsFeatIds)
+{
+  if(descTypes.size() != trackIds.size() ||
+     trackOffsets.size() != trackIds.size() + 1 ||
+     obsViewIds.size() != obsFeatIds.size() ||
+     trackOffsets.back() != obsViewIds.size())
+    throw std::runtime_error("TracksCSR: inconsistent track arrays.");
+
+  if(trackIds.size() >= UndefinedIndexT)
+    throw std::runtime_error("TracksCSR: too many tracks.");
+
+  _trackIds = std::move(trackIds);
+  _descTypes = std::move(descTypes);
+  _trackOffsets = std::move(trackOffsets);
+  _obsViewIds = std::move(obsViewIds);
+  _obsFeatIds = std::move(obsFeatIds);
+
+  buildViewIndex();
+}
+
+void TracksCSR::clear()
+{
+  _trackIds.clear();
+  _descTypes.clear();
+  _trackOffsets.clear();
+  _obsViewIds.clear();
+  _obsFeatIds.clear();
+  _viewIds.clear();
+  _viewOffsets.clear();
+  _viewTrackIndexes.clear();
+  _viewFeatIds.clear();
+}
+
+void TracksCSR::buildViewIndex()
+{
+  // dense index of each view, view ids are not contiguous
+  std::unordered_map<IndexT, IndexT> viewIndexes;
+  for(IndexT viewId : _obsViewIds)
+    viewIndexes.emplace(viewId, 0);
+
+  _viewIds.clear();
+  _viewIds.reserve(viewIndexes.size());
+  for(const auto& viewIndex : viewIndexes)
+    _viewIds.push_back(viewIndex.first);
+  std::sort(_viewIds.begin(), _viewIds.end());
+
+  for(IndexT i = 0; i < _viewIds.size(); ++i)
+    viewIndexes[_viewIds[i]] = i;
+
+  std::vector<IndexT> obsViewIndexes(_obsViewIds.size());
+  for(std::size_t i = 0; i < _obsViewIds.size(); ++i)
+    obsViewIndexes[i] = viewIndexes.at(_obsViewIds[i]);
+
+  // counting sort of the observations per view,
+  // tracks are visited in increasing order so the track indexes of each view are sorted
+  _viewOffsets.assign(_viewIds.size() + 1, 0);
+  for(IndexT viewIndex : obsViewIndexes)
+    ++_viewOffsets[viewIndex + 1];
+  for(std::size_t v = 0; v < _viewIds.size(); ++v)
+    _viewOffsets[v + 1] += _viewOffsets[v];
+
+  _viewTrackIndexes.resize(_obsViewIds.size());
+  _viewFeatIds.resize(_obsViewIds.size());
+
+  std::vector<std::size_t> positions(_viewOffsets.begin(), _viewOffsets.end() - 1);
+  for(std::size_t t = 0; t < nbTracks(); ++t)
+  {
+    for(std::size_t i = trackBegin(t); i < trackEnd(t); ++i)
+    {
+      std::size_t& position = positions[obsViewIndexes[i]];
+      _viewTrackIndexes[position] = IndexT(t);
+      _viewFeatIds[position] = _obsFeatIds[i];
+      ++position;
+    }
+  }
+}
+
+IndexT TracksCSR::getFeatureInView(std::size_t trackIndex, IndexT viewId) const
+{
+  const auto begin = _obsViewIds.begin() + trackBegin(trackIndex);
+  const auto end = _obsViewIds.begin() + trackEnd(trackIndex);
+  const auto it = std::lower_bound(begin, end, viewId);
+  if(it == end || *it != viewId)
+    return UndefinedIndexT;
+  return _obsFeatIds[std::distance(_obsViewIds.begin(), it)];
+}
+
+IndexT TracksCSR::findTrackIndex(std::size_t trackId) const
+{
+  const auto it = std::lower_bound(_trackIds.begin(), _trackIds.end(), trackId);
+  if(it == _trackIds.end() || *it != trackId)
+    return UndefinedIndexT;
+  return IndexT(std::distance(_trackIds.begin(), it));
+}
+
+TracksCSR::ViewRange TracksCSR::getViewRange(IndexT viewId) const
+{
+  ViewRange range;
+  const auto it = std::lower_bound(_viewIds.begin(), _viewIds.end(), viewId);
+  if(it == _viewIds.end() || *it != viewId)
+    return range;
+  const std::size_t viewIndex = std::distance(_viewIds.begin(), it);
+  range.begin = _viewOffsets[viewIndex];
+  range.end = _viewOffsets[viewIndex + 1];
+  return range;
+}
+
+void TracksCSR::exportToSTL(TracksMap& tracks) const
+{
+  tracks.clear();
+  tracks.reserve(nbTracks());
+
+  for(std::size_t t = 0; t < nbTracks(); ++t)
+  {
+    Track& track = tracks.emplace_hint(tracks.end(), _trackIds[t], Track())->second;
+    track.descType = _descTypes[t];
+    track.featPerView.reserve(trackLength(t));
+    for(std::size_t i = trackBegin(t); i < trackEnd(t); ++i)
+      track.featPerView.emplace_hint(track.featPerView.end(), _obsViewIds[i], _obsFeatIds[i]);
+  }
+}
+
+std::size_t intersectSortedIndexes(const IndexT* a, std::size_t sizeA,
+                                   const IndexT* b, std::size_t sizeB,
+                                   IndexT* out)
+{
+  std::size_t i = 0;
+  std::size_t j = 0;
+  std::size_t k = 0;
+
+  // branchless merge: the loop only depends on comparisons results
+  while(i < sizeA && j < sizeB)
+  {
+    const IndexT va = a[i];
+    const IndexT vb = b[j];
+    out[k] = va;
+    k += (va == vb);
+    i += (va <= vb);
+    j += (vb <= va);
+  }
+  return k;
+}
+
+} // namespace track
+} // namespace aliceVision
@@ -0,0 +1,141 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/track/Track.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace aliceVision {
+namespace track {
+
+/**
+ * @brief Tracks stored in Compressed Sparse Row arrays.
+ *
+ * The observations of the track at index t are [trackBegin(t), trackEnd(t)) in the packed
+ * obsViewIds() / obsFeatIds() arrays, sorted by view id.
+ * The transposed index stores, for each view, the indexes of its tracks (sorted increasing)
+ * with the corresponding feature ids, in the packed viewTrackIndexes() / viewFeatIds() arrays.
+ *
+ * Track indexes are dense in [0, nbTracks()) and sorted by track id,
+ * so sorted track indexes are also sorted track ids.
+ */
+class TracksCSR
+{
+public:
+  /// observations range of a view in the transposed index
+  struct ViewRange
+  {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+
+    inline std::size_t size() const { return end - begin; }
+    inline bool empty() const { return begin == end; }
+  };
+
+  TracksCSR() = default;
+
+  /**
+   * @brief Build the CSR arrays from tracks stored as a map.
+   * @param[in] tracks the tracks as a map {trackId, track}
+   */
+  explicit TracksCSR(const TracksMap& tracks);
+
+  /**
+   * @brief Build the CSR arrays from tracks stored as a map.
+   * @param[in] tracks the tracks as a map {trackId, track}
+   */
+  void build(const TracksMap& tracks);
+
+  /**
+   * @brief Build from packed track arrays and compute the transposed index.
+   * @param[in] trackIds the id of each track (sorted increasing)
+   * @param[in] descTypes the describer type of each track
+   * @param[in] trackOffsets the observations offset of each track (nbTracks + 1 values)
+   * @param[in] obsViewIds the view id of each observation (sorted increasing in each track)
+   * @param[in] obsFeatIds the feature id of each observation
+   */
+  void build(std::vector<std::size_t>&& trackIds,
+             std::vector<feature::EImageDescriberType>&& descTypes,
+             std::vector<std::size_t>&& trackOffsets,
+             std::vector<IndexT>&& obsViewIds,
+             std::vector<IndexT>&& obsFeatIds);
+
+  void clear();
+
+  inline std::size_t nbTracks() const { return _trackIds.size(); }
+  inline std::size_t nbObservations() const { return _obsViewIds.size(); }
+
+  inline std::size_t trackId(std::size_t trackIndex) const { return _trackIds[trackIndex]; }
+  inline feature::EImageDescriberType descType(std::size_t trackIndex) const { return _descTypes[trackIndex]; }
+  inline std::size_t trackBegin(std::size_t trackIndex) const { return _trackOffsets[trackIndex]; }
+  inline std::size_t trackEnd(std::size_t trackIndex) const { return _trackOffsets[trackIndex + 1]; }
+  inline std::size_t trackLength(std::size_t trackIndex) const { return trackEnd(trackIndex) - trackBegin(trackIndex); }
+
+  inline const std::vector<IndexT>& obsViewIds() const { return _obsViewIds; }
+  inline const std::vector<IndexT>& obsFeatIds() const { return _obsFeatIds; }
+
+  /**
+   * @brief Get the feature id of a track in a view.
+   * @return UndefinedIndexT if the track is not visible in the view
+   */
+  IndexT getFeatureInView(std::size_t trackIndex, IndexT viewId) const;
+
+  /**
+   * @brief Find the index of a track from its id.
+   * @return UndefinedIndexT if the track does not exist
+   */
+  IndexT findTrackIndex(std::size_t trackId) const;
+
+  /// the view ids with at least one track (sorted increasing)
+  inline const std::vector<IndexT>& viewIds() const { return _viewIds; }
+
+  /**
+   * @brief Get the observations range of a view in the transposed index.
+   * @return an empty range if there is no track in the view
+   */
+  ViewRange getViewRange(IndexT viewId) const;
+
+  inline const std::vector<IndexT>& viewTrackIndexes() const { return _viewTrackIndexes; }
+  inline const std::vector<IndexT>& viewFeatIds() const { return _viewFeatIds; }
+
+  /**
+   * @brief Convert back to the map representation.
+   * @param[out] tracks the tracks as a map {trackId, track}
+   */
+  void exportToSTL(TracksMap& tracks) const;
+
+private:
+  void buildViewIndex();
+
+  // tracks
+  std::vector<std::size_t> _trackIds;
+  std::vector<feature::EImageDescriberType> _descTypes;
+  std::vector<std::size_t> _trackOffsets;
+  std::vector<IndexT> _obsViewIds;
+  std::vector<IndexT> _obsFeatIds;
+
+  // transposed index
+  std::vector<IndexT> _viewIds;
+  std::vector<std::size_t> _viewOffsets;
+  std::vector<IndexT> _viewTrackIndexes;
+  std::vector<IndexT> _viewFeatIds;
+};
+
+/**
+ * @brief Intersect two sorted arrays of indexes.
+ *        The output can be the first input array (in-place intersection).
+ * @return the number of common indexes written in \p out
+ */
+std::size_t intersectSortedIndexes(const IndexT* a, std::size_t sizeA,
+                                   const IndexT* b, std::size_t sizeB,
+                                   IndexT* out);
+
+} // namespace track
+} // namespace aliceVision
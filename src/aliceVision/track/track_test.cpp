@@ -180,6 +180,57 @@ BOOST_AUTO_TEST_CASE(Track_Conflict) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(Track_DescTypesAndLongChain) {
+
+  // A long chain of matches across many views, with the pairs in reverse order,
+  // and a second describer type using the same feature indexes.
+  const int nbViews = 50;
+  const int nbFeatures = 100;
+
+  PairwiseMatches map_pairwisematches;
+  for(int v = nbViews - 2; v >= 0; --v)
+  {
+    std::vector<IndMatch> sift;
+    std::vector<IndMatch> akaze;
+    for(int f = 0; f < nbFeatures; ++f)
+    {
+      sift.emplace_back(f, f);
+      // akaze features are shifted by one index at each view
+      akaze.emplace_back(f + v, f + v + 1);
+    }
+    map_pairwisematches[std::make_pair(v, v + 1)][EImageDescriberType::SIFT] = sift;
+    map_pairwisematches[std::make_pair(v, v + 1)][EImageDescriberType::AKAZE] = akaze;
+  }
+
+  TracksBuilder trackBuilder;
+  trackBuilder.build(map_pairwisematches);
+  BOOST_CHECK_EQUAL(2 * nbFeatures, trackBuilder.nbTracks());
+
+  TracksMap map_tracks;
+  trackBuilder.exportToSTL(map_tracks);
+  BOOST_CHECK_EQUAL(2 * nbFeatures, map_tracks.size());
+
+  for(const auto& trackIt : map_tracks)
+  {
+    const Track& track = trackIt.second;
+    BOOST_CHECK_EQUAL(nbViews, track.featPerView.size());
+
+    // tracks are sorted by their first feature (view, describer type, feature index)
+    const std::size_t f = trackIt.first % nbFeatures;
+    const EImageDescriberType expectedType = (trackIt.first < nbFeatures) ? EImageDescriberType::SIFT : EImageDescriberType::AKAZE;
+    BOOST_CHECK(expectedType == track.descType);
+
+    for(const auto& featIt : track.featPerView)
+    {
+      const std::size_t expectedFeat = (expectedType == EImageDescriberType::SIFT) ? f : f + featIt.first;
+      BOOST_CHECK_EQUAL(expectedFeat, featIt.second);
+    }
+  }
+
+  trackBuilder.filter(true, nbViews + 1);
+  BOOST_CHECK_EQUAL(0, trackBuilder.nbTracks());
+}
+
 BOOST_AUTO_TEST_CASE(Track_GetCommonTracksInImages)
 {
   {
@@ -228,3 +279,87 @@ BOOST_AUTO_TEST_CASE(Track_GetCommonTracksInImages)
     BOOST_CHECK_EQUAL(base.size(), set_visibleTracks.size());
   }
 }
+
+BOOST_AUTO_TEST_CASE(Track_CSR)
+{
+  // tracks with a fork in view 5 and views sharing only a subset of the tracks
+  PairwiseMatches map_pairwisematches;
+  map_pairwisematches[std::make_pair(0, 1)][EImageDescriberType::UNKNOWN] = {IndMatch(0,0), IndMatch(1,1), IndMatch(2,2), IndMatch(3,3)};
+  map_pairwisematches[std::make_pair(1, 2)][EImageDescriberType::UNKNOWN] = {IndMatch(0,0), IndMatch(1,1), IndMatch(3,3), IndMatch(4,4)};
+  map_pairwisematches[std::make_pair(2, 5)][EImageDescriberType::UNKNOWN] = {IndMatch(0,0), IndMatch(3,3), IndMatch(4,4)};
+  map_pairwisematches[std::make_pair(0, 5)][EImageDescriberType::UNKNOWN] = {IndMatch(2,5), IndMatch(2,6)};
+
+  TracksBuilder trackBuilder;
+  trackBuilder.build(map_pairwisematches);
+
+  TracksMap map_tracks;
+  trackBuilder.exportToSTL(map_tracks);
+
+  TracksCSR tracksCSR;
+  trackBuilder.exportToCSR(tracksCSR);
+  BOOST_CHECK_EQUAL(map_tracks.size(), tracksCSR.nbTracks());
+
+  // same tracks than the map representation
+  TracksMap map_tracksFromCSR;
+  tracksCSR.exportToSTL(map_tracksFromCSR);
+  BOOST_REQUIRE_EQUAL(map_tracks.size(), map_tracksFromCSR.size());
+  for(const auto& trackIt : map_tracks)
+  {
+    const Track& trackCSR = map_tracksFromCSR.at(trackIt.first);
+    BOOST_CHECK(trackIt.second.descType == trackCSR.descType);
+    BOOST_CHECK(trackIt.second.featPerView == trackCSR.featPerView);
+  }
+
+  TracksPerView map_tracksPerView;
+  computeTracksPerView(map_tracks, map_tracksPerView);
+  BOOST_CHECK_EQUAL(map_tracksPerView.size(), tracksCSR.viewIds().size());
+
+  TracksPerView map_tracksPerViewCSR;
+  computeTracksPerView(tracksCSR, map_tracksPerViewCSR);
+  BOOST_CHECK(map_tracksPerView == map_tracksPerViewCSR);
+
+  std::map<std::size_t, std::size_t> occurenceTrackLength;
+  std::map<std::size_t, std::size_t> occurenceTrackLengthCSR;
+  tracksLength(map_tracks, occurenceTrackLength);
+  tracksLength(tracksCSR, occurenceTrackLengthCSR);
+  BOOST_CHECK(occurenceTrackLength == occurenceTrackLengthCSR);
+
+  // a track id without track is ignored
+  std::set<std::size_t> allTrackIds;
+  getTracksIdVector(map_tracks, &allTrackIds);
+  allTrackIds.insert(map_tracks.size() + 10);
+  for(const aliceVision::IndexT viewId : tracksCSR.viewIds())
+  {
+    std::vector<FeatureId> featuresId;
+    std::vector<FeatureId> featuresIdCSR;
+    getFeatureIdInViewPerTrack(map_tracks, allTrackIds, viewId, &featuresId);
+    getFeatureIdInViewPerTrack(tracksCSR, allTrackIds, viewId, &featuresIdCSR);
+    BOOST_CHECK(featuresId == featuresIdCSR);
+  }
+
+  const std::vector<std::set<std::size_t>> imageSets = {{0, 1}, {1, 2}, {0, 2, 5}, {1, 5}, {0, 1, 2, 5}, {0, 3}};
+  for(const std::set<std::size_t>& imageIndexes : imageSets)
+  {
+    TracksMap commonTracks;
+    TracksMap commonTracksCSR;
+    const bool found = getCommonTracksInImagesFast(imageIndexes, map_tracks, map_tracksPerView, commonTracks);
+    const bool foundCSR = getCommonTracksInImagesFast(imageIndexes, tracksCSR, commonTracksCSR);
+    BOOST_CHECK_EQUAL(found, foundCSR);
+    BOOST_REQUIRE_EQUAL(commonTracks.size(), commonTracksCSR.size());
+    for(const auto& trackIt : commonTracks)
+      BOOST_CHECK(trackIt.second.featPerView == commonTracksCSR.at(trackIt.first).featPerView);
+
+    const std::set<aliceVision::IndexT> imagesId(imageIndexes.begin(), imageIndexes.end());
+    std::set<aliceVision::IndexT> tracksIds;
+    std::set<aliceVision::IndexT> tracksIdsCSR;
+    getTracksInImagesFast(imagesId, map_tracksPerView, tracksIds);
+    getTracksInImagesFast(imagesId, tracksCSR, tracksIdsCSR);
+    BOOST_CHECK(tracksIds == tracksIdsCSR);
+  }
+
+  // in-place intersection
+  std::vector<aliceVision::IndexT> a{1, 3, 4, 7, 9, 12};
+  const std::vector<aliceVision::IndexT> b{0, 3, 7, 8, 12, 15};
+  a.resize(intersectSortedIndexes(a.data(), a.size(), b.data(), b.size(), a.data()));
+  BOOST_CHECK(a == std::vector<aliceVision::IndexT>({3, 7, 12}));
+}
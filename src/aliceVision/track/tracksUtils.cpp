@@ -7,6 +7,7 @@
 
 #include "tracksUtils.hpp"
 
+#include <algorithm>
 #include <iterator>
 
 
@@ -120,6 +121,77 @@ bool getCommonTracksInImagesFast(const std::set<std::size_t>& imageIndexes,
   return !tracksOut.empty();
 }
 
+void getCommonTracksInImages(const std::set<std::size_t>& imageIndexes,
+                             const TracksCSR& tracks,
+                             std::vector<IndexT>& trackIndexes)
+{
+  assert(!imageIndexes.empty());
+  trackIndexes.clear();
+
+  std::vector<TracksCSR::ViewRange> ranges;
+  ranges.reserve(imageIndexes.size());
+  for(std::size_t imageIndex : imageIndexes)
+  {
+    ranges.push_back(tracks.getViewRange(IndexT(imageIndex)));
+    // one image has no track, so there is no track in common
+    if(ranges.back().empty())
+      return;
+  }
+
+  // start from the smallest list of tracks
+  std::sort(ranges.begin(), ranges.end(), [](const TracksCSR::ViewRange& a, const TracksCSR::ViewRange& b) {
+    return a.size() < b.size();
+  });
+
+  const IndexT* viewTrackIndexes = tracks.viewTrackIndexes().data();
+  trackIndexes.assign(viewTrackIndexes + ranges.front().begin, viewTrackIndexes + ranges.front().end);
+
+  for(std::size_t r = 1; r < ranges.size() && !trackIndexes.empty(); ++r)
+  {
+    const std::size_t nbCommon = intersectSortedIndexes(trackIndexes.data(), trackIndexes.size(),
+                                                        viewTrackIndexes + ranges[r].begin, ranges[r].size(),
+                                                        trackIndexes.data());
+    trackIndexes.resize(nbCommon);
+  }
+}
+
+bool getCommonTracksInImagesFast(const std::set<std::size_t>& imageIndexes,
+                                 const TracksCSR& tracks,
+                                 TracksMap& tracksOut)
+{
+  assert(!imageIndexes.empty());
+  tracksOut.clear();
+
+  std::vector<IndexT> trackIndexes;
+  getCommonTracksInImages(imageIndexes, tracks, trackIndexes);
+
+  tracksOut.reserve(trackIndexes.size());
+
+  const std::vector<IndexT>& obsViewIds = tracks.obsViewIds();
+  const std::vector<IndexT>& obsFeatIds = tracks.obsFeatIds();
+
+  // track indexes are sorted, so the track ids are inserted at the end of the map
+  for(IndexT trackIndex : trackIndexes)
+  {
+    Track& trackFeatsOut = tracksOut.emplace_hint(tracksOut.end(), tracks.trackId(trackIndex), Track())->second;
+    trackFeatsOut.descType = tracks.descType(trackIndex);
+    trackFeatsOut.featPerView.reserve(imageIndexes.size());
+
+    // both the track observations and the image indexes are sorted by view id
+    std::size_t i = tracks.trackBegin(trackIndex);
+    const std::size_t end = tracks.trackEnd(trackIndex);
+    for(std::size_t imageIndex : imageIndexes)
+    {
+      while(i < end && obsViewIds[i] < imageIndex)
+        ++i;
+      if(i < end && obsViewIds[i] == imageIndex)
+        trackFeatsOut.featPerView.emplace_hint(trackFeatsOut.featPerView.end(), imageIndex, obsFeatIds[i]);
+    }
+    assert(trackFeatsOut.featPerView.size() == imageIndexes.size());
+  }
+  return !tracksOut.empty();
+}
+
 void getTracksInImages(const std::set<std::size_t>& imagesId,
                        const TracksMap& tracks,
                        std::set<std::size_t>& tracksId)
@@ -146,6 +218,26 @@ void getTracksInImagesFast(const std::set<IndexT>& imagesId,
   }
 }
 
+void getTracksInImagesFast(const std::set<IndexT>& imagesId,
+                           const TracksCSR& tracks,
+                           std::set<IndexT>& tracksIds)
+{
+  tracksIds.clear();
+
+  std::vector<IndexT> trackIndexes;
+  for(const IndexT id : imagesId)
+  {
+    const TracksCSR::ViewRange range = tracks.getViewRange(id);
+    trackIndexes.insert(trackIndexes.end(), tracks.viewTrackIndexes().begin() + range.begin, tracks.viewTrackIndexes().begin() + range.end);
+  }
+  std::sort(trackIndexes.begin(), trackIndexes.end());
+  trackIndexes.erase(std::unique(trackIndexes.begin(), trackIndexes.end()), trackIndexes.end());
+
+  // sorted insertion at the end of the set
+  for(IndexT trackIndex : trackIndexes)
+    tracksIds.emplace_hint(tracksIds.end(), IndexT(tracks.trackId(trackIndex)));
+}
+
 void getTracksInImage(const std::size_t& imageIndex,
                              const TracksMap& tracks,
                              std::set<std::size_t>& tracksIds)
@@ -194,6 +286,21 @@ void computeTracksPerView(const TracksMap& tracks, TracksPerView& tracksPerView)
   }
 }
 
+void computeTracksPerView(const TracksCSR& tracks, TracksPerView& tracksPerView)
+{
+  const std::vector<IndexT>& viewTrackIndexes = tracks.viewTrackIndexes();
+
+  // the track indexes of each view are sorted, so are the track ids
+  for(IndexT viewId : tracks.viewIds())
+  {
+    const TracksCSR::ViewRange range = tracks.getViewRange(viewId);
+    TrackIdSet& tracksSet = tracksPerView[viewId];
+    tracksSet.reserve(tracksSet.size() + range.size());
+    for(std::size_t i = range.begin; i < range.end; ++i)
+      tracksSet.push_back(tracks.trackId(viewTrackIndexes[i]));
+  }
+}
+
 void getTracksIdVector(const TracksMap& tracks,
                               std::set<std::size_t>* tracksIds)
 {
@@ -224,6 +331,26 @@ bool getFeatureIdInViewPerTrack(const TracksMap& allTracks,
   return !out_featId->empty();
 }
 
+bool getFeatureIdInViewPerTrack(const TracksCSR& allTracks,
+                                const std::set<std::size_t>& trackIds,
+                                IndexT viewId,
+                                std::vector<FeatureId>* out_featId)
+{
+  for(std::size_t trackId: trackIds)
+  {
+    const IndexT trackIndex = allTracks.findTrackIndex(trackId);
+
+    // ignore it if the track doesn't exist
+    if(trackIndex == UndefinedIndexT)
+      continue;
+
+    const IndexT featId = allTracks.getFeatureInView(trackIndex, viewId);
+    if(featId != UndefinedIndexT)
+      out_featId->emplace_back(allTracks.descType(trackIndex), featId);
+  }
+  return !out_featId->empty();
+}
+
 void tracksToIndexedMatches(const TracksMap& tracks,
                                    const std::vector<IndexT>& filterIndex,
                                    std::vector<IndMatch>* out_index)
@@ -264,6 +391,13 @@ void tracksLength(const TracksMap& tracks,
   }
 }
 
+void tracksLength(const TracksCSR& tracks,
+                  std::map<std::size_t, std::size_t>& occurenceTrackLength)
+{
+  for(std::size_t trackIndex = 0; trackIndex < tracks.nbTracks(); ++trackIndex)
+    ++occurenceTrackLength[tracks.trackLength(trackIndex)];
+}
+
 void imageIdInTracks(const TracksPerView& tracksPerView,
                             std::set<std::size_t>& imagesId)
 {
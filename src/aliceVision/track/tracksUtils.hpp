@@ -7,6 +7,7 @@
 
 #pragma once
 #include <aliceVision/track/Track.hpp>
+#include <aliceVision/track/TracksCSR.hpp>
 
 
 namespace aliceVision {
@@ -44,6 +45,26 @@ bool getCommonTracksInImagesFast(const std::set<std::size_t>& imageIndexes,
                                           const TracksPerView& tracksPerView,
                                           TracksMap& tracksOut);
   
+/**
+ * @brief Find common tracks among a set of images.
+ * @param[in] imageIndexes: set of images we are looking for common tracks.
+ * @param[in] tracks: all tracks of the scene in CSR arrays.
+ * @param[out] trackIndexes: output with the indexes of the common tracks (sorted increasing).
+ */
+void getCommonTracksInImages(const std::set<std::size_t>& imageIndexes,
+                             const TracksCSR& tracks,
+                             std::vector<IndexT>& trackIndexes);
+
+/**
+ * @brief Find common tracks among images.
+ * @param[in] imageIndexes: set of images we are looking for common tracks.
+ * @param[in] tracks: all tracks of the scene in CSR arrays.
+ * @param[out] tracksOut: output with only the common tracks.
+ */
+bool getCommonTracksInImagesFast(const std::set<std::size_t>& imageIndexes,
+                                 const TracksCSR& tracks,
+                                 TracksMap& tracksOut);
+
 /**
  * @brief Find all the visible tracks from a set of images.
  * @param[in] imagesId set of images we are looking for tracks.
@@ -64,6 +85,16 @@ void getTracksInImagesFast(const std::set<IndexT>& imagesId,
                                   const TracksPerView& tracksPerView,
                                   std::set<IndexT>& tracksIds);
 
+/**
+ * @brief Find all the visible tracks from a set of images.
+ * @param[in] imagesId set of images we are looking for tracks.
+ * @param[in] tracks all tracks of the scene in CSR arrays.
+ * @param[out] tracksId the tracks in the images
+ */
+void getTracksInImagesFast(const std::set<IndexT>& imagesId,
+                           const TracksCSR& tracks,
+                           std::set<IndexT>& tracksIds);
+
 /**
  * @brief Find all the visible tracks from a single image.
  * @param[in] imageIndex of the image we are looking for tracks.
@@ -91,6 +122,13 @@ void getTracksInImageFast(const std::size_t& imageId,
  */
 void computeTracksPerView(const TracksMap& tracks, TracksPerView& tracksPerView);
 
+/**
+ * @brief Compute the number of tracks for each view
+ * @param[in] tracks all tracks of the scene in CSR arrays
+ * @param[out] tracksPerView : for each view the id of the visible tracks as a map {viewID, vector<trackID>}
+ */
+void computeTracksPerView(const TracksCSR& tracks, TracksPerView& tracksPerView);
+
 /**
  * @brief Return the tracksId as a set (sorted increasing)
  * @param[in] tracks all tracks of the scene as a map {trackId, track}
@@ -112,6 +150,19 @@ bool getFeatureIdInViewPerTrack(const TracksMap& allTracks,
                                        IndexT viewId,
                                        std::vector<FeatureId>* out_featId);
 
+/**
+ * @brief Get feature id (with associated describer type) in the specified view for each TrackId
+ * @param[in] allTracks all tracks of the scene in CSR arrays
+ * @param[in] trackIds the tracks in the images
+ * @param[in] viewId: ImageId we are looking for features
+ * @param[out] out_featId the number of features in the image as a vector
+ * @return true if the vector of features Ids is not empty
+ */
+bool getFeatureIdInViewPerTrack(const TracksCSR& allTracks,
+                                const std::set<std::size_t>& trackIds,
+                                IndexT viewId,
+                                std::vector<FeatureId>* out_featId);
+
 
 struct FunctorMapFirstEqual : public std::unary_function <TracksMap , bool>
 {
@@ -150,6 +201,14 @@ void tracksToIndexedMatches(const TracksMap& tracks,
 void tracksLength(const TracksMap& tracks,
                          std::map<std::size_t, std::size_t>& occurenceTrackLength);
 
+/**
+ * @brief Return the occurrence of tracks length.
+ * @param[in] tracks all tracks of the scene in CSR arrays
+ * @param[out] occurenceTrackLength : the occurence length of each trackId in the scene
+ */
+void tracksLength(const TracksCSR& tracks,
+                  std::map<std::size_t, std::size_t>& occurenceTrackLength);
+
 /**
  * @brief Return a set containing the image Id considered in the tracks container.
  * @param[in] tracksPerView the visible tracks as a map {viewID, vector<trackID>}
@@ -8,6 +8,7 @@
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/tail.hpp>
 #include <boost/progress.hpp>
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <stdexcept>
@@ -26,6 +27,30 @@ std::ostream& operator<<(std::ostream& os, const SparseHistogram &dv)
 	return os;
 }
 
+namespace {
+
+/// distance methods between sparse histograms (see sparseDistance)
+enum class EDistanceMethod
+{
+  CLASSIC,
+  COMMON_POINTS,
+  STRONG_COMMON_POINTS,
+  WEIGHTED_STRONG_COMMON_POINTS,
+  INVERSED_WEIGHTED_COMMON_POINTS
+};
+
+EDistanceMethod EDistanceMethod_stringToEnum(const std::string& distanceMethod)
+{
+  if(distanceMethod == "classic")                      return EDistanceMethod::CLASSIC;
+  if(distanceMethod == "commonPoints")                 return EDistanceMethod::COMMON_POINTS;
+  if(distanceMethod == "strongCommonPoints")           return EDistanceMethod::STRONG_COMMON_POINTS;
+  if(distanceMethod == "weightedStrongCommonPoints")   return EDistanceMethod::WEIGHTED_STRONG_COMMON_POINTS;
+  if(distanceMethod == "inversedWeightedCommonPoints") return EDistanceMethod::INVERSED_WEIGHTED_COMMON_POINTS;
+  throw std::invalid_argument("distance method "+ distanceMethod +" unknown!");
+}
+
+} // namespace
+
 Database::Database(uint32_t num_words)
 : word_files_(num_words),
 word_weights_( num_words, 1.0f ) { }
@@ -35,17 +60,29 @@ DocId Database::insert(DocId doc_id, const SparseHistogram& document)
   // Ensure that the new document to insert is not already there.
   assert(database_.find(doc_id) == database_.end());
 
+  const uint32_t index = documentIds_.size();
+  uint32_t nbWords = 0;
+
   // For each word, retrieve its inverted file and increment the count for doc_id.
   for(SparseHistogram::const_iterator it = document.begin(), end = document.end(); it != end; ++it)
   {
     Word word = it->first;
+    if(static_cast<std::size_t>(word) >= word_files_.size())
+    {
+      // database created without the size of the vocabulary
+      word_files_.resize(word + 1);
+      word_weights_.resize(word + 1, 1.0f);
+    }
     InvertedFile& file = word_files_[word];
-    if(file.empty() || file.back().id != doc_id)
-      file.push_back(WordFrequency(doc_id, it->second.size()));
+    if(file.empty() || file.back().index != index)
+      file.push_back(WordFrequency(index, it->second.size()));
     else
       file.back().count += it->second.size();
+    nbWords += it->second.size();
   }
 
+  documentIds_.push_back(doc_id);
+  documentSizes_.push_back(nbWords);
   database_[doc_id] = document;
 
   return doc_id;
@@ -69,16 +106,28 @@ void Database::sanityCheck(std::size_t N, std::map<std::size_t, DocMatches>& mat
   matches.clear();
   // since we already know the size of the vectors, in order to parallelize the 
   // query allocate the whole memory
-  boost::progress_display display(database_.size());
-  
-  //#pragma omp parallel for default(none) shared(database_)
+  std::vector<const SparseHistogramPerImage::value_type*> documents;
+  documents.reserve(database_.size());
   for(const auto &doc : database_)
   {
+    documents.push_back(&doc);
+    matches[doc.first];
+  }
+
+  boost::progress_display display(documents.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < static_cast<int>(documents.size()); ++i)
+  {
+    const auto& doc = *documents[i];
     std::vector<DocMatch> m;
     find(doc.second, N, m);
-    //		matches.emplace_back( m );
-    matches[doc.first] = m;
-    ++display;
+
+    #pragma omp critical
+    {
+      matches.at(doc.first) = std::move(m);
+      ++display;
+    }
   }
 }
 
@@ -110,15 +159,81 @@ void Database::find(const std::vector<Word>& document, std::size_t N, std::vecto
  */
 void Database::find( const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod) const
 {
+    const EDistanceMethod method = EDistanceMethod_stringToEnum(distanceMethod);
+    const std::size_t nbDocuments = documentIds_.size();
+    const float epsilon{0.001f};
+
+    // accumulate the score of the words in common with the query
+    // for the documents of the inverted files of the query words
+    std::vector<float> scores(nbDocuments, 0.0f);
+    std::vector<bool> isScored(nbDocuments, false);
+    std::vector<uint32_t> scoredDocuments;
+    float querySize{0.0f};
+
+    for(const auto& queryWord : query)
+    {
+        const Word word = queryWord.first;
+        const std::size_t queryCount = queryWord.second.size();
+        querySize += queryCount;
+
+        if(static_cast<std::size_t>(word) >= word_files_.size())
+          continue;
+
+        for(const WordFrequency& wordFrequency : word_files_[word])
+        {
+            float score{0.0f};
+            switch(method)
+            {
+                case EDistanceMethod::CLASSIC:
+                case EDistanceMethod::COMMON_POINTS:
+                    score = std::min<std::size_t>(queryCount, wordFrequency.count);
+                    break;
+                case EDistanceMethod::STRONG_COMMON_POINTS:
+                    if((std::fabs(queryCount - 1.f) < epsilon) && (std::fabs(wordFrequency.count - 1.f) < epsilon))
+                      score = 1.0f;
+                    break;
+                case EDistanceMethod::WEIGHTED_STRONG_COMMON_POINTS:
+                    if((std::fabs(queryCount - 1.f) < epsilon) && (std::fabs(wordFrequency.count - 1.f) < epsilon))
+                      score = word_weights_[word];
+                    break;
+                case EDistanceMethod::INVERSED_WEIGHTED_COMMON_POINTS:
+                    score = (1.f / std::min<std::size_t>(queryCount, wordFrequency.count)) * word_weights_[word];
+                    break;
+            }
+
+            scores[wordFrequency.index] += score;
+            if(!isScored[wordFrequency.index])
+            {
+                isScored[wordFrequency.index] = true;
+                scoredDocuments.push_back(wordFrequency.index);
+            }
+        }
+    }
+
     matches.clear();
-    matches.reserve(database_.size());
-    for(const auto& document : database_)
+
+    if(method == EDistanceMethod::CLASSIC)
     {
-        // for each document/image in the database compute the distance between the
-        // histograms of the query image and the others
-        const float distance = sparseDistance(query, document.second, distanceMethod, word_weights_);
-        matches.emplace_back(document.first, distance);
+        // the sum of the absolute differences of the word counts depends on the size of all the documents:
+        // sum(|a - b|) = |query| + |document| - 2 * sum(min(a, b))
+        matches.reserve(nbDocuments);
+        for(std::size_t i = 0; i < nbDocuments; ++i)
+          matches.emplace_back(documentIds_[i], querySize + documentSizes_[i] - 2.0f * scores[i]);
     }
+    else
+    {
+        // the other distances are -score, the documents without any word in common with the query have a distance of 0
+        matches.reserve(std::max(scoredDocuments.size(), std::min(N, nbDocuments)));
+        for(const uint32_t i : scoredDocuments)
+          matches.emplace_back(documentIds_[i], -scores[i]);
+
+        for(std::size_t i = 0; i < nbDocuments && matches.size() < N; ++i)
+        {
+          if(!isScored[i])
+            matches.emplace_back(documentIds_[i], 0.0f);
+        }
+    }
+
     const std::size_t nMatches = std::min(N, matches.size());
     std::partial_sort(matches.begin(), matches.begin() + nMatches, matches.end());
     matches.resize(nMatches);
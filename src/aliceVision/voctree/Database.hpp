@@ -77,7 +77,7 @@ public:
 
   /**
    * @brief Perform a sanity check of the database by querying each document
-   * of the database and finding its top N matches
+   * of the database and finding its top N matches (the queries are run in parallel)
    * 
    * @param[in] N The number of matches to return.
    * @param[out] matches IDs and scores for the top N matching database documents.
@@ -97,6 +97,10 @@ public:
     /**
    * @brief Find the top N matches in the database for the query document.
    *
+   * Only the documents sharing words with the query are scored, using the inverted files.
+   * The other documents are only returned to complete the N matches.
+   * This method is thread-safe.
+   *
    * @param[in] query The query document, a normalized set of quantized words.
    * @param[int] N        The number of matches to return.
    * @param[in] distanceMethod distance method (norm L1, etc.)
@@ -136,17 +140,18 @@ private:
 
   struct WordFrequency
   {
-    DocId id;
+    /// index of the document in documentIds_
+    uint32_t index;
     uint32_t count;
 
     WordFrequency() = default;
-    WordFrequency(DocId _id, uint32_t _count)
-      : id(_id)
+    WordFrequency(uint32_t _index, uint32_t _count)
+      : index(_index)
       , count(_count)
     {}
   };
 
-  // Stored in increasing order by DocId
+  // Stored in increasing order by document index
   typedef std::vector<WordFrequency> InvertedFile;
 
   /// @todo Use sorted vector?
@@ -157,6 +162,8 @@ private:
   std::vector<InvertedFile> word_files_;
   std::vector<float> word_weights_;
   SparseHistogramPerImage database_; // Precomputed for inserted documents
+  std::vector<DocId> documentIds_; // DocId of each document index of the inverted files
+  std::vector<uint32_t> documentSizes_; // number of words of each document index
 
   /**
    * Normalize a document vector representing the histogram of visual words for a given image
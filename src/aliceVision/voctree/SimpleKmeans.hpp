@@ -10,6 +10,7 @@
 #include "DefaultAllocator.hpp"
 
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/function.hpp>
 #include <boost/foreach.hpp>
@@ -253,6 +254,35 @@ bool checkVectorElements(const std::vector<Feature, FeatureAllocator> &f, const
   return correct;
 }
 
+/**
+ * @brief Distances between a feature and the k cluster centers.
+ *
+ * Generic version calling the distance functor for each center.
+ */
+template<class Feature, class Distance>
+struct KmeansCentersDistances
+{
+  typedef typename Distance::result_type result_type;
+
+  static void compute(const Distance& distance, const Feature& feature, const Feature* centers, std::size_t k, result_type* out)
+  {
+    for(std::size_t j = 0; j < k; ++j)
+      out[j] = distance(feature, centers[j]);
+  }
+};
+
+/// L2 distances, computed with the batched SIMD kernels when available (see CentersDistances).
+template<class Feature>
+struct KmeansCentersDistances<Feature, L2<Feature, Feature> >
+{
+  typedef typename CentersDistances<Feature, L2, Feature>::result_type result_type;
+
+  static void compute(const L2<Feature, Feature>&, const Feature& feature, const Feature* centers, std::size_t k, result_type* out)
+  {
+    CentersDistances<Feature, L2, Feature>::compute(&feature, 1, centers, k, out);
+  }
+};
+
 /**
  * @brief Class for performing K-means clustering, optimized for a particular feature type and metric.
  *
@@ -420,10 +450,19 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector
   typedef typename std::vector<Feature, FeatureAllocator>::value_type centerType;
   typedef typename Distance::value_type feature_value_type;
 
+  typedef KmeansCentersDistances<Feature, Distance> CentersDistancesT;
+  typedef typename CentersDistancesT::result_type centers_distance_type;
+
   std::vector<std::size_t> new_center_counts(k);
   std::vector<Feature, FeatureAllocator> new_centers(k);
   squared_distance_type max_center_shift = std::numeric_limits<squared_distance_type>::max();
 
+  // per thread buffers
+  const int nbThreads = omp_get_max_threads();
+  std::vector<Feature, FeatureAllocator> thread_centers(nbThreads * k, zero_);
+  std::vector<std::size_t> thread_center_counts(nbThreads * k);
+  std::vector<centers_distance_type> thread_distances(nbThreads * k);
+
   if(verbose_ > 0) ALICEVISION_LOG_DEBUG("Iterations");
   for(std::size_t iter = 0; iter < max_iterations_; ++iter)
   {
@@ -438,31 +477,23 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector
 
 
     // Assign data objects to current centers
-    #pragma omp parallel for shared( new_centers, new_center_counts, features, centers, membership)
+    // each thread accumulates the cluster centers and their membership counts of its features
+    std::fill(thread_centers.begin(), thread_centers.end(), zero_);
+    std::fill(thread_center_counts.begin(), thread_center_counts.end(), 0);
+
+    #pragma omp parallel for reduction(&&:is_stable)
     for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
     {
-      squared_distance_type d_min = std::numeric_limits<squared_distance_type>::max();
-      unsigned int nearest = 0;
-      bool found = false;
+      const int thread = omp_get_thread_num();
+      centers_distance_type* distances = &thread_distances[thread * k];
 
       // @todo if k is large, let's say k>100 use FLAAN to retrieve the 
       // cluster center
 
       // Find the nearest cluster center to feature i
-      for(unsigned int j = 0; j < k; ++j)
-      {
-        squared_distance_type distance = distance_(*features[i], centers[j]);
-        //		printf("\t\tdistance %f\n", (float)distance);
-        //		PrintFeat(*features[i] );
-        if(distance < d_min)
-        {
-          d_min = distance;
-          nearest = j;
-          found = true;
-        }
-        //		 printf("\t distance %f %f\n", (double)distance, (double)d_min);
-      }
-      assert(found);
+      CentersDistancesT::compute(distance_, *features[i], &centers[0], k, distances);
+      const unsigned int nearest = std::min_element(distances, distances + k) - distances;
+
       // Assign feature i to the cluster it is nearest to
       if(membership[i] != nearest)
       {
@@ -470,17 +501,19 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector
         membership[i] = nearest;
       }
       // Accumulate the cluster center and its membership count
-      //	  printf("\t nearest %d\n", nearest);
-      //			checkElements(*features[i], "feat");
-      #pragma omp critical
+      thread_centers[thread * k + nearest] += *features[i];
+      ++thread_center_counts[thread * k + nearest];
+    }//for
+
+    // merge the accumulations of the threads, always in the same order
+    for(int thread = 0; thread < nbThreads; ++thread)
+    {
+      for(std::size_t i = 0; i < k; ++i)
       {
-        new_centers[nearest] += *features[i];
-        //			checkElements(new_centers[nearest], "sum");
-        //	  printf("\t new_centers[nearest] += *features[i];\n");
-        ++new_center_counts[nearest];
-        //	  printf("\taccumulate\n");
+        new_centers[i] += thread_centers[thread * k + i];
+        new_center_counts[i] += thread_center_counts[thread * k + i];
       }
-    }//for
+    }
 
     if(is_stable) break;
 
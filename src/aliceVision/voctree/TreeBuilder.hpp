@@ -8,12 +8,39 @@
 
 #include "MutableVocabularyTree.hpp"
 #include "SimpleKmeans.hpp"
+
+#include <boost/filesystem.hpp>
+
 #include <deque>
+#include <random>
+#include <stdexcept>
+#include <string>
 //#include <cstdio> //DEBUG
 
 namespace aliceVision {
 namespace voctree {
 
+/**
+ * @brief Interface providing the training features by batches,
+ * to build a vocabulary tree without loading all the features in memory.
+ */
+template<class Feature, class FeatureAllocator = typename DefaultAllocator<Feature>::type>
+class FeatureStream
+{
+public:
+  virtual ~FeatureStream() = default;
+
+  /// Restart the stream from the first feature.
+  virtual void reset() = 0;
+
+  /**
+   * @brief Get the next batch of features.
+   * @param[out] batch The features of the batch
+   * @return false if there is no more feature
+   */
+  virtual bool next(std::vector<Feature, FeatureAllocator>& batch) = 0;
+};
+
 /**
  * @brief Class for building a new vocabulary by hierarchically clustering
  * a set of training features.
@@ -48,6 +75,27 @@ public:
    */
   void build(const FeatureVector& training_features, uint32_t k, uint32_t levels);
 
+  /**
+   * @brief Build a new vocabulary tree level by level from a stream of training features.
+   *
+   * Only a sample of the features and the current batch are kept in memory. For each level:
+   *  - the features are streamed to sample at most \p sampleSize features spread over the nodes of the level,
+   *    and the children of each node are initialized with the k-means of its samples;
+   *  - the features are streamed \p nbPasses times to refine the children with mini-batch k-means updates.
+   * The batches are assigned to the nodes of the tree in parallel.
+   *
+   * @param stream            The training features.
+   * @param k                 The branching factor, or max children of any node.
+   * @param levels            The number of levels in the tree.
+   * @param sampleSize        The maximal number of features sampled at each level.
+   * @param nbPasses          The number of mini-batch k-means passes over the features at each level.
+   * @param checkpointFile    If not empty, the tree is saved in this file after each level,
+   *                          and the build is resumed from it if it exists.
+   */
+  void buildOutOfCore(FeatureStream<Feature, FeatureAllocator>& stream, uint32_t k, uint32_t levels,
+                      std::size_t sampleSize = 1000000, std::size_t nbPasses = 1,
+                      const std::string& checkpointFile = "");
+
   /// Get the built vocabulary tree.
 
   const Tree& tree() const
@@ -172,5 +220,148 @@ void TreeBuilder<Feature, DistanceT, FeatureAllocator>::build(const FeatureVecto
   }
 }
 
+template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
+void TreeBuilder<Feature, DistanceT, FeatureAllocator>::buildOutOfCore(FeatureStream<Feature, FeatureAllocator>& stream,
+                                                                      uint32_t k, uint32_t levels,
+                                                                      std::size_t sampleSize, std::size_t nbPasses,
+                                                                      const std::string& checkpointFile)
+{
+  tree_.clear();
+  uint32_t firstLevel = 0;
+
+  if(!checkpointFile.empty() && boost::filesystem::exists(checkpointFile))
+  {
+    // resume from the levels already built
+    tree_.load(checkpointFile);
+    if(tree_.splits() != k || tree_.levels() > levels)
+      throw std::runtime_error("The vocabulary tree checkpoint '" + checkpointFile + "' does not match the requested tree.");
+    firstLevel = tree_.levels();
+    ALICEVISION_LOG_INFO("Resume the vocabulary tree from level " << firstLevel << " (" << checkpointFile << ")");
+  }
+
+  // seeded with rand() as the k-means, to be reproducible with makeRandomOperationsReproducible
+  std::mt19937_64 generator(rand());
+  FeatureVector batch;
+  std::vector<Word> words;
+
+  for(uint32_t level = firstLevel; level < levels; ++level)
+  {
+    if(verbose_) printf("# Level %u\n", level);
+
+    // the parents are the nodes of the previous level (the virtual root for the first level)
+    const std::size_t nbParents = (level == 0) ? 1 : tree_.words();
+    const std::size_t parentStart = (level == 0) ? 0 : tree_.nodes() - tree_.words();
+    const std::size_t childStart = tree_.nodes();
+    const std::size_t parentCapacity = std::max<std::size_t>(2 * k, sampleSize / nbParents);
+
+    // 1. sample the features of each parent (reservoir sampling)
+    std::vector<FeatureVector> samples(nbParents);
+    std::vector<std::size_t> parentCounts(nbParents, 0);
+
+    stream.reset();
+    while(stream.next(batch))
+    {
+      if(level > 0)
+        words = tree_.quantize(batch);
+
+      for(std::size_t i = 0; i < batch.size(); ++i)
+      {
+        const std::size_t parent = (level == 0) ? 0 : words[i];
+        const std::size_t count = ++parentCounts[parent];
+        if(count <= parentCapacity)
+        {
+          samples[parent].push_back(batch[i]);
+        }
+        else
+        {
+          const std::size_t j = generator() % count;
+          if(j < parentCapacity)
+            samples[parent][j] = batch[i];
+        }
+      }
+    }
+
+    if(level == 0 && parentCounts[0] == 0)
+      throw std::runtime_error("No training features to build the vocabulary tree.");
+
+    // 2. initialize the children of each parent with the k-means of its samples
+    tree_.centers().resize(childStart + nbParents * k, zero_);
+    tree_.validCenters().resize(childStart + nbParents * k, 0);
+    // number of features assigned to each child, used as learning rate of the mini-batch updates
+    std::vector<double> childCounts(nbParents * k, 0.0);
+
+    FeatureVector centers;
+    std::vector<unsigned int> membership;
+    for(std::size_t parent = 0; parent < nbParents; ++parent)
+    {
+      FeatureVector& subset = samples[parent];
+      const std::size_t firstChild = childStart + parent * k;
+
+      // invalid parents and parents without features have invalid children
+      if(subset.empty() || (level > 0 && !tree_.validCenters()[parentStart + parent]))
+        continue;
+
+      if(verbose_ > 1) printf("#\tClustering subset %lu/%lu of size %lu\n", parent + 1, nbParents, subset.size());
+
+      if(subset.size() <= k)
+      {
+        // all the features of the parent are sampled, just use them as the centers
+        std::copy(subset.begin(), subset.end(), tree_.centers().begin() + firstChild);
+        std::fill(tree_.validCenters().begin() + firstChild, tree_.validCenters().begin() + firstChild + subset.size(), 1);
+        std::fill(childCounts.begin() + parent * k, childCounts.begin() + parent * k + subset.size(), 1.0);
+      }
+      else
+      {
+        kmeans_.cluster(subset, k, centers, membership);
+        std::copy(centers.begin(), centers.end(), tree_.centers().begin() + firstChild);
+        std::fill(tree_.validCenters().begin() + firstChild, tree_.validCenters().begin() + firstChild + k, 1);
+
+        const double sampleWeight = double(parentCounts[parent]) / subset.size();
+        for(std::size_t i = 0; i < subset.size(); ++i)
+          childCounts[parent * k + membership[i]] += sampleWeight;
+      }
+      FeatureVector().swap(subset);
+    }
+    samples.clear();
+
+    tree_.setSize(level + 1, k);
+
+    // 3. refine the children with mini-batch k-means: each feature moves its nearest child towards it
+    for(std::size_t pass = 0; pass < nbPasses; ++pass)
+    {
+      if(verbose_) printf("#\tMini-batch pass %lu/%lu\n", pass + 1, nbPasses);
+
+      stream.reset();
+      while(stream.next(batch))
+      {
+        words = tree_.quantize(batch);
+
+        for(std::size_t i = 0; i < batch.size(); ++i)
+        {
+          const std::size_t child = words[i];
+          if(!tree_.validCenters()[childStart + child])
+            continue;
+
+          childCounts[child] += 1.0;
+          const double learningRate = 1.0 / childCounts[child];
+          Feature& center = tree_.centers()[childStart + child];
+          for(std::size_t d = 0; d < center.size(); ++d)
+            center[d] += (batch[i][d] - center[d]) * learningRate;
+        }
+      }
+    }
+
+    if(verbose_) printf("# centers so far = %lu\n", tree_.centers().size());
+
+    if(!checkpointFile.empty())
+    {
+      // write the whole checkpoint before replacing the previous one, so an interrupted save cannot corrupt it
+      const std::string tmpCheckpointFile = checkpointFile + ".tmp";
+      tree_.save(tmpCheckpointFile);
+      boost::filesystem::rename(tmpCheckpointFile, checkpointFile);
+    }
+  }
+}
+
 }
 }
@@ -17,6 +17,7 @@
 #include <aliceVision/system/Logger.hpp>
 
 #include <stdint.h>
+#include <algorithm>
 #include <vector>
 #include <map>
 #include <cassert>
@@ -118,8 +119,8 @@ public:
   Word quantize(const DescriptorT& feature) const;
 
   /// Quantizes a set of features into visual words.
-  template<class DescriptorT>
-  std::vector<Word> quantize(const std::vector<DescriptorT>& features) const;
+  template<class DescriptorT, class DescriptorAllocator>
+  std::vector<Word> quantize(const std::vector<DescriptorT, DescriptorAllocator>& features) const;
 
   /// Quantizes a set of features into sparse histogram of visual words.
   template<class DescriptorT>
@@ -171,6 +172,21 @@ protected:
   }
 
   void setNodeCounts();
+
+  /**
+   * @brief Quantize a feature from a given level of the tree.
+   * @param[in] feature the feature to quantize
+   * @param[in] level the level of the children of \p index
+   * @param[in] index the node to start from (-1 for the root)
+   * @param[in] distances buffer of splits() distances
+   * @return the index of the leaf node
+   */
+  template<class DescriptorT>
+  int32_t quantizeFromLevel(const DescriptorT& feature, unsigned level, int32_t index,
+                            typename CentersDistances<Feature, Distance, DescriptorT>::result_type* distances) const;
+
+  /// Number of valid children, stored contiguously from \p first_child.
+  uint32_t nbValidChildren(int32_t first_child) const;
 };
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
@@ -190,55 +206,109 @@ template<class Feature, template<typename, typename> class Distance, class Featu
 template<class DescriptorT>
 Word VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const DescriptorT& feature) const
 {
-  typedef typename Distance<Feature, DescriptorT>::result_type distance_type;
-
   //	printf("asserting\n");
   assert(initialized());
   //	printf("initialized\n");
-  int32_t index = -1; // virtual "root" index, which has no associated center.
-  for(unsigned level = 0; level < levels_; ++level)
+  typedef typename CentersDistances<Feature, Distance, DescriptorT>::result_type distance_type;
+
+  // the distances to the children of a node, on the stack unless the branching factor is unusually large
+  const uint32_t maxStackSplits = 64;
+  distance_type stackDistances[maxStackSplits];
+  std::vector<distance_type> heapDistances;
+  distance_type* distances = stackDistances;
+  if(splits() > maxStackSplits)
   {
-    // Calculate the offset to the first child of the current index.
-    int32_t first_child = (index + 1) * splits();
-    // Find the child center closest to the query.
-    int32_t best_child = first_child;
-    distance_type best_distance = std::numeric_limits<distance_type>::max();
-    for(int32_t child = first_child; child < first_child + (int32_t) splits(); ++child)
-    {
-      if(!valid_centers_[child])
-        break; // Fewer than splits() children.
-      distance_type child_distance = Distance<DescriptorT, Feature>()(feature, centers_[child]);
-      if(child_distance < best_distance)
-      {
-        best_child = child;
-        best_distance = child_distance;
-      }
-    }
-    index = best_child;
+    heapDistances.resize(splits());
+    distances = heapDistances.data();
   }
 
-  return index - word_start_;
+  // virtual "root" index, which has no associated center.
+  return quantizeFromLevel(feature, 0, -1, distances) - word_start_;
 }
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
-template<class DescriptorT>
-std::vector<Word> VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const std::vector<DescriptorT>& features) const
+template<class DescriptorT, class DescriptorAllocator>
+std::vector<Word> VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const std::vector<DescriptorT, DescriptorAllocator>& features) const
 {
+  typedef CentersDistances<Feature, Distance, DescriptorT> CentersDistancesT;
+  typedef typename CentersDistancesT::result_type distance_type;
+
   // ALICEVISION_LOG_DEBUG("VocabularyTree quantize: " << features.size());
   std::vector<Word> imgVisualWords(features.size(), 0);
 
+  if(features.empty())
+    return imgVisualWords;
+
+  assert(initialized());
+
+  // the features are quantized by blocks: the distances to the children of the root
+  // are computed for all the features of a block at once
+  const int blockSize = 256;
+  const int nbBlocks = (static_cast<int>(features.size()) + blockSize - 1) / blockSize;
+  const uint32_t nbRootChildren = nbValidChildren(0);
+
   // quantize the features
-  #pragma omp parallel for
-  for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(features.size()); ++j)
+  #pragma omp parallel for schedule(dynamic)
+  for(int block = 0; block < nbBlocks; ++block)
   {
-    // store the visual word associated to the feature in the temporary list
-    imgVisualWords[j] = quantize<DescriptorT>(features[j]);
+    const std::size_t blockBegin = block * blockSize;
+    const std::size_t blockEnd = std::min(features.size(), blockBegin + blockSize);
+    std::vector<distance_type> distances(std::max<std::size_t>((blockEnd - blockBegin) * nbRootChildren, splits()));
+    std::vector<int32_t> rootChildren(blockEnd - blockBegin);
+
+    CentersDistancesT::compute(&features[blockBegin], blockEnd - blockBegin, &centers_[0], nbRootChildren, distances.data());
+
+    for(std::size_t j = blockBegin; j < blockEnd; ++j)
+    {
+      const distance_type* featureDistances = &distances[(j - blockBegin) * nbRootChildren];
+      const int32_t rootChild = std::min_element(featureDistances, featureDistances + nbRootChildren) - featureDistances;
+      rootChildren[j - blockBegin] = rootChild;
+    }
+
+    // the distances of the root level are not needed anymore, the buffer is reused for the next levels
+    for(std::size_t j = blockBegin; j < blockEnd; ++j)
+    {
+      // store the visual word associated to the feature in the temporary list
+      imgVisualWords[j] = quantizeFromLevel(features[j], 1, rootChildren[j - blockBegin], distances.data()) - word_start_;
+    }
   }
 
   // add the vector to the documents
   return imgVisualWords;
 }
 
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+template<class DescriptorT>
+int32_t VocabularyTree<Feature, Distance, FeatureAllocator>::quantizeFromLevel(const DescriptorT& feature, unsigned level, int32_t index,
+                                                                              typename CentersDistances<Feature, Distance, DescriptorT>::result_type* distances) const
+{
+  for(; level < levels_; ++level)
+  {
+    // Calculate the offset to the first child of the current index.
+    const int32_t first_child = (index + 1) * splits();
+    // Find the child center closest to the query.
+    const uint32_t nbChildren = nbValidChildren(first_child);
+    if(nbChildren == 0)
+    {
+      index = first_child;
+      continue;
+    }
+    CentersDistances<Feature, Distance, DescriptorT>::compute(&feature, 1, &centers_[first_child], nbChildren, distances);
+    index = first_child + (std::min_element(distances, distances + nbChildren) - distances);
+  }
+
+  return index;
+}
+
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+uint32_t VocabularyTree<Feature, Distance, FeatureAllocator>::nbValidChildren(int32_t first_child) const
+{
+  uint32_t nbChildren = 0;
+  while(nbChildren < splits() && valid_centers_[first_child + nbChildren])
+    ++nbChildren; // Fewer than splits() children.
+  return nbChildren;
+}
+
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
 template<class DescriptorT>
 SparseHistogram VocabularyTree<Feature, Distance, FeatureAllocator>::quantizeToSparse(const std::vector<DescriptorT>& features) const
@@ -10,6 +10,7 @@
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/voctree/Database.hpp>
 #include <aliceVision/voctree/VocabularyTree.hpp>
+#include <aliceVision/voctree/TreeBuilder.hpp>
 
 #include <string>
 
@@ -52,6 +53,36 @@ std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
                          std::vector<DescriptorT>& descriptors,
                          std::vector<std::size_t>& numFeatures);
 
+/**
+ * @brief Stream of the descriptors of a list of .desc files, read by batches.
+ * A batch contains the descriptors of consecutive files, until it has at least batchSize descriptors.
+ */
+template<class DescriptorT, class FileDescriptorT>
+class DescriptorFilesStream : public FeatureStream<DescriptorT>
+{
+public:
+  /**
+   * @param[in] descriptorsFiles The .desc files
+   * @param[in] batchSize The minimal number of descriptors of a batch (except the last one)
+   */
+  DescriptorFilesStream(const std::vector<std::string>& descriptorsFiles, std::size_t batchSize)
+    : _descriptorsFiles(descriptorsFiles)
+    , _batchSize(batchSize)
+  {}
+
+  void reset() override
+  {
+    _currentFile = 0;
+  }
+
+  bool next(std::vector<DescriptorT>& batch) override;
+
+private:
+  std::vector<std::string> _descriptorsFiles;
+  std::size_t _batchSize;
+  std::size_t _currentFile = 0;
+};
+
 } // namespace voctree
 } // namespace aliceVision
 
@@ -89,5 +89,18 @@ std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
   return numDescriptors;
 }
 
+template<class DescriptorT, class FileDescriptorT>
+bool DescriptorFilesStream<DescriptorT, FileDescriptorT>::next(std::vector<DescriptorT>& batch)
+{
+  batch.clear();
+  while(_currentFile < _descriptorsFiles.size() && batch.size() < _batchSize)
+  {
+    // Read the descriptors and append them in the vector
+    feature::loadDescsFromBinFile<DescriptorT, FileDescriptorT>(_descriptorsFiles[_currentFile], batch, true);
+    ++_currentFile;
+  }
+  return !batch.empty();
+}
+
 } // namespace voctree
 } // namespace aliceVision
@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include <aliceVision/feature/Descriptor.hpp>
+#include <aliceVision/feature/distanceKernels.hpp>
+
 #include <stdint.h>
 #include <Eigen/Core>
 
@@ -56,5 +59,52 @@ struct L2< Eigen::Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols>, Eigen::
   }
 };
 
+/**
+ * \brief Distances between descriptors and consecutive tree centers, used to find the closest child of a node.
+ *
+ * Generic version calling the \c Distance functor for each pair.
+ * out[i * nbCenters + c] = distance(features[i], centers[c])
+ */
+template<class Feature, template<typename, typename> class Distance, class DescriptorT>
+struct CentersDistances
+{
+  typedef typename Distance<DescriptorT, Feature>::result_type result_type;
+
+  static void compute(const DescriptorT* features, std::size_t nbFeatures, const Feature* centers, std::size_t nbCenters, result_type* out)
+  {
+    const Distance<DescriptorT, Feature> distance;
+    for(std::size_t i = 0; i < nbFeatures; ++i)
+      for(std::size_t c = 0; c < nbCenters; ++c)
+        out[i * nbCenters + c] = distance(features[i], centers[c]);
+  }
+};
+
+/// L2 distances between float or unsigned char descriptors and float centers, computed with the batched SIMD kernels.
+template<class DescriptorValueT, std::size_t N>
+struct CentersDistancesKernel
+{
+  typedef float result_type;
+
+  static void compute(const feature::Descriptor<DescriptorValueT, N>* features, std::size_t nbFeatures,
+                      const feature::Descriptor<float, N>* centers, std::size_t nbCenters, result_type* out)
+  {
+    // the descriptors of a vector are contiguous
+    static_assert(sizeof(feature::Descriptor<DescriptorValueT, N>) == N * sizeof(DescriptorValueT), "Descriptor values should be contiguous");
+    static_assert(sizeof(feature::Descriptor<float, N>) == N * sizeof(float), "Descriptor values should be contiguous");
+
+    feature::l2SquaredDistances(features->getData(), nbFeatures, centers->getData(), nbCenters, N, out);
+  }
+};
+
+template<std::size_t N>
+struct CentersDistances<feature::Descriptor<float, N>, L2, feature::Descriptor<float, N> >
+  : public CentersDistancesKernel<float, N>
+{};
+
+template<std::size_t N>
+struct CentersDistances<feature::Descriptor<float, N>, L2, feature::Descriptor<unsigned char, N> >
+  : public CentersDistancesKernel<unsigned char, N>
+{};
+
 }
 }
@@ -9,8 +9,12 @@
 
 #include <Eigen/Core>
 
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <string>
 #include <vector>
 
 #define BOOST_TEST_MODULE voctreeBuilder
@@ -86,3 +90,104 @@ BOOST_AUTO_TEST_CASE(voctreeBuilder)
   }
 //  voctree::printFeatVector( features ); 
 }
+
+BOOST_AUTO_TEST_CASE(voctreeBuilderOutOfCore)
+{
+  using namespace aliceVision;
+
+  makeRandomOperationsReproducible();
+
+  const std::string checkpointName = "test_checkpoint.tree";
+
+  const std::size_t DIMENSION = 3;
+  const std::size_t FEATURENUMBER = 100;
+  const std::size_t K = 4;
+  const std::size_t LEVELS = 3;
+  const std::size_t LEAVESNUMBER = std::pow(K, LEVELS);
+
+  typedef Eigen::Matrix<float, 1, DIMENSION> FeatureFloat;
+  typedef std::vector<FeatureFloat, Eigen::aligned_allocator<FeatureFloat> > FeatureFloatVector;
+
+  /// features stored in memory, streamed by batches
+  class VectorStream : public voctree::FeatureStream<FeatureFloat>
+  {
+  public:
+    VectorStream(const FeatureFloatVector& features, std::size_t batchSize)
+      : _features(features)
+      , _batchSize(batchSize)
+    {}
+
+    void reset() override { _position = 0; }
+
+    bool next(FeatureFloatVector& batch) override
+    {
+      const std::size_t end = std::min(_features.size(), _position + _batchSize);
+      batch.assign(_features.begin() + _position, _features.begin() + end);
+      _position = end;
+      return !batch.empty();
+    }
+
+  private:
+    const FeatureFloatVector& _features;
+    std::size_t _batchSize;
+    std::size_t _position = 0;
+  };
+
+  // generate LEAVESNUMBER clusters of features
+  FeatureFloatVector features;
+  for(std::size_t i = 0; i < LEAVESNUMBER; ++i)
+  {
+    const FeatureFloat center = FeatureFloat::Random() * 10.f;
+    for(std::size_t j = 0; j < FEATURENUMBER; ++j)
+      features.push_back(center + FeatureFloat::Random() * 0.1f);
+  }
+
+  const auto meanSquaredError = [&](const voctree::MutableVocabularyTree<FeatureFloat>& tree)
+  {
+    const std::vector<voctree::Word> words = tree.quantize(features);
+    const std::size_t wordStart = tree.nodes() - tree.words();
+    double sse = 0.0;
+    for(std::size_t i = 0; i < features.size(); ++i)
+      sse += (features[i] - tree.centers()[wordStart + words[i]]).squaredNorm();
+    return sse / features.size();
+  };
+
+  voctree::TreeBuilder<FeatureFloat> builder(FeatureFloat::Zero());
+  builder.kmeans().setRestarts(5);
+  builder.build(features, K, LEVELS);
+  const double inCoreError = meanSquaredError(builder.tree());
+
+  // the sample is smaller than the set of features
+  VectorStream stream(features, 1000);
+  voctree::TreeBuilder<FeatureFloat> outOfCoreBuilder(FeatureFloat::Zero());
+  outOfCoreBuilder.kmeans().setRestarts(5);
+  outOfCoreBuilder.buildOutOfCore(stream, K, LEVELS, 3000, 2);
+
+  BOOST_CHECK_EQUAL(outOfCoreBuilder.tree().levels(), LEVELS);
+  BOOST_CHECK_EQUAL(outOfCoreBuilder.tree().splits(), K);
+  BOOST_CHECK_EQUAL(outOfCoreBuilder.tree().centers().size(), outOfCoreBuilder.tree().nodes());
+  BOOST_CHECK_LE(meanSquaredError(outOfCoreBuilder.tree()), 2.0 * inCoreError + 0.01);
+
+  // resume from a checkpoint of the first levels
+  boost::filesystem::remove(checkpointName);
+  voctree::TreeBuilder<FeatureFloat> checkpointBuilder(FeatureFloat::Zero());
+  checkpointBuilder.buildOutOfCore(stream, K, LEVELS - 1, 3000, 1, checkpointName);
+  const FeatureFloatVector checkpointCenters = checkpointBuilder.tree().centers();
+  BOOST_CHECK(boost::filesystem::exists(checkpointName));
+  BOOST_CHECK(!boost::filesystem::exists(checkpointName + ".tmp"));
+
+  voctree::TreeBuilder<FeatureFloat> resumedBuilder(FeatureFloat::Zero());
+  resumedBuilder.buildOutOfCore(stream, K, LEVELS, 3000, 1, checkpointName);
+  BOOST_CHECK_EQUAL(resumedBuilder.tree().levels(), LEVELS);
+  BOOST_CHECK_EQUAL(resumedBuilder.tree().centers().size(), resumedBuilder.tree().nodes());
+  for(std::size_t i = 0; i < checkpointCenters.size(); ++i)
+    BOOST_CHECK(resumedBuilder.tree().centers()[i] == checkpointCenters[i]);
+
+  boost::filesystem::remove(checkpointName);
+
+  // no training features
+  const FeatureFloatVector noFeatures;
+  VectorStream emptyStream(noFeatures, 10);
+  voctree::TreeBuilder<FeatureFloat> emptyBuilder(FeatureFloat::Zero());
+  BOOST_CHECK_THROW(emptyBuilder.buildOutOfCore(emptyStream, K, LEVELS), std::runtime_error);
+}
@@ -5,9 +5,15 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/voctree/Database.hpp>
+#include <aliceVision/voctree/MutableVocabularyTree.hpp>
 
+#include <cmath>
 #include <iostream>
 #include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 #define BOOST_TEST_MODULE vocabularyTree
@@ -57,3 +63,125 @@ BOOST_AUTO_TEST_CASE(database)
     BOOST_CHECK_SMALL(static_cast<double>(match[0].score), 0.001);
   }
 }
+
+BOOST_AUTO_TEST_CASE(database_invertedFile)
+{
+  const int cardDocuments = 50;
+  const int cardFeatures = 200;
+  const int cardWords = 500;
+
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<Word> wordDistribution(0, cardWords - 1);
+
+  // random documents with repeated words
+  Database db(cardWords);
+  std::vector<SparseHistogram> histograms(cardDocuments);
+  for(int i = 0; i < cardDocuments; ++i)
+  {
+    std::vector<Word> document(cardFeatures);
+    for(Word& word : document)
+      word = wordDistribution(generator);
+    computeSparseHistogram(document, histograms[i]);
+    db.insert(i, histograms[i]);
+  }
+  db.computeTfIdfWeights();
+
+  std::vector<float> weights(cardWords);
+  for(Word w = 0; w < cardWords; ++w)
+  {
+    std::size_t nbDocuments = 0;
+    for(const SparseHistogram& histogram : histograms)
+      nbDocuments += histogram.count(w);
+    weights[w] = (nbDocuments != 0) ? std::log(float(cardDocuments) / nbDocuments) : 1.0f;
+  }
+
+  for(const std::string distanceMethod : {"classic", "commonPoints", "strongCommonPoints", "weightedStrongCommonPoints", "inversedWeightedCommonPoints"})
+  {
+    for(int i = 0; i < cardDocuments; ++i)
+    {
+      // all the documents are returned with the same score as sparseDistance
+      std::vector<DocMatch> matches;
+      db.find(histograms[i], cardDocuments, matches, distanceMethod);
+      BOOST_CHECK_EQUAL(matches.size(), cardDocuments);
+      for(std::size_t j = 1; j < matches.size(); ++j)
+        BOOST_CHECK_LE(matches[j - 1].score, matches[j].score);
+      for(const DocMatch& match : matches)
+        BOOST_CHECK_CLOSE(match.score, sparseDistance(histograms[i], histograms[match.id], distanceMethod, weights), 1e-3);
+
+      // top N
+      std::vector<DocMatch> bestMatches;
+      db.find(histograms[i], 5, bestMatches, distanceMethod);
+      BOOST_CHECK_EQUAL(bestMatches.size(), 5);
+      BOOST_CHECK_CLOSE(bestMatches.front().score, matches.front().score, 1e-3);
+    }
+  }
+
+  std::vector<DocMatch> matches;
+  BOOST_CHECK_THROW(db.find(histograms[0], 1, matches, "unknown"), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(vocabularyTree_quantize)
+{
+  typedef aliceVision::feature::Descriptor<float, 128> CenterT;
+  typedef aliceVision::feature::Descriptor<unsigned char, 128> DescriptorT;
+
+  const int cardFeatures = 1000;
+
+  // the usual branching factor, and one larger than the quantization stack buffer
+  for(const std::pair<uint32_t, uint32_t>& levelsSplits : {std::make_pair(3u, 10u), std::make_pair(2u, 70u)})
+  {
+    const uint32_t levels = levelsSplits.first;
+    const uint32_t splits = levelsSplits.second;
+
+    std::mt19937 generator(0);
+    std::uniform_int_distribution<int> valueDistribution(0, 255);
+
+    // integer values so that the float distances are exact
+    MutableVocabularyTree<CenterT> tree;
+    tree.setSize(levels, splits);
+    tree.centers().resize(tree.nodes());
+    tree.validCenters().resize(tree.nodes(), 1);
+    for(CenterT& center : tree.centers())
+      for(std::size_t i = 0; i < center.size(); ++i)
+        center[i] = valueDistribution(generator);
+
+    // nodes with fewer than splits() children
+    tree.validCenters()[7] = tree.validCenters()[8] = tree.validCenters()[9] = 0;
+    tree.validCenters()[15 * splits + 2] = 0;
+
+    std::vector<DescriptorT> features(cardFeatures);
+    for(DescriptorT& feature : features)
+      for(std::size_t i = 0; i < feature.size(); ++i)
+        feature[i] = valueDistribution(generator);
+
+    const std::vector<Word> words = tree.quantize(features);
+    BOOST_CHECK_EQUAL(words.size(), cardFeatures);
+
+    const L2<DescriptorT, CenterT> distance;
+    const int32_t wordStart = tree.nodes() - tree.words();
+    for(int j = 0; j < cardFeatures; ++j)
+    {
+      // closest child at each level with the generic distance
+      int32_t index = -1;
+      for(uint32_t level = 0; level < levels; ++level)
+      {
+        const int32_t firstChild = (index + 1) * splits;
+        int32_t bestChild = firstChild;
+        double bestDistance = std::numeric_limits<double>::max();
+        for(int32_t child = firstChild; child < firstChild + int32_t(splits) && tree.validCenters()[child]; ++child)
+        {
+          const double childDistance = distance(features[j], tree.centers()[child]);
+          if(childDistance < bestDistance)
+          {
+            bestChild = child;
+            bestDistance = childDistance;
+          }
+        }
+        index = bestChild;
+      }
+
+      BOOST_CHECK_EQUAL(words[j], index - wordStart);
+      BOOST_CHECK_EQUAL(tree.quantize(features[j]), words[j]);
+    }
+  }
+}
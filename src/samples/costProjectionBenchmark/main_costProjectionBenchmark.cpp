@@ -0,0 +1,145 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/CostProjection.hpp>
+#include <aliceVision/camera/camera.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+using namespace aliceVision::sfm;
+
+namespace po = boost::program_options;
+
+// small distortion parameters for each camera model
+std::vector<double> getDistortionParams(EINTRINSIC intrinsicType)
+{
+  switch(intrinsicType)
+  {
+    case EINTRINSIC::PINHOLE_CAMERA_RADIAL1:        return {-0.1};
+    case EINTRINSIC::PINHOLE_CAMERA_RADIAL3:        return {-0.1, 0.02, -0.001};
+    case EINTRINSIC::PINHOLE_CAMERA_FISHEYE:        return {0.01, -0.02, 0.003, -0.001};
+    case EINTRINSIC::PINHOLE_CAMERA_3DERADIAL4:     return {-0.1, 0.02, 0.001, -0.002, 0.0005, 0.0003};
+    case EINTRINSIC::PINHOLE_CAMERA_3DEANAMORPHIC4: return {-0.1, 0.02, -0.05, 0.01};
+    case EINTRINSIC::PINHOLE_CAMERA_3DECLASSICLD:   return {-0.1, 0.8, 0.01, -0.02, 0.001};
+    default:                                        return {};
+  }
+}
+
+// evaluation time (in ms) of a residual with all its jacobians
+double timeEvaluations(const ceres::CostFunction& costFunction, const std::vector<std::vector<double>>& parameterBlocks, int nbEvaluations)
+{
+  std::array<double, 2> residuals;
+  std::vector<std::vector<double>> jacobians(parameterBlocks.size());
+  std::vector<const double*> parameters;
+  std::vector<double*> jacobiansPtr;
+  for(std::size_t i = 0; i < parameterBlocks.size(); ++i)
+  {
+    jacobians[i].resize(2 * parameterBlocks[i].size());
+    parameters.push_back(parameterBlocks[i].data());
+    jacobiansPtr.push_back(jacobians[i].data());
+  }
+
+  system::Timer timer;
+  for(int i = 0; i < nbEvaluations; ++i)
+    costFunction.Evaluate(parameters.data(), residuals.data(), jacobiansPtr.data());
+  return timer.elapsedMs();
+}
+
+int main(int argc, char **argv)
+{
+  int nbEvaluations = 100000;
+
+  po::options_description allParams("AliceVision Sample costProjectionBenchmark\n"
+                                    "Compare the evaluation time of the generic reprojection cost function "
+                                    "and of the fixed-size one for each pinhole camera model with an analytic distortion derivative");
+  allParams.add_options()
+    ("nbEvaluations", po::value<int>(&nbEvaluations)->default_value(nbEvaluations),
+      "Number of evaluations of a residual and its jacobians for each cost function.");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  if(nbEvaluations <= 0)
+  {
+    ALICEVISION_CERR("ERROR: the number of evaluations must be positive.");
+    return EXIT_FAILURE;
+  }
+
+  const std::vector<EINTRINSIC> intrinsicTypes = {
+    EINTRINSIC::PINHOLE_CAMERA,
+    EINTRINSIC::PINHOLE_CAMERA_RADIAL1,
+    EINTRINSIC::PINHOLE_CAMERA_RADIAL3,
+    EINTRINSIC::PINHOLE_CAMERA_FISHEYE,
+    EINTRINSIC::PINHOLE_CAMERA_3DERADIAL4,
+    EINTRINSIC::PINHOLE_CAMERA_3DEANAMORPHIC4,
+    EINTRINSIC::PINHOLE_CAMERA_3DECLASSICLD};
+
+  const sfmData::Observation observation(Vec2(1000.0, 600.0), 0, 2.0);
+
+  // pose, rig and landmark
+  SE3::Matrix rTo = SE3::Matrix::Identity();
+  rTo.block<3, 3>(0, 0) = RotationAroundY(0.2) * RotationAroundX(-0.1);
+  rTo.block<3, 1>(0, 3) = Vec3(0.1, -0.2, 0.3);
+  SE3::Matrix cTr = SE3::Matrix::Identity();
+  cTr.block<3, 3>(0, 0) = RotationAroundZ(0.05);
+  cTr.block<3, 1>(0, 3) = Vec3(0.05, 0.0, 0.0);
+  const Vec3 X(0.4, 0.3, 4.0);
+
+  for(const EINTRINSIC intrinsicType : intrinsicTypes)
+  {
+    std::shared_ptr<IntrinsicBase> intrinsic = createIntrinsic(intrinsicType, 1920, 1080, 1500.0, 1520.0, 10.0, -5.0);
+    std::shared_ptr<IntrinsicsScaleOffsetDisto> intrinsicDisto = std::dynamic_pointer_cast<IntrinsicsScaleOffsetDisto>(intrinsic);
+    if(intrinsicDisto && intrinsicDisto->hasDistortion())
+      intrinsicDisto->setDistortionParams(getDistortionParams(intrinsicType));
+
+    const std::vector<std::vector<double>> parameterBlocks = {
+      std::vector<double>(rTo.data(), rTo.data() + 16),
+      std::vector<double>(cTr.data(), cTr.data() + 16),
+      intrinsic->getParams(),
+      std::vector<double>(X.data(), X.data() + 3)};
+
+    std::unique_ptr<ceres::CostFunction> genericCost(createCostProjection(observation, intrinsic, true));
+    std::unique_ptr<ceres::CostFunction> fixedSizeCost(getCostProjectionCreator(*intrinsic)(observation, intrinsic, true));
+
+    const double genericTime = timeEvaluations(*genericCost, parameterBlocks, nbEvaluations);
+    const double fixedSizeTime = timeEvaluations(*fixedSizeCost, parameterBlocks, nbEvaluations);
+
+    ALICEVISION_LOG_INFO(EINTRINSIC_enumToString(intrinsicType) << ": "
+                         << (1e6 * genericTime / nbEvaluations) << " ns per residual (generic), "
+                         << (1e6 * fixedSizeTime / nbEvaluations) << " ns per residual (fixed-size).");
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -179,10 +179,10 @@ int aliceVision_main(int argc, char* argv[])
     ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
 
     // check if the gpu suppport CUDA compute capability 2.0
-    if(!gpu::gpuSupportCUDA(2,0))
+    const bool useCUDA = gpu::gpuSupportCUDA(2,0);
+    if(!useCUDA)
     {
-      ALICEVISION_LOG_ERROR("This program needs a CUDA-Enabled GPU (with at least compute capability 2.0).");
-      return EXIT_FAILURE;
+      ALICEVISION_LOG_WARNING("No CUDA-Enabled GPU (with at least compute capability 2.0), depth maps will be computed on the CPU.");
     }
 
     // check if the scale is correct
@@ -261,7 +261,10 @@ int aliceVision_main(int argc, char* argv[])
     }
 
     ALICEVISION_LOG_INFO("Create depth maps.");
-    depthMap::computeOnMultiGPUs(mp, cams, depthMap::estimateAndRefineDepthMaps, nbGPUs);
+    if(useCUDA)
+      depthMap::computeOnMultiGPUs(mp, cams, depthMap::estimateAndRefineDepthMaps, nbGPUs);
+    else
+      depthMap::estimateAndRefineDepthMaps(depthMap::CPU_DEVICE_INDEX, mp, cams);
 
     ALICEVISION_COMMANDLINE_END
 }
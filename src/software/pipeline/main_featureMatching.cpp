@@ -8,6 +8,7 @@
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/sfm/pipeline/regionsIO.hpp>
+#include <aliceVision/sfm/pipeline/RegionsCache.hpp>
 #include <aliceVision/sfm/pipeline/ReconstructionEngine.hpp>
 #include <aliceVision/sfm/pipeline/structureFromKnownPoses/StructureEstimationFromKnownPoses.hpp>
 #include <aliceVision/matching/matchesFiltering.hpp>
@@ -24,6 +25,7 @@
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix_H_AC.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix_HGrowing.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterType.hpp>
+#include <aliceVision/matchingImageCollection/pairScheduler.hpp>
 #include <aliceVision/matching/pairwiseAdjacencyDisplay.hpp>
 #include <aliceVision/matching/io.hpp>
 #include <aliceVision/system/main.hpp>
@@ -38,11 +40,13 @@
 #include <cstdlib>
 #include <fstream>
 #include <cctype>
+#include <iterator>
+#include <memory>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 3
 
 using namespace aliceVision;
 using namespace aliceVision::camera;
@@ -106,6 +110,7 @@ int aliceVision_main(int argc, char **argv)
   std::string nearestMatchingMethod = "ANN_L2";
   robustEstimation::ERobustEstimator geometricEstimator = robustEstimation::ERobustEstimator::ACRANSAC;
   double geometricErrorMax = 0.0; //< the maximum reprojection error allowed for image matching with geometric validation
+  bool geometricUseSprt = false;
   double knownPosesGeometricErrorMax = 4.0;
   bool savePutativeMatches = false;
   bool guidedMatching = false;
@@ -116,7 +121,9 @@ int aliceVision_main(int argc, char **argv)
   bool useGridSort = true;
   bool exportDebugFiles = false;
   bool matchFromKnownCameraPoses = false;
-  const std::string fileExtension = "txt";
+  bool memoryMappedDescriptors = false;
+  std::size_t maxMemory = 0;
+  std::string fileExtension = "txt";
   int randomSeed = std::mt19937::default_seed;
 
   po::options_description allParams(
@@ -151,12 +158,16 @@ int aliceVision_main(int argc, char **argv)
       "* CASCADE_HASHING_L2: L2 Cascade Hashing matching\n"
       "* FAST_CASCADE_HASHING_L2: L2 Cascade Hashing with precomputed hashed regions\n"
       "(faster than CASCADE_HASHING_L2 but use more memory)\n"
+      "* BLOCKED_BRUTE_FORCE_L2: L2 BruteForce matching computed by cache blocks of descriptors\n"
       "For Binary based descriptor:\n"
       "* BRUTE_FORCE_HAMMING: BruteForce Hamming matching")
     ("geometricEstimator", po::value<robustEstimation::ERobustEstimator>(&geometricEstimator)->default_value(geometricEstimator),
       "Geometric estimator:\n"
       "* acransac: A-Contrario Ransac\n"
       "* loransac: LO-Ransac (only available for fundamental matrix). Need to set '--geometricError'")
+    ("geometricUseSprt", po::value<bool>(&geometricUseSprt)->default_value(geometricUseSprt),
+      "Verify the LO-Ransac hypotheses with a Sequential Probability Ratio Test (SPRT): "
+      "the hypotheses are rejected after a few residuals once they are statistically hopeless.")
     ("geometricError", po::value<double>(&geometricErrorMax)->default_value(geometricErrorMax), 
       "Maximum error (in pixels) allowed for features matching during geometric verification. "
       "If set to 0 it lets the ACRansac select an optimal value.")
@@ -184,6 +195,18 @@ int aliceVision_main(int argc, char **argv)
       "Export debug files (svg, dot).")
     ("maxMatches", po::value<std::size_t>(&numMatchesToKeep)->default_value(numMatchesToKeep),
       "Maximum number pf matches to keep.")
+    ("memoryMappedDescriptors", po::value<bool>(&memoryMappedDescriptors)->default_value(memoryMappedDescriptors),
+      "Access the descriptors files through a read-only memory mapping instead of loading them in memory. "
+      "The OS page cache handles their residency and shares them between processes on the same node.")
+    ("maxMemory", po::value<std::size_t>(&maxMemory)->default_value(maxMemory),
+      "Memory budget (in MB) of the loaded regions (0 to load the regions of all the views). "
+      "The pairs are ordered to maximize the locality of the views and matched by batches, "
+      "the regions are loaded on demand and the regions of the next batch are loaded in the background.")
+    ("matchesFileExtension", po::value<std::string>(&fileExtension)->default_value(fileExtension),
+      "Matches file format:\n"
+      "* txt: ASCII matches files\n"
+      "* bin: binary matches files with a pair index, allowing to load only a subset of the pairs. "
+      "Without matchFilePerImage, the matches are written batch by batch instead of being kept in memory.")
     ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
       "Range image index start.")
     ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
@@ -242,7 +265,13 @@ int aliceVision_main(int argc, char **argv)
     ALICEVISION_LOG_ERROR("Invalid output matches folder: " + matchesFolder);
     return EXIT_FAILURE;
   }
-  
+
+  if(fileExtension != "txt" && fileExtension != "bin")
+  {
+    ALICEVISION_LOG_ERROR("Invalid matches file extension: " + fileExtension);
+    return EXIT_FAILURE;
+  }
+
 
   const matchingImageCollection::EGeometricFilterType geometricFilterType = matchingImageCollection::EGeometricFilterType_stringToEnum(geometricFilterTypeName);
 
@@ -307,8 +336,6 @@ int aliceVision_main(int argc, char **argv)
     filter.insert(pair.second);
   }
 
-  PairwiseMatches mapPutativesMatches;
-
   // allocate the right Matcher according the Matching requested method
   EMatcherType collectionMatcherType = EMatcherType_stringToEnum(nearestMatchingMethod);
   std::unique_ptr<IImageCollectionMatcher> imageCollectionMatcher = createImageCollectionMatcher(collectionMatcherType, distRatio, crossMatching);
@@ -317,87 +344,90 @@ int aliceVision_main(int argc, char **argv)
 
   ALICEVISION_LOG_INFO("There are " << sfmData.getViews().size() << " views and " << pairs.size() << " image pairs.");
 
-  ALICEVISION_LOG_INFO("Load features and descriptors");
+  // batches of pairs and their regions:
+  // - without memory budget, a single batch with the regions of all the views
+  // - with a memory budget, the pairs are ordered to maximize the locality of the views
+  //   and the regions are loaded on demand for each batch of pairs
+  std::vector<PairSet> pairsBatches;
+  RegionsPerView allRegionsPerView;
+  std::unique_ptr<sfm::RegionsCache> regionsCache;
 
-  // load the corresponding view regions
-  RegionsPerView regionPerView;
-  if(!sfm::loadRegionsPerView(regionPerView, sfmData, featuresFolders, describerTypes, filter))
+  const auto getBatchViews = [](const PairSet& batchPairs)
   {
-    ALICEVISION_LOG_ERROR("Invalid regions in '" + sfmDataFilename + "'");
-    return EXIT_FAILURE;
-  }
-
-  // perform the matching
-  system::Timer timer;
-  PairSet pairsPoseKnown;
-  PairSet pairsPoseUnknown;
+    std::set<IndexT> batchViews;
+    for(const Pair& pair : batchPairs)
+    {
+      batchViews.insert(pair.first);
+      batchViews.insert(pair.second);
+    }
+    return batchViews;
+  };
 
-  if(matchFromKnownCameraPoses)
+  if(maxMemory == 0)
   {
-      for(const auto& p: pairs)
-      {
-        if(sfmData.isPoseAndIntrinsicDefined(p.first) && sfmData.isPoseAndIntrinsicDefined(p.second))
-        {
-            pairsPoseKnown.insert(p);
-        }
-        else
-        {
-            pairsPoseUnknown.insert(p);
-        }
-      }
+    ALICEVISION_LOG_INFO("Load features and descriptors");
+
+    // load the corresponding view regions
+    if(!sfm::loadRegionsPerView(allRegionsPerView, sfmData, featuresFolders, describerTypes, filter, memoryMappedDescriptors))
+    {
+      ALICEVISION_LOG_ERROR("Invalid regions in '" + sfmDataFilename + "'");
+      return EXIT_FAILURE;
+    }
+    pairsBatches.push_back(pairs);
   }
   else
   {
-      pairsPoseUnknown = pairs;
-  }
+    const std::size_t maxMemoryBytes = maxMemory << 20;
+    regionsCache.reset(new sfm::RegionsCache(sfmData, featuresFolders, describerTypes, maxMemoryBytes, memoryMappedDescriptors));
 
-  if(!pairsPoseKnown.empty())
-  {
-    // compute matches from known camera poses when you have an initialization on the camera poses
-    ALICEVISION_LOG_INFO("Putative matches from known poses: " << pairsPoseKnown.size() << " image pairs.");
+    std::map<IndexT, std::size_t> viewsMemory;
+    for(const IndexT viewId : filter)
+      viewsMemory[viewId] = regionsCache->getViewMemory(viewId);
 
-    sfm::StructureEstimationFromKnownPoses structureEstimator;
-    structureEstimator.match(sfmData, pairsPoseKnown, regionPerView, knownPosesGeometricErrorMax);
-    mapPutativesMatches = structureEstimator.getPutativesMatches();
-  }
+    // half of the budget for the views of a batch, the other half for the prefetching of the next batch
+    pairsBatches = matchingImageCollection::splitPairsByMemory(matchingImageCollection::orderPairsByLocality(pairs), viewsMemory, maxMemoryBytes / 2);
 
-  if(!pairsPoseUnknown.empty())
-  {
-      ALICEVISION_LOG_INFO("Putative matches (unknown poses): " << pairsPoseUnknown.size() << " image pairs.");
-      // match feature descriptors between them without geometric notion
+    ALICEVISION_LOG_INFO("Matching by " << pairsBatches.size() << " batches of pairs (memory budget: " << maxMemory << " MB)");
 
-      for(const feature::EImageDescriberType descType : describerTypes)
-      {
-        assert(descType != feature::EImageDescriberType::UNINITIALIZED);
-        ALICEVISION_LOG_INFO(EImageDescriberType_enumToString(descType) + " Regions Matching");
+    // the cascade hashing is computed once from the regions of all the views,
+    // so the matches do not depend on the batches
+    ImageCollectionMatcher_cascadeHashing* cascadeHashingMatcher = dynamic_cast<ImageCollectionMatcher_cascadeHashing*>(imageCollectionMatcher.get());
+    if(cascadeHashingMatcher != nullptr && pairsBatches.size() > 1)
+    {
+      ALICEVISION_LOG_INFO("Compute the cascade hashing from the regions of all the views");
 
-        // photometric matching of putative pairs
-        imageCollectionMatcher->Match(randomNumberGenerator, regionPerView, pairsPoseUnknown, descType, mapPutativesMatches);
+      std::map<feature::EImageDescriberType, std::map<IndexT, Eigen::VectorXf>> meanDescriptorPerView;
+      for(std::size_t batchIndex = 0; batchIndex < pairsBatches.size(); ++batchIndex)
+      {
+        const std::set<IndexT> batchViews = getBatchViews(pairsBatches.at(batchIndex));
+        regionsCache->load(batchViews);
+        // prefetch the next batch, or the first one for the matching
+        regionsCache->prefetch(getBatchViews(pairsBatches.at((batchIndex + 1) % pairsBatches.size())));
 
-        // TODO: DELI
-        // if(!guided_matching) regionPerView.clearDescriptors()
+        const RegionsPerView& regionPerView = regionsCache->getRegionsPerView();
+        for(const IndexT viewId : batchViews)
+        {
+          for(const feature::EImageDescriberType descType : describerTypes)
+          {
+            const feature::Regions& regions = regionPerView.getRegions(viewId, descType);
+            if(!regions.IsBinary() && meanDescriptorPerView[descType].count(viewId) == 0)
+              meanDescriptorPerView[descType].emplace(viewId, ImageCollectionMatcher_cascadeHashing::computeMeanDescriptor(regions));
+          }
+        }
       }
 
-  }
-
-  if(mapPutativesMatches.empty())
-  {
-    ALICEVISION_LOG_INFO("No putative feature matches.");
-    // If we only compute a selection of matches, we may have no match.
-    return rangeSize ? EXIT_SUCCESS : EXIT_FAILURE;
-  }
-
-  if(geometricFilterType == EGeometricFilterType::HOMOGRAPHY_GROWING)
-  {
-    // sort putative matches according to their Lowe ratio
-    // This is suggested by [F.Srajer, 2016]: the matches used to be the seeds of the homographies growing are chosen according
-    // to the putative matches order. This modification should improve recall.
-    for(auto& imgPair: mapPutativesMatches)
-    {
-      for(auto& descType: imgPair.second)
+      // same random draws than a single batch: one hashing per describer type, in the describer types order
+      for(const feature::EImageDescriberType descType : describerTypes)
       {
-        IndMatches & matches = descType.second;
-        sortMatches_byDistanceRatio(matches);
+        const auto meanDescriptorIt = meanDescriptorPerView.find(descType);
+        if(meanDescriptorIt == meanDescriptorPerView.end())
+          continue;
+
+        std::vector<Eigen::VectorXf> viewsMeanDescriptor;
+        viewsMeanDescriptor.reserve(meanDescriptorIt->second.size());
+        for(const auto& viewMeanDescriptor : meanDescriptorIt->second)
+          viewsMeanDescriptor.push_back(viewMeanDescriptor.second);
+        cascadeHashingMatcher->initHashing(randomNumberGenerator, descType, viewsMeanDescriptor);
       }
     }
   }
@@ -407,207 +437,361 @@ int aliceVision_main(int argc, char **argv)
   // => without matchFilePerImage: avoids overwriting the unique resulting file
   const std::string filePrefix = rangeSize > 0 ? std::to_string(rangeStart/rangeSize) + "." : "";
 
-  ALICEVISION_LOG_INFO(std::to_string(mapPutativesMatches.size()) << " putative image pair matches");
-
-  for(const auto& imageMatch: mapPutativesMatches)
-    ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(imageMatch.first.first) << ", " + std::to_string(imageMatch.first.second) + ") contains " + std::to_string(imageMatch.second.getNbAllMatches()) + " putative matches.");
+  PairwiseMatches allPutativesMatches;
+  PairwiseMatches finalMatches;
+  PairSet finalPairs;
+  std::size_t nbPutativesMatches = 0;
+  double regionsMatchingTime = 0.0;
+  double geometricFilteringTime = 0.0;
+
+  // with a single binary file, the final matches of each batch are appended to the file
+  // as soon as the batch is done instead of being kept in memory until the end
+  std::unique_ptr<MatchesBinWriter> finalMatchesWriter;
+  if(fileExtension == "bin" && !matchFilePerImage)
+    finalMatchesWriter.reset(new MatchesBinWriter((fs::path(matchesFolder) / (filePrefix + "matches.bin")).string()));
+
+  for(std::size_t batchIndex = 0; batchIndex < pairsBatches.size(); ++batchIndex)
+  {
+    const PairSet& batchPairs = pairsBatches.at(batchIndex);
 
-  // export putative matches
-  if(savePutativeMatches)
-    Save(mapPutativesMatches, (fs::path(matchesFolder) / "putativeMatches").string(), fileExtension, matchFilePerImage, filePrefix);
+    if(regionsCache)
+    {
+      ALICEVISION_LOG_INFO("Batch " << (batchIndex + 1) << "/" << pairsBatches.size() << ": " << batchPairs.size() << " image pairs.");
 
-  ALICEVISION_LOG_INFO("Task (Regions Matching) done in (s): " + std::to_string(timer.elapsed()));
+      // load the regions of the batch and prefetch the regions of the next batch
+      regionsCache->load(getBatchViews(batchPairs));
+      if(batchIndex + 1 < pairsBatches.size())
+        regionsCache->prefetch(getBatchViews(pairsBatches.at(batchIndex + 1)));
+    }
 
-  /*
-  // TODO: DELI
-  if(exportDebugFiles)
-  {
-    //-- export putative matches Adjacency matrix
-    PairwiseMatchingToAdjacencyMatrixSVG(sfmData.getViews().size(),
-      mapPutativesMatches,
-      (fs::path(matchesFolder) / "PutativeAdjacencyMatrix.svg").string());
-    //-- export view pair graph once putative graph matches have been computed
-    {
-      std::set<IndexT> set_ViewIds;
+    const RegionsPerView& regionPerView = regionsCache ? regionsCache->getRegionsPerView() : allRegionsPerView;
 
-      std::transform(sfmData.getViews().begin(), sfmData.getViews().end(),
-        std::inserter(set_ViewIds, set_ViewIds.begin()), stl::RetrieveKey());
+    PairwiseMatches mapPutativesMatches;
 
-      graph::indexedGraph putativeGraph(set_ViewIds, getPairs(mapPutativesMatches));
+    // perform the matching
+    system::Timer timer;
+    PairSet pairsPoseKnown;
+    PairSet pairsPoseUnknown;
 
-      graph::exportToGraphvizData(
-        (fs::path(matchesFolder) / "putative_matches.dot").string(),
-        putativeGraph.g);
+    if(matchFromKnownCameraPoses)
+    {
+        for(const auto& p: batchPairs)
+        {
+          if(sfmData.isPoseAndIntrinsicDefined(p.first) && sfmData.isPoseAndIntrinsicDefined(p.second))
+          {
+              pairsPoseKnown.insert(p);
+          }
+          else
+          {
+              pairsPoseUnknown.insert(p);
+          }
+        }
+    }
+    else
+    {
+        pairsPoseUnknown = batchPairs;
     }
-  }
-  */
 
-#ifdef ALICEVISION_DEBUG_MATCHING
+    if(!pairsPoseKnown.empty())
     {
-      ALICEVISION_LOG_DEBUG("PUTATIVE");
-      getStatsMap(mapPutativesMatches);
+      // compute matches from known camera poses when you have an initialization on the camera poses
+      ALICEVISION_LOG_INFO("Putative matches from known poses: " << pairsPoseKnown.size() << " image pairs.");
+
+      sfm::StructureEstimationFromKnownPoses structureEstimator;
+      structureEstimator.match(sfmData, pairsPoseKnown, regionPerView, knownPosesGeometricErrorMax);
+      mapPutativesMatches = structureEstimator.getPutativesMatches();
     }
-#endif
 
-  // c. Geometric filtering of putative matches
-  //    - AContrario Estimation of the desired geometric model
-  //    - Use an upper bound for the a contrario estimated threshold
+    if(!pairsPoseUnknown.empty())
+    {
+        ALICEVISION_LOG_INFO("Putative matches (unknown poses): " << pairsPoseUnknown.size() << " image pairs.");
+        // match feature descriptors between them without geometric notion
 
-  timer.reset();
+        for(const feature::EImageDescriberType descType : describerTypes)
+        {
+          assert(descType != feature::EImageDescriberType::UNINITIALIZED);
+          ALICEVISION_LOG_INFO(EImageDescriberType_enumToString(descType) + " Regions Matching");
 
-  matching::PairwiseMatches geometricMatches;
+          // photometric matching of putative pairs
+          imageCollectionMatcher->Match(randomNumberGenerator, regionPerView, pairsPoseUnknown, descType, mapPutativesMatches);
 
-  ALICEVISION_LOG_INFO("Geometric filtering: using " << matchingImageCollection::EGeometricFilterType_enumToString(geometricFilterType));
+          // TODO: DELI
+          // if(!guided_matching) regionPerView.clearDescriptors()
+        }
 
-  switch(geometricFilterType)
-  {
+    }
 
-    case EGeometricFilterType::NO_FILTERING:
-      geometricMatches = mapPutativesMatches;
-    break;
+    if(mapPutativesMatches.empty())
+      continue;
 
-    case EGeometricFilterType::FUNDAMENTAL_MATRIX:
+    nbPutativesMatches += mapPutativesMatches.size();
+
+    if(geometricFilterType == EGeometricFilterType::HOMOGRAPHY_GROWING)
     {
-      matchingImageCollection::robustModelEstimation(geometricMatches,
-        &sfmData,
-        regionPerView,
-        GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator),
-        mapPutativesMatches,
-        randomNumberGenerator,
-        guidedMatching);
+      // sort putative matches according to their Lowe ratio
+      // This is suggested by [F.Srajer, 2016]: the matches used to be the seeds of the homographies growing are chosen according
+      // to the putative matches order. This modification should improve recall.
+      for(auto& imgPair: mapPutativesMatches)
+      {
+        for(auto& descType: imgPair.second)
+        {
+          IndMatches & matches = descType.second;
+          sortMatches_byDistanceRatio(matches);
+        }
+      }
     }
-    break;
 
-  case EGeometricFilterType::FUNDAMENTAL_WITH_DISTORTION:
-  {
-    matchingImageCollection::robustModelEstimation(geometricMatches,
-      &sfmData,
-      regionPerView,
-      GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator, true),
-      mapPutativesMatches,
-      randomNumberGenerator,
-      guidedMatching);
-  }
-  break;
+    ALICEVISION_LOG_INFO(std::to_string(mapPutativesMatches.size()) << " putative image pair matches");
 
-    case EGeometricFilterType::ESSENTIAL_MATRIX:
+    for(const auto& imageMatch: mapPutativesMatches)
+      ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(imageMatch.first.first) << ", " + std::to_string(imageMatch.first.second) + ") contains " + std::to_string(imageMatch.second.getNbAllMatches()) + " putative matches.");
+
+    // keep putative matches for the export
+    if(savePutativeMatches)
     {
-      matchingImageCollection::robustModelEstimation(geometricMatches,
-        &sfmData,
-        regionPerView,
-        GeometricFilterMatrix_E_AC(geometricErrorMax, maxIteration),
+      for(const auto& imageMatch: mapPutativesMatches)
+        allPutativesMatches.insert(imageMatch);
+    }
+
+    regionsMatchingTime += timer.elapsed();
+    ALICEVISION_LOG_INFO("Task (Regions Matching) done in (s): " + std::to_string(timer.elapsed()));
+
+    /*
+    // TODO: DELI
+    if(exportDebugFiles)
+    {
+      //-- export putative matches Adjacency matrix
+      PairwiseMatchingToAdjacencyMatrixSVG(sfmData.getViews().size(),
         mapPutativesMatches,
-        randomNumberGenerator,
-        guidedMatching);
+        (fs::path(matchesFolder) / "PutativeAdjacencyMatrix.svg").string());
+      //-- export view pair graph once putative graph matches have been computed
+      {
+        std::set<IndexT> set_ViewIds;
 
-      // perform an additional check to remove pairs with poor overlap
-      std::vector<PairwiseMatches::key_type> toRemoveVec;
-      for(PairwiseMatches::const_iterator iterMap = geometricMatches.begin();
-        iterMap != geometricMatches.end(); ++iterMap)
+        std::transform(sfmData.getViews().begin(), sfmData.getViews().end(),
+          std::inserter(set_ViewIds, set_ViewIds.begin()), stl::RetrieveKey());
+
+        graph::indexedGraph putativeGraph(set_ViewIds, getPairs(mapPutativesMatches));
+
+        graph::exportToGraphvizData(
+          (fs::path(matchesFolder) / "putative_matches.dot").string(),
+          putativeGraph.g);
+      }
+    }
+    */
+
+#ifdef ALICEVISION_DEBUG_MATCHING
       {
-        const size_t putativePhotometricCount = mapPutativesMatches.find(iterMap->first)->second.getNbAllMatches();
-        const size_t putativeGeometricCount = iterMap->second.getNbAllMatches();
-        const float ratio = putativeGeometricCount / (float)putativePhotometricCount;
-        if (putativeGeometricCount < 50 || ratio < .3f)
-          toRemoveVec.push_back(iterMap->first); // the image pair will be removed
+        ALICEVISION_LOG_DEBUG("PUTATIVE");
+        getStatsMap(mapPutativesMatches);
       }
+#endif
 
-      // remove discarded pairs
-      for(std::vector<PairwiseMatches::key_type>::const_iterator iter = toRemoveVec.begin();
-          iter != toRemoveVec.end(); ++iter)
-        geometricMatches.erase(*iter);
-    }
-    break;
+    // c. Geometric filtering of putative matches
+    //    - AContrario Estimation of the desired geometric model
+    //    - Use an upper bound for the a contrario estimated threshold
+
+    timer.reset();
 
-    case EGeometricFilterType::HOMOGRAPHY_MATRIX:
+    matching::PairwiseMatches geometricMatches;
+
+    ALICEVISION_LOG_INFO("Geometric filtering: using " << matchingImageCollection::EGeometricFilterType_enumToString(geometricFilterType));
+
+    switch(geometricFilterType)
     {
-      const bool onlyGuidedMatching = true;
-      matchingImageCollection::robustModelEstimation(geometricMatches,
-        &sfmData,
-        regionPerView,
-        GeometricFilterMatrix_H_AC(geometricErrorMax, maxIteration),
-        mapPutativesMatches, randomNumberGenerator, guidedMatching,
-        onlyGuidedMatching ? -1.0 : 0.6);
-    }
-    break;
 
-    case EGeometricFilterType::HOMOGRAPHY_GROWING:
+      case EGeometricFilterType::NO_FILTERING:
+        geometricMatches = mapPutativesMatches;
+      break;
+
+      case EGeometricFilterType::FUNDAMENTAL_MATRIX:
+      {
+        matchingImageCollection::robustModelEstimation(geometricMatches,
+          &sfmData,
+          regionPerView,
+          GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator, false, geometricUseSprt),
+          mapPutativesMatches,
+          randomNumberGenerator,
+          guidedMatching);
+      }
+      break;
+
+    case EGeometricFilterType::FUNDAMENTAL_WITH_DISTORTION:
     {
       matchingImageCollection::robustModelEstimation(geometricMatches,
         &sfmData,
         regionPerView,
-        GeometricFilterMatrix_HGrowing(geometricErrorMax, maxIteration),
+        GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator, true, geometricUseSprt),
         mapPutativesMatches,
         randomNumberGenerator,
         guidedMatching);
     }
     break;
-  }
 
-  ALICEVISION_LOG_INFO(std::to_string(geometricMatches.size()) + " geometric image pair matches:");
-  for(const auto& matchGeo: geometricMatches)
-    ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(matchGeo.first.first) + ", " + std::to_string(matchGeo.first.second) + ") contains " + std::to_string(matchGeo.second.getNbAllMatches()) + " geometric matches.");
+      case EGeometricFilterType::ESSENTIAL_MATRIX:
+      {
+        matchingImageCollection::robustModelEstimation(geometricMatches,
+          &sfmData,
+          regionPerView,
+          GeometricFilterMatrix_E_AC(geometricErrorMax, maxIteration),
+          mapPutativesMatches,
+          randomNumberGenerator,
+          guidedMatching);
+
+        // perform an additional check to remove pairs with poor overlap
+        std::vector<PairwiseMatches::key_type> toRemoveVec;
+        for(PairwiseMatches::const_iterator iterMap = geometricMatches.begin();
+          iterMap != geometricMatches.end(); ++iterMap)
+        {
+          const size_t putativePhotometricCount = mapPutativesMatches.find(iterMap->first)->second.getNbAllMatches();
+          const size_t putativeGeometricCount = iterMap->second.getNbAllMatches();
+          const float ratio = putativeGeometricCount / (float)putativePhotometricCount;
+          if (putativeGeometricCount < 50 || ratio < .3f)
+            toRemoveVec.push_back(iterMap->first); // the image pair will be removed
+        }
 
-  // grid filtering
-  ALICEVISION_LOG_INFO("Grid filtering");
+        // remove discarded pairs
+        for(std::vector<PairwiseMatches::key_type>::const_iterator iter = toRemoveVec.begin();
+            iter != toRemoveVec.end(); ++iter)
+          geometricMatches.erase(*iter);
+      }
+      break;
 
-  PairwiseMatches finalMatches;
-  
-  {
-    for(const auto& geometricMatch: geometricMatches)
-    {
-      //Get the image pair and their matches.
-      const Pair& indexImagePair = geometricMatch.first;
-      const aliceVision::matching::MatchesPerDescType& matchesPerDesc = geometricMatch.second;
+      case EGeometricFilterType::HOMOGRAPHY_MATRIX:
+      {
+        const bool onlyGuidedMatching = true;
+        matchingImageCollection::robustModelEstimation(geometricMatches,
+          &sfmData,
+          regionPerView,
+          GeometricFilterMatrix_H_AC(geometricErrorMax, maxIteration),
+          mapPutativesMatches, randomNumberGenerator, guidedMatching,
+          onlyGuidedMatching ? -1.0 : 0.6);
+      }
+      break;
 
-      for(const auto& match: matchesPerDesc)
+      case EGeometricFilterType::HOMOGRAPHY_GROWING:
       {
-        const feature::EImageDescriberType descType = match.first;
-        assert(descType != feature::EImageDescriberType::UNINITIALIZED);
-        const aliceVision::matching::IndMatches& inputMatches = match.second;
+        matchingImageCollection::robustModelEstimation(geometricMatches,
+          &sfmData,
+          regionPerView,
+          GeometricFilterMatrix_HGrowing(geometricErrorMax, maxIteration),
+          mapPutativesMatches,
+          randomNumberGenerator,
+          guidedMatching);
+      }
+      break;
+    }
+
+    ALICEVISION_LOG_INFO(std::to_string(geometricMatches.size()) + " geometric image pair matches:");
+    for(const auto& matchGeo: geometricMatches)
+      ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(matchGeo.first.first) + ", " + std::to_string(matchGeo.first.second) + ") contains " + std::to_string(matchGeo.second.getNbAllMatches()) + " geometric matches.");
+
+    // grid filtering
+    ALICEVISION_LOG_INFO("Grid filtering");
 
-        const feature::Regions* rRegions = &regionPerView.getRegions(indexImagePair.second, descType);
-        const feature::Regions* lRegions = &regionPerView.getRegions(indexImagePair.first, descType);
+    PairwiseMatches batchFinalMatches;
+    {
+      for(const auto& geometricMatch: geometricMatches)
+      {
+        //Get the image pair and their matches.
+        const Pair& indexImagePair = geometricMatch.first;
+        const aliceVision::matching::MatchesPerDescType& matchesPerDesc = geometricMatch.second;
 
-        // get the regions for the current view pair:
-        if(rRegions && lRegions)
+        for(const auto& match: matchesPerDesc)
         {
-          // sorting function:
-          aliceVision::matching::IndMatches outMatches;
-          sortMatches_byFeaturesScale(inputMatches, *lRegions, *rRegions, outMatches);
+          const feature::EImageDescriberType descType = match.first;
+          assert(descType != feature::EImageDescriberType::UNINITIALIZED);
+          const aliceVision::matching::IndMatches& inputMatches = match.second;
+
+          const feature::Regions* rRegions = &regionPerView.getRegions(indexImagePair.second, descType);
+          const feature::Regions* lRegions = &regionPerView.getRegions(indexImagePair.first, descType);
 
-          if(useGridSort)
+          // get the regions for the current view pair:
+          if(rRegions && lRegions)
           {
-            // TODO: rename as matchesGridOrdering
-              matchesGridFiltering(*lRegions, sfmData.getView(indexImagePair.first).getImgSize(),
-                                   *rRegions, sfmData.getView(indexImagePair.second).getImgSize(),
-                                   indexImagePair, outMatches);
+            // sorting function:
+            aliceVision::matching::IndMatches outMatches;
+            sortMatches_byFeaturesScale(inputMatches, *lRegions, *rRegions, outMatches);
+
+            if(useGridSort)
+            {
+              // TODO: rename as matchesGridOrdering
+                matchesGridFiltering(*lRegions, sfmData.getView(indexImagePair.first).getImgSize(),
+                                     *rRegions, sfmData.getView(indexImagePair.second).getImgSize(),
+                                     indexImagePair, outMatches);
+            }
+            if(numMatchesToKeep > 0)
+            {
+              size_t finalSize = std::min(numMatchesToKeep, outMatches.size());
+              outMatches.resize(finalSize);
+            }
+
+            // std::cout << "Left features: " << lRegions->Features().size() << ", right features: " << rRegions->Features().size() << ", num matches: " << inputMatches.size() << ", num filtered matches: " << outMatches.size() << std::endl;
+            batchFinalMatches[indexImagePair].insert(std::make_pair(descType, outMatches));
           }
-          if(numMatchesToKeep > 0)
+          else
           {
-            size_t finalSize = std::min(numMatchesToKeep, outMatches.size());
-            outMatches.resize(finalSize);
+            ALICEVISION_LOG_INFO("You cannot perform the grid filtering with these regions");
           }
-
-          // std::cout << "Left features: " << lRegions->Features().size() << ", right features: " << rRegions->Features().size() << ", num matches: " << inputMatches.size() << ", num filtered matches: " << outMatches.size() << std::endl;
-          finalMatches[indexImagePair].insert(std::make_pair(descType, outMatches));
-        }
-        else
-        {
-          ALICEVISION_LOG_INFO("You cannot perform the grid filtering with these regions");
         }
       }
+
+      ALICEVISION_LOG_INFO("After grid filtering:");
+      for(const auto& geometricMatch: geometricMatches)
+      {
+        const auto matchGridFiltering = batchFinalMatches.find(geometricMatch.first);
+        if(matchGridFiltering != batchFinalMatches.end())
+          ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(matchGridFiltering->first.first) + ", " + std::to_string(matchGridFiltering->first.second) + ") contains " + std::to_string(matchGridFiltering->second.getNbAllMatches()) + " geometric matches.");
+      }
+    }
+
+#ifdef ALICEVISION_DEBUG_MATCHING
+    {
+      ALICEVISION_LOG_DEBUG("GEOMETRIC");
+      getStatsMap(batchFinalMatches);
+    }
+#endif
+
+    for(const auto& matchesPerPair: batchFinalMatches)
+    {
+      if(!matchesPerPair.second.empty())
+        finalPairs.insert(matchesPerPair.first);
+    }
+
+    if(finalMatchesWriter)
+    {
+      finalMatchesWriter->append(batchFinalMatches.begin(), batchFinalMatches.end());
+    }
+    else
+    {
+      finalMatches.insert(std::make_move_iterator(batchFinalMatches.begin()),
+                          std::make_move_iterator(batchFinalMatches.end()));
     }
 
-    ALICEVISION_LOG_INFO("After grid filtering:");
-    for(const auto& matchGridFiltering: finalMatches)
-      ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(matchGridFiltering.first.first) + ", " + std::to_string(matchGridFiltering.first.second) + ") contains " + std::to_string(matchGridFiltering.second.getNbAllMatches()) + " geometric matches.");
+    geometricFilteringTime += timer.elapsed();
+  }
+
+  if(nbPutativesMatches == 0)
+  {
+    ALICEVISION_LOG_INFO("No putative feature matches.");
+    // If we only compute a selection of matches, we may have no match.
+    return rangeSize ? EXIT_SUCCESS : EXIT_FAILURE;
   }
 
+  // export putative matches
+  if(savePutativeMatches)
+    Save(allPutativesMatches, (fs::path(matchesFolder) / "putativeMatches").string(), fileExtension, matchFilePerImage, filePrefix);
+
+  ALICEVISION_LOG_INFO("Regions matching done in (s): " + std::to_string(regionsMatchingTime));
+
   // export geometric filtered matches
+  system::Timer timer;
   ALICEVISION_LOG_INFO("Save geometric matches.");
-  Save(finalMatches, matchesFolder, fileExtension, matchFilePerImage, filePrefix);
-  ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
+  if(finalMatchesWriter)
+    finalMatchesWriter->close();
+  else
+    Save(finalMatches, matchesFolder, fileExtension, matchFilePerImage, filePrefix);
+  ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(geometricFilteringTime + timer.elapsed()));
 
   // d. Export some statistics
   if(exportDebugFiles)
@@ -615,7 +799,7 @@ int aliceVision_main(int argc, char **argv)
     // export Adjacency matrix
     ALICEVISION_LOG_INFO("Export Adjacency Matrix of the pairwise's geometric matches");
     PairwiseMatchingToAdjacencyMatrixSVG(sfmData.getViews().size(),
-      finalMatches,(fs::path(matchesFolder) / "GeometricAdjacencyMatrix.svg").string());
+      finalPairs,(fs::path(matchesFolder) / "GeometricAdjacencyMatrix.svg").string());
 
     /*
     // export view pair graph once geometric filter have been done
@@ -631,12 +815,5 @@ int aliceVision_main(int argc, char **argv)
     */
   }
 
-#ifdef ALICEVISION_DEBUG_MATCHING
-  {
-    ALICEVISION_LOG_DEBUG("GEOMETRIC");
-    getStatsMap(geometricMatches);
-  }
-#endif
-
   return EXIT_SUCCESS;
 }
@@ -382,12 +382,17 @@ void generateFromVoctree(PairList& allMatches,
       allMatches[descriptorPair.first] = {};
   }
 
+  // random access to the documents for the parallel loop
+  std::vector<std::map<IndexT, std::string>::const_iterator> descriptorsFilesIts;
+  descriptorsFilesIts.reserve(descriptorsFiles.size());
+  for(auto it = descriptorsFiles.cbegin(); it != descriptorsFiles.cend(); ++it)
+    descriptorsFilesIts.push_back(it);
+
   // query each document
-  #pragma omp parallel for
+  #pragma omp parallel for schedule(dynamic)
   for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(descriptorsFiles.size()); ++i)
   {
-    auto itA = descriptorsFiles.cbegin();
-    std::advance(itA, i);
+    auto itA = descriptorsFilesIts[i];
     const IndexT viewIdA = itA->first;
     const std::string featuresPathA = itA->second;
 
@@ -23,11 +23,12 @@
 #include <boost/filesystem.hpp>
 
 #include <cstdlib>
+#include <memory>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 3
 
 using namespace aliceVision;
 
@@ -88,6 +89,8 @@ int aliceVision_main(int argc, char **argv)
   std::pair<std::string,std::string> initialPairString("","");
 
   sfm::ReconstructionEngine_sequentialSfM::Params sfmParams;
+  sfm::ReconstructionEngine_partitionedSfM::Params partitionedParams;
+  std::size_t maxClusterSize = 0;
   bool lockScenePreviouslyReconstructed = true;
   int maxNbMatches = 0;
   int minNbMatches = 0;
@@ -166,6 +169,19 @@ int aliceVision_main(int argc, char **argv)
       "Reprojection error threshold (in pixels) for the localizer estimator (0 for default value according to the estimator).")
     ("localizerEstimatorMaxIterations", po::value<std::size_t>(&sfmParams.localizerEstimatorMaxIterations)->default_value(sfmParams.localizerEstimatorMaxIterations),
       "Max number of RANSAC iterations.")
+    ("localizerUseSprt", po::value<bool>(&sfmParams.localizerUseSprt)->default_value(sfmParams.localizerUseSprt),
+      "Verify the localizer hypotheses with a Sequential Probability Ratio Test (SPRT), only used with loransac: "
+      "the hypotheses are rejected after a few residuals once they are statistically hopeless.")
+    ("pipelinedResection", po::value<bool>(&sfmParams.pipelinedResection)->default_value(sfmParams.pipelinedResection),
+      "Resect the next group of images on a snapshot of the scene while the bundle adjustment of the current group is running. "
+      "The speculative poses are validated and refined on the updated scene before being added.")
+    ("maxClusterSize", po::value<std::size_t>(&maxClusterSize)->default_value(maxClusterSize),
+      "For very large collections, cut the view graph into overlapping clusters of at most this number of images, "
+      "reconstruct each cluster independently and merge them on their shared images before a final bundle adjustment (0: disabled).")
+    ("clusterOverlap", po::value<double>(&partitionedParams.clusterOverlap)->default_value(partitionedParams.clusterOverlap),
+      "Ratio of the cluster size shared with the neighbouring clusters (only used with maxClusterSize).")
+    ("nbParallelClusters", po::value<int>(&partitionedParams.nbParallelClusters)->default_value(partitionedParams.nbParallelClusters),
+      "Number of clusters reconstructed at the same time (only used with maxClusterSize).")
     ("useOnlyMatchesFromInputFolder", po::value<bool>(&useOnlyMatchesFromInputFolder)->default_value(useOnlyMatchesFromInputFolder),
       "Use only matches from the input matchesFolder parameter.\n"
       "Matches folders previously added to the SfMData file will be ignored.")
@@ -311,53 +327,74 @@ int aliceVision_main(int argc, char **argv)
     }
   }
 
-  sfm::ReconstructionEngine_sequentialSfM sfmEngine(
-    sfmData,
-    sfmParams,
-    extraInfoFolder,
-    (fs::path(extraInfoFolder) / "sfm_log.html").string());
+  std::unique_ptr<sfm::ReconstructionEngine> sfmEngine;
 
-  sfmEngine.initRandomSeed(randomSeed);
+  if(maxClusterSize > 0 && sfmData.getViews().size() > maxClusterSize)
+  {
+    partitionedParams.maxClusterSize = maxClusterSize;
+    partitionedParams.clusterParams = sfmParams;
+
+    sfm::ReconstructionEngine_partitionedSfM* partitionedEngine = new sfm::ReconstructionEngine_partitionedSfM(
+      sfmData,
+      partitionedParams,
+      extraInfoFolder);
+
+    // configure the featuresPerView & the matches_provider
+    partitionedEngine->setFeatures(&featuresPerView);
+    partitionedEngine->setMatches(&pairwiseMatches);
+    sfmEngine.reset(partitionedEngine);
+  }
+  else
+  {
+    sfm::ReconstructionEngine_sequentialSfM* sequentialEngine = new sfm::ReconstructionEngine_sequentialSfM(
+      sfmData,
+      sfmParams,
+      extraInfoFolder,
+      (fs::path(extraInfoFolder) / "sfm_log.html").string());
+
+    // configure the featuresPerView & the matches_provider
+    sequentialEngine->setFeatures(&featuresPerView);
+    sequentialEngine->setMatches(&pairwiseMatches);
+    sfmEngine.reset(sequentialEngine);
+  }
 
-  // configure the featuresPerView & the matches_provider
-  sfmEngine.setFeatures(&featuresPerView);
-  sfmEngine.setMatches(&pairwiseMatches);
+  sfmEngine->initRandomSeed(randomSeed);
 
-  if(!sfmEngine.process())
+  if(!sfmEngine->process())
     return EXIT_FAILURE;
 
   // set featuresFolders and matchesFolders relative paths
   {
-      sfmEngine.getSfMData().addFeaturesFolders(featuresFolders);
-      sfmEngine.getSfMData().addMatchesFolders(matchesFolders);
-      sfmEngine.getSfMData().setAbsolutePath(outputSfM);
+      sfmEngine->getSfMData().addFeaturesFolders(featuresFolders);
+      sfmEngine->getSfMData().addMatchesFolders(matchesFolders);
+      sfmEngine->getSfMData().setAbsolutePath(outputSfM);
   }
 
   // get the color for the 3D points
   if(computeStructureColor)
-    sfmEngine.colorize();
+    sfmEngine->colorize();
 
-  sfmEngine.retrieveMarkersId();
+  sfmEngine->retrieveMarkersId();
 
   ALICEVISION_LOG_INFO("Structure from motion took (s): " + std::to_string(timer.elapsed()));
   ALICEVISION_LOG_INFO("Generating HTML report...");
 
-  sfm::generateSfMReport(sfmEngine.getSfMData(), (fs::path(extraInfoFolder) / "sfm_report.html").string());
+  sfm::generateSfMReport(sfmEngine->getSfMData(), (fs::path(extraInfoFolder) / "sfm_report.html").string());
 
   // export to disk computed scene (data & visualizable results)
   ALICEVISION_LOG_INFO("Export SfMData to disk: " + outputSfM);
 
-  sfmDataIO::Save(sfmEngine.getSfMData(), (fs::path(extraInfoFolder) / ("cloud_and_poses" + sfmParams.sfmStepFileExtension)).string(), sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::EXTRINSICS|sfmDataIO::INTRINSICS|sfmDataIO::STRUCTURE));
-  sfmDataIO::Save(sfmEngine.getSfMData(), outputSfM, sfmDataIO::ESfMData::ALL);
+  sfmDataIO::Save(sfmEngine->getSfMData(), (fs::path(extraInfoFolder) / ("cloud_and_poses" + sfmParams.sfmStepFileExtension)).string(), sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::EXTRINSICS|sfmDataIO::INTRINSICS|sfmDataIO::STRUCTURE));
+  sfmDataIO::Save(sfmEngine->getSfMData(), outputSfM, sfmDataIO::ESfMData::ALL);
 
   if(!outputSfMViewsAndPoses.empty())
-   sfmDataIO:: Save(sfmEngine.getSfMData(), outputSfMViewsAndPoses, sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::EXTRINSICS|sfmDataIO::INTRINSICS));
+   sfmDataIO:: Save(sfmEngine->getSfMData(), outputSfMViewsAndPoses, sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::EXTRINSICS|sfmDataIO::INTRINSICS));
 
   ALICEVISION_LOG_INFO("Structure from Motion results:" << std::endl
-    << "\t- # input images: " << sfmEngine.getSfMData().getViews().size() << std::endl
-    << "\t- # cameras calibrated: " << sfmEngine.getSfMData().getValidViews().size() << std::endl
-    << "\t- # poses: " << sfmEngine.getSfMData().getPoses().size() << std::endl
-    << "\t- # landmarks: " << sfmEngine.getSfMData().getLandmarks().size());
+    << "\t- # input images: " << sfmEngine->getSfMData().getViews().size() << std::endl
+    << "\t- # cameras calibrated: " << sfmEngine->getSfMData().getValidViews().size() << std::endl
+    << "\t- # poses: " << sfmEngine->getSfMData().getPoses().size() << std::endl
+    << "\t- # landmarks: " << sfmEngine->getSfMData().getLandmarks().size());
 
   return EXIT_SUCCESS;
 }
@@ -27,7 +27,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 static const int DIMENSION = 128;
 
@@ -54,6 +54,11 @@ int aliceVision_main(int argc, char** argv)
   std::uint32_t restart = 5;
   std::uint32_t LEVELS = 6;
   bool sanityCheck = true;
+  bool outOfCore = false;
+  std::size_t batchSize = 1000000;
+  std::size_t sampleSize = 1000000;
+  std::size_t nbPasses = 1;
+  std::string checkpointFile;
 
   po::options_description allParams("This program is used to load the sift descriptors from a SfMData file and create a vocabulary tree\n"
                                     "It takes as input either a list.txt file containing the a simple list of images (bundler format and older AliceVision version format)\n"
@@ -73,7 +78,12 @@ int aliceVision_main(int argc, char** argv)
     (",k", po::value<uint32_t>(&K)->default_value(10), "The branching factor of the tree")
     ("restart,r", po::value<uint32_t>(&restart)->default_value(5), "Number of times that the kmean is launched for each cluster, the best solution is kept")
     (",L", po::value<uint32_t>(&LEVELS)->default_value(6), "Number of levels of the tree")
-    ("sanitycheck,s", po::value<bool>(&sanityCheck)->default_value(sanityCheck), "Perform a sanity check at the end of the creation of the vocabulary tree. The sanity check is a query to the database with the same documents/images useed to train the vocabulary tree");
+    ("sanitycheck,s", po::value<bool>(&sanityCheck)->default_value(sanityCheck), "Perform a sanity check at the end of the creation of the vocabulary tree. The sanity check is a query to the database with the same documents/images useed to train the vocabulary tree")
+    ("outOfCore", po::value<bool>(&outOfCore)->default_value(outOfCore), "Build the tree level by level by streaming the descriptors from the files, instead of loading all of them in memory")
+    ("batchSize", po::value<std::size_t>(&batchSize)->default_value(batchSize), "Out-of-core: number of descriptors read at once")
+    ("sampleSize", po::value<std::size_t>(&sampleSize)->default_value(sampleSize), "Out-of-core: maximal number of descriptors sampled at each level to initialize the clusters")
+    ("nbPasses", po::value<std::size_t>(&nbPasses)->default_value(nbPasses), "Out-of-core: number of mini-batch k-means passes over the descriptors at each level")
+    ("checkpoint", po::value<std::string>(&checkpointFile)->default_value(checkpointFile), "Out-of-core: tree file saved after each level, used to resume an interrupted build");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -122,71 +132,126 @@ int aliceVision_main(int argc, char** argv)
     return EXIT_FAILURE;
   }
 
-  std::vector<DescriptorFloat> descriptors;
-
-  std::vector<size_t> descRead;
-  ALICEVISION_COUT("Reading descriptors from " << sfmDataFilename);
-  auto detect_start = std::chrono::steady_clock::now();
-  size_t numTotDescriptors = aliceVision::voctree::readDescFromFiles<DescriptorFloat, DescriptorUChar>(sfmData, featuresFolders, descriptors, descRead);
-  auto detect_end = std::chrono::steady_clock::now();
-  auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
-  if(descriptors.empty())
-  {
-    ALICEVISION_CERR("No descriptors loaded!!");
-    return EXIT_FAILURE;
-  }
-
-  ALICEVISION_COUT("Done! " << descRead.size() << " sets of descriptors read for a total of " << numTotDescriptors << " features");
-  ALICEVISION_COUT("Reading took " << detect_elapsed.count() << " sec");
-
-  // Create tree
   aliceVision::voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0));
   builder.setVerbose(tbVerbosity);
   builder.kmeans().setRestarts(restart);
-  ALICEVISION_COUT("Building a tree of L=" << LEVELS << " levels with a branching factor of k=" << K);
-  detect_start = std::chrono::steady_clock::now();
-  builder.build(descriptors, K, LEVELS);
-  detect_end = std::chrono::steady_clock::now();
-  detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
-  ALICEVISION_COUT("Tree created in " << ((float) detect_elapsed.count()) / 1000 << " sec");
-  ALICEVISION_COUT(builder.tree().centers().size() << " centers");
-  ALICEVISION_COUT("Saving vocabulary tree as " << treeName);
-  builder.tree().save(treeName);
 
   aliceVision::voctree::SparseHistogramPerImage allSparseHistograms;
-  // temporary vector used to save all the visual word for each image before adding them to documents
-  std::vector<aliceVision::voctree::Word> imgVisualWords;
-  ALICEVISION_COUT("Quantizing the features");
-  size_t offset = 0; ///< this is used to align to the features of a given image in 'feature'
-  detect_start = std::chrono::steady_clock::now();
-  // pass each feature through the vocabulary tree to get the associated visual word
-  // for each read images, recover the number of features in it from descRead and loop over the features
-  for(size_t i = 0; i < descRead.size(); ++i)
+  std::chrono::steady_clock::time_point detect_start;
+  std::chrono::steady_clock::time_point detect_end;
+  std::chrono::milliseconds detect_elapsed;
+
+  if(outOfCore)
   {
-    // for each image:
-    // clear the temporary vector used to save all the visual word and allocate the proper size
-    imgVisualWords.clear();
-    // allocate as many visual words as the number of the features in the image
-    imgVisualWords.resize(descRead[i], 0);
-
-    #pragma omp parallel for
-    for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(descRead[i]); ++j)
+    std::map<IndexT, std::string> descriptorsFilesPerView;
+    aliceVision::voctree::getListOfDescriptorFiles(sfmData, featuresFolders, descriptorsFilesPerView);
+
+    std::vector<std::string> descriptorsFiles;
+    for(const auto& descriptorsFile : descriptorsFilesPerView)
+      descriptorsFiles.push_back(descriptorsFile.second);
+
+    if(descriptorsFiles.empty())
     {
-      //	store the visual word associated to the feature in the temporary list
-      imgVisualWords[j] = builder.tree().quantize(descriptors[ j + offset ]);
+      ALICEVISION_CERR("No descriptors loaded!!");
+      return EXIT_FAILURE;
     }
-    aliceVision::voctree::SparseHistogram histo;
-    aliceVision::voctree::computeSparseHistogram(imgVisualWords, histo);
-    // add the vector to the documents
-    allSparseHistograms[i] = histo;
 
-    // update the offset
-    offset += descRead[i];
+    // Create tree
+    aliceVision::voctree::DescriptorFilesStream<DescriptorFloat, DescriptorUChar> stream(descriptorsFiles, batchSize);
+    ALICEVISION_COUT("Building a tree of L=" << LEVELS << " levels with a branching factor of k=" << K << " from " << descriptorsFiles.size() << " descriptor files");
+    detect_start = std::chrono::steady_clock::now();
+    try
+    {
+      builder.buildOutOfCore(stream, K, LEVELS, sampleSize, nbPasses, checkpointFile);
+    }
+    catch(const std::exception& e)
+    {
+      ALICEVISION_CERR("ERROR: " << e.what());
+      return EXIT_FAILURE;
+    }
+    detect_end = std::chrono::steady_clock::now();
+    detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
+    ALICEVISION_COUT("Tree created in " << ((float) detect_elapsed.count()) / 1000 << " sec");
+    ALICEVISION_COUT(builder.tree().centers().size() << " centers");
+    ALICEVISION_COUT("Saving vocabulary tree as " << treeName);
+    builder.tree().save(treeName);
+
+    ALICEVISION_COUT("Quantizing the features");
+    detect_start = std::chrono::steady_clock::now();
+    // read the descriptors of each image again to get its visual words
+    std::vector<DescriptorFloat> descriptors;
+    for(size_t i = 0; i < descriptorsFiles.size(); ++i)
+    {
+      aliceVision::feature::loadDescsFromBinFile<DescriptorFloat, DescriptorUChar>(descriptorsFiles[i], descriptors, false);
+      allSparseHistograms[i] = builder.tree().quantizeToSparse(descriptors);
+    }
+    detect_end = std::chrono::steady_clock::now();
+    detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
+    ALICEVISION_COUT("Feature quantization took " << detect_elapsed.count() << " sec");
   }
-  detect_end = std::chrono::steady_clock::now();
-  detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
-  ALICEVISION_COUT("Feature quantization took " << detect_elapsed.count() << " sec");
+  else
+  {
+    std::vector<DescriptorFloat> descriptors;
+
+    std::vector<size_t> descRead;
+    ALICEVISION_COUT("Reading descriptors from " << sfmDataFilename);
+    detect_start = std::chrono::steady_clock::now();
+    size_t numTotDescriptors = aliceVision::voctree::readDescFromFiles<DescriptorFloat, DescriptorUChar>(sfmData, featuresFolders, descriptors, descRead);
+    detect_end = std::chrono::steady_clock::now();
+    detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
+    if(descriptors.empty())
+    {
+      ALICEVISION_CERR("No descriptors loaded!!");
+      return EXIT_FAILURE;
+    }
 
+    ALICEVISION_COUT("Done! " << descRead.size() << " sets of descriptors read for a total of " << numTotDescriptors << " features");
+    ALICEVISION_COUT("Reading took " << detect_elapsed.count() << " sec");
+
+    // Create tree
+    ALICEVISION_COUT("Building a tree of L=" << LEVELS << " levels with a branching factor of k=" << K);
+    detect_start = std::chrono::steady_clock::now();
+    builder.build(descriptors, K, LEVELS);
+    detect_end = std::chrono::steady_clock::now();
+    detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
+    ALICEVISION_COUT("Tree created in " << ((float) detect_elapsed.count()) / 1000 << " sec");
+    ALICEVISION_COUT(builder.tree().centers().size() << " centers");
+    ALICEVISION_COUT("Saving vocabulary tree as " << treeName);
+    builder.tree().save(treeName);
+
+    // temporary vector used to save all the visual word for each image before adding them to documents
+    std::vector<aliceVision::voctree::Word> imgVisualWords;
+    ALICEVISION_COUT("Quantizing the features");
+    size_t offset = 0; ///< this is used to align to the features of a given image in 'feature'
+    detect_start = std::chrono::steady_clock::now();
+    // pass each feature through the vocabulary tree to get the associated visual word
+    // for each read images, recover the number of features in it from descRead and loop over the features
+    for(size_t i = 0; i < descRead.size(); ++i)
+    {
+      // for each image:
+      // clear the temporary vector used to save all the visual word and allocate the proper size
+      imgVisualWords.clear();
+      // allocate as many visual words as the number of the features in the image
+      imgVisualWords.resize(descRead[i], 0);
+
+      #pragma omp parallel for
+      for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(descRead[i]); ++j)
+      {
+        //	store the visual word associated to the feature in the temporary list
+        imgVisualWords[j] = builder.tree().quantize(descriptors[ j + offset ]);
+      }
+      aliceVision::voctree::SparseHistogram histo;
+      aliceVision::voctree::computeSparseHistogram(imgVisualWords, histo);
+      // add the vector to the documents
+      allSparseHistograms[i] = histo;
+
+      // update the offset
+      offset += descRead[i];
+    }
+    detect_end = std::chrono::steady_clock::now();
+    detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
+    ALICEVISION_COUT("Feature quantization took " << detect_elapsed.count() << " sec");
+  }
 
   ALICEVISION_COUT("Creating the database...");
   // Add each object (document) to the database